@@ -9,13 +9,16 @@
 // Arguments:
 // - cchRowWidth - the length of the default text attribute
 // - attr - the default text attribute
+// - table - the attribute table of the buffer that this row belongs to
 // Return Value:
 // - constructed object
 // Note: will throw exception if unable to allocate memory for text attribute storage
-ATTR_ROW::ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr)
+ATTR_ROW::ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr, TextAttributeTable& table) :
+    _cchRowWidth{ cchRowWidth },
+    _table{ &table }
 {
-    _list.push_back(TextAttributeRun(cchRowWidth, attr));
-    _cchRowWidth = cchRowWidth;
+    _list.push_back(TextAttributeIdRun(cchRowWidth, _table->Intern(attr)));
+    _UpdateRunEnds();
 }
 
 // Routine Description:
@@ -24,8 +27,10 @@ ATTR_ROW::ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr)
 // - attr - The default text attributes to use on text in this row.
 void ATTR_ROW::Reset(const TextAttribute attr)
 {
+    const auto id = _table->Intern(attr);
     _list.clear();
-    _list.push_back(TextAttributeRun(_cchRowWidth, attr));
+    _list.push_back(TextAttributeIdRun(_cchRowWidth, id));
+    _UpdateRunEnds();
 }
 
 // Routine Description:
@@ -79,6 +84,38 @@ void ATTR_ROW::Resize(const size_t newWidth)
         // in memory. We're not going to waste time redimensioning the array in the heap. We're just noting that the useful
         // portions of it have changed.
     }
+
+    _UpdateRunEnds();
+}
+
+// Routine Description:
+// - Flags every attribute id that this row refers to. Used when compacting
+//   the attribute table.
+// Arguments:
+// - inUse - one entry per id in the table. Entries for ids we use are set to true.
+// Return Value:
+// - <none>
+void ATTR_ROW::MarkAttributesInUse(std::vector<bool>& inUse) const
+{
+    for (const auto& run : _list)
+    {
+        inUse.at(run.GetAttributeId()) = true;
+    }
+}
+
+// Routine Description:
+// - Renumbers the attribute ids that this row refers to after the attribute
+//   table was compacted.
+// Arguments:
+// - remap - the new id for each old id, as returned by TextAttributeTable::Compact
+// Return Value:
+// - <none>
+void ATTR_ROW::RemapAttributes(const std::vector<TextAttributeId>& remap)
+{
+    for (auto& run : _list)
+    {
+        run.SetAttributeId(remap.at(run.GetAttributeId()));
+    }
 }
 
 // Routine Description:
@@ -108,7 +145,7 @@ TextAttribute ATTR_ROW::GetAttrByColumn(const size_t column,
 {
     THROW_HR_IF(E_INVALIDARG, column >= _cchRowWidth);
     const auto runPos = FindAttrIndex(column, pApplies);
-    return _list.at(runPos).GetAttributes();
+    return _table->Get(_list.at(runPos).GetAttributeId());
 }
 
 // Routine Description:
@@ -122,6 +159,8 @@ size_t ATTR_ROW::GetNumberOfRuns() const noexcept
 
 // Routine Description:
 // - This routine finds the nth attribute in this ATTR_ROW.
+// - The first run that ends after the index is the one that covers it, so we
+//   binary search the run ends for it.
 // Arguments:
 // - index - which attribute to find
 // - applies - on output, contains corrected length of indexed attr.
@@ -133,38 +172,20 @@ size_t ATTR_ROW::FindAttrIndex(const size_t index, size_t* const pApplies) const
 {
     FAIL_FAST_IF(!(index < _cchRowWidth)); // The requested index cannot be longer than the total length described by this set of Attrs.
 
-    size_t cTotalLength = 0;
-
     FAIL_FAST_IF(!(_list.size() > 0)); // There should be a non-zero and positive number of items in the array.
+    FAIL_FAST_IF(_runEnds.size() != _list.size()); // Something changed the runs without rebuilding their ends.
 
-    // Scan through the internal array from position 0 adding up the lengths that each attribute applies to
-    auto runPos = _list.cbegin();
-    do
-    {
-        cTotalLength += runPos->GetLength();
-
-        if (cTotalLength > index)
-        {
-            // If we've just passed up the requested index with the length we added, break early
-            break;
-        }
+    const auto runEnd = std::upper_bound(_runEnds.cbegin(), _runEnds.cend(), index);
 
-        runPos++;
-    } while (runPos < _list.cend());
+    // if we didn't find a run that ends after the index, then this ATTR_ROW wasn't filled with enough attributes for the entire row of characters
+    FAIL_FAST_IF(runEnd == _runEnds.cend());
 
-    // we should have broken before falling out the while case.
-    // if we didn't break, then this ATTR_ROW wasn't filled with enough attributes for the entire row of characters
-    FAIL_FAST_IF(runPos >= _list.cend());
-
-    // The remaining iterator position is the position of the attribute that is applicable at the position requested (index)
-    // Calculate its remaining applicability if requested
-
-    // The length on which the found attribute applies is the total length seen so far minus the index we were searching for.
-    FAIL_FAST_IF(!(cTotalLength > index)); // The length of all attributes we counted up so far should be longer than the index requested or we'll underflow.
+    const auto runPos = static_cast<size_t>(std::distance(_runEnds.cbegin(), runEnd));
 
+    // The found attribute applies from the index up to the end of its run.
     if (nullptr != pApplies)
     {
-        const auto attrApplies = cTotalLength - index;
+        const auto attrApplies = *runEnd - index;
         FAIL_FAST_IF(!(attrApplies > 0)); // An attribute applies for >0 characters
         // MSFT: 17130145 - will restore this and add a better assert to catch the real issue.
         //FAIL_FAST_IF(!(attrApplies <= _cchRowWidth)); // An attribute applies for a maximum of the total length available to us
@@ -172,7 +193,7 @@ size_t ATTR_ROW::FindAttrIndex(const size_t index, size_t* const pApplies) const
         *pApplies = attrApplies;
     }
 
-    return runPos - _list.cbegin();
+    return runPos;
 }
 
 // Routine Description:
@@ -220,13 +241,60 @@ void ATTR_ROW::ReplaceLegacyAttrs(_In_ WORD wToBeReplacedAttr, _In_ WORD wReplac
 // - <none>
 void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAttribute& replaceWith) noexcept
 {
-    for (auto& run : _list)
+    try
     {
-        if (run.GetAttributes() == toBeReplacedAttr)
+        // If the attribute isn't in the table, no row can be using it.
+        if (!_table->Find(toBeReplacedAttr))
+        {
+            return;
+        }
+
+        // Interning might compact the table and renumber everything,
+        // so only look up the id we're replacing once that's done.
+        const auto replaceWithId = _table->Intern(replaceWith);
+        const auto toBeReplacedId = _table->Find(toBeReplacedAttr);
+        if (!toBeReplacedId)
         {
-            run.SetAttributes(replaceWith);
+            return;
+        }
+
+        for (auto& run : _list)
+        {
+            if (run.GetAttributeId() == *toBeReplacedId)
+            {
+                run.SetAttributeId(replaceWithId);
+            }
         }
     }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Replaces the elements [begin, end) of a container with the given range,
+//   in place. Only the elements after the replaced ones have to move.
+// Arguments:
+// - container - the container to modify
+// - begin - the index of the first element to replace
+// - end - the index just past the last element to replace
+// - replacement - the elements to put in their place
+// Return Value:
+// - <none>
+template<typename Container, typename Range>
+static void _Splice(Container& container, const size_t begin, const size_t end, const Range& replacement)
+{
+    const size_t replaced = end - begin;
+    const size_t overwritten = std::min(replaced, replacement.size());
+
+    std::copy_n(replacement.begin(), overwritten, container.begin() + begin);
+
+    if (replaced > overwritten)
+    {
+        container.erase(container.begin() + begin + overwritten, container.begin() + end);
+    }
+    else
+    {
+        container.insert(container.begin() + end, replacement.begin() + overwritten, replacement.end());
+    }
 }
 
 // Routine Description:
@@ -234,15 +302,16 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
 // - For example, if the current row was was [{4, BLUE}], the merge string
 //   was [{ 2, RED }], with (StartIndex, EndIndex) = (1, 2),
 //   then the row would modified to be = [{ 1, BLUE}, {2, RED}, {1, BLUE}].
+// - The row is modified in place: we only rebuild the existing runs that the
+//   insertion touches, and splice their replacement in.
 // Arguments:
-// - rgInsertAttrs - The array of attrRuns to merge into this row.
-// - cInsertAttrs - The number of elements in rgInsertAttrs
+// - newAttrs - The array of attrRuns to merge into this row. Their lengths must add up to iEnd - iStart + 1.
 // - iStart - The index in the row to place the array of runs.
 // - iEnd - the final index of the merge runs
 // - BufferWidth - the width of the row.
 // Return Value:
-// - STATUS_NO_MEMORY if there wasn't enough memory to insert the runs
-//   otherwise STATUS_SUCCESS if we were successful.
+// - S_OK if we were successful.
+// Note: will throw if we're unable to allocate memory for the runs
 [[nodiscard]] HRESULT ATTR_ROW::InsertAttrRuns(const std::basic_string_view<TextAttributeRun> newAttrs,
                                                const size_t iStart,
                                                const size_t iEnd,
@@ -251,317 +320,146 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
     // Definitions:
     // Existing Run = The run length encoded color array we're already storing in memory before this was called.
     // Insert Run = The run length encoded color array that someone is asking us to inject into our stored memory run.
-    // New Run = The run length encoded color array that we have to allocate and rebuild to store internally
-    //           which will replace Existing Run at the end of this function.
+    // Replacement Run = The runs that take the place of the existing runs covering iStart through iEnd.
     // Example:
     // cBufferWidth = 10.
     // Existing Run: R3 -> G5 -> B2
     // Insert Run: Y1 -> N1 at iStart = 5 and iEnd = 6
-    //            (rgInsertAttrs is a 2 length array with Y1->N1 in it and cInsertAttrs = 2)
+    // The G5 covers both iStart and iEnd, so it's the only existing run we'll touch.
+    // Replacement Run: G2 -> Y1 -> N1 -> G1
     // Final Run: R3 -> G2 -> Y1 -> N1 -> G1 -> B2
 
-    // We'll need to know what the last valid column is for some calculations versus iEnd
-    // because iEnd is specified to us as an inclusive index value.
-    // Do the -1 math here now so we don't have to have -1s scattered all over this function.
-    const size_t iLastBufferCol = cBufferWidth - 1;
-
-    // If the insertion size is 1, do some pre-processing to
-    // see if we can get this done quickly.
-    if (newAttrs.size() == 1)
+    if (newAttrs.empty())
     {
-        // Get the new color attribute we're trying to apply
-        const TextAttribute NewAttr = newAttrs.at(0).GetAttributes();
-
-        // If the existing run was only 1 element...
-        // ...and the new color is the same as the old, we don't have to do anything and can exit quick.
-        if (_list.size() == 1 && _list.at(0).GetAttributes() == NewAttr)
-        {
-            return S_OK;
-        }
-        // .. otherwise if we internally have a list of 2 or more and we're about to insert a single color
-        // it's possible that we just walk left-to-right through the row and find a quick exit.
-        else if (iStart > 0 && iStart == iEnd)
-        {
-            // First we try to find the run where the insertion happens, using lowerBound and upperBound to track
-            // where we are currently at.
-            size_t lowerBound = 0;
-            size_t upperBound = 0;
-            for (size_t i = 0; i < _list.size(); i++)
-            {
-                upperBound += _list.at(i).GetLength();
-                if (iStart >= lowerBound && iStart < upperBound)
-                {
-                    const auto curr = std::next(_list.begin(), i);
-
-                    // The run that we try to insert into has the same color as the new one.
-                    // e.g.
-                    // AAAAABBBBBBBCCC
-                    //       ^
-                    // AAAAABBBBBBBCCC
-                    //
-                    // 'B' is the new color and '^' represents where iStart is. We don't have to
-                    // do anything.
-                    if (curr->GetAttributes() == NewAttr)
-                    {
-                        return S_OK;
-                    }
-
-                    // If the insertion happens at current run's lower boundary...
-                    if (iStart == lowerBound)
-                    {
-                        const auto prev = std::prev(curr, 1);
-                        // ... and the previous run has the same color as the new one, we can
-                        // just adjust the counts in the existing two elements in our internal list.
-                        // e.g.
-                        // AAAAABBBBBBBCCC
-                        //      ^
-                        // AAAAAABBBBBBCCC
-                        //
-                        // Here 'A' is the new color.
-                        if (NewAttr == prev->GetAttributes())
-                        {
-                            prev->IncrementLength();
-                            curr->DecrementLength();
-
-                            // If we just reduced the right half to zero, just erase it out of the list.
-                            if (curr->GetLength() == 0)
-                            {
-                                _list.erase(curr);
-                            }
-
-                            return S_OK;
-                        }
-                    }
-                }
-
-                // Advance one run in the _list.
-                lowerBound = upperBound;
-
-                // The lowerBound is larger than iStart, which means we fail to find an early exit at the run
-                // where the insertion happens. We can just break out.
-                if (lowerBound > iStart)
-                {
-                    break;
-                }
-            }
-        }
+        return S_OK;
     }
 
+    // Runs only store ids into the attribute table, so look those up first.
+    const auto insertRuns = _InternRuns(newAttrs);
+
     // If we're about to cover the entire existing run with a new one, we can also make an optimization.
-    if (iStart == 0 && iEnd == iLastBufferCol)
+    if (iStart == 0 && iEnd == cBufferWidth - 1)
     {
         // Just dump what we're given over what we have and call it a day.
-        _list.assign(newAttrs.cbegin(), newAttrs.cend());
+        _list.assign(insertRuns.cbegin(), insertRuns.cend());
+        _UpdateRunEnds();
 
         return S_OK;
     }
 
-    // In the worst case scenario, we will need a new run that is the length of
-    // The existing run in memory + The new run in memory + 1.
-    // This worst case occurs when we inject a new item in the middle of an existing run like so
-    // Existing R3->B5->G2, Insertion Y2 starting at 5 (in the middle of the B5)
-    // becomes R3->B2->Y2->B1->G2.
-    // The original run was 3 long. The insertion run was 1 long. We need 1 more for the
-    // fact that an existing piece of the run was split in half (to hold the latter half).
-    const size_t cNewRun = _list.size() + newAttrs.size() + 1;
-    std::vector<TextAttributeRun> newRun;
-    newRun.resize(cNewRun);
-
-    // We will start analyzing from the beginning of our existing run.
-    // Use some pointers to keep track of where we are in walking through our runs.
-
-    // Get the existing run that we'll be updating/manipulating.
-    const auto existingRun = _list.begin();
-    auto pExistingRunPos = existingRun;
-    const auto pExistingRunEnd = existingRun + _list.size();
-    auto pInsertRunPos = newAttrs.begin();
-    size_t cInsertRunRemaining = newAttrs.size();
-    auto pNewRunPos = newRun.begin();
-    size_t iExistingRunCoverage = 0;
-
-    // Copy the existing run into the new buffer up to the "start index" where the new run will be injected.
-    // If the new run starts at 0, we have nothing to copy from the beginning.
-    if (iStart != 0)
-    {
-        // While we're less than the desired insertion position...
-        while (iExistingRunCoverage < iStart)
+    // Find the existing runs that the insertion starts and ends in.
+    // FindAttrIndex tells us how many columns are left in the run from the given one on,
+    // which gives us the first run's start column and the last run's end column.
+    size_t firstApplies = 0;
+    const auto firstRun = FindAttrIndex(iStart, &firstApplies);
+    const auto firstRunStart = iStart + firstApplies - _list.at(firstRun).GetLength();
+
+    size_t lastApplies = 0;
+    const auto lastRun = FindAttrIndex(iEnd, &lastApplies);
+    const auto lastRunEnd = iEnd + lastApplies;
+
+    // Build the replacement: whatever is left of the first run on the left of the insertion,
+    // then the insert run, then whatever is left of the last run on the right of it.
+    // Neighbors with the same attribute are merged as we go.
+    til::small_vector<TextAttributeIdRun, 4> replacement;
+    const auto append = [&](const size_t length, const TextAttributeId id) {
+        if (length == 0)
         {
-            // Add up how much length we can cover by copying an item from the existing run.
-            iExistingRunCoverage += pExistingRunPos->GetLength();
-
-            // Copy it to the new run buffer and advance both pointers.
-            *pNewRunPos++ = *pExistingRunPos++;
+            return;
         }
 
-        // When we get to this point, we've copied full segments from the original existing run
-        // into our new run buffer. We will have 1 or more full segments of color attributes and
-        // we MIGHT have to cut the last copied segment's length back depending on where the inserted
-        // attributes will fall in the final/new run.
-        // Some examples:
-        // - Starting with the original string R3 -> G5 -> B2
-        // - 1. If the insertion is Y5 at start index 3
-        //      We are trying to get a result/final/new run of R3 -> Y5 -> B2.
-        //      We just copied R3 to the new destination buffer and we cang skip down and start inserting the new attrs.
-        // - 2. If the insertion is Y3 at start index 5
-        //      We are trying to get a result/final/new run of R3 -> G2 -> Y3 -> B2.
-        //      We just copied R3 -> G5 to the new destination buffer with the code above.
-        //      But the insertion is going to cut out some of the length of the G5.
-        //      We need to fix this up below so it says G2 instead to leave room for the Y3 to fit in
-        //      the new/final run.
-
-        // Copying above advanced the pointer to an empty cell beyond what we copied.
-        // Back up one cell so we can manipulate the final item we copied from the existing run to the new run.
-        pNewRunPos--;
-
-        // Fetch out the length so we can fix it up based on the below conditions.
-        size_t length = pNewRunPos->GetLength();
-
-        // If we've covered more cells already than the start of the attributes to be inserted...
-        if (iExistingRunCoverage > iStart)
+        if (!replacement.empty() && replacement.back().GetAttributeId() == id)
         {
-            // ..then subtract some of the length of the final cell we copied.
-            // We want to take remove the difference in distance between the cells we've covered in the new
-            // run and the insertion point.
-            // (This turns G5 into G2 from Example 2 just above)
-            length -= (iExistingRunCoverage - iStart);
+            replacement.back().SetLength(replacement.back().GetLength() + length);
         }
-
-        // Now we're still on that "last cell copied" into the new run.
-        // If the color of that existing copied cell matches the color of the first segment
-        // of the run we're about to insert, we can just increment the length to extend the coverage.
-        if (pNewRunPos->GetAttributes() == pInsertRunPos->GetAttributes())
+        else
         {
-            length += pInsertRunPos->GetLength();
-
-            // Since the color matched, we have already "used up" part of the insert run
-            // and can skip it in our big "memcopy" step below that will copy the bulk of the insert run.
-            cInsertRunRemaining--;
-            pInsertRunPos++;
+            replacement.push_back(TextAttributeIdRun(length, id));
         }
+    };
 
-        // We're done manipulating the length. Store it back.
-        pNewRunPos->SetLength(length);
-
-        // Now that we're done adjusting the last copied item, advance the pointer into a fresh/blank
-        // part of the new run array.
-        pNewRunPos++;
+    append(iStart - firstRunStart, _list.at(firstRun).GetAttributeId());
+    for (const auto& run : insertRuns)
+    {
+        append(run.GetLength(), run.GetAttributeId());
     }
+    append(lastRunEnd - (iEnd + 1), _list.at(lastRun).GetAttributeId());
 
-    // Bulk copy the majority (or all, depending on circumstance) of the insert run into the final run buffer.
-    std::copy_n(pInsertRunPos, cInsertRunRemaining, pNewRunPos);
+    RETURN_HR_IF(E_INVALIDARG, replacement.empty());
 
-    // Advance the new run pointer into the position just after everything we copied.
-    pNewRunPos += cInsertRunRemaining;
-
-    // We're technically done with the insert run now and have 0 remaining, but won't bother updating its pointers
-    // and counts any further because we won't use them.
-
-    // Now we need to move our pointer for the original existing run forward and update our counts
-    // on how many cells we could have copied from the source before finishing off the new run.
-    while (iExistingRunCoverage <= iEnd)
+    // The runs right outside of the ones we're replacing might have the same attribute
+    // as the ends of the replacement. If so, swallow them too.
+    // e.g. Existing R3 -> G5 -> B2, Insert B5 at iStart = 3 and iEnd = 7 gives R3 -> B7.
+    auto spliceBegin = firstRun;
+    auto spliceEnd = lastRun + 1;
+    if (spliceBegin > 0 && _list.at(spliceBegin - 1).GetAttributeId() == replacement.front().GetAttributeId())
     {
-        FAIL_FAST_IF(!(pExistingRunPos != pExistingRunEnd));
-        iExistingRunCoverage += pExistingRunPos->GetLength();
-        pExistingRunPos++;
+        spliceBegin--;
+        replacement.front().SetLength(replacement.front().GetLength() + _list.at(spliceBegin).GetLength());
     }
-
-    // If we still have original existing run cells remaining, copy them into the final new run.
-    if (pExistingRunPos != pExistingRunEnd || iExistingRunCoverage != (iEnd + 1))
+    if (spliceEnd < _list.size() && _list.at(spliceEnd).GetAttributeId() == replacement.back().GetAttributeId())
     {
-        // Back up one cell so we can inspect the most recent item copied into the new run for optimizations.
-        pNewRunPos--;
-
-        // We advanced the existing run pointer and its count to on or past the end of what the insertion run filled in.
-        // If this ended up being past the end of what the insertion run covers, we have to account for the cells after
-        // the insertion run but before the next piece of the original existing run.
-        // The example in this case is if we had...
-        // Existing Run = R3 -> G5 -> B2 -> X5
-        // Insert Run = Y2 @ iStart = 7 and iEnd = 8
-        // ... then at this point in time, our states would look like...
-        // New Run so far = R3 -> G4 -> Y2
-        // Existing Run Pointer is at X5
-        // Existing run coverage count at 3 + 5 + 2 = 10.
-        // However, in order to get the final desired New Run
-        //   (which is R3 -> G4 -> Y2 -> B1 -> X5)
-        //   we would need to grab a piece of that B2 we already skipped past.
-        // iExistingRunCoverage = 10. iEnd = 8. iEnd+1 = 9. 10 > 9. So we skipped something.
-        if (iExistingRunCoverage > (iEnd + 1))
-        {
-            // Back up the existing run pointer so we can grab the piece we skipped.
-            pExistingRunPos--;
-
-            // If the color matches what's already in our run, just increment the count value.
-            // This case is slightly off from the example above. This case is for if the B2 above was actually Y2.
-            // That Y2 from the existing run is the same color as the Y2 we just filled a few columns left in the final run
-            // so we can just adjust the final run's column count instead of adding another segment here.
-            if (pNewRunPos->GetAttributes() == pExistingRunPos->GetAttributes())
-            {
-                size_t length = pNewRunPos->GetLength();
-                length += (iExistingRunCoverage - (iEnd + 1));
-                pNewRunPos->SetLength(length);
-            }
-            else
-            {
-                // If the color didn't match, then we just need to copy the piece we skipped and adjust
-                // its length for the discrepancy in columns not yet covered by the final/new run.
+        replacement.back().SetLength(replacement.back().GetLength() + _list.at(spliceEnd).GetLength());
+        spliceEnd++;
+    }
 
-                // Move forward to a blank spot in the new run
-                pNewRunPos++;
+    _Splice(_list, spliceBegin, spliceEnd, replacement);
+    _UpdateRunEnds();
 
-                // Copy the existing run's color information to the new run
-                pNewRunPos->SetAttributes(pExistingRunPos->GetAttributes());
+    return S_OK;
+}
 
-                // Adjust the length of that copied color to cover only the reduced number of columns needed
-                // now that some have been replaced by the insert run.
-                pNewRunPos->SetLength(iExistingRunCoverage - (iEnd + 1));
-            }
+// Routine Description:
+// - Looks up the attribute table ids for runs that are about to be inserted into this row.
+// - Interning can compact the table when it's full, which renumbers every id that we've
+//   looked up so far. If that happens, we start over. If it happens again, there's
+//   really no room left for these attributes.
+// Arguments:
+// - runs - the runs to look up
+// Return Value:
+// - the same runs, with attribute ids instead of attributes
+// Note: will throw E_OUTOFMEMORY if the attributes can't fit into the table
+til::small_vector<TextAttributeIdRun, 4> ATTR_ROW::_InternRuns(const std::basic_string_view<TextAttributeRun> runs) const
+{
+    til::small_vector<TextAttributeIdRun, 4> idRuns;
+    idRuns.reserve(runs.size());
 
-            // Now that we're done recovering a piece of the existing run we skipped, move the pointer forward again.
-            pExistingRunPos++;
-        }
+    for (auto attempt = 0; attempt < 2; ++attempt)
+    {
+        const auto generation = _table->GetGeneration();
 
-        // OK. In this case, we didn't skip anything. The end of the insert run fell right at a boundary
-        // in columns that was in the original existing run.
-        // However, the next piece of the original existing run might happen to have the same color attribute
-        // as the final piece of what we just copied.
-        // As an example...
-        // Existing Run = R3 -> G5 -> B2.
-        // Insert Run = B5 @ iStart = 3 and iEnd = 7
-        // New Run so far = R3 -> B5
-        // New Run desired when done = R3 -> B7
-        // Existing run pointer is on B2.
-        // We want to merge the 2 from the B2 into the B5 so we get B7.
-        else if (pNewRunPos->GetAttributes() == pExistingRunPos->GetAttributes())
+        idRuns.clear();
+        for (const auto& run : runs)
         {
-            // Add the value from the existing run into the current new run position.
-            size_t length = pNewRunPos->GetLength();
-            length += pExistingRunPos->GetLength();
-            pNewRunPos->SetLength(length);
-
-            // Advance the existing run position since we consumed its value and merged it in.
-            pExistingRunPos++;
+            idRuns.push_back(TextAttributeIdRun(run.GetLength(), _table->Intern(run.GetAttributes())));
         }
 
-        // OK. We're done inspecting the most recently copied cell for optimizations.
-        pNewRunPos++;
-
-        // Now bulk copy any segments left in the original existing run
-        if (pExistingRunPos < pExistingRunEnd)
+        if (_table->GetGeneration() == generation)
         {
-            std::copy_n(pExistingRunPos, (pExistingRunEnd - pExistingRunPos), pNewRunPos);
-
-            // Fix up the end pointer so we know where we are for counting how much of the new run's memory space we used.
-            pNewRunPos += (pExistingRunEnd - pExistingRunPos);
+            return idRuns;
         }
     }
 
-    // OK, phew. We're done. Now we just need to free the existing run, store the new run in its place,
-    // and update the count for the correct length of the new run now that we've filled it up.
+    THROW_HR(E_OUTOFMEMORY);
+}
 
-    newRun.erase(pNewRunPos, newRun.end());
-    _list.swap(newRun);
+// Routine Description:
+// - Rebuilds the end column of each run after the run lengths have changed.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+// Note: will throw if we're unable to allocate memory for the run ends
+void ATTR_ROW::_UpdateRunEnds()
+{
+    _runEnds.resize(_list.size());
 
-    return S_OK;
+    size_t runEnd = 0;
+    for (size_t i = 0; i < _list.size(); ++i)
+    {
+        runEnd += _list[i].GetLength();
+        _runEnds[i] = runEnd;
+    }
 }
 
 // Routine Description:
@@ -28,7 +28,7 @@ class ATTR_ROW final
 public:
     using const_iterator = typename AttrRowIterator;
 
-    ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr);
+    ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr, TextAttributeTable& table);
 
     void Reset(const TextAttribute attr);
 
@@ -47,6 +47,9 @@ public:
 
     void Resize(const size_t newWidth);
 
+    void MarkAttributesInUse(std::vector<bool>& inUse) const;
+    void RemapAttributes(const std::vector<TextAttributeId>& remap);
+
     [[nodiscard]] HRESULT InsertAttrRuns(const std::basic_string_view<TextAttributeRun> newAttrs,
                                          const size_t iStart,
                                          const size_t iEnd,
@@ -64,8 +67,17 @@ public:
     friend class AttrRowIterator;
 
 private:
-    std::vector<TextAttributeRun> _list;
+    // Most rows only have a handful of runs. Keep those inline.
+    til::small_vector<TextAttributeIdRun, 4> _list;
+    // The column just past the end of each run in _list, so that FindAttrIndex
+    // can binary search for a column. Anything that changes the run lengths
+    // has to rebuild it. Changing only the attribute ids leaves it as it is.
+    til::small_vector<size_t, 4> _runEnds;
     size_t _cchRowWidth;
+    TextAttributeTable* _table; // non ownership pointer
+
+    til::small_vector<TextAttributeIdRun, 4> _InternRuns(const std::basic_string_view<TextAttributeRun> runs) const;
+    void _UpdateRunEnds();
 
 #ifdef UNIT_TESTING
     friend class AttrRowTests;
@@ -90,13 +90,24 @@ AttrRowIterator AttrRowIterator::operator--(int)
 const TextAttribute* AttrRowIterator::operator->() const
 {
     THROW_HR_IF(E_BOUNDS, _exceeded);
-    return &_run->GetAttributes();
+    return &_pAttrRow->_table->Get(_run->GetAttributeId());
 }
 
 const TextAttribute& AttrRowIterator::operator*() const
 {
     THROW_HR_IF(E_BOUNDS, _exceeded);
-    return _run->GetAttributes();
+    return _pAttrRow->_table->Get(_run->GetAttributeId());
+}
+
+// Routine Description:
+// - Gets the attribute table id of the attribute we're pointing at. Two cells
+//   of the same buffer have the same attribute exactly when their ids match.
+// Return Value:
+// - the attribute id
+TextAttributeId AttrRowIterator::GetAttributeId() const
+{
+    THROW_HR_IF(E_BOUNDS, _exceeded);
+    return _run->GetAttributeId();
 }
 
 // Routine Description:
@@ -50,8 +50,10 @@ public:
     const TextAttribute* operator->() const;
     const TextAttribute& operator*() const;
 
+    TextAttributeId GetAttributeId() const;
+
 private:
-    std::vector<TextAttributeRun>::const_iterator _run;
+    const TextAttributeIdRun* _run;
     const ATTR_ROW* _pAttrRow;
     size_t _currentAttributeIndex; // index of TextAttribute within the current TextAttributeRun
     bool _exceeded;
@@ -19,7 +19,8 @@ CharRow::CharRow(size_t rowWidth, ROW* const pParent) :
     _wrapForced{ false },
     _doubleBytePadded{ false },
     _data(rowWidth, value_type()),
-    _pParent{ FAIL_FAST_IF_NULL(pParent) }
+    _pParent{ FAIL_FAST_IF_NULL(pParent) },
+    _delimiterClassesGeneration{ 0 }
 {
 }
 
@@ -93,6 +94,7 @@ void CharRow::Reset() noexcept
 
     _wrapForced = false;
     _doubleBytePadded = false;
+    _delimiterClassesGeneration = 0;
 }
 
 // Routine Description:
@@ -107,6 +109,7 @@ void CharRow::Reset() noexcept
     {
         const value_type insertVals;
         _data.resize(newSize, insertVals);
+        _delimiterClassesGeneration = 0;
     }
     CATCH_RETURN();
 
@@ -115,6 +118,7 @@ void CharRow::Reset() noexcept
 
 typename CharRow::iterator CharRow::begin() noexcept
 {
+    _delimiterClassesGeneration = 0;
     return _data.begin();
 }
 
@@ -125,6 +129,7 @@ typename CharRow::const_iterator CharRow::cbegin() const noexcept
 
 typename CharRow::iterator CharRow::end() noexcept
 {
+    _delimiterClassesGeneration = 0;
     return _data.end();
 }
 
@@ -168,6 +173,7 @@ size_t CharRow::MeasureRight() const noexcept
 void CharRow::ClearCell(const size_t column)
 {
     _data.at(column).Reset();
+    _delimiterClassesGeneration = 0;
 }
 
 // Routine Description:
@@ -222,6 +228,7 @@ DbcsAttribute& CharRow::DbcsAttrAt(const size_t column)
 void CharRow::ClearGlyph(const size_t column)
 {
     _data.at(column).EraseChars();
+    _delimiterClassesGeneration = 0;
 }
 
 // Routine Description:
@@ -247,6 +254,8 @@ const CharRow::reference CharRow::GlyphAt(const size_t column) const
 CharRow::reference CharRow::GlyphAt(const size_t column)
 {
     THROW_HR_IF(E_INVALIDARG, column >= _data.size());
+    // The caller may write through the reference.
+    _delimiterClassesGeneration = 0;
     return { *this, column };
 }
 
@@ -296,6 +305,28 @@ const DelimiterClass CharRow::DelimiterClassAt(const size_t column, const std::w
     }
 }
 
+// Method Description:
+// - get the delimiter class of every column in the char row, building them
+//   if our text or the word delimiters changed since the last time
+// - used for double click selection and uia word navigation
+// - this fills in our cached classes, so the caller has to make sure that
+//   nobody else is looking at this row's classes at the same time
+// Arguments:
+// - wordDelimiters: the delimiters defined as a part of the DelimiterClass::DelimiterChar
+// - generation: identifies this set of word delimiters. Must never be 0, and
+//   must change whenever the word delimiters do.
+// Return Value:
+// - the delimiter classes for the row
+const DelimiterClassBitmap& CharRow::GetDelimiterClasses(const std::wstring_view wordDelimiters, const size_t generation) const
+{
+    if (_delimiterClassesGeneration != generation)
+    {
+        _delimiterClasses.Build(*this, wordDelimiters);
+        _delimiterClassesGeneration = generation;
+    }
+    return _delimiterClasses;
+}
+
 UnicodeStorage& CharRow::GetUnicodeStorage() noexcept
 {
     return _pParent->GetUnicodeStorage();
@@ -325,3 +356,176 @@ void CharRow::UpdateParent(ROW* const pParent) noexcept
 {
     _pParent = FAIL_FAST_IF_NULL(pParent);
 }
+
+DelimiterClassBitmap::DelimiterClassBitmap() noexcept :
+    _size{ 0 }
+{
+}
+
+// Routine Description:
+// - Classifies every column of a row.
+// Arguments:
+// - charRow - the row to classify
+// - wordDelimiters - the delimiters defined as a part of the DelimiterClass::DelimiterChar
+// Return Value:
+// - <none>
+void DelimiterClassBitmap::Build(const CharRow& charRow, const std::wstring_view wordDelimiters)
+{
+    _size = charRow.size();
+    const auto words = (_size + BitsPerWord - 1) / BitsPerWord;
+    _regularChars.assign(words, 0);
+    _delimiterChars.assign(words, 0);
+
+    for (size_t column = 0; column < _size; ++column)
+    {
+        const uint32_t bit = 1u << (column % BitsPerWord);
+        switch (charRow.DelimiterClassAt(column, wordDelimiters))
+        {
+        case DelimiterClass::RegularChar:
+            til::at(_regularChars, column / BitsPerWord) |= bit;
+            break;
+        case DelimiterClass::DelimiterChar:
+            til::at(_delimiterChars, column / BitsPerWord) |= bit;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+// Routine Description:
+// - Gets the delimiter class of a column.
+// Arguments:
+// - column - the column to look at
+// Return Value:
+// - the delimiter class of the column
+DelimiterClass DelimiterClassBitmap::At(const size_t column) const
+{
+    THROW_HR_IF(E_INVALIDARG, column >= _size);
+
+    const uint32_t bit = 1u << (column % BitsPerWord);
+    if (til::at(_regularChars, column / BitsPerWord) & bit)
+    {
+        return DelimiterClass::RegularChar;
+    }
+    else if (til::at(_delimiterChars, column / BitsPerWord) & bit)
+    {
+        return DelimiterClass::DelimiterChar;
+    }
+    return DelimiterClass::ControlChar;
+}
+
+// Routine Description:
+// - Finds the first column at or right of the given one whose delimiter
+//   class is (or, if equal is false, isn't) the given class.
+// Arguments:
+// - column - the column to start at
+// - delimiterClass - the class to look for
+// - equal - whether to look for that class or for any other class
+// Return Value:
+// - the column that was found, or nullopt if there's none
+std::optional<size_t> DelimiterClassBitmap::FindNext(const size_t column, const DelimiterClass delimiterClass, const bool equal) const
+{
+    if (column >= _size)
+    {
+        return std::nullopt;
+    }
+
+    auto index = column / BitsPerWord;
+    // Ignore the columns left of the starting one.
+    auto bits = _GetWord(index, delimiterClass, equal) & (~0u << (column % BitsPerWord));
+    for (;;)
+    {
+        if (bits != 0)
+        {
+            unsigned long bit;
+            _BitScanForward(&bit, bits);
+            return index * BitsPerWord + bit;
+        }
+
+        if (++index == _regularChars.size())
+        {
+            return std::nullopt;
+        }
+        bits = _GetWord(index, delimiterClass, equal);
+    }
+}
+
+// Routine Description:
+// - Finds the first column at or left of the given one whose delimiter
+//   class is (or, if equal is false, isn't) the given class.
+// Arguments:
+// - column - the column to start at
+// - delimiterClass - the class to look for
+// - equal - whether to look for that class or for any other class
+// Return Value:
+// - the column that was found, or nullopt if there's none
+std::optional<size_t> DelimiterClassBitmap::FindPrevious(const size_t column, const DelimiterClass delimiterClass, const bool equal) const
+{
+    if (column >= _size)
+    {
+        return std::nullopt;
+    }
+
+    auto index = column / BitsPerWord;
+    // Ignore the columns right of the starting one.
+    auto bits = _GetWord(index, delimiterClass, equal) & (~0u >> (BitsPerWord - 1 - column % BitsPerWord));
+    for (;;)
+    {
+        if (bits != 0)
+        {
+            unsigned long bit;
+            _BitScanReverse(&bit, bits);
+            return index * BitsPerWord + bit;
+        }
+
+        if (index == 0)
+        {
+            return std::nullopt;
+        }
+        bits = _GetWord(--index, delimiterClass, equal);
+    }
+}
+
+// Routine Description:
+// - Gets one word of the bitmap for the given class, where a set bit means
+//   that the column is (or, if equal is false, isn't) of that class.
+// Arguments:
+// - index - the index of the word
+// - delimiterClass - the class to get the bits for
+// - equal - whether to set the bits for that class or for any other class
+// Return Value:
+// - the bits. Bits past the end of the row are never set.
+uint32_t DelimiterClassBitmap::_GetWord(const size_t index, const DelimiterClass delimiterClass, const bool equal) const
+{
+    const auto regularChars = til::at(_regularChars, index);
+    const auto delimiterChars = til::at(_delimiterChars, index);
+
+    uint32_t bits;
+    switch (delimiterClass)
+    {
+    case DelimiterClass::RegularChar:
+        bits = regularChars;
+        break;
+    case DelimiterClass::DelimiterChar:
+        bits = delimiterChars;
+        break;
+    default:
+        bits = ~(regularChars | delimiterChars);
+        break;
+    }
+
+    if (!equal)
+    {
+        bits = ~bits;
+    }
+
+    // The last word may only be partially used.
+    const auto usedBits = _size - index * BitsPerWord;
+    if (usedBits < BitsPerWord)
+    {
+        bits &= (1u << usedBits) - 1;
+    }
+
+    return bits;
+}
@@ -34,6 +34,32 @@ enum class DelimiterClass
     RegularChar
 };
 
+class CharRow;
+
+// The delimiter class of every column of a row, kept as one bit per column
+// for each class. Finding where a run of one class ends is then a bit scan
+// instead of a delimiter search per cell.
+class DelimiterClassBitmap final
+{
+public:
+    DelimiterClassBitmap() noexcept;
+
+    void Build(const CharRow& charRow, const std::wstring_view wordDelimiters);
+
+    DelimiterClass At(const size_t column) const;
+    std::optional<size_t> FindNext(const size_t column, const DelimiterClass delimiterClass, const bool equal) const;
+    std::optional<size_t> FindPrevious(const size_t column, const DelimiterClass delimiterClass, const bool equal) const;
+
+private:
+    static constexpr size_t BitsPerWord = 32;
+
+    std::vector<uint32_t> _regularChars;
+    std::vector<uint32_t> _delimiterChars;
+    size_t _size;
+
+    uint32_t _GetWord(const size_t index, const DelimiterClass delimiterClass, const bool equal) const;
+};
+
 // the characters of one row of screen buffer
 // we keep the following values so that we don't write
 // more pixels to the screen than we have to:
@@ -72,6 +98,7 @@ public:
     std::wstring GetText() const;
 
     const DelimiterClass DelimiterClassAt(const size_t column, const std::wstring_view wordDelimiters) const;
+    const DelimiterClassBitmap& GetDelimiterClasses(const std::wstring_view wordDelimiters, const size_t generation) const;
 
     // working with glyphs
     const reference GlyphAt(const size_t column) const;
@@ -105,6 +132,14 @@ protected:
 
     // ROW that this CharRow belongs to
     ROW* _pParent;
+
+    // The delimiter classes of our text, for the set of word delimiters that
+    // _delimiterClassesGeneration identifies. 0 means they need to be rebuilt,
+    // which is what every change to our text does. GetDelimiterClasses fills
+    // them in from const code, so the TextBuffer only calls it with its
+    // _delimiterClassesLock held.
+    mutable DelimiterClassBitmap _delimiterClasses;
+    mutable size_t _delimiterClassesGeneration;
 };
 
 constexpr bool operator==(const CharRow& a, const CharRow& b) noexcept
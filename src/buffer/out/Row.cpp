@@ -20,7 +20,7 @@ ROW::ROW(const SHORT rowId, const short rowWidth, const TextAttribute fillAttrib
     _id{ rowId },
     _rowWidth{ gsl::narrow<size_t>(rowWidth) },
     _charRow{ gsl::narrow<size_t>(rowWidth), this },
-    _attrRow{ gsl::narrow<UINT>(rowWidth), fillAttribute },
+    _attrRow{ gsl::narrow<UINT>(rowWidth), fillAttribute, pParent->GetAttributeTable() },
     _pParent{ pParent }
 {
 }
@@ -160,16 +160,43 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const size_t index, co
     // If we're given a right-side column limit, use it. Otherwise, the write limit is the final column index available in the char row.
     const auto finalColumnInRow = limitRight.value_or(_charRow.size() - 1);
 
+    // Colors are packed into runs as we go and spliced into the attribute row
+    // once per stretch of colored cells, rather than once per cell.
+    til::small_vector<TextAttributeRun, 4> attrRuns;
+    size_t attrRunsStart = currentIndex;
+    const auto flushAttrRuns = [&]() {
+        if (!attrRuns.empty())
+        {
+            LOG_IF_FAILED(_attrRow.InsertAttrRuns({ attrRuns.data(), attrRuns.size() },
+                                                  attrRunsStart,
+                                                  currentIndex - 1,
+                                                  _charRow.size()));
+            attrRuns.clear();
+        }
+    };
+
     while (it && currentIndex <= finalColumnInRow)
     {
         // Fill the color if the behavior isn't set to keeping the current color.
         if (it->TextAttrBehavior() != TextAttributeBehavior::Current)
         {
-            const TextAttributeRun attrRun{ 1, it->TextAttr() };
-            LOG_IF_FAILED(_attrRow.InsertAttrRuns({ &attrRun, 1 },
-                                                  currentIndex,
-                                                  currentIndex,
-                                                  _charRow.size()));
+            if (attrRuns.empty())
+            {
+                attrRunsStart = currentIndex;
+            }
+
+            if (!attrRuns.empty() && attrRuns.back().GetAttributes() == it->TextAttr())
+            {
+                attrRuns.back().IncrementLength();
+            }
+            else
+            {
+                attrRuns.push_back(TextAttributeRun{ 1, it->TextAttr() });
+            }
+        }
+        else
+        {
+            flushAttrRuns();
         }
 
         // Fill the text if the behavior isn't set to saying there's only a color stored in this iterator.
@@ -222,5 +249,88 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const size_t index, co
         ++currentIndex;
     }
 
+    flushAttrRuns();
+
     return it;
 }
+
+// Routine Description:
+// - Finds the spans of the row that writing the given cells would change.
+// Arguments:
+// - it - custom console iterator over the cells to compare.
+// - index - column in row to start comparing at
+// - limitRight - right inclusive column ID for the last cell to compare. (optional, will just compare to the end of row if nullopt)
+// Return Value:
+// - The changed spans, as [begin, end) columns, left to right. A cell is
+//   changed if its text, double byte state or color differ, or if WriteCells
+//   would pad a double byte character instead of writing it. Both halves of a
+//   double byte character, given or stored, are in the same span, so that
+//   writing just the spans can't split one.
+std::vector<std::pair<size_t, size_t>> ROW::GetChangedSpans(OutputCellIterator it, const size_t index, std::optional<size_t> limitRight) const
+{
+    THROW_HR_IF(E_INVALIDARG, index >= _charRow.size());
+    THROW_HR_IF(E_INVALIDARG, limitRight.value_or(0) >= _charRow.size());
+
+    // This has to agree with WriteCells on where the row ends.
+    const auto finalColumnInRow = limitRight.value_or(_charRow.size() - 1);
+
+    std::vector<std::pair<size_t, size_t>> spans;
+
+    // Colors are looked up a run at a time.
+    TextAttribute attr;
+    size_t attrApplies = 0;
+
+    for (auto column = index; it && column <= finalColumnInRow; ++column, ++it)
+    {
+        const auto behavior = it->TextAttrBehavior();
+        const auto dbcsAttr = it->DbcsAttr();
+        const auto& storedDbcsAttr = _charRow.DbcsAttrAt(column);
+
+        bool changed = false;
+        if (behavior != TextAttributeBehavior::StoredOnly)
+        {
+            changed = (column == 0 && dbcsAttr.IsTrailing()) ||
+                      (column == finalColumnInRow && dbcsAttr.IsLeading()) ||
+                      storedDbcsAttr.IsLeading() != dbcsAttr.IsLeading() ||
+                      storedDbcsAttr.IsTrailing() != dbcsAttr.IsTrailing() ||
+                      static_cast<std::wstring_view>(_charRow.GlyphAt(column)) != it->Chars();
+        }
+
+        if (behavior != TextAttributeBehavior::Current)
+        {
+            if (attrApplies == 0)
+            {
+                attr = _attrRow.GetAttrByColumn(column, &attrApplies);
+            }
+
+            changed = changed || attr != it->TextAttr();
+        }
+
+        if (attrApplies > 0)
+        {
+            --attrApplies;
+        }
+
+        const auto pairsWithPrevious = dbcsAttr.IsTrailing() || storedDbcsAttr.IsTrailing();
+        if (changed)
+        {
+            // If this is a trailing half, its leading half goes along.
+            const auto begin = pairsWithPrevious && column > index ? column - 1 : column;
+            if (!spans.empty() && spans.back().second >= begin)
+            {
+                spans.back().second = column + 1;
+            }
+            else
+            {
+                spans.emplace_back(begin, column + 1);
+            }
+        }
+        else if (pairsWithPrevious && !spans.empty() && spans.back().second == column)
+        {
+            // The leading half of this one changed, so it goes along.
+            spans.back().second = column + 1;
+        }
+    }
+
+    return spans;
+}
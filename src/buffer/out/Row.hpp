@@ -58,6 +58,7 @@ public:
     const UnicodeStorage& GetUnicodeStorage() const noexcept;
 
     OutputCellIterator WriteCells(OutputCellIterator it, const size_t index, const std::optional<bool> wrap = std::nullopt, std::optional<size_t> limitRight = std::nullopt);
+    std::vector<std::pair<size_t, size_t>> GetChangedSpans(OutputCellIterator it, const size_t index, std::optional<size_t> limitRight = std::nullopt) const;
 
     friend bool operator==(const ROW& a, const ROW& b) noexcept;
 
@@ -27,6 +27,14 @@ Revision History:
 #include "WexTestClass.h"
 #endif
 
+class TextAttribute;
+
+namespace std
+{
+    template<>
+    struct hash<TextAttribute>;
+}
+
 #pragma pack(push, 1)
 
 class TextAttribute final
@@ -205,6 +213,8 @@ private:
     TextColor _background;
     ExtendedAttributes _extendedAttrs;
 
+    friend struct std::hash<TextAttribute>;
+
 #ifdef UNIT_TESTING
     friend class TextBufferTests;
     friend class TextAttributeTests;
@@ -260,6 +270,30 @@ constexpr bool operator!=(const WORD& legacyAttr, const TextAttribute& attr) noe
     return !(attr == legacyAttr);
 }
 
+// std::unordered_map needs help to know how to hash a TextAttribute
+namespace std
+{
+    template<>
+    struct hash<TextAttribute>
+    {
+        // Routine Description:
+        // - hashes an attribute from the same fields that operator== compares.
+        // Arguments:
+        // - attr - the attribute to hash
+        // Return Value:
+        // - the hashed attribute
+        size_t operator()(const TextAttribute& attr) const noexcept
+        {
+            const hash<TextColor> colorHash;
+            size_t retVal = colorHash(attr._foreground);
+            retVal = retVal * 31 + colorHash(attr._background);
+            retVal = retVal * 31 + attr._wAttrLegacy;
+            retVal = retVal * 31 + static_cast<size_t>(attr._extendedAttrs);
+            return retVal;
+        }
+    };
+}
+
 #ifdef UNIT_TESTING
 
 #define LOG_ATTR(attr) (Log::Comment(NoThrowString().Format( \
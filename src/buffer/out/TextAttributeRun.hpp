@@ -21,6 +21,7 @@ Revision History:
 #pragma once
 
 #include "TextAttribute.hpp"
+#include "TextAttributeTable.hpp"
 
 class TextAttributeRun final
 {
@@ -45,3 +46,56 @@ private:
     friend class AttrRowTests;
 #endif
 };
+
+// The form in which ATTR_ROW stores its runs: the attribute is an id into the
+// owning buffer's TextAttributeTable. Rows are never wider than SHRT_MAX, so
+// 16 bits of length are plenty and the whole run fits in 4 bytes.
+class TextAttributeIdRun final
+{
+public:
+    constexpr TextAttributeIdRun() noexcept :
+        _cchLength{ 0 },
+        _attributeId{ 0 }
+    {
+    }
+
+    constexpr TextAttributeIdRun(const size_t cchLength, const TextAttributeId attributeId) noexcept :
+        _cchLength{ gsl::narrow_cast<uint16_t>(cchLength) },
+        _attributeId{ attributeId }
+    {
+    }
+
+    constexpr size_t GetLength() const noexcept
+    {
+        return _cchLength;
+    }
+
+    constexpr void SetLength(const size_t cchLength) noexcept
+    {
+        _cchLength = gsl::narrow_cast<uint16_t>(cchLength);
+    }
+
+    constexpr void IncrementLength() noexcept
+    {
+        _cchLength++;
+    }
+
+    constexpr void DecrementLength() noexcept
+    {
+        _cchLength--;
+    }
+
+    constexpr TextAttributeId GetAttributeId() const noexcept
+    {
+        return _attributeId;
+    }
+
+    constexpr void SetAttributeId(const TextAttributeId attributeId) noexcept
+    {
+        _attributeId = attributeId;
+    }
+
+private:
+    uint16_t _cchLength;
+    TextAttributeId _attributeId;
+};
@@ -0,0 +1,134 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "TextAttributeTable.hpp"
+
+TextAttributeTable::TextAttributeTable() :
+    _attributes{},
+    _ids{},
+    _compactionCallback{},
+    _generation{ 0 }
+{
+}
+
+// Routine Description:
+// - Gets the id for the given attribute, adding it to the table if we haven't
+//   seen it before.
+// - If the table is full, the compaction callback is given a chance to free up
+//   ids first. Any ids handed out before that may have been renumbered, which
+//   callers can detect by checking GetGeneration().
+// Arguments:
+// - attr - the attribute to look up
+// Return Value:
+// - the id of the attribute
+// Note: will throw E_OUTOFMEMORY if every id is still in use after compacting
+TextAttributeId TextAttributeTable::Intern(const TextAttribute& attr)
+{
+    const auto it = _ids.find(attr);
+    if (it != _ids.end())
+    {
+        return it->second;
+    }
+
+    if (_attributes.size() >= MaxSize && _compactionCallback)
+    {
+        _compactionCallback();
+    }
+
+    THROW_HR_IF(E_OUTOFMEMORY, _attributes.size() >= MaxSize);
+
+    const auto id = gsl::narrow_cast<TextAttributeId>(_attributes.size());
+    _attributes.push_back(attr);
+    _ids.emplace(attr, id);
+    return id;
+}
+
+// Routine Description:
+// - Gets the id for the given attribute, without adding it to the table.
+// Arguments:
+// - attr - the attribute to look up
+// Return Value:
+// - the id of the attribute, or nullopt if the table doesn't hold it
+std::optional<TextAttributeId> TextAttributeTable::Find(const TextAttribute& attr) const
+{
+    const auto it = _ids.find(attr);
+    if (it != _ids.end())
+    {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+// Routine Description:
+// - Gets the attribute for the given id.
+// Arguments:
+// - id - an id previously returned by Intern or Find
+// Return Value:
+// - the attribute
+const TextAttribute& TextAttributeTable::Get(const TextAttributeId id) const noexcept
+{
+    return _attributes[id];
+}
+
+// Routine Description:
+// - Gets the number of ids currently handed out.
+size_t TextAttributeTable::Size() const noexcept
+{
+    return _attributes.size();
+}
+
+// Routine Description:
+// - Gets a counter that's incremented every time the table is compacted, and
+//   previously returned ids might have changed meaning.
+size_t TextAttributeTable::GetGeneration() const noexcept
+{
+    return _generation;
+}
+
+// Routine Description:
+// - Sets the function that's called when the table runs out of ids. It's
+//   expected to call Compact with the ids that are still in use, and update
+//   everything that holds on to ids with the returned mapping.
+// Arguments:
+// - callback - the function to call
+void TextAttributeTable::SetCompactionCallback(std::function<void()> callback)
+{
+    _compactionCallback = std::move(callback);
+}
+
+// Routine Description:
+// - Drops every attribute that isn't in use anymore and renumbers the rest so
+//   that they're contiguous again. Attributes keep their relative order.
+// - Ids that Get or Intern handed out before this refer to different
+//   attributes afterwards, or to none at all. Everything that holds on to ids,
+//   like ATTR_ROW, has to remap them with the returned mapping.
+// Arguments:
+// - inUse - for each id, whether it's still referred to. Ids past the end of
+//   the vector are considered unused.
+// Return Value:
+// - a mapping from each old id to its new id. Entries for dropped ids are
+//   meaningless.
+std::vector<TextAttributeId> TextAttributeTable::Compact(const std::vector<bool>& inUse)
+{
+    std::vector<TextAttributeId> remap(_attributes.size(), TextAttributeId{ 0 });
+
+    // Compact within the existing storage, so that references handed out by
+    // Get stay pointed at valid (if different) attributes.
+    _ids.clear();
+    size_t next = 0;
+    for (size_t id = 0; id < _attributes.size(); ++id)
+    {
+        if (id < inUse.size() && inUse.at(id))
+        {
+            const auto newId = gsl::narrow_cast<TextAttributeId>(next++);
+            _attributes.at(newId) = _attributes.at(id);
+            _ids.emplace(_attributes.at(newId), newId);
+            remap.at(id) = newId;
+        }
+    }
+    _attributes.resize(next);
+
+    ++_generation;
+    return remap;
+}
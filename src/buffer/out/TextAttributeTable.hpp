@@ -0,0 +1,53 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- TextAttributeTable.hpp
+
+Abstract:
+- Per-buffer intern table for text attributes. Every distinct TextAttribute
+  used in the buffer is stored once, and the attribute runs of each row only
+  hold its 16-bit id. Comparing two cells' attributes then comes down to an
+  integer compare, and a colorful row costs a few bytes per run instead of a
+  full TextAttribute.
+- Ids are only meaningful within the table that handed them out.
+- Once every id is in use, the owner gets a chance to compact the table,
+  dropping attributes that no row refers to anymore and renumbering the rest.
+--*/
+
+#pragma once
+
+#include "TextAttribute.hpp"
+
+using TextAttributeId = uint16_t;
+
+class TextAttributeTable final
+{
+public:
+    static constexpr size_t MaxSize = static_cast<size_t>(std::numeric_limits<TextAttributeId>::max()) + 1;
+
+    TextAttributeTable();
+
+    TextAttributeId Intern(const TextAttribute& attr);
+    std::optional<TextAttributeId> Find(const TextAttribute& attr) const;
+    const TextAttribute& Get(const TextAttributeId id) const noexcept;
+
+    size_t Size() const noexcept;
+    size_t GetGeneration() const noexcept;
+
+    void SetCompactionCallback(std::function<void()> callback);
+    std::vector<TextAttributeId> Compact(const std::vector<bool>& inUse);
+
+private:
+    // A deque, so that growing the table doesn't move the attributes that
+    // callers are holding references to.
+    std::deque<TextAttribute> _attributes;
+    std::unordered_map<TextAttribute, TextAttributeId> _ids;
+    std::function<void()> _compactionCallback;
+    size_t _generation;
+
+#ifdef UNIT_TESTING
+    friend class TextAttributeTableTests;
+#endif
+};
@@ -37,6 +37,14 @@ Revision History:
 #include "WexTestClass.h"
 #endif
 
+struct TextColor;
+
+namespace std
+{
+    template<>
+    struct hash<TextColor>;
+}
+
 #pragma pack(push, 1)
 
 enum class ColorType : BYTE
@@ -115,6 +123,8 @@ private:
 
     COLORREF _GetRGB() const noexcept;
 
+    friend struct std::hash<TextColor>;
+
 #ifdef UNIT_TESTING
     friend class TextBufferTests;
     template<typename TextColor>
@@ -137,6 +147,29 @@ bool constexpr operator!=(const TextColor& a, const TextColor& b) noexcept
     return !(a == b);
 }
 
+// std::unordered_map needs help to know how to hash a TextColor
+namespace std
+{
+    template<>
+    struct hash<TextColor>
+    {
+        // Routine Description:
+        // - hashes a color by packing its type and its three value bytes into the
+        //   lower bits of a size_t. This hashes the same fields that operator== compares.
+        // Arguments:
+        // - color - the color to hash
+        // Return Value:
+        // - the hashed color
+        constexpr size_t operator()(const TextColor& color) const noexcept
+        {
+            return static_cast<size_t>(color._meta) << 24 |
+                   static_cast<size_t>(color._red) << 16 |
+                   static_cast<size_t>(color._green) << 8 |
+                   static_cast<size_t>(color._blue);
+        }
+    };
+}
+
 #ifdef UNIT_TESTING
 
 namespace WEX
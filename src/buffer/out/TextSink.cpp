@@ -0,0 +1,513 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "TextSink.hpp"
+
+#include "../types/inc/convert.hpp"
+
+#pragma hdrstop
+
+namespace
+{
+    // Appends a number in decimal, padded with leading zeroes to at least the given width.
+    void AppendNumber(std::string& out, size_t value, const size_t width = 0)
+    {
+        std::array<char, 20> digits;
+        size_t count = 0;
+        do
+        {
+            til::at(digits, count++) = gsl::narrow_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+
+        if (width > count)
+        {
+            out.append(width - count, '0');
+        }
+        while (count != 0)
+        {
+            out.push_back(til::at(digits, --count));
+        }
+    }
+
+    // Appends a color as #RRGGBB.
+    void AppendHexColor(std::string& out, const COLORREF color)
+    {
+        static constexpr std::string_view hexDigits{ "0123456789ABCDEF" };
+        out.push_back('#');
+        for (const BYTE component : { GetRValue(color), GetGValue(color), GetBValue(color) })
+        {
+            out.push_back(hexDigits.at(component >> 4));
+            out.push_back(hexDigits.at(component & 0xF));
+        }
+    }
+
+    // Appends text, replacing each character that the output format reserves
+    // with what escape returns for it. Everything between those characters is
+    // copied over in one go.
+    template<typename TEscape>
+    void AppendEscaped(std::string& out, const std::string_view text, TEscape escape)
+    {
+        size_t start = 0;
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            const std::string_view replacement = escape(text.at(i));
+            if (!replacement.empty())
+            {
+                out.append(text.substr(start, i - start));
+                out.append(replacement);
+                start = i + 1;
+            }
+        }
+        out.append(text.substr(start));
+    }
+
+    // once filled with values, there will be exactly 157 bytes in the clipboard header
+    constexpr size_t ClipboardHeaderSize = 157;
+
+    constexpr std::string_view HtmlFooter = "</BODY></HTML>";
+}
+
+// Routine Description:
+// - Creates a sink that collects plain text.
+// Arguments:
+// - maxLength - if set, stop collecting once we have this many characters.
+PlainTextSink::PlainTextSink(const std::optional<size_t> maxLength) noexcept :
+    _maxLength{ maxLength }
+{
+}
+
+void PlainTextSink::BeginRow() noexcept
+{
+}
+
+void PlainTextSink::AppendText(const std::wstring_view text, const COLORREF /*foreground*/, const COLORREF /*background*/)
+{
+    _Append(text);
+}
+
+void PlainTextSink::AppendLineBreak()
+{
+    _Append(L"\r\n");
+}
+
+void PlainTextSink::Reserve(const size_t rows, const size_t cells)
+{
+    // One character per cell, plus a CR/LF per row.
+    const auto estimate = cells + rows * 2;
+    _text.reserve(_maxLength.has_value() ? std::min(estimate, *_maxLength) : estimate);
+}
+
+bool PlainTextSink::IsFull() const noexcept
+{
+    return _maxLength.has_value() && _text.size() >= *_maxLength;
+}
+
+// Routine Description:
+// - Gets the text collected so far. Callers are free to move it out.
+std::wstring& PlainTextSink::GetText() noexcept
+{
+    return _text;
+}
+
+void PlainTextSink::_Append(const std::wstring_view text)
+{
+    if (_maxLength.has_value())
+    {
+        _text.append(text.substr(0, *_maxLength - std::min(*_maxLength, _text.size())));
+    }
+    else
+    {
+        _text.append(text);
+    }
+}
+
+// Routine Description:
+// - Creates a sink that generates a CF_HTML compliant structure
+// Arguments:
+// - fontHeightPoints - the unscaled font height
+// - fontFaceName - the name of the font used
+// - backgroundColor - default background color for characters, also used in padding
+// - htmlTitle - value used in title tag of html header. Used to name the application
+HtmlTextSink::HtmlTextSink(const int fontHeightPoints,
+                           const std::wstring_view fontFaceName,
+                           const COLORREF backgroundColor,
+                           const std::string& htmlTitle) :
+    _rows{ 0 },
+    _hasWrittenAnyText{ false },
+    _fgColor{ std::nullopt },
+    _bkColor{ std::nullopt }
+{
+    // Leave room for the clipboard header. Finish fills it in once the
+    // offsets of everything after it are known.
+    _html.assign(ClipboardHeaderSize, ' ');
+
+    // First we have to add some standard
+    // HTML boiler plate required for CF_HTML
+    // as part of the HTML Clipboard format
+    _html += "<!DOCTYPE><HTML><HEAD><TITLE>";
+    _html += htmlTitle;
+    _html += "</TITLE></HEAD><BODY>";
+    _fragmentStart = _html.size();
+
+    _html += "<!--StartFragment -->";
+
+    // apply global style in div element
+    _html += "<DIV STYLE=\"";
+    _html += "display:inline-block;";
+    _html += "white-space:pre;";
+
+    _html += "background-color:";
+    AppendHexColor(_html, backgroundColor);
+    _html += ";";
+
+    _html += "font-family:";
+    _html += "'";
+    _html += ConvertToA(CP_UTF8, fontFaceName);
+    _html += "',";
+    // even with different font, add monospace as fallback
+    _html += "monospace;";
+
+    _html += "font-size:";
+    _html += std::to_string(fontHeightPoints);
+    _html += "pt;";
+
+    // note: MS Word doesn't support padding (in this way at least)
+    _html += "padding:";
+    _html += "4"; // todo: customizable padding
+    _html += "px;";
+
+    _html += "\">";
+}
+
+void HtmlTextSink::Reserve(const size_t rows, const size_t cells)
+{
+    // Assume one byte per cell, and a line break and a color change per row.
+    constexpr std::string_view perRow{ "<BR></SPAN><SPAN STYLE=\"color:#000000;background-color:#000000;\">" };
+    constexpr std::string_view trailer{ "</SPAN></DIV><!--EndFragment -->" };
+    _html.reserve(_html.size() + cells + rows * perRow.size() + trailer.size() + HtmlFooter.size());
+}
+
+void HtmlTextSink::BeginRow()
+{
+    if (_rows++ != 0)
+    {
+        _html += "<BR>";
+    }
+}
+
+void HtmlTextSink::AppendText(const std::wstring_view text, const COLORREF foreground, const COLORREF background)
+{
+    if (text.empty())
+    {
+        return;
+    }
+
+    if (_fgColor != foreground || _bkColor != background)
+    {
+        _fgColor = foreground;
+        _bkColor = background;
+
+        if (_hasWrittenAnyText)
+        {
+            _html += "</SPAN>";
+        }
+
+        _html += "<SPAN STYLE=\"";
+        _html += "color:";
+        AppendHexColor(_html, foreground);
+        _html += ";";
+        _html += "background-color:";
+        AppendHexColor(_html, background);
+        _html += ";";
+        _html += "\">";
+    }
+
+    _hasWrittenAnyText = true;
+
+    THROW_IF_FAILED(til::u16u8(text, _utf8));
+    AppendEscaped(_html, _utf8, [](const char c) -> std::string_view {
+        switch (c)
+        {
+        case '<':
+            return "&lt;";
+        case '>':
+            return "&gt;";
+        case '&':
+            return "&amp;";
+        default:
+            return {};
+        }
+    });
+}
+
+void HtmlTextSink::AppendLineBreak() noexcept
+{
+    // do not include \r nor \n as they don't have color attributes
+    // and are not HTML friendly. For line break use '<BR>' instead.
+}
+
+// Routine Description:
+// - Closes the document and fills in the clipboard header.
+// - The sink can't be used anymore afterwards.
+// Return Value:
+// - string containing the generated HTML
+std::string HtmlTextSink::Finish()
+{
+    if (_hasWrittenAnyText)
+    {
+        // last opened span wasn't closed yet, so close it now
+        _html += "</SPAN>";
+    }
+
+    _html += "</DIV>";
+
+    _html += "<!--EndFragment -->";
+
+    _html += HtmlFooter;
+
+    // these values are byte offsets from start of clipboard
+    const size_t htmlStartPos = ClipboardHeaderSize;
+    const size_t htmlEndPos = _html.size();
+    const size_t fragStartPos = _fragmentStart;
+    const size_t fragEndPos = htmlEndPos - HtmlFooter.length();
+
+    // header required by HTML 0.9 format
+    std::string clipHeader;
+    clipHeader.reserve(ClipboardHeaderSize);
+    clipHeader += "Version:0.9\r\n";
+    clipHeader += "StartHTML:";
+    AppendNumber(clipHeader, htmlStartPos, 10);
+    clipHeader += "\r\n";
+    clipHeader += "EndHTML:";
+    AppendNumber(clipHeader, htmlEndPos, 10);
+    clipHeader += "\r\n";
+    clipHeader += "StartFragment:";
+    AppendNumber(clipHeader, fragStartPos, 10);
+    clipHeader += "\r\n";
+    clipHeader += "EndFragment:";
+    AppendNumber(clipHeader, fragEndPos, 10);
+    clipHeader += "\r\n";
+    clipHeader += "StartSelection:";
+    AppendNumber(clipHeader, fragStartPos, 10);
+    clipHeader += "\r\n";
+    clipHeader += "EndSelection:";
+    AppendNumber(clipHeader, fragEndPos, 10);
+    clipHeader += "\r\n";
+
+    FAIL_FAST_IF(clipHeader.size() != ClipboardHeaderSize);
+    _html.replace(0, ClipboardHeaderSize, clipHeader);
+
+    return std::move(_html);
+}
+
+// Routine Description:
+// - Creates a sink that generates an RTF document
+//   RTF 1.5 Spec: https://www.biblioscape.com/rtf15_spec.htm
+// Arguments:
+// - fontHeightPoints - the unscaled font height
+// - fontFaceName - the name of the font used
+// - backgroundColor - default background color for characters, also used in padding
+RtfTextSink::RtfTextSink(const int fontHeightPoints,
+                         const std::wstring_view fontFaceName,
+                         const COLORREF backgroundColor) :
+    _fontFaceName{ ConvertToA(CP_UTF8, fontFaceName) },
+    _nextColorIndex{ 1 }, // leave 0 for the default color and start from 1.
+    _rows{ 0 },
+    _fgColor{ std::nullopt },
+    _bkColor{ std::nullopt }
+{
+    // RTF color table
+    _colorTable += "{\\colortbl ;";
+    _GetColorIndex(backgroundColor);
+
+    // content
+    _content += "\\viewkind4\\uc4";
+
+    // paragraph styles
+    // \fs specifies font size in half-points i.e. \fs20 results in a font size
+    // of 10 pts. That's why, font size is multiplied by 2 here.
+    _content += "\\pard\\slmult1\\f0\\fs";
+    _content += std::to_string(2 * fontHeightPoints);
+    _content += "\\highlight1";
+    _content += " ";
+}
+
+void RtfTextSink::Reserve(const size_t rows, const size_t cells)
+{
+    // Assume one byte per cell, and a line break and a color change per row.
+    constexpr std::string_view perRow{ "\\line \\highlight00\\cf00 " };
+    _content.reserve(_content.size() + cells + rows * perRow.size());
+}
+
+void RtfTextSink::BeginRow()
+{
+    if (_rows++ != 0)
+    {
+        _content += "\\line "; // new line
+    }
+}
+
+void RtfTextSink::AppendText(const std::wstring_view text, const COLORREF foreground, const COLORREF background)
+{
+    if (text.empty())
+    {
+        return;
+    }
+
+    if (_fgColor != foreground || _bkColor != background)
+    {
+        _fgColor = foreground;
+        _bkColor = background;
+
+        const int bkColorIndex = _GetColorIndex(background);
+        const int fgColorIndex = _GetColorIndex(foreground);
+
+        _content += "\\highlight";
+        AppendNumber(_content, gsl::narrow_cast<size_t>(bkColorIndex));
+        _content += "\\cf";
+        AppendNumber(_content, gsl::narrow_cast<size_t>(fgColorIndex));
+        _content += " ";
+    }
+
+    THROW_IF_FAILED(til::u16u8(text, _utf8));
+    AppendEscaped(_content, _utf8, [](const char c) -> std::string_view {
+        switch (c)
+        {
+        case '\\':
+            return "\\\\";
+        case '{':
+            return "\\{";
+        case '}':
+            return "\\}";
+        default:
+            return {};
+        }
+    });
+}
+
+void RtfTextSink::AppendLineBreak() noexcept
+{
+    // do not include \r nor \n as they don't have color attributes.
+    // For line break use \line instead.
+}
+
+// Routine Description:
+// - Assembles the header, the color table and the content into the final document.
+// Return Value:
+// - string containing the generated RTF
+std::string RtfTextSink::Finish()
+{
+    // Standard RTF header.
+    // This is similar to the header generated by WordPad.
+    // \ansi - specifies that the ANSI char set is used in the current doc
+    // \ansicpg1252 - represents the ANSI code page which is used to perform the Unicode to ANSI conversion when writing RTF text
+    // \deff0 - specifies that the default font for the document is the one at index 0 in the font table
+    // \nouicompat - ?
+    constexpr std::string_view header{ "\\rtf1\\ansi\\ansicpg1252\\deff0\\nouicompat" };
+    constexpr std::string_view fontTableStart{ "{\\fonttbl{\\f0\\fmodern\\fcharset0 " };
+    constexpr std::string_view fontTableEnd{ ";}}" };
+
+    std::string rtf;
+    rtf.reserve(1 + header.size() + fontTableStart.size() + _fontFaceName.size() + fontTableEnd.size() +
+                _colorTable.size() + 1 + _content.size() + 1);
+
+    // start rtf
+    rtf += "{";
+
+    rtf += header;
+
+    // font table
+    rtf += fontTableStart;
+    rtf += _fontFaceName;
+    rtf += fontTableEnd;
+
+    // add color table to the final RTF
+    rtf += _colorTable;
+    rtf += "}";
+
+    // add the text content to the final RTF
+    rtf += _content;
+
+    // end rtf
+    rtf += "}";
+
+    return rtf;
+}
+
+// Routine Description:
+// - Gets the index of a color in the color table, adding it if it isn't there yet.
+// Arguments:
+// - color - the color to look up
+// Return Value:
+// - the index of the color in the color table
+int RtfTextSink::_GetColorIndex(const COLORREF color)
+{
+    const auto found = _colorMap.find(color);
+    if (found != _colorMap.end())
+    {
+        // color already exists in the map, just retrieve the index
+        return found->second;
+    }
+
+    // color not present in the map, so add it
+    _colorTable += "\\red";
+    AppendNumber(_colorTable, GetRValue(color));
+    _colorTable += "\\green";
+    AppendNumber(_colorTable, GetGValue(color));
+    _colorTable += "\\blue";
+    AppendNumber(_colorTable, GetBValue(color));
+    _colorTable += ";";
+    _colorMap.emplace(color, _nextColorIndex);
+    return _nextColorIndex++;
+}
+
+// Routine Description:
+// - Creates a sink that forwards everything to each of the given sinks.
+// Arguments:
+// - sinks - the sinks to forward to. They must outlive the tee.
+TeeTextSink::TeeTextSink(std::initializer_list<ITextSink*> sinks) :
+    _sinks{ sinks }
+{
+}
+
+void TeeTextSink::Reserve(const size_t rows, const size_t cells)
+{
+    for (const auto sink : _sinks)
+    {
+        sink->Reserve(rows, cells);
+    }
+}
+
+void TeeTextSink::BeginRow()
+{
+    for (const auto sink : _sinks)
+    {
+        sink->BeginRow();
+    }
+}
+
+void TeeTextSink::AppendText(const std::wstring_view text, const COLORREF foreground, const COLORREF background)
+{
+    for (const auto sink : _sinks)
+    {
+        sink->AppendText(text, foreground, background);
+    }
+}
+
+void TeeTextSink::AppendLineBreak()
+{
+    for (const auto sink : _sinks)
+    {
+        sink->AppendLineBreak();
+    }
+}
+
+// Routine Description:
+// - The tee is only full once every one of its sinks is.
+bool TeeTextSink::IsFull() const noexcept
+{
+    return std::all_of(_sinks.begin(), _sinks.end(), [](const auto sink) { return sink->IsFull(); });
+}
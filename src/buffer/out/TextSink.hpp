@@ -0,0 +1,140 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- TextSink.hpp
+
+Abstract:
+- Receivers for the text that TextBuffer::VisitText streams out of a region of
+    the buffer. Text arrives one row at a time, in runs that share the same
+    colors, so a sink never needs more than its own output in memory.
+- Plain text (clipboard, UIA), HTML and RTF (copy with formatting) each have
+    a sink. A TeeTextSink feeds one pass over the buffer into several of them.
+--*/
+
+#pragma once
+
+class ITextSink
+{
+public:
+    virtual ~ITextSink() = default;
+
+    // Called before the first run of each row, including empty rows.
+    virtual void BeginRow() = 0;
+
+    // Called for each run of text with the same colors. The colors are only
+    // meaningful if VisitText was given functions to look them up.
+    virtual void AppendText(const std::wstring_view text, const COLORREF foreground, const COLORREF background) = 0;
+
+    // Called at the end of a row that should be followed by a CR/LF.
+    virtual void AppendLineBreak() = 0;
+
+    // Called once before the first row, with the size of the region, so that
+    // the sink can preallocate its output.
+    virtual void Reserve(const size_t /*rows*/, const size_t /*cells*/)
+    {
+    }
+
+    // Lets VisitText stop early once the sink has all it wants.
+    virtual bool IsFull() const noexcept
+    {
+        return false;
+    }
+};
+
+class PlainTextSink final : public ITextSink
+{
+public:
+    PlainTextSink(const std::optional<size_t> maxLength = std::nullopt) noexcept;
+
+    void Reserve(const size_t rows, const size_t cells) override;
+    void BeginRow() noexcept override;
+    void AppendText(const std::wstring_view text, const COLORREF foreground, const COLORREF background) override;
+    void AppendLineBreak() override;
+    bool IsFull() const noexcept override;
+
+    std::wstring& GetText() noexcept;
+
+private:
+    std::wstring _text;
+    std::optional<size_t> _maxLength;
+
+    void _Append(const std::wstring_view text);
+};
+
+class HtmlTextSink final : public ITextSink
+{
+public:
+    HtmlTextSink(const int fontHeightPoints,
+                 const std::wstring_view fontFaceName,
+                 const COLORREF backgroundColor,
+                 const std::string& htmlTitle);
+
+    void Reserve(const size_t rows, const size_t cells) override;
+    void BeginRow() override;
+    void AppendText(const std::wstring_view text, const COLORREF foreground, const COLORREF background) override;
+    void AppendLineBreak() noexcept override;
+
+    std::string Finish();
+
+private:
+    // The whole clipboard payload. The clipboard header at the front is a
+    // placeholder until Finish fills in the offsets.
+    std::string _html;
+    // Scratch space for converting each run to UTF-8.
+    std::string _utf8;
+    size_t _fragmentStart;
+    size_t _rows;
+    bool _hasWrittenAnyText;
+    std::optional<COLORREF> _fgColor;
+    std::optional<COLORREF> _bkColor;
+};
+
+class RtfTextSink final : public ITextSink
+{
+public:
+    RtfTextSink(const int fontHeightPoints,
+                const std::wstring_view fontFaceName,
+                const COLORREF backgroundColor);
+
+    void Reserve(const size_t rows, const size_t cells) override;
+    void BeginRow() override;
+    void AppendText(const std::wstring_view text, const COLORREF foreground, const COLORREF background) override;
+    void AppendLineBreak() noexcept override;
+
+    std::string Finish();
+
+private:
+    std::string _fontFaceName;
+    // The color table is built as new colors show up, since it has to come
+    // before the content that refers to it.
+    std::string _colorTable;
+    std::string _content;
+    // Scratch space for converting each run to UTF-8.
+    std::string _utf8;
+    // keys are colors represented by COLORREF
+    // values are indices of the corresponding colors in the color table
+    std::unordered_map<COLORREF, int> _colorMap;
+    int _nextColorIndex;
+    size_t _rows;
+    std::optional<COLORREF> _fgColor;
+    std::optional<COLORREF> _bkColor;
+
+    int _GetColorIndex(const COLORREF color);
+};
+
+class TeeTextSink final : public ITextSink
+{
+public:
+    TeeTextSink(std::initializer_list<ITextSink*> sinks);
+
+    void Reserve(const size_t rows, const size_t cells) override;
+    void BeginRow() override;
+    void AppendText(const std::wstring_view text, const COLORREF foreground, const COLORREF background) override;
+    void AppendLineBreak() override;
+    bool IsFull() const noexcept override;
+
+private:
+    std::vector<ITextSink*> _sinks;
+};
@@ -40,6 +40,13 @@ void UnicodeStorage::Erase(const key_type key)
     _map.erase(key);
 }
 
+// Routine Description:
+// - erases everything in the storage
+void UnicodeStorage::Clear() noexcept
+{
+    _map.clear();
+}
+
 // Routine Description:
 // - Remaps all of the stored items to new coordinate positions
 //   based on a bulk rearrangement of row IDs and potential row width resize.
@@ -96,3 +103,40 @@ void UnicodeStorage::Remap(const std::map<SHORT, SHORT>& rowMap, const std::opti
     // Swap into the stored map, free the temporary when we exit.
     _map.swap(newMap);
 }
+
+// Routine Description:
+// - Moves the stored items of some rows to new row IDs, after those rows were
+//   shuffled around among themselves.
+// - Unlike Remap, items on rows that aren't in the map are kept where they are.
+// Arguments:
+// - rowMap - A map of the old row IDs to the new row IDs, for the rows that moved.
+void UnicodeStorage::RemapRows(const std::map<SHORT, SHORT>& rowMap)
+{
+    // Most buffers don't have anything stored at all.
+    if (_map.empty() || rowMap.empty())
+    {
+        return;
+    }
+
+    // Pull out everything on the moved rows first, so that we don't overwrite
+    // an item that hasn't been moved yet with one that has.
+    std::vector<std::pair<key_type, mapped_type>> moved;
+    for (auto it = _map.begin(); it != _map.end();)
+    {
+        const auto mapIter = rowMap.find(it->first.Y);
+        if (mapIter != rowMap.end())
+        {
+            moved.emplace_back(COORD{ it->first.X, mapIter->second }, std::move(it->second));
+            it = _map.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (auto& pair : moved)
+    {
+        _map.insert_or_assign(pair.first, std::move(pair.second));
+    }
+}
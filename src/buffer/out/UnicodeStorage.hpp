@@ -55,8 +55,12 @@ public:
 
     void Erase(const key_type key);
 
+    void Clear() noexcept;
+
     void Remap(const std::map<SHORT, SHORT>& rowMap, const std::optional<SHORT> width);
 
+    void RemapRows(const std::map<SHORT, SHORT>& rowMap);
+
 private:
     std::unordered_map<key_type, mapped_type> _map;
 
@@ -26,6 +26,7 @@ Cursor::Cursor(const ULONG ulSize, TextBuffer& parentBuffer) noexcept :
     _coordDelayedAt{ 0 },
     _fDeferCursorRedraw(false),
     _fHaveDeferredCursorRedraw(false),
+    _coordDeferredFrom{ 0 },
     _ulSize(ulSize),
     _cursorType(CursorType::Legacy),
     _fUseColor(false),
@@ -168,7 +169,13 @@ void Cursor::_RedrawCursor() noexcept
     {
         if (_fDeferCursorRedraw)
         {
-            _fHaveDeferredCursorRedraw = true;
+            // Remember where the cursor was last drawn, so that
+            // EndDeferDrawing can erase it from there.
+            if (!_fHaveDeferredCursorRedraw)
+            {
+                _coordDeferredFrom = _cPosition;
+                _fHaveDeferredCursorRedraw = true;
+            }
         }
         else
         {
@@ -281,6 +288,7 @@ void Cursor::CopyProperties(const Cursor& OtherCursor) noexcept
 
     _fDeferCursorRedraw = OtherCursor._fDeferCursorRedraw;
     _fHaveDeferredCursorRedraw = OtherCursor._fHaveDeferredCursorRedraw;
+    _coordDeferredFrom = OtherCursor._coordDeferredFrom;
 
     // Size will be handled separately in the resize operation.
     //_ulSize                       = OtherCursor._ulSize;
@@ -288,6 +296,35 @@ void Cursor::CopyProperties(const Cursor& OtherCursor) noexcept
     _color = OtherCursor._color;
 }
 
+// Routine Description:
+// - Puts every property back the way the constructor left it, so that the
+//   buffer this belongs to can be reused as if it were new.
+// Arguments:
+// - ulSize - The size to give the cursor.
+// Return Value:
+// - <none>
+void Cursor::Reset(const ULONG ulSize) noexcept
+{
+    _cPosition = { 0 };
+    _fHasMoved = false;
+    _fIsVisible = true;
+    _fIsOn = true;
+    _fIsDouble = false;
+    _fBlinkingAllowed = true;
+    _fDelay = false;
+    _fIsConversionArea = false;
+    _fIsPopupShown = false;
+    _fDelayedEolWrap = false;
+    _coordDelayedAt = { 0 };
+    _fDeferCursorRedraw = false;
+    _fHaveDeferredCursorRedraw = false;
+    _coordDeferredFrom = { 0 };
+    _ulSize = ulSize;
+    _cursorType = CursorType::Legacy;
+    _fUseColor = false;
+    _color = s_InvertCursorColor;
+}
+
 void Cursor::DelayEOLWrap(const COORD coordDelayedAt) noexcept
 {
     _coordDelayedAt = coordDelayedAt;
@@ -315,14 +352,31 @@ void Cursor::StartDeferDrawing() noexcept
     _fDeferCursorRedraw = true;
 }
 
+// Routine Description:
+// - Sends the redraws that were held back since StartDeferDrawing, no matter
+//   how often the cursor moved in the meantime: one where the cursor was
+//   before the first move, and one where it is now.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
 void Cursor::EndDeferDrawing() noexcept
 {
     if (_fHaveDeferredCursorRedraw)
     {
+        if (_coordDeferredFrom.X != _cPosition.X || _coordDeferredFrom.Y != _cPosition.Y)
+        {
+            try
+            {
+                _parentBuffer.GetRenderTarget().TriggerRedrawCursor(&_coordDeferredFrom);
+            }
+            CATCH_LOG();
+        }
         _RedrawCursorAlways();
     }
 
-    _fDeferCursorRedraw = FALSE;
+    _fDeferCursorRedraw = false;
+    _fHaveDeferredCursorRedraw = false;
 }
 
 const CursorType Cursor::GetType() const noexcept
@@ -77,6 +77,7 @@ public:
     void DecrementYPosition(const int DeltaY) noexcept;
 
     void CopyProperties(const Cursor& OtherCursor) noexcept;
+    void Reset(const ULONG ulSize) noexcept;
 
     void DelayEOLWrap(const COORD coordDelayedAt) noexcept;
     void ResetDelayEOLWrap() noexcept;
@@ -91,7 +92,7 @@ private:
 
     //TODO: separate the rendering and text placement
 
-    // NOTE: If you are adding a property here, go add it to CopyProperties.
+    // NOTE: If you are adding a property here, go add it to CopyProperties and Reset.
 
     COORD _cPosition; // current position on screen (in screen buffer coords).
 
@@ -109,6 +110,7 @@ private:
 
     bool _fDeferCursorRedraw; // whether we should defer redrawing the cursor or not
     bool _fHaveDeferredCursorRedraw; // have we been asked to redraw the cursor while it was being deferred?
+    COORD _coordDeferredFrom; // where the cursor was drawn when the first redraw was deferred.
 
     ULONG _ulSize;
 
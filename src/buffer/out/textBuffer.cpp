@@ -31,10 +31,15 @@ TextBuffer::TextBuffer(const COORD screenBufferSize,
     _firstRow{ 0 },
     _currentAttributes{ defaultAttributes },
     _cursor{ cursorSize, *this },
+    _attributeTable{},
     _storage{},
     _unicodeStorage{},
-    _renderTarget{ renderTarget }
+    _renderTarget{ renderTarget },
+    _wordDelimiters{},
+    _wordDelimitersGeneration{ 0 }
 {
+    _attributeTable.SetCompactionCallback([this]() { _CompactAttributeTable(); });
+
     // initialize ROWs
     for (size_t i = 0; i < static_cast<size_t>(screenBufferSize.Y); ++i)
     {
@@ -662,6 +667,17 @@ void TextBuffer::_SetFirstRowIndex(const SHORT FirstRowIndex) noexcept
     _firstRow = FirstRowIndex;
 }
 
+// Routine Description:
+// - Moves a set of whole rows up or down within the buffer by rotating the
+//   row objects themselves, rather than copying their contents.
+// - Only the rows between the source and the target are touched, so this is
+//   proportional to the size of the scrolled region, not of the buffer.
+// Arguments:
+// - firstRow - the first row to move, relative to the top of the buffer
+// - size - the number of rows to move
+// - delta - how far to move them. Negative moves them up.
+// Return Value:
+// - <none>
 void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT delta)
 {
     // If we don't have to move anything, leave early.
@@ -672,16 +688,30 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
 
     // OK. We're about to play games by moving rows around within the deque to
     // scroll a massive region in a faster way than copying things.
-    // To make this easier, first correct the circular buffer to have the first row be 0 again.
-    if (_firstRow != 0)
+    // These are the rows that will change places, relative to the top of the buffer:
+    // the ones being moved, plus the ones that they're moving over.
+    const size_t rangeTop = firstRow + std::min<SHORT>(delta, 0);
+    const size_t rangeHeight = size + std::abs(delta);
+
+    // Find where that range sits within the circular buffer. If it wraps around
+    // the end of the storage, correct the circular buffer to have the first row
+    // be 0 again, so that we can rotate it as one contiguous piece.
+    // That has to touch every row, so it's only worth it if we really need to.
+    auto storageTop = (_firstRow + rangeTop) % _storage.size();
+    const auto straighten = storageTop + rangeHeight > _storage.size();
+    if (straighten)
     {
         // Rotate the buffer to put the first row at the front.
         std::rotate(_storage.begin(), _storage.begin() + _firstRow, _storage.end());
 
         // The first row is now at the top.
         _firstRow = 0;
+        storageTop = rangeTop;
     }
 
+    const auto rangeBegin = _storage.begin() + storageTop;
+    const auto rangeEnd = rangeBegin + rangeHeight;
+
     // Rotate just the subsection specified
     if (delta < 0)
     {
@@ -689,23 +719,23 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
         // delta is -2, size is 3, firstRow is 5
         // We want 3 rows from 5 (5, 6, and 7) to move up 2 spots.
         // --- (storage) ----
-        // | 0 begin
+        // | 0
         // | 1
         // | 2
-        // | 3 A. begin + firstRow + delta (because delta is negative)
+        // | 3 A. rangeBegin (firstRow + delta, because delta is negative)
         // | 4
-        // | 5 B. begin + firstRow
+        // | 5 B. rangeBegin - delta (firstRow)
         // | 6
         // | 7
-        // | 8 C. begin + firstRow + size
+        // | 8 C. rangeEnd (firstRow + size)
         // | 9
         // | 10
         // | 11
-        // - end
+        // -
         // We want B to slide up to A (the negative delta) and everything from [B,C) to slide up with it.
         // So the final layout will be
         // --- (storage) ----
-        // | 0 begin
+        // | 0
         // | 1
         // | 2
         // | 5
@@ -717,8 +747,8 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
         // | 9
         // | 10
         // | 11
-        // - end
-        std::rotate(_storage.begin() + firstRow + delta, _storage.begin() + firstRow, _storage.begin() + firstRow + size);
+        // -
+        std::rotate(rangeBegin, rangeBegin - delta, rangeEnd);
     }
     else
     {
@@ -726,23 +756,23 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
         // delta is 2, size is 3, firstRow is 5
         // We want 3 rows from 5 (5, 6, and 7) to move down 2 spots.
         // --- (storage) ----
-        // | 0 begin
+        // | 0
         // | 1
         // | 2
         // | 3
         // | 4
-        // | 5 A. begin + firstRow
+        // | 5 A. rangeBegin (firstRow)
         // | 6
         // | 7
-        // | 8 B. begin + firstRow + size
+        // | 8 B. rangeBegin + size (firstRow + size)
         // | 9
-        // | 10 C. begin + firstRow + size + delta
+        // | 10 C. rangeEnd (firstRow + size + delta)
         // | 11
-        // - end
+        // -
         // We want B-1 to slide down to C-1 (the positive delta) and everything from [A, B) to slide down with it.
         // So the final layout will be
         // --- (storage) ----
-        // | 0 begin
+        // | 0
         // | 1
         // | 2
         // | 3
@@ -754,13 +784,20 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
         // | 7
         // | 10
         // | 11
-        // - end
-        std::rotate(_storage.begin() + firstRow, _storage.begin() + firstRow + size, _storage.begin() + firstRow + size + delta);
+        // -
+        std::rotate(rangeBegin, rangeBegin + size, rangeEnd);
     }
 
     // Renumber the IDs now that we've rearranged where the rows sit within the buffer.
     // Refreshing should also delegate to the UnicodeStorage to re-key all the stored unicode sequences (where applicable).
-    _RefreshRowIDs(std::nullopt);
+    if (straighten)
+    {
+        _RefreshRowIDs(std::nullopt);
+    }
+    else
+    {
+        _RefreshRowIDs(storageTop, storageTop + rangeHeight);
+    }
 }
 
 Cursor& TextBuffer::GetCursor() noexcept
@@ -797,6 +834,27 @@ void TextBuffer::Reset()
     }
 }
 
+// Routine Description:
+// - Puts this buffer back the way it was when it was created, as if it had
+//   been created again with the given attributes and cursor size, but reusing
+//   the rows it already has instead of allocating new ones.
+// Arguments:
+// - defaultAttributes - The attributes to fill the buffer with, and to write with from now on.
+// - cursorSize - The size to give the cursor.
+// Return Value:
+// - <none>
+void TextBuffer::Reinitialize(const TextAttribute defaultAttributes, const UINT cursorSize)
+{
+    _currentAttributes = defaultAttributes;
+    _cursor.Reset(cursorSize);
+    _unicodeStorage.Clear();
+
+    Reset();
+
+    // Nothing refers to the attributes the rows used to have anymore.
+    _CompactAttributeTable();
+}
+
 // Routine Description:
 // - This is the legacy screen resize with minimal changes
 // Arguments:
@@ -861,6 +919,39 @@ UnicodeStorage& TextBuffer::GetUnicodeStorage() noexcept
     return _unicodeStorage;
 }
 
+const TextAttributeTable& TextBuffer::GetAttributeTable() const noexcept
+{
+    return _attributeTable;
+}
+
+TextAttributeTable& TextBuffer::GetAttributeTable() noexcept
+{
+    return _attributeTable;
+}
+
+// Routine Description:
+// - Called by the attribute table when it runs out of ids. Drops every
+//   attribute that no row is using anymore, and renumbers the ids stored in
+//   the rows to match.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void TextBuffer::_CompactAttributeTable()
+{
+    std::vector<bool> inUse(_attributeTable.Size(), false);
+    for (const auto& row : _storage)
+    {
+        row.GetAttrRow().MarkAttributesInUse(inUse);
+    }
+
+    const auto remap = _attributeTable.Compact(inUse);
+    for (auto& row : _storage)
+    {
+        row.GetAttrRow().RemapAttributes(remap);
+    }
+}
+
 // Routine Description:
 // - Method to help refresh all the Row IDs after manipulating the row
 //   by shuffling pointers around.
@@ -897,6 +988,35 @@ void TextBuffer::_RefreshRowIDs(std::optional<SHORT> newRowWidth)
     _unicodeStorage.Remap(rowMap, newRowWidth);
 }
 
+// Routine Description:
+// - Refreshes the Row IDs of a range of rows within the storage, after they
+//   were shuffled around among themselves. Rows outside of the range keep
+//   their IDs, as do any UnicodeStorage entries on them.
+// Arguments:
+// - begin - the index of the first row in the storage to refresh
+// - end - the index just past the last row in the storage to refresh
+void TextBuffer::_RefreshRowIDs(const size_t begin, const size_t end)
+{
+    std::map<SHORT, SHORT> rowMap;
+    for (auto i = begin; i < end; ++i)
+    {
+        auto& row = _storage.at(i);
+        const auto id = gsl::narrow<SHORT>(i);
+
+        // Build a map so we can update Unicode Storage
+        rowMap.emplace(row.GetId(), id);
+
+        // Update the IDs
+        row.SetId(id);
+
+        // Also update the char row parent pointers as they can get shuffled up in the rotates.
+        row.GetCharRow().UpdateParent(&row);
+    }
+
+    // Give the new mapping to Unicode Storage
+    _unicodeStorage.RemapRows(rowMap);
+}
+
 void TextBuffer::_NotifyPaint(const Viewport& viewport) const
 {
     _renderTarget.TriggerRedraw(viewport);
@@ -945,6 +1065,30 @@ Microsoft::Console::Render::IRenderTarget& TextBuffer::GetRenderTarget() noexcep
     return _renderTarget;
 }
 
+// Method Description:
+// - get the delimiter classes of every cell in a row
+// - each row keeps its classes until its text changes, so screen readers
+//   walking the same text over and over don't classify it over and over
+// - the caller must hold _delimiterClassesLock until it's done with the classes
+// Arguments:
+// - row: the row under observation
+// - wordDelimiters: the delimiters defined as a part of the DelimiterClass::DelimiterChar
+// Return Value:
+// - the delimiter classes for the row
+const DelimiterClassBitmap& TextBuffer::_GetDelimiterClasses(const SHORT row, const std::wstring_view wordDelimiters) const
+{
+    // Rows never move to another buffer, so a generation only has to tell
+    // apart the sets of word delimiters that this buffer has seen.
+    // Rows start out at 0, which never names a set.
+    if (_wordDelimitersGeneration == 0 || wordDelimiters != _wordDelimiters)
+    {
+        _wordDelimiters = wordDelimiters;
+        ++_wordDelimitersGeneration;
+    }
+
+    return GetRowByOffset(row).GetCharRow().GetDelimiterClasses(wordDelimiters, _wordDelimitersGeneration);
+}
+
 // Method Description:
 // - get delimiter class for buffer cell position
 // - used for double click selection and uia word navigation
@@ -955,7 +1099,92 @@ Microsoft::Console::Render::IRenderTarget& TextBuffer::GetRenderTarget() noexcep
 // - the delimiter class for the given char
 const DelimiterClass TextBuffer::_GetDelimiterClassAt(const COORD pos, const std::wstring_view wordDelimiters) const
 {
-    return GetRowByOffset(pos.Y).GetCharRow().DelimiterClassAt(pos.X, wordDelimiters);
+    return _GetDelimiterClasses(pos.Y, wordDelimiters).At(pos.X);
+}
+
+// Method Description:
+// - Moves pos right while the cell it's on is (or, if equal is false, isn't)
+//   of the given delimiter class, wrapping onto the following rows.
+// - This is the same as incrementing pos one cell at a time until that stops
+//   being the case, but scans a row at a time.
+// Arguments:
+// - pos: the position to move
+// - delimiterClass: the class to skip over
+// - equal: whether to skip over that class or over every other class
+// - wordDelimiters: the delimiters defined as a part of the DelimiterClass::DelimiterChar
+// - allowEndExclusive: if true, running out of cells leaves pos at the
+//   EndExclusive COORD, otherwise on the last cell
+// Return Value:
+// - true if a cell that stops the skip was found. False if we ran out of cells.
+bool TextBuffer::_SkipDelimiterClassForward(COORD& pos,
+                                            const DelimiterClass delimiterClass,
+                                            const bool equal,
+                                            const std::wstring_view wordDelimiters,
+                                            const bool allowEndExclusive) const
+{
+    const auto bufferSize = GetSize();
+    if (!bufferSize.IsInBounds(pos))
+    {
+        // We're already past the last cell.
+        return false;
+    }
+
+    for (;;)
+    {
+        const auto found = _GetDelimiterClasses(pos.Y, wordDelimiters).FindNext(pos.X, delimiterClass, !equal);
+        if (found.has_value())
+        {
+            pos.X = gsl::narrow<SHORT>(*found);
+            return true;
+        }
+
+        if (pos.Y == bufferSize.BottomInclusive())
+        {
+            pos = allowEndExclusive ? bufferSize.EndExclusive() : COORD{ bufferSize.RightInclusive(), pos.Y };
+            return false;
+        }
+
+        pos = { bufferSize.Left(), gsl::narrow<SHORT>(pos.Y + 1) };
+    }
+}
+
+// Method Description:
+// - Moves pos left while the cell it's on is (or, if equal is false, isn't)
+//   of the given delimiter class, wrapping onto the preceding rows.
+// - This is the same as decrementing pos one cell at a time until that stops
+//   being the case, but scans a row at a time.
+// Arguments:
+// - pos: the position to move
+// - delimiterClass: the class to skip over
+// - equal: whether to skip over that class or over every other class
+// - wordDelimiters: the delimiters defined as a part of the DelimiterClass::DelimiterChar
+// Return Value:
+// - true if a cell that stops the skip was found. False if we ran out of cells,
+//   in which case pos is the first cell in the buffer.
+bool TextBuffer::_SkipDelimiterClassBackward(COORD& pos,
+                                             const DelimiterClass delimiterClass,
+                                             const bool equal,
+                                             const std::wstring_view wordDelimiters) const
+{
+    const auto bufferSize = GetSize();
+
+    for (;;)
+    {
+        const auto found = _GetDelimiterClasses(pos.Y, wordDelimiters).FindPrevious(pos.X, delimiterClass, !equal);
+        if (found.has_value())
+        {
+            pos.X = gsl::narrow<SHORT>(*found);
+            return true;
+        }
+
+        if (pos.Y == bufferSize.Top())
+        {
+            pos.X = bufferSize.Left();
+            return false;
+        }
+
+        pos = { bufferSize.RightInclusive(), gsl::narrow<SHORT>(pos.Y - 1) };
+    }
 }
 
 // Method Description:
@@ -986,6 +1215,7 @@ const COORD TextBuffer::GetWordStart(const COORD target, const std::wstring_view
         return target;
     }
 
+    const std::lock_guard<std::mutex> lock{ _delimiterClassesLock };
     if (accessibilityMode)
     {
         return _GetWordStartForAccessibility(target, wordDelimiters);
@@ -1010,27 +1240,16 @@ const COORD TextBuffer::_GetWordStartForAccessibility(const COORD target, const
     bool stayAtOrigin = false;
 
     // ignore left boundary. Continue until readable text found
-    while (_GetDelimiterClassAt(result, wordDelimiters) != DelimiterClass::RegularChar)
+    if (!_SkipDelimiterClassBackward(result, DelimiterClass::RegularChar, false, wordDelimiters))
     {
-        if (!bufferSize.DecrementInBounds(result))
-        {
-            // first char in buffer is a DelimiterChar or ControlChar
-            // we can't move any further back
-            stayAtOrigin = true;
-            break;
-        }
+        // first char in buffer is a DelimiterChar or ControlChar
+        // we can't move any further back
+        stayAtOrigin = true;
     }
 
-    // make sure we expand to the left boundary or the beginning of the word
-    while (_GetDelimiterClassAt(result, wordDelimiters) == DelimiterClass::RegularChar)
-    {
-        if (!bufferSize.DecrementInBounds(result))
-        {
-            // first char in buffer is a RegularChar
-            // we can't move any further back
-            break;
-        }
-    }
+    // make sure we expand to the left boundary or the beginning of the word.
+    // If the first char in buffer is a RegularChar, we can't move any further back.
+    _SkipDelimiterClassBackward(result, DelimiterClass::RegularChar, true, wordDelimiters);
 
     // move off of delimiter and onto word start
     if (!stayAtOrigin && _GetDelimiterClassAt(result, wordDelimiters) != DelimiterClass::RegularChar)
@@ -1053,19 +1272,14 @@ const COORD TextBuffer::_GetWordStartForSelection(const COORD target, const std:
     COORD result = target;
     const auto bufferSize = GetSize();
 
-    const auto initialDelimiter = _GetDelimiterClassAt(result, wordDelimiters);
+    const auto& delimiterClasses = _GetDelimiterClasses(result.Y, wordDelimiters);
+    const auto initialDelimiter = delimiterClasses.At(result.X);
 
     // expand left until we hit the left boundary or a different delimiter class
-    while (result.X > bufferSize.Left() && (_GetDelimiterClassAt(result, wordDelimiters) == initialDelimiter))
-    {
-        bufferSize.DecrementInBounds(result);
-    }
+    const auto found = delimiterClasses.FindPrevious(result.X, initialDelimiter, false);
 
-    if (_GetDelimiterClassAt(result, wordDelimiters) != initialDelimiter)
-    {
-        // move off of delimiter
-        bufferSize.IncrementInBounds(result);
-    }
+    // move off of delimiter
+    result.X = found.has_value() ? gsl::narrow<SHORT>(*found + 1) : bufferSize.Left();
 
     return result;
 }
@@ -1092,6 +1306,7 @@ const COORD TextBuffer::GetWordEnd(const COORD target, const std::wstring_view w
     //  so the words in the example include ["word   ", "other  "]
     // NOTE: the end anchor (this one) is exclusive, whereas the start anchor (GetWordStart) is inclusive
 
+    const std::lock_guard<std::mutex> lock{ _delimiterClassesLock };
     if (accessibilityMode)
     {
         return _GetWordEndForAccessibility(target, wordDelimiters);
@@ -1111,29 +1326,16 @@ const COORD TextBuffer::GetWordEnd(const COORD target, const std::wstring_view w
 // - The COORD for the first character of the next readable "word". If no next word, return one past the end of the buffer
 const COORD TextBuffer::_GetWordEndForAccessibility(const COORD target, const std::wstring_view wordDelimiters) const
 {
-    const auto bufferSize = GetSize();
     COORD result = target;
 
     // ignore right boundary. Continue through readable text found
-    while (_GetDelimiterClassAt(result, wordDelimiters) == DelimiterClass::RegularChar)
-    {
-        if (!bufferSize.IncrementInBounds(result, true))
-        {
-            break;
-        }
-    }
+    _SkipDelimiterClassForward(result, DelimiterClass::RegularChar, true, wordDelimiters, true);
 
-    // make sure we expand to the beginning of the NEXT word
-    while (_GetDelimiterClassAt(result, wordDelimiters) != DelimiterClass::RegularChar)
-    {
-        if (!bufferSize.IncrementInBounds(result, true))
-        {
-            // we are at the EndInclusive COORD
-            // this signifies that we must include the last char in the buffer
-            // but the position of the COORD points to nothing
-            break;
-        }
-    }
+    // make sure we expand to the beginning of the NEXT word.
+    // If there isn't one, we end up at the EndExclusive COORD.
+    // this signifies that we must include the last char in the buffer
+    // but the position of the COORD points to nothing
+    _SkipDelimiterClassForward(result, DelimiterClass::RegularChar, false, wordDelimiters, true);
 
     return result;
 }
@@ -1156,19 +1358,14 @@ const COORD TextBuffer::_GetWordEndForSelection(const COORD target, const std::w
     }
 
     COORD result = target;
-    const auto initialDelimiter = _GetDelimiterClassAt(result, wordDelimiters);
+    const auto& delimiterClasses = _GetDelimiterClasses(result.Y, wordDelimiters);
+    const auto initialDelimiter = delimiterClasses.At(result.X);
 
     // expand right until we hit the right boundary or a different delimiter class
-    while (result.X < bufferSize.RightInclusive() && (_GetDelimiterClassAt(result, wordDelimiters) == initialDelimiter))
-    {
-        bufferSize.IncrementInBounds(result);
-    }
+    const auto found = delimiterClasses.FindNext(result.X, initialDelimiter, false);
 
-    if (_GetDelimiterClassAt(result, wordDelimiters) != initialDelimiter)
-    {
-        // move off of delimiter
-        bufferSize.DecrementInBounds(result);
-    }
+    // move off of delimiter
+    result.X = found.has_value() ? gsl::narrow<SHORT>(*found - 1) : bufferSize.RightInclusive();
 
     return result;
 }
@@ -1184,18 +1381,16 @@ const COORD TextBuffer::_GetWordEndForSelection(const COORD target, const std::w
 // - pos - The COORD for the first character on the "word" (inclusive)
 bool TextBuffer::MoveToNextWord(COORD& pos, const std::wstring_view wordDelimiters, COORD lastCharPos) const
 {
+    const std::lock_guard<std::mutex> lock{ _delimiterClassesLock };
     auto copy = pos;
     const auto bufferSize = GetSize();
 
     // started on a word, continue until the end of the word
-    while (_GetDelimiterClassAt(copy, wordDelimiters) == DelimiterClass::RegularChar)
+    if (!_SkipDelimiterClassForward(copy, DelimiterClass::RegularChar, true, wordDelimiters))
     {
-        if (!bufferSize.IncrementInBounds(copy))
-        {
-            // last char in buffer is a RegularChar
-            // thus there is no next word
-            return false;
-        }
+        // last char in buffer is a RegularChar
+        // thus there is no next word
+        return false;
     }
 
     // we are already on/past the last RegularChar
@@ -1205,14 +1400,11 @@ bool TextBuffer::MoveToNextWord(COORD& pos, const std::wstring_view wordDelimite
     }
 
     // on whitespace, continue until the beginning of the next word
-    while (_GetDelimiterClassAt(copy, wordDelimiters) != DelimiterClass::RegularChar)
+    if (!_SkipDelimiterClassForward(copy, DelimiterClass::RegularChar, false, wordDelimiters))
     {
-        if (!bufferSize.IncrementInBounds(copy))
-        {
-            // last char in buffer is a DelimiterChar or ControlChar
-            // there is no next word
-            return false;
-        }
+        // last char in buffer is a DelimiterChar or ControlChar
+        // there is no next word
+        return false;
     }
 
     // successful move, copy result out
@@ -1230,29 +1422,23 @@ bool TextBuffer::MoveToNextWord(COORD& pos, const std::wstring_view wordDelimite
 // - pos - The COORD for the first character on the "word" (inclusive)
 bool TextBuffer::MoveToPreviousWord(COORD& pos, std::wstring_view wordDelimiters) const
 {
+    const std::lock_guard<std::mutex> lock{ _delimiterClassesLock };
     auto copy = pos;
-    auto bufferSize = GetSize();
 
     // started on whitespace/delimiter, continue until the end of the previous word
-    while (_GetDelimiterClassAt(copy, wordDelimiters) != DelimiterClass::RegularChar)
+    if (!_SkipDelimiterClassBackward(copy, DelimiterClass::RegularChar, false, wordDelimiters))
     {
-        if (!bufferSize.DecrementInBounds(copy))
-        {
-            // first char in buffer is a DelimiterChar or ControlChar
-            // there is no previous word
-            return false;
-        }
+        // first char in buffer is a DelimiterChar or ControlChar
+        // there is no previous word
+        return false;
     }
 
     // on a word, continue until the beginning of the word
-    while (_GetDelimiterClassAt(copy, wordDelimiters) == DelimiterClass::RegularChar)
+    if (!_SkipDelimiterClassBackward(copy, DelimiterClass::RegularChar, true, wordDelimiters))
     {
-        if (!bufferSize.DecrementInBounds(copy))
-        {
-            // first char in buffer is a RegularChar
-            // there is no previous word
-            return false;
-        }
+        // first char in buffer is a RegularChar
+        // there is no previous word
+        return false;
     }
 
     // successful move, copy result out
@@ -1443,8 +1629,53 @@ void TextBuffer::_ExpandTextRow(SMALL_RECT& textRow) const
     }
 }
 
+namespace
+{
+    // Collects everything into a TextAndColor, with one color per character.
+    class TextAndColorSink final : public ITextSink
+    {
+    public:
+        TextAndColorSink(TextBuffer::TextAndColor& data, const bool copyTextColor) noexcept :
+            _data{ data },
+            _copyTextColor{ copyTextColor }
+        {
+        }
+
+        void BeginRow() override
+        {
+            _data.text.emplace_back();
+            if (_copyTextColor)
+            {
+                _data.FgAttr.emplace_back();
+                _data.BkAttr.emplace_back();
+            }
+        }
+
+        void AppendText(const std::wstring_view text, const COLORREF foreground, const COLORREF background) override
+        {
+            _data.text.back().append(text);
+            if (_copyTextColor)
+            {
+                _data.FgAttr.back().insert(_data.FgAttr.back().end(), text.size(), foreground);
+                _data.BkAttr.back().insert(_data.BkAttr.back().end(), text.size(), background);
+            }
+        }
+
+        void AppendLineBreak() override
+        {
+            // cant see CR/LF so just use black FG & BK
+            AppendText(L"\r\n", RGB(0x00, 0x00, 0x00), RGB(0x00, 0x00, 0x00));
+        }
+
+    private:
+        TextBuffer::TextAndColor& _data;
+        const bool _copyTextColor;
+    };
+}
+
 // Routine Description:
 // - Retrieves the text data from the selected region and presents it in a clipboard-ready format (given little post-processing).
+// - This holds the whole region in memory (with a color per character). Prefer VisitText for anything that can be large.
 // Arguments:
 // - includeCRLF - inject CRLF pairs to the end of each line
 // - trimTrailingWhitespace - remove the trailing whitespace at the end of each line
@@ -1471,56 +1702,108 @@ const TextBuffer::TextAndColor TextBuffer::GetText(const bool includeCRLF,
         data.BkAttr.reserve(rows);
     }
 
+    TextAndColorSink sink{ data, copyTextColor };
+    VisitText(includeCRLF, trimTrailingWhitespace, selectionRects, sink, GetForegroundColor, GetBackgroundColor);
+
+    return data;
+}
+
+// Routine Description:
+// - Streams the text data from the selected region into a sink, one row at a time.
+// - Each row is handed over as runs of text that share the same colors. The runs
+//   come straight from the row's attribute runs, so the colors are looked up once
+//   per run, and nothing larger than a single row is held here no matter how large
+//   the region is.
+// Arguments:
+// - includeCRLF - inject CRLF pairs to the end of each line
+// - trimTrailingWhitespace - remove the trailing whitespace at the end of each line
+// - textRects - the rectangular regions from which the data will be extracted from the buffer (i.e.: selection rects)
+// - sink - receives the text
+// - GetForegroundColor - function used to map TextAttribute to RGB COLORREF for foreground color. If null, only extract the text.
+// - GetBackgroundColor - function used to map TextAttribute to RGB COLORREF for background color. If null, only extract the text.
+// Return Value:
+// - <none>
+void TextBuffer::VisitText(const bool includeCRLF,
+                           const bool trimTrailingWhitespace,
+                           const std::vector<SMALL_RECT>& selectionRects,
+                           ITextSink& sink,
+                           std::function<COLORREF(TextAttribute&)> GetForegroundColor,
+                           std::function<COLORREF(TextAttribute&)> GetBackgroundColor) const
+{
+    const bool copyTextColor = GetForegroundColor && GetBackgroundColor;
+
+    struct ColorSpan
+    {
+        size_t length;
+        COLORREF foreground;
+        COLORREF background;
+    };
+
+    // These hold a single row and are reused for every row.
+    std::wstring rowText;
+    std::vector<ColorSpan> rowSpans;
+
+    // Let the sink size its output up front.
+    size_t cells = 0;
+    for (const auto& rect : selectionRects)
+    {
+        cells += gsl::narrow<size_t>(rect.Right - rect.Left + 1);
+    }
+    sink.Reserve(selectionRects.size(), cells);
+
     // for each row in the selection
-    for (UINT i = 0; i < rows; i++)
+    for (size_t i = 0; i < selectionRects.size() && !sink.IsFull(); i++)
     {
-        const UINT iRow = selectionRects.at(i).Top;
+        const auto& rect = selectionRects.at(i);
+        const auto& row = GetRowByOffset(gsl::narrow<size_t>(rect.Top));
+        const auto& charRow = row.GetCharRow();
+        const auto& attrRow = row.GetAttrRow();
 
-        const Viewport highlight = Viewport::FromInclusive(selectionRects.at(i));
+        rowText.clear();
+        rowSpans.clear();
+        rowText.reserve(gsl::narrow<size_t>(rect.Right - rect.Left + 1));
 
-        // retrieve the data from the screen buffer
-        auto it = GetCellDataAt(highlight.Origin(), highlight);
+        const size_t right = std::min(gsl::narrow<size_t>(rect.Right) + 1, charRow.size());
+        size_t column = gsl::narrow<size_t>(rect.Left);
 
-        // allocate a string buffer
-        std::wstring selectionText;
-        std::vector<COLORREF> selectionFgAttr;
-        std::vector<COLORREF> selectionBkAttr;
+        // Walk the attribute runs alongside the columns with a single iterator,
+        // so the colors are only looked up once per run rather than once per cell.
+        auto attrIt = attrRow.begin();
+        attrIt += gsl::narrow<ptrdiff_t>(column);
 
-        // preallocate to avoid reallocs
-        selectionText.reserve(gsl::narrow<size_t>(highlight.Width()) + 2); // + 2 for \r\n if we munged it
-        if (copyTextColor)
-        {
-            selectionFgAttr.reserve(gsl::narrow<size_t>(highlight.Width()) + 2);
-            selectionBkAttr.reserve(gsl::narrow<size_t>(highlight.Width()) + 2);
-        }
+        std::optional<TextAttributeId> attrId;
+        COLORREF foreground = 0;
+        COLORREF background = 0;
 
         // copy char data into the string buffer, skipping trailing bytes
-        while (it)
+        for (; column < right; ++column, ++attrIt)
         {
-            const auto& cell = *it;
+            if (copyTextColor && attrIt.GetAttributeId() != attrId)
+            {
+                attrId = attrIt.GetAttributeId();
+                auto attr = *attrIt;
+                foreground = GetForegroundColor(attr);
+                background = GetBackgroundColor(attr);
+            }
 
-            if (!cell.DbcsAttr().IsTrailing())
+            if (charRow.DbcsAttrAt(column).IsTrailing())
             {
-                selectionText.append(cell.Chars());
+                continue;
+            }
 
-                if (copyTextColor)
-                {
-                    auto cellData = cell.TextAttr();
-                    COLORREF const CellFgAttr = GetForegroundColor(cellData);
-                    COLORREF const CellBkAttr = GetBackgroundColor(cellData);
-                    for (const wchar_t wch : cell.Chars())
-                    {
-                        selectionFgAttr.push_back(CellFgAttr);
-                        selectionBkAttr.push_back(CellBkAttr);
-                    }
-                }
+            // Neighboring runs often map to the same colors (e.g. they only differ in
+            // attributes that we don't export), in which case they share a span.
+            if (rowSpans.empty() || rowSpans.back().foreground != foreground || rowSpans.back().background != background)
+            {
+                rowSpans.push_back({ 0, foreground, background });
             }
-#pragma warning(suppress : 26444)
-            // TODO GH 2675: figure out why there's custom construction/destruction happening here
-            it++;
+
+            const std::wstring_view chars = charRow.GlyphAt(column);
+            rowText.append(chars);
+            rowSpans.back().length += chars.size();
         }
 
-        const bool forcedWrap = GetRowByOffset(iRow).GetCharRow().WasWrapForced();
+        const bool forcedWrap = charRow.WasWrapForced();
 
         if (trimTrailingWhitespace)
         {
@@ -1528,18 +1811,27 @@ const TextBuffer::TextAndColor TextBuffer::GetText(const bool includeCRLF,
             if (!forcedWrap)
             {
                 // remove the spaces at the end (aka trim the trailing whitespace)
-                while (!selectionText.empty() && selectionText.back() == UNICODE_SPACE)
+                while (!rowText.empty() && rowText.back() == UNICODE_SPACE)
                 {
-                    selectionText.pop_back();
-                    if (copyTextColor)
+                    rowText.pop_back();
+                    if (--rowSpans.back().length == 0)
                     {
-                        selectionFgAttr.pop_back();
-                        selectionBkAttr.pop_back();
+                        rowSpans.pop_back();
                     }
                 }
             }
         }
 
+        sink.BeginRow();
+
+        const std::wstring_view rowView{ rowText };
+        size_t offset = 0;
+        for (const auto& span : rowSpans)
+        {
+            sink.AppendText(rowView.substr(offset, span.length), span.foreground, span.background);
+            offset += span.length;
+        }
+
         // apply CR/LF to the end of the final string, unless we're the last line.
         // a.k.a if we're earlier than the bottom, then apply CR/LF.
         if (includeCRLF && i < selectionRects.size() - 1)
@@ -1548,401 +1840,9 @@ const TextBuffer::TextAndColor TextBuffer::GetText(const bool includeCRLF,
             if (!forcedWrap)
             {
                 // then we can assume a CR/LF is proper
-                selectionText.push_back(UNICODE_CARRIAGERETURN);
-                selectionText.push_back(UNICODE_LINEFEED);
-
-                if (copyTextColor)
-                {
-                    // cant see CR/LF so just use black FG & BK
-                    COLORREF const Blackness = RGB(0x00, 0x00, 0x00);
-                    selectionFgAttr.push_back(Blackness);
-                    selectionFgAttr.push_back(Blackness);
-                    selectionBkAttr.push_back(Blackness);
-                    selectionBkAttr.push_back(Blackness);
-                }
+                sink.AppendLineBreak();
             }
         }
-
-        data.text.emplace_back(std::move(selectionText));
-        if (copyTextColor)
-        {
-            data.FgAttr.emplace_back(std::move(selectionFgAttr));
-            data.BkAttr.emplace_back(std::move(selectionBkAttr));
-        }
-    }
-
-    return data;
-}
-
-// Routine Description:
-// - Generates a CF_HTML compliant structure based on the passed in text and color data
-// Arguments:
-// - rows - the text and color data we will format & encapsulate
-// - backgroundColor - default background color for characters, also used in padding
-// - fontHeightPoints - the unscaled font height
-// - fontFaceName - the name of the font used
-// - htmlTitle - value used in title tag of html header. Used to name the application
-// Return Value:
-// - string containing the generated HTML
-std::string TextBuffer::GenHTML(const TextAndColor& rows, const int fontHeightPoints, const std::wstring_view fontFaceName, const COLORREF backgroundColor, const std::string& htmlTitle)
-{
-    try
-    {
-        std::ostringstream htmlBuilder;
-
-        // First we have to add some standard
-        // HTML boiler plate required for CF_HTML
-        // as part of the HTML Clipboard format
-        const std::string htmlHeader =
-            "<!DOCTYPE><HTML><HEAD><TITLE>" + htmlTitle + "</TITLE></HEAD><BODY>";
-        htmlBuilder << htmlHeader;
-
-        htmlBuilder << "<!--StartFragment -->";
-
-        // apply global style in div element
-        {
-            htmlBuilder << "<DIV STYLE=\"";
-            htmlBuilder << "display:inline-block;";
-            htmlBuilder << "white-space:pre;";
-
-            htmlBuilder << "background-color:";
-            htmlBuilder << Utils::ColorToHexString(backgroundColor);
-            htmlBuilder << ";";
-
-            htmlBuilder << "font-family:";
-            htmlBuilder << "'";
-            htmlBuilder << ConvertToA(CP_UTF8, fontFaceName);
-            htmlBuilder << "',";
-            // even with different font, add monospace as fallback
-            htmlBuilder << "monospace;";
-
-            htmlBuilder << "font-size:";
-            htmlBuilder << fontHeightPoints;
-            htmlBuilder << "pt;";
-
-            // note: MS Word doesn't support padding (in this way at least)
-            htmlBuilder << "padding:";
-            htmlBuilder << 4; // todo: customizable padding
-            htmlBuilder << "px;";
-
-            htmlBuilder << "\">";
-        }
-
-        // copy text and info color from buffer
-        bool hasWrittenAnyText = false;
-        std::optional<COLORREF> fgColor = std::nullopt;
-        std::optional<COLORREF> bkColor = std::nullopt;
-        for (size_t row = 0; row < rows.text.size(); row++)
-        {
-            size_t startOffset = 0;
-
-            if (row != 0)
-            {
-                htmlBuilder << "<BR>";
-            }
-
-            for (size_t col = 0; col < rows.text.at(row).length(); col++)
-            {
-                const auto writeAccumulatedChars = [&](bool includeCurrent) {
-                    if (col >= startOffset)
-                    {
-                        const auto unescapedText = ConvertToA(CP_UTF8, std::wstring_view(rows.text.at(row)).substr(startOffset, col - startOffset + includeCurrent));
-                        for (const auto c : unescapedText)
-                        {
-                            switch (c)
-                            {
-                            case '<':
-                                htmlBuilder << "&lt;";
-                                break;
-                            case '>':
-                                htmlBuilder << "&gt;";
-                                break;
-                            case '&':
-                                htmlBuilder << "&amp;";
-                                break;
-                            default:
-                                htmlBuilder << c;
-                            }
-                        }
-
-                        startOffset = col;
-                    }
-                };
-
-                if (rows.text.at(row).at(col) == '\r' || rows.text.at(row).at(col) == '\n')
-                {
-                    // do not include \r nor \n as they don't have color attributes
-                    // and are not HTML friendly. For line break use '<BR>' instead.
-                    writeAccumulatedChars(false);
-                    break;
-                }
-
-                bool colorChanged = false;
-                if (!fgColor.has_value() || rows.FgAttr.at(row).at(col) != fgColor.value())
-                {
-                    fgColor = rows.FgAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (!bkColor.has_value() || rows.BkAttr.at(row).at(col) != bkColor.value())
-                {
-                    bkColor = rows.BkAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (colorChanged)
-                {
-                    writeAccumulatedChars(false);
-
-                    if (hasWrittenAnyText)
-                    {
-                        htmlBuilder << "</SPAN>";
-                    }
-
-                    htmlBuilder << "<SPAN STYLE=\"";
-                    htmlBuilder << "color:";
-                    htmlBuilder << Utils::ColorToHexString(fgColor.value());
-                    htmlBuilder << ";";
-                    htmlBuilder << "background-color:";
-                    htmlBuilder << Utils::ColorToHexString(bkColor.value());
-                    htmlBuilder << ";";
-                    htmlBuilder << "\">";
-                }
-
-                hasWrittenAnyText = true;
-
-                // if this is the last character in the row, flush the whole row
-                if (col == rows.text.at(row).length() - 1)
-                {
-                    writeAccumulatedChars(true);
-                }
-            }
-        }
-
-        if (hasWrittenAnyText)
-        {
-            // last opened span wasn't closed in loop above, so close it now
-            htmlBuilder << "</SPAN>";
-        }
-
-        htmlBuilder << "</DIV>";
-
-        htmlBuilder << "<!--EndFragment -->";
-
-        constexpr std::string_view HtmlFooter = "</BODY></HTML>";
-        htmlBuilder << HtmlFooter;
-
-        // once filled with values, there will be exactly 157 bytes in the clipboard header
-        constexpr size_t ClipboardHeaderSize = 157;
-
-        // these values are byte offsets from start of clipboard
-        const size_t htmlStartPos = ClipboardHeaderSize;
-        const size_t htmlEndPos = ClipboardHeaderSize + gsl::narrow<size_t>(htmlBuilder.tellp());
-        const size_t fragStartPos = ClipboardHeaderSize + gsl::narrow<size_t>(htmlHeader.length());
-        const size_t fragEndPos = htmlEndPos - HtmlFooter.length();
-
-        // header required by HTML 0.9 format
-        std::ostringstream clipHeaderBuilder;
-        clipHeaderBuilder << "Version:0.9\r\n";
-        clipHeaderBuilder << std::setfill('0');
-        clipHeaderBuilder << "StartHTML:" << std::setw(10) << htmlStartPos << "\r\n";
-        clipHeaderBuilder << "EndHTML:" << std::setw(10) << htmlEndPos << "\r\n";
-        clipHeaderBuilder << "StartFragment:" << std::setw(10) << fragStartPos << "\r\n";
-        clipHeaderBuilder << "EndFragment:" << std::setw(10) << fragEndPos << "\r\n";
-        clipHeaderBuilder << "StartSelection:" << std::setw(10) << fragStartPos << "\r\n";
-        clipHeaderBuilder << "EndSelection:" << std::setw(10) << fragEndPos << "\r\n";
-
-        return clipHeaderBuilder.str() + htmlBuilder.str();
-    }
-    catch (...)
-    {
-        LOG_HR(wil::ResultFromCaughtException());
-        return {};
-    }
-}
-
-// Routine Description:
-// - Generates an RTF document based on the passed in text and color data
-//   RTF 1.5 Spec: https://www.biblioscape.com/rtf15_spec.htm
-// Arguments:
-// - rows - the text and color data we will format & encapsulate
-// - backgroundColor - default background color for characters, also used in padding
-// - fontHeightPoints - the unscaled font height
-// - fontFaceName - the name of the font used
-// - htmlTitle - value used in title tag of html header. Used to name the application
-// Return Value:
-// - string containing the generated RTF
-std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoints, const std::wstring_view fontFaceName, const COLORREF backgroundColor)
-{
-    try
-    {
-        std::ostringstream rtfBuilder;
-
-        // start rtf
-        rtfBuilder << "{";
-
-        // Standard RTF header.
-        // This is similar to the header generated by WordPad.
-        // \ansi - specifies that the ANSI char set is used in the current doc
-        // \ansicpg1252 - represents the ANSI code page which is used to perform the Unicode to ANSI conversion when writing RTF text
-        // \deff0 - specifies that the default font for the document is the one at index 0 in the font table
-        // \nouicompat - ?
-        rtfBuilder << "\\rtf1\\ansi\\ansicpg1252\\deff0\\nouicompat";
-
-        // font table
-        rtfBuilder << "{\\fonttbl{\\f0\\fmodern\\fcharset0 " << ConvertToA(CP_UTF8, fontFaceName) << ";}}";
-
-        // map to keep track of colors:
-        // keys are colors represented by COLORREF
-        // values are indices of the corresponding colors in the color table
-        std::unordered_map<COLORREF, int> colorMap;
-        int nextColorIndex = 1; // leave 0 for the default color and start from 1.
-
-        // RTF color table
-        std::ostringstream colorTableBuilder;
-        colorTableBuilder << "{\\colortbl ;";
-        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(backgroundColor))
-                          << "\\green" << static_cast<int>(GetGValue(backgroundColor))
-                          << "\\blue" << static_cast<int>(GetBValue(backgroundColor))
-                          << ";";
-        colorMap[backgroundColor] = nextColorIndex++;
-
-        // content
-        std::ostringstream contentBuilder;
-        contentBuilder << "\\viewkind4\\uc4";
-
-        // paragraph styles
-        // \fs specifies font size in half-points i.e. \fs20 results in a font size
-        // of 10 pts. That's why, font size is multiplied by 2 here.
-        contentBuilder << "\\pard\\slmult1\\f0\\fs" << std::to_string(2 * fontHeightPoints)
-                       << "\\highlight1"
-                       << " ";
-
-        std::optional<COLORREF> fgColor = std::nullopt;
-        std::optional<COLORREF> bkColor = std::nullopt;
-        for (size_t row = 0; row < rows.text.size(); ++row)
-        {
-            size_t startOffset = 0;
-
-            if (row != 0)
-            {
-                contentBuilder << "\\line "; // new line
-            }
-
-            for (size_t col = 0; col < rows.text.at(row).length(); ++col)
-            {
-                const auto writeAccumulatedChars = [&](bool includeCurrent) {
-                    if (col >= startOffset)
-                    {
-                        const auto unescapedText = ConvertToA(CP_UTF8, std::wstring_view(rows.text.at(row)).substr(startOffset, col - startOffset + includeCurrent));
-                        for (const auto c : unescapedText)
-                        {
-                            switch (c)
-                            {
-                            case '\\':
-                            case '{':
-                            case '}':
-                                contentBuilder << "\\" << c;
-                                break;
-                            default:
-                                contentBuilder << c;
-                            }
-                        }
-
-                        startOffset = col;
-                    }
-                };
-
-                if (rows.text.at(row).at(col) == '\r' || rows.text.at(row).at(col) == '\n')
-                {
-                    // do not include \r nor \n as they don't have color attributes.
-                    // For line break use \line instead.
-                    writeAccumulatedChars(false);
-                    break;
-                }
-
-                bool colorChanged = false;
-                if (!fgColor.has_value() || rows.FgAttr.at(row).at(col) != fgColor.value())
-                {
-                    fgColor = rows.FgAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (!bkColor.has_value() || rows.BkAttr.at(row).at(col) != bkColor.value())
-                {
-                    bkColor = rows.BkAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (colorChanged)
-                {
-                    writeAccumulatedChars(false);
-
-                    int bkColorIndex = 0;
-                    if (colorMap.find(bkColor.value()) != colorMap.end())
-                    {
-                        // color already exists in the map, just retrieve the index
-                        bkColorIndex = colorMap[bkColor.value()];
-                    }
-                    else
-                    {
-                        // color not present in the map, so add it
-                        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(bkColor.value()))
-                                          << "\\green" << static_cast<int>(GetGValue(bkColor.value()))
-                                          << "\\blue" << static_cast<int>(GetBValue(bkColor.value()))
-                                          << ";";
-                        colorMap[bkColor.value()] = nextColorIndex;
-                        bkColorIndex = nextColorIndex++;
-                    }
-
-                    int fgColorIndex = 0;
-                    if (colorMap.find(fgColor.value()) != colorMap.end())
-                    {
-                        // color already exists in the map, just retrieve the index
-                        fgColorIndex = colorMap[fgColor.value()];
-                    }
-                    else
-                    {
-                        // color not present in the map, so add it
-                        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(fgColor.value()))
-                                          << "\\green" << static_cast<int>(GetGValue(fgColor.value()))
-                                          << "\\blue" << static_cast<int>(GetBValue(fgColor.value()))
-                                          << ";";
-                        colorMap[fgColor.value()] = nextColorIndex;
-                        fgColorIndex = nextColorIndex++;
-                    }
-
-                    contentBuilder << "\\highlight" << bkColorIndex
-                                   << "\\cf" << fgColorIndex
-                                   << " ";
-                }
-
-                // if this is the last character in the row, flush the whole row
-                if (col == rows.text.at(row).length() - 1)
-                {
-                    writeAccumulatedChars(true);
-                }
-            }
-        }
-
-        // end colortbl
-        colorTableBuilder << "}";
-
-        // add color table to the final RTF
-        rtfBuilder << colorTableBuilder.str();
-
-        // add the text content to the final RTF
-        rtfBuilder << contentBuilder.str();
-
-        // end rtf
-        rtfBuilder << "}";
-
-        return rtfBuilder.str();
-    }
-    catch (...)
-    {
-        LOG_HR(wil::ResultFromCaughtException());
-        return {};
     }
 }
 
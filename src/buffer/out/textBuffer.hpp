@@ -53,6 +53,7 @@ filling in the last row, and updating the screen.
 #include "Row.hpp"
 #include "TextAttribute.hpp"
 #include "UnicodeStorage.hpp"
+#include "TextSink.hpp"
 #include "../types/inc/Viewport.hpp"
 
 #include "../buffer/out/textBufferCellIterator.hpp"
@@ -121,12 +122,16 @@ public:
     void SetCurrentAttributes(const TextAttribute currentAttributes) noexcept;
 
     void Reset();
+    void Reinitialize(const TextAttribute defaultAttributes, const UINT cursorSize);
 
     [[nodiscard]] HRESULT ResizeTraditional(const COORD newSize) noexcept;
 
     const UnicodeStorage& GetUnicodeStorage() const noexcept;
     UnicodeStorage& GetUnicodeStorage() noexcept;
 
+    const TextAttributeTable& GetAttributeTable() const noexcept;
+    TextAttributeTable& GetAttributeTable() noexcept;
+
     Microsoft::Console::Render::IRenderTarget& GetRenderTarget() noexcept;
 
     const COORD GetWordStart(const COORD target, const std::wstring_view wordDelimiters, bool accessibilityMode = false) const;
@@ -155,16 +160,12 @@ public:
                                std::function<COLORREF(TextAttribute&)> GetForegroundColor = nullptr,
                                std::function<COLORREF(TextAttribute&)> GetBackgroundColor = nullptr) const;
 
-    static std::string GenHTML(const TextAndColor& rows,
-                               const int fontHeightPoints,
-                               const std::wstring_view fontFaceName,
-                               const COLORREF backgroundColor,
-                               const std::string& htmlTitle);
-
-    static std::string GenRTF(const TextAndColor& rows,
-                              const int fontHeightPoints,
-                              const std::wstring_view fontFaceName,
-                              const COLORREF backgroundColor);
+    void VisitText(const bool includeCRLF,
+                   const bool trimTrailingWhitespace,
+                   const std::vector<SMALL_RECT>& textRects,
+                   ITextSink& sink,
+                   std::function<COLORREF(TextAttribute&)> GetForegroundColor = nullptr,
+                   std::function<COLORREF(TextAttribute&)> GetBackgroundColor = nullptr) const;
 
     struct PositionInformation
     {
@@ -178,6 +179,10 @@ public:
                           std::optional<std::reference_wrapper<PositionInformation>> positionInfo);
 
 private:
+    // every distinct attribute in the buffer. The rows refer to these by id,
+    // so this has to outlive them.
+    TextAttributeTable _attributeTable;
+
     std::deque<ROW> _storage;
     Cursor _cursor;
 
@@ -189,6 +194,9 @@ private:
     UnicodeStorage _unicodeStorage;
 
     void _RefreshRowIDs(std::optional<SHORT> newRowWidth);
+    void _RefreshRowIDs(const size_t begin, const size_t end);
+
+    void _CompactAttributeTable();
 
     Microsoft::Console::Render::IRenderTarget& _renderTarget;
 
@@ -210,7 +218,18 @@ private:
 
     void _ExpandTextRow(SMALL_RECT& selectionRow) const;
 
+    // Word navigation is const, but it fills in the delimiter classes that our
+    // rows keep, and several threads may navigate the buffer at once. All of
+    // that, and the word delimiters the classes were built for, is only
+    // touched with _delimiterClassesLock held.
+    mutable std::mutex _delimiterClassesLock;
+    mutable std::wstring _wordDelimiters;
+    mutable size_t _wordDelimitersGeneration;
+
+    const DelimiterClassBitmap& _GetDelimiterClasses(const SHORT row, const std::wstring_view wordDelimiters) const;
     const DelimiterClass _GetDelimiterClassAt(const COORD pos, const std::wstring_view wordDelimiters) const;
+    bool _SkipDelimiterClassForward(COORD& pos, const DelimiterClass delimiterClass, const bool equal, const std::wstring_view wordDelimiters, const bool allowEndExclusive = false) const;
+    bool _SkipDelimiterClassBackward(COORD& pos, const DelimiterClass delimiterClass, const bool equal, const std::wstring_view wordDelimiters) const;
     const COORD _GetWordStartForAccessibility(const COORD target, const std::wstring_view wordDelimiters) const;
     const COORD _GetWordStartForSelection(const COORD target, const std::wstring_view wordDelimiters) const;
     const COORD _GetWordEndForAccessibility(const COORD target, const std::wstring_view wordDelimiters) const;
@@ -265,3 +265,14 @@ const OutputCellView* TextBufferCellIterator::operator->() const noexcept
 {
     return &_view;
 }
+
+// Routine Description:
+// - Gets the attribute table id of the current cell's attribute. Comparing
+//   these is a much cheaper way to find where the attribute changes than
+//   comparing the attributes themselves.
+// Return Value:
+// - the attribute id
+TextAttributeId TextBufferCellIterator::GetAttributeId() const
+{
+    return _attrIter.GetAttributeId();
+}
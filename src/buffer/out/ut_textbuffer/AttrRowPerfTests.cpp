@@ -0,0 +1,67 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../AttrRow.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class AttrRowPerfTests
+{
+    TEST_CLASS(AttrRowPerfTests);
+
+    TEST_METHOD(WriteAlternatingSegments)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+            TEST_METHOD_PROPERTY(L"Data:segments", L"{16, 256, 4096}")
+        END_TEST_METHOD_PROPERTIES()
+
+        unsigned int segments;
+        VERIFY_SUCCEEDED(TestData::TryGetValue(L"segments", segments), L"Get number of segments");
+
+        // This is what writing a long colorized line looks like to the row:
+        // each segment is inserted on its own, left to right, in alternating colors.
+        const size_t segmentLength = 2;
+        const auto width = gsl::narrow<UINT>(segments * segmentLength);
+        const auto iterations = 100;
+
+        const TextAttributeRun runs[]{
+            { segmentLength, TextAttribute(FOREGROUND_RED) },
+            { segmentLength, TextAttribute(FOREGROUND_BLUE) },
+        };
+
+        TextAttributeTable table;
+        ATTR_ROW row{ width, TextAttribute{}, table };
+
+        Log::Comment(L"Working. Please wait...");
+        const auto now = std::chrono::steady_clock::now();
+
+        for (auto i = 0; i < iterations; ++i)
+        {
+            row.Reset(TextAttribute{});
+            for (size_t segment = 0; segment < segments; ++segment)
+            {
+                const auto start = segment * segmentLength;
+                const auto& run = runs[segment % 2];
+                VERIFY_SUCCEEDED(row.InsertAttrRuns({ &run, 1 }, start, start + segmentLength - 1, width));
+            }
+        }
+
+        const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+
+        VERIFY_ARE_EQUAL(static_cast<size_t>(segments), row.GetNumberOfRuns());
+        VERIFY_ARE_EQUAL(TextAttribute(FOREGROUND_BLUE), row.GetAttrByColumn(width - 1));
+
+        Log::Comment(String().Format(L"%d rows of %u segments took %lld us. Avg %lld us per row",
+                                     iterations,
+                                     segments,
+                                     delta,
+                                     delta / iterations));
+    }
+};
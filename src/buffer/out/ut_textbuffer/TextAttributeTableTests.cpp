@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../TextAttributeTable.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class TextAttributeTableTests
+{
+    TEST_CLASS(TextAttributeTableTests);
+
+    // Gets an attribute that's distinct for every value of i.
+    static TextAttribute _MakeAttribute(const size_t i)
+    {
+        return TextAttribute(RGB(i & 0xff, (i >> 8) & 0xff, 0), RGB(0, 0, 0));
+    }
+
+    TEST_METHOD(InternDeduplicates)
+    {
+        TextAttributeTable table;
+
+        const TextAttribute red{ FOREGROUND_RED };
+        const TextAttribute blue{ FOREGROUND_BLUE };
+
+        const auto redId = table.Intern(red);
+        const auto blueId = table.Intern(blue);
+        VERIFY_ARE_NOT_EQUAL(redId, blueId);
+        VERIFY_ARE_EQUAL(2u, table.Size());
+
+        Log::Comment(L"Interning an attribute we've already seen should give us the same id.");
+        VERIFY_ARE_EQUAL(redId, table.Intern(TextAttribute{ FOREGROUND_RED }));
+        VERIFY_ARE_EQUAL(2u, table.Size());
+
+        VERIFY_ARE_EQUAL(red, table.Get(redId));
+        VERIFY_ARE_EQUAL(blue, table.Get(blueId));
+    }
+
+    TEST_METHOD(FindDoesNotInsert)
+    {
+        TextAttributeTable table;
+
+        const TextAttribute red{ FOREGROUND_RED };
+        VERIFY_IS_FALSE(table.Find(red).has_value());
+        VERIFY_ARE_EQUAL(0u, table.Size());
+
+        const auto redId = table.Intern(red);
+        const auto found = table.Find(red);
+        VERIFY_IS_TRUE(found.has_value());
+        VERIFY_ARE_EQUAL(redId, found.value());
+    }
+
+    TEST_METHOD(CompactRenumbersLiveAttributes)
+    {
+        TextAttributeTable table;
+
+        const auto first = table.Intern(_MakeAttribute(0));
+        table.Intern(_MakeAttribute(1));
+        const auto third = table.Intern(_MakeAttribute(2));
+
+        std::vector<bool> inUse(table.Size(), false);
+        inUse.at(first) = true;
+        inUse.at(third) = true;
+
+        const auto generation = table.GetGeneration();
+        const auto remap = table.Compact(inUse);
+        VERIFY_ARE_EQUAL(generation + 1, table.GetGeneration());
+        VERIFY_ARE_EQUAL(2u, table.Size());
+
+        VERIFY_ARE_EQUAL(_MakeAttribute(0), table.Get(remap.at(first)));
+        VERIFY_ARE_EQUAL(_MakeAttribute(2), table.Get(remap.at(third)));
+
+        Log::Comment(L"The dropped attribute shouldn't be found anymore.");
+        VERIFY_IS_FALSE(table.Find(_MakeAttribute(1)).has_value());
+    }
+
+    TEST_METHOD(FullTableCallsCompaction)
+    {
+        TextAttributeTable table;
+        for (size_t i = 0; i < TextAttributeTable::MaxSize; ++i)
+        {
+            table.Intern(_MakeAttribute(i));
+        }
+        VERIFY_ARE_EQUAL(TextAttributeTable::MaxSize, table.Size());
+
+        Log::Comment(L"Without a way to compact, a full table can't take anything new.");
+        VERIFY_THROWS_SPECIFIC(table.Intern(TextAttribute{ FOREGROUND_RED }),
+                               wil::ResultException,
+                               [](wil::ResultException& e) { return e.GetErrorCode() == E_OUTOFMEMORY; });
+
+        Log::Comment(L"Attributes that are already in the table are still fine.");
+        VERIFY_ARE_EQUAL(TextAttributeId{ 5 }, table.Intern(_MakeAttribute(5)));
+
+        auto compactions = 0;
+        table.SetCompactionCallback([&]() {
+            compactions++;
+            std::vector<bool> inUse(table.Size(), false);
+            inUse.at(5) = true;
+            table.Compact(inUse);
+        });
+
+        const auto redId = table.Intern(TextAttribute{ FOREGROUND_RED });
+        VERIFY_ARE_EQUAL(1, compactions);
+        VERIFY_ARE_EQUAL(2u, table.Size());
+        VERIFY_ARE_EQUAL(TextAttribute{ FOREGROUND_RED }, table.Get(redId));
+        VERIFY_ARE_EQUAL(TextAttributeId{ 0 }, table.Intern(_MakeAttribute(5)));
+    }
+};
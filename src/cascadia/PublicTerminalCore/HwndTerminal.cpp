@@ -48,13 +48,8 @@ LRESULT CALLBACK HwndTerminal::HwndTerminalWndProc(
         case WM_RBUTTONDOWN:
             if (terminal->_terminal->IsSelectionActive())
             {
-                try
-                {
-                    const auto bufferData = terminal->_terminal->RetrieveSelectedTextFromBuffer(false);
-                    LOG_IF_FAILED(terminal->_CopyTextToSystemClipboard(bufferData, true));
-                    terminal->_terminal->ClearSelection();
-                }
-                CATCH_LOG();
+                LOG_IF_FAILED(terminal->_CopySelectionToSystemClipboard(true));
+                terminal->_terminal->ClearSelection();
             }
             else
             {
@@ -157,7 +152,7 @@ HRESULT HwndTerminal::Initialize()
     _terminal->Create(COORD{ 80, 25 }, 1000, *_renderer);
     _terminal->SetDefaultBackground(RGB(5, 27, 80));
     _terminal->SetDefaultForeground(RGB(255, 255, 255));
-    _terminal->SetWriteInputCallback([=](std::wstring & input) noexcept { _WriteTextToConnection(input); });
+    _terminal->SetWriteInputCallback([=](const std::wstring_view input) noexcept { _WriteTextToConnection(input); });
     localPointerToThread->EnablePainting();
 
     return S_OK;
@@ -168,7 +163,7 @@ void HwndTerminal::RegisterScrollCallback(std::function<void(int, int, int)> cal
     _terminal->SetScrollPositionChangedCallback(callback);
 }
 
-void HwndTerminal::_WriteTextToConnection(const std::wstring& input) noexcept
+void HwndTerminal::_WriteTextToConnection(const std::wstring_view input) noexcept
 {
     if (!_pfnWriteCallback)
     {
@@ -241,7 +236,11 @@ HRESULT HwndTerminal::Refresh(const SIZE windowSize, _Out_ COORD* dimensions)
 
     auto lock = _terminal->LockForWriting();
 
-    RETURN_IF_FAILED(_renderEngine->SetWindowSize(windowSize));
+    {
+        // The engine mustn't change size in the middle of a frame.
+        const auto engineLock = _renderer->LockForEngineChanges();
+        RETURN_IF_FAILED(_renderEngine->SetWindowSize(windowSize));
+    }
 
     // Invalidate everything
     _renderer->TriggerRedrawAll();
@@ -412,16 +411,10 @@ const wchar_t* _stdcall TerminalGetSelection(void* terminal)
 {
     const auto publicTerminal = static_cast<const HwndTerminal*>(terminal);
 
-    const auto bufferData = publicTerminal->_terminal->RetrieveSelectedTextFromBuffer(false);
-
-    // convert text: vector<string> --> string
-    std::wstring selectedText;
-    for (const auto& text : bufferData.text)
-    {
-        selectedText += text;
-    }
+    PlainTextSink sink;
+    publicTerminal->_terminal->RetrieveSelectedTextFromBuffer(false, sink);
 
-    auto returnText = wil::make_cotaskmem_string_nothrow(selectedText.c_str());
+    auto returnText = wil::make_cotaskmem_string_nothrow(sink.GetText().c_str());
     TerminalClearSelection(terminal);
 
     return returnText.release();
@@ -543,22 +536,50 @@ void _stdcall TerminalSetCursorVisible(void* terminal, const bool visible)
 }
 
 // Routine Description:
-// - Copies the text given onto the global system clipboard.
+// - Copies the selected text onto the global system clipboard.
 // Arguments:
-// - rows - Rows of text data to copy
 // - fAlsoCopyFormatting - true if the color and formatting should also be copied, false otherwise
-HRESULT HwndTerminal::_CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows, bool const fAlsoCopyFormatting)
+HRESULT HwndTerminal::_CopySelectionToSystemClipboard(bool const fAlsoCopyFormatting)
+try
 {
-    std::wstring finalString;
+    PlainTextSink textSink;
+    std::string htmlData;
+    std::string rtfData;
 
-    // Concatenate strings into one giant string to put onto the clipboard.
-    for (const auto& str : rows.text)
+    if (fAlsoCopyFormatting)
     {
-        finalString += str;
+        const auto& fontData = _actualFont;
+        int const iFontHeightPoints = fontData.GetUnscaledSize().Y * 72 / this->_currentDpi;
+        const COLORREF bgColor = _terminal->GetBackgroundColor(_terminal->GetDefaultBrushColors());
+
+        // Produce all three formats in a single pass over the selection.
+        HtmlTextSink htmlSink{ iFontHeightPoints, fontData.GetFaceName(), bgColor, "Hwnd Console Host" };
+        RtfTextSink rtfSink{ iFontHeightPoints, fontData.GetFaceName(), bgColor };
+        TeeTextSink sink{ &textSink, &htmlSink, &rtfSink };
+        _terminal->RetrieveSelectedTextFromBuffer(false, sink);
+
+        htmlData = htmlSink.Finish();
+        rtfData = rtfSink.Finish();
+    }
+    else
+    {
+        _terminal->RetrieveSelectedTextFromBuffer(false, textSink);
     }
 
+    return _CopyTextToSystemClipboard(textSink.GetText(), htmlData, rtfData);
+}
+CATCH_RETURN();
+
+// Routine Description:
+// - Copies the text given onto the global system clipboard.
+// Arguments:
+// - text - The plain text to copy
+// - htmlData - The text as CF_HTML. If empty, no HTML is placed on the clipboard.
+// - rtfData - The text as RTF. If empty, no RTF is placed on the clipboard.
+HRESULT HwndTerminal::_CopyTextToSystemClipboard(const std::wstring_view text, const std::string& htmlData, const std::string& rtfData)
+{
     // allocate the final clipboard data
-    const size_t cchNeeded = finalString.size() + 1;
+    const size_t cchNeeded = text.size() + 1;
     const size_t cbNeeded = sizeof(wchar_t) * cchNeeded;
     wil::unique_hglobal globalHandle(GlobalAlloc(GMEM_MOVEABLE | GMEM_DDESHARE, cbNeeded));
     RETURN_LAST_ERROR_IF_NULL(globalHandle.get());
@@ -568,7 +589,7 @@ HRESULT HwndTerminal::_CopyTextToSystemClipboard(const TextBuffer::TextAndColor&
 
     // The pattern gets a bit strange here because there's no good wil built-in for global lock of this type.
     // Try to copy then immediately unlock. Don't throw until after (so the hglobal won't be freed until we unlock).
-    const HRESULT hr = StringCchCopyW(pwszClipboard, cchNeeded, finalString.data());
+    const HRESULT hr = StringCchCopyNW(pwszClipboard, cchNeeded, text.data(), text.size());
     GlobalUnlock(globalHandle.get());
     RETURN_IF_FAILED(hr);
 
@@ -583,17 +604,14 @@ HRESULT HwndTerminal::_CopyTextToSystemClipboard(const TextBuffer::TextAndColor&
         RETURN_LAST_ERROR_IF(!EmptyClipboard());
         RETURN_LAST_ERROR_IF_NULL(SetClipboardData(CF_UNICODETEXT, globalHandle.get()));
 
-        if (fAlsoCopyFormatting)
+        if (!htmlData.empty())
         {
-            const auto& fontData = _actualFont;
-            int const iFontHeightPoints = fontData.GetUnscaledSize().Y * 72 / this->_currentDpi;
-            const COLORREF bgColor = _terminal->GetBackgroundColor(_terminal->GetDefaultBrushColors());
-
-            std::string HTMLToPlaceOnClip = TextBuffer::GenHTML(rows, iFontHeightPoints, fontData.GetFaceName(), bgColor, "Hwnd Console Host");
-            _CopyToSystemClipboard(HTMLToPlaceOnClip, L"HTML Format");
+            _CopyToSystemClipboard(htmlData, L"HTML Format");
+        }
 
-            std::string RTFToPlaceOnClip = TextBuffer::GenRTF(rows, iFontHeightPoints, fontData.GetFaceName(), bgColor);
-            _CopyToSystemClipboard(RTFToPlaceOnClip, L"Rich Text Format");
+        if (!rtfData.empty())
+        {
+            _CopyToSystemClipboard(rtfData, L"Rich Text Format");
         }
     }
 
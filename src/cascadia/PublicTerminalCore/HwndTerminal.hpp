@@ -89,8 +89,9 @@ private:
     friend void _stdcall TerminalSetCursorVisible(void* terminal, const bool visible);
 
     void _UpdateFont(int newDpi);
-    void _WriteTextToConnection(const std::wstring& text) noexcept;
-    HRESULT _CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows, bool const fAlsoCopyFormatting);
+    void _WriteTextToConnection(const std::wstring_view text) noexcept;
+    HRESULT _CopySelectionToSystemClipboard(bool const fAlsoCopyFormatting);
+    HRESULT _CopyTextToSystemClipboard(const std::wstring_view text, const std::string& htmlData, const std::string& rtfData);
     HRESULT _CopyToSystemClipboard(std::string stringToCopy, LPCWSTR lpszFormat);
     void _PasteTextFromClipboard() noexcept;
     void _StringPaste(const wchar_t* const pData) noexcept;
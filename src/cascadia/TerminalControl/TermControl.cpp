@@ -63,6 +63,7 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         _autoScrollingPointerPoint{ std::nullopt },
         _autoScrollTimer{},
         _lastAutoScrollUpdateTime{ std::nullopt },
+        _mouseMotionTimer{},
         _desiredFont{ DEFAULT_FONT_FACE, 0, 10, { 0, DEFAULT_FONT_SIZE }, CP_UTF8 },
         _actualFont{ DEFAULT_FONT_FACE, 0, 10, { 0, DEFAULT_FONT_SIZE }, CP_UTF8, false },
         _touchAnchor{ std::nullopt },
@@ -122,6 +123,8 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         _autoScrollTimer.Interval(AutoScrollUpdateInterval);
         _autoScrollTimer.Tick({ this, &TermControl::_UpdateAutoScroll });
 
+        _mouseMotionTimer.Tick({ this, &TermControl::_FlushMouseMotion });
+
         _ApplyUISettings();
     }
 
@@ -218,8 +221,12 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
             // Update our control settings
             _ApplyUISettings();
 
-            // Update DxEngine's SelectionBackground
-            _renderEngine->SetSelectionBackground(_settings.SelectionBackground());
+            // Update DxEngine's SelectionBackground. The renderer paints without
+            // the terminal lock, so wait for the frame in flight first.
+            {
+                const auto engineLock = _renderer->LockForEngineChanges();
+                _renderEngine->SetSelectionBackground(_settings.SelectionBackground());
+            }
 
             // Update the terminal core with its new Core settings
             _terminal->UpdateSettings(_settings);
@@ -869,7 +876,35 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         }
 
         const auto modifiers = _GetPressedModifierKeys();
-        return _terminal->SendMouseEvent(terminalPosition, uiButton, modifiers, sWheelDelta);
+        const auto handled = _terminal->SendMouseEvent(terminalPosition, uiButton, modifiers, sWheelDelta);
+        _ScheduleMouseMotionFlush(_terminal->FlushMouseMotion());
+        return handled;
+    }
+
+    // Method Description:
+    // - Makes sure that a mouse motion report that the terminal held back is
+    //   sent once it's due, even if the pointer doesn't move anymore.
+    // Arguments:
+    // - due: when the report that's held back is due, if there is one
+    void TermControl::_ScheduleMouseMotionFlush(const std::optional<std::chrono::steady_clock::time_point> due)
+    {
+        if (!due.has_value())
+        {
+            _mouseMotionTimer.Stop();
+            return;
+        }
+
+        const auto delay = std::max(due.value() - std::chrono::steady_clock::now(), std::chrono::steady_clock::duration::zero());
+        _mouseMotionTimer.Interval(std::chrono::duration_cast<Windows::Foundation::TimeSpan>(delay));
+        _mouseMotionTimer.Start();
+    }
+
+    // Method Description:
+    // - Called when a mouse motion report that was held back is due.
+    void TermControl::_FlushMouseMotion(Windows::Foundation::IInspectable const& /* sender */,
+                                        Windows::Foundation::IInspectable const& /* e */)
+    {
+        _ScheduleMouseMotionFlush(_terminal->FlushMouseMotion());
     }
 
     // Method Description:
@@ -1571,7 +1606,7 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
     // - wstr: the string of characters to write to the terminal connection.
     // Return Value:
     // - <none>
-    void TermControl::_SendInputToConnection(const std::wstring& wstr)
+    void TermControl::_SendInputToConnection(const std::wstring_view wstr)
     {
         _connection.WriteInput(wstr);
     }
@@ -1683,7 +1718,10 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
             const auto dpi = (int)(scale * USER_DEFAULT_SCREEN_DPI);
 
             // TODO: MSFT: 21169071 - Shouldn't this all happen through _renderer and trigger the invalidate automatically on DPI change?
-            THROW_IF_FAILED(_renderEngine->UpdateDpi(dpi));
+            {
+                const auto engineLock = _renderer->LockForEngineChanges();
+                THROW_IF_FAILED(_renderEngine->UpdateDpi(dpi));
+            }
             _renderer->TriggerRedrawAll();
         }
     }
@@ -1747,7 +1785,11 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         _terminal->ClearSelection();
 
         // Tell the dx engine that our window is now the new size.
-        THROW_IF_FAILED(_renderEngine->SetWindowSize(size));
+        // It mustn't change size in the middle of a frame.
+        {
+            const auto engineLock = _renderer->LockForEngineChanges();
+            THROW_IF_FAILED(_renderEngine->SetWindowSize(size));
+        }
 
         // Invalidate everything
         _renderer->TriggerRedrawAll();
@@ -1920,28 +1962,21 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         // Mark the current selection as copied
         _selectionNeedsToBeCopied = false;
 
-        // extract text from buffer
-        const auto bufferData = _terminal->RetrieveSelectedTextFromBuffer(singleLine);
-
-        // convert text: vector<string> --> string
-        std::wstring textData;
-        for (const auto& text : bufferData.text)
-        {
-            textData += text;
-        }
-
-        // convert text to HTML format
-        const auto htmlData = TextBuffer::GenHTML(bufferData,
-                                                  _actualFont.GetUnscaledSize().Y,
-                                                  _actualFont.GetFaceName(),
-                                                  _settings.DefaultBackground(),
-                                                  "Windows Terminal");
-
-        // convert to RTF format
-        const auto rtfData = TextBuffer::GenRTF(bufferData,
-                                                _actualFont.GetUnscaledSize().Y,
-                                                _actualFont.GetFaceName(),
-                                                _settings.DefaultBackground());
+        // extract text from buffer, converting it to plain text, HTML and RTF in one pass
+        PlainTextSink textSink;
+        HtmlTextSink htmlSink{ _actualFont.GetUnscaledSize().Y,
+                               _actualFont.GetFaceName(),
+                               _settings.DefaultBackground(),
+                               "Windows Terminal" };
+        RtfTextSink rtfSink{ _actualFont.GetUnscaledSize().Y,
+                             _actualFont.GetFaceName(),
+                             _settings.DefaultBackground() };
+        TeeTextSink sink{ &textSink, &htmlSink, &rtfSink };
+        _terminal->RetrieveSelectedTextFromBuffer(singleLine, sink);
+
+        const auto& textData = textSink.GetText();
+        const auto htmlData = htmlSink.Finish();
+        const auto rtfData = rtfSink.Finish();
 
         if (!_settings.CopyOnSelect())
         {
@@ -2000,6 +2035,7 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
 
             TSFInputControl().Close(); // Disconnect the TSF input control so it doesn't receive EditContext events.
             _autoScrollTimer.Stop();
+            _mouseMotionTimer.Stop();
 
             // GH#1996 - Close the connection asynchronously on a background
             // thread.
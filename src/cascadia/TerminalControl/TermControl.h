@@ -144,6 +144,9 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         Windows::UI::Xaml::DispatcherTimer _autoScrollTimer;
         std::optional<std::chrono::high_resolution_clock::time_point> _lastAutoScrollUpdateTime;
 
+        // Sends mouse motion reports that the terminal held back.
+        Windows::UI::Xaml::DispatcherTimer _mouseMotionTimer;
+
         // storage location for the leading surrogate of a utf-16 surrogate pair
         std::optional<wchar_t> _leadingSurrogate;
 
@@ -191,7 +194,7 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
 
         void _CursorTimerTick(Windows::Foundation::IInspectable const& sender, Windows::Foundation::IInspectable const& e);
         void _SetEndSelectionPointAtCursor(Windows::Foundation::Point const& cursorPosition);
-        void _SendInputToConnection(const std::wstring& wstr);
+        void _SendInputToConnection(const std::wstring_view wstr);
         void _SendPastedTextToConnection(const std::wstring& wstr);
         void _SwapChainSizeChanged(Windows::Foundation::IInspectable const& sender, Windows::UI::Xaml::SizeChangedEventArgs const& e);
         void _SwapChainScaleChanged(Windows::UI::Xaml::Controls::SwapChainPanel const& sender, Windows::Foundation::IInspectable const& args);
@@ -218,6 +221,8 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         ::Microsoft::Terminal::Core::ControlKeyStates _GetPressedModifierKeys() const;
         bool _TrySendKeyEvent(const WORD vkey, const WORD scanCode, ::Microsoft::Terminal::Core::ControlKeyStates modifiers);
         bool _TrySendMouseEvent(Windows::UI::Input::PointerPoint const& point);
+        void _ScheduleMouseMotionFlush(const std::optional<std::chrono::steady_clock::time_point> due);
+        void _FlushMouseMotion(Windows::Foundation::IInspectable const& sender, Windows::Foundation::IInspectable const& e);
         bool _CanSendVTMouseInput();
 
         const COORD _GetTerminalPosition(winrt::Windows::Foundation::Point cursorPosition);
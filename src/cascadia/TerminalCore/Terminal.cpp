@@ -19,21 +19,6 @@ using namespace Microsoft::Console::Render;
 using namespace Microsoft::Console::Types;
 using namespace Microsoft::Console::VirtualTerminal;
 
-static std::wstring _KeyEventsToText(std::deque<std::unique_ptr<IInputEvent>>& inEventsToWrite)
-{
-    std::wstring wstr = L"";
-    for (const auto& ev : inEventsToWrite)
-    {
-        if (ev->EventType() == InputEventType::KeyEvent)
-        {
-            const auto& k = static_cast<KeyEvent&>(*ev);
-            const auto wch = k.GetCharData();
-            wstr += wch;
-        }
-    }
-    return wstr;
-}
-
 #pragma warning(suppress : 26455) // default constructor is throwing, too much effort to rearrange at this time.
 Terminal::Terminal() :
     _mutableViewport{ Viewport::Empty() },
@@ -52,16 +37,15 @@ Terminal::Terminal() :
 
     _stateMachine = std::make_unique<StateMachine>(std::move(engine));
 
-    auto passAlongInput = [&](std::deque<std::unique_ptr<IInputEvent>>& inEventsToWrite) {
+    auto passAlongInput = [&](const std::wstring_view text) {
         if (!_pfnWriteInput)
         {
             return;
         }
-        std::wstring wstr = _KeyEventsToText(inEventsToWrite);
-        _pfnWriteInput(wstr);
+        _pfnWriteInput(text);
     };
 
-    _terminalInput = std::make_unique<TerminalInput>(passAlongInput);
+    _terminalInput = std::make_unique<TerminalInput>(TerminalInput::WriteInputText{ passAlongInput });
 
     _InitializeColorTable();
 }
@@ -466,6 +450,19 @@ bool Terminal::SendMouseEvent(const COORD viewportPos, const unsigned int uiButt
     return _terminalInput->HandleMouse(viewportPos, uiButton, GET_KEYSTATE_WPARAM(states.Value()), wheelDelta);
 }
 
+// Method Description:
+// - Mouse motion is reported at a limited rate. Between two reports, only the
+//   latest one is kept. This sends it, if it's due.
+// Arguments:
+// - <none>
+// Return Value:
+// - The time at which the report that's still held back becomes due, or
+//   nullopt if nothing is held back anymore.
+std::optional<std::chrono::steady_clock::time_point> Terminal::FlushMouseMotion()
+{
+    return _terminalInput->FlushMouseMotion(std::chrono::steady_clock::now());
+}
+
 // Method Description:
 // - Send this particular character to the terminal.
 // - This method is the counterpart to SendKeyEvent and behaves almost identical.
@@ -680,69 +677,105 @@ Viewport Terminal::_GetVisibleViewport() const noexcept
 //       I had to make a bunch of hacks to get Japanese and emoji to work-ish.
 void Terminal::_WriteBuffer(const std::wstring_view& stringView)
 {
+    if (stringView.empty())
+    {
+        return;
+    }
+
     auto& cursor = _buffer->GetCursor();
+    const auto bufferWidth = _buffer->GetSize().Width();
+    bool notifyScroll = false;
 
     // Defer the cursor drawing while we are iterating the string, for a better performance.
     // We can not waste time displaying a cursor event when we know more text is coming right behind it.
     cursor.StartDeferDrawing();
 
-    for (size_t i = 0; i < stringView.size(); i++)
+    auto remaining = stringView;
+    while (!remaining.empty())
     {
-        const auto wch = stringView.at(i);
-        const COORD cursorPosBefore = cursor.GetPosition();
-        COORD proposedCursorPosition = cursorPosBefore;
-
-        // TODO: MSFT 21006766
-        // This is not great but I need it demoable. Fix by making a buffer stream writer.
-        //
-        // If wch is a surrogate character we need to read 2 code units
-        // from the stringView to form a single code point.
-        const auto isSurrogate = wch >= 0xD800 && wch <= 0xDFFF;
-        const auto view = stringView.substr(i, isSurrogate ? 2 : 1);
-        const OutputCellIterator it{ view, _buffer->GetCurrentAttributes() };
-        const auto end = _buffer->Write(it);
-        const auto cellDistance = end.GetCellDistance(it);
+        // GH#780 - When the last write filled the final column of a row, the
+        // cursor was left in that column with the wrap delayed. More text
+        // is here, so the line really wraps. If anything had moved the cursor
+        // in the meantime, that would have cancelled the delay.
+        if (cursor.IsDelayedEOLWrap())
+        {
+            const auto delayedAt = cursor.GetDelayedAtPosition();
+            notifyScroll |= _MoveCursor({ 0, gsl::narrow<SHORT>(delayedAt.Y + 1) });
+        }
+
+        // Write as much of the text as fits onto the rest of this row at once,
+        // and only move the cursor after, rather than once per character.
+        const auto cursorPosBefore = cursor.GetPosition();
+        const OutputCellIterator it{ remaining, _buffer->GetCurrentAttributes() };
+        const auto end = _buffer->WriteLine(it, cursorPosBefore, true);
         const auto inputDistance = end.GetInputDistance(it);
+        remaining = remaining.substr(inputDistance);
 
-        if (inputDistance > 0)
+        if (!remaining.empty())
         {
-            // If "wch" was a surrogate character, we just consumed 2 code units above.
-            // -> Increment "i" by 1 in that case and thus by 2 in total in this iteration.
-            proposedCursorPosition.X += gsl::narrow<SHORT>(cellDistance);
-            i += inputDistance - 1;
+            // The row is full, or the next glyph is too wide for what's left
+            // of it. TextBuffer::WriteLine marked the row as wrapped for us.
+            if (inputDistance == 0 && cursorPosBefore.X == 0)
+            {
+                // Not even an empty row can hold the next glyph
+                // (a wide glyph in a 1 column buffer). Give up on it rather
+                // than trying again forever.
+                break;
+            }
+            notifyScroll |= _MoveCursor({ 0, gsl::narrow<SHORT>(cursorPosBefore.Y + 1) });
         }
         else
         {
-            // If _WriteBuffer() is called with a consecutive string longer than the viewport/buffer width
-            // the call to _buffer->Write() will refuse to write anything on the current line.
-            // GetInputDistance() thus returns 0, which would in turn cause i to be
-            // decremented by 1 below and force the outer loop to loop forever.
-            // This if() basically behaves as if "\r\n" had been encountered above and retries the write.
-            // With well behaving shells during normal operation this safeguard should normally not be encountered.
-            proposedCursorPosition.X = 0;
-            proposedCursorPosition.Y++;
-
-            // Try the character again.
-            i--;
-
-            // If we write the last cell of the row here, TextBuffer::Write will
-            // mark this line as wrapped for us. If the next character we
-            // process is a newline, the Terminal::CursorLineFeed will unmark
-            // this line as wrapped.
-
-            // TODO: GH#780 - This should really be a _deferred_ newline. If
-            // the next character to come in is a newline or a cursor
-            // movement or anything, then we should _not_ wrap this line
-            // here.
+            const auto column = cursorPosBefore.X + end.GetCellDistance(it);
+            if (column < bufferWidth)
+            {
+                notifyScroll |= _MoveCursor({ gsl::narrow<SHORT>(column), cursorPosBefore.Y });
+            }
+            else
+            {
+                // We just filled the last column. Stay in it, and only wrap
+                // once we know that more text is coming. If a newline comes
+                // next instead, Terminal::CursorLineFeed will unmark the row
+                // that TextBuffer::WriteLine marked as wrapped.
+                notifyScroll |= _MoveCursor({ gsl::narrow<SHORT>(bufferWidth - 1), cursorPosBefore.Y });
+                cursor.DelayEOLWrap(cursor.GetPosition());
+            }
         }
+    }
 
-        _AdjustCursorPosition(proposedCursorPosition);
+    if (notifyScroll)
+    {
+        _buffer->GetRenderTarget().TriggerRedrawAll();
+        _NotifyScrollEvent();
     }
 
+    _NotifyTerminalCursorPositionChanged();
+
     cursor.EndDeferDrawing();
 }
 
 void Terminal::_AdjustCursorPosition(const COORD proposedPosition)
+{
+    if (_MoveCursor(proposedPosition))
+    {
+        _buffer->GetRenderTarget().TriggerRedrawAll();
+        _NotifyScrollEvent();
+    }
+
+    _NotifyTerminalCursorPositionChanged();
+}
+
+// Method Description:
+// - Moves the cursor to the given position. If that's past the bottom of the
+//   buffer, the buffer is cycled first, and if it's past the bottom of the
+//   viewport, the viewport follows it.
+// - This doesn't notify anyone. Callers that move the cursor several times in
+//   a row (like _WriteBuffer) notify once, when they're done.
+// Arguments:
+// - proposedPosition: the new position of the cursor
+// Return Value:
+// - true if the buffer cycled or the viewport moved, and a scroll event is due.
+bool Terminal::_MoveCursor(const COORD proposedPosition)
 {
 #pragma warning(suppress : 26496) // cpp core checks wants this const but it's modified below.
     auto proposedCursorPosition = proposedPosition;
@@ -778,13 +811,7 @@ void Terminal::_AdjustCursorPosition(const COORD proposedPosition)
         }
     }
 
-    if (notifyScroll)
-    {
-        _buffer->GetRenderTarget().TriggerRedrawAll();
-        _NotifyScrollEvent();
-    }
-
-    _NotifyTerminalCursorPositionChanged();
+    return notifyScroll;
 }
 
 void Terminal::UserScrollViewport(const int viewTop)
@@ -825,7 +852,7 @@ void Terminal::_NotifyTerminalCursorPositionChanged() noexcept
     }
 }
 
-void Terminal::SetWriteInputCallback(std::function<void(std::wstring&)> pfn) noexcept
+void Terminal::SetWriteInputCallback(std::function<void(const std::wstring_view)> pfn) noexcept
 {
     _pfnWriteInput.swap(pfn);
 }
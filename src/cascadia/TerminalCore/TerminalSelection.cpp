@@ -219,23 +219,23 @@ void Terminal::ClearSelection()
 }
 
 // Method Description:
-// - get wstring text from highlighted portion of text buffer
+// - stream the text and colors from highlighted portion of text buffer into a sink
 // Arguments:
 // - singleLine: collapse all of the text to one line
-// Return Value:
-// - wstring text from buffer. If extended to multiple lines, each line is separated by \r\n
-const TextBuffer::TextAndColor Terminal::RetrieveSelectedTextFromBuffer(bool singleLine) const
+// - sink: receives the text from the buffer. If extended to multiple lines, each line is separated by \r\n
+void Terminal::RetrieveSelectedTextFromBuffer(bool singleLine, ITextSink& sink) const
 {
     const auto selectionRects = _GetSelectionRects();
 
     std::function<COLORREF(TextAttribute&)> GetForegroundColor = std::bind(&Terminal::GetForegroundColor, this, std::placeholders::_1);
     std::function<COLORREF(TextAttribute&)> GetBackgroundColor = std::bind(&Terminal::GetBackgroundColor, this, std::placeholders::_1);
 
-    return _buffer->GetText(!singleLine,
-                            !singleLine,
-                            selectionRects,
-                            GetForegroundColor,
-                            GetBackgroundColor);
+    _buffer->VisitText(!singleLine,
+                       !singleLine,
+                       selectionRects,
+                       sink,
+                       GetForegroundColor,
+                       GetBackgroundColor);
 }
 
 // Method Description:
@@ -31,6 +31,8 @@ class TerminalCoreUnitTests::TerminalBufferTests final
 
     TEST_METHOD(TestWrappingCharByChar);
     TEST_METHOD(TestWrappingALongString);
+    TEST_METHOD(TestDeferredWrapAtEndOfLine);
+    TEST_METHOD(TestCursorMovesOncePerString);
 
     TEST_METHOD_SETUP(MethodSetup)
     {
@@ -142,3 +144,59 @@ void TerminalBufferTests::TestWrappingALongString()
 
     TestUtils::VerifyExpectedString(termTb, TestUtils::Test100CharsString, { 0, 0 });
 }
+
+void TerminalBufferTests::TestDeferredWrapAtEndOfLine()
+{
+    auto& termTb = *term->_buffer;
+    auto& termSm = *term->_stateMachine;
+    const auto initialView = term->GetViewport();
+    auto& cursor = termTb.GetCursor();
+
+    const auto fullLine = std::wstring(initialView.Width(), L'A');
+
+    Log::Comment(L"Filling a line exactly should leave the cursor in the last column, waiting to wrap.");
+    termSm.ProcessString(fullLine);
+    VERIFY_ARE_EQUAL(COORD({ gsl::narrow<SHORT>(initialView.Width() - 1), 0 }), cursor.GetPosition());
+    VERIFY_IS_TRUE(cursor.IsDelayedEOLWrap());
+
+    Log::Comment(L"The next character should wrap to the next line before it's written.");
+    termSm.ProcessString(L"B");
+    VERIFY_ARE_EQUAL(COORD({ 1, 1 }), cursor.GetPosition());
+    VERIFY_IS_FALSE(cursor.IsDelayedEOLWrap());
+    VERIFY_IS_TRUE(termTb.GetRowByOffset(0).GetCharRow().WasWrapForced());
+    TestUtils::VerifyExpectedString(termTb, fullLine + L"B", { 0, 0 });
+
+    Log::Comment(L"A newline after a full line should not wrap it, nor leave an empty line behind.");
+    termSm.ProcessString(L"\r\n");
+    termSm.ProcessString(fullLine);
+    termSm.ProcessString(L"\r\n");
+    termSm.ProcessString(L"C");
+    VERIFY_ARE_EQUAL(COORD({ 1, 3 }), cursor.GetPosition());
+    VERIFY_IS_FALSE(termTb.GetRowByOffset(2).GetCharRow().WasWrapForced());
+    TestUtils::VerifyExpectedString(termTb, L"C", { 0, 3 });
+
+    Log::Comment(L"Moving the cursor after a full line should cancel the wrap.");
+    termSm.ProcessString(L"\x1b[5;1H");
+    termSm.ProcessString(fullLine);
+    termSm.ProcessString(L"\x1b[5;5H");
+    VERIFY_IS_FALSE(cursor.IsDelayedEOLWrap());
+    termSm.ProcessString(L"D");
+    VERIFY_ARE_EQUAL(COORD({ 5, 4 }), cursor.GetPosition());
+    TestUtils::VerifyExpectedString(termTb, L"AAAADAAAA", { 0, 4 });
+}
+
+void TerminalBufferTests::TestCursorMovesOncePerString()
+{
+    auto& termTb = *term->_buffer;
+    auto& termSm = *term->_stateMachine;
+    const auto initialView = term->GetViewport();
+
+    size_t cursorNotifications = 0;
+    term->SetCursorPositionChangedCallback([&]() { cursorNotifications++; });
+
+    Log::Comment(L"Writing a string that wraps should only report the new cursor position once.");
+    termSm.ProcessString(TestUtils::Test100CharsString);
+    VERIFY_ARE_EQUAL(1u, cursorNotifications);
+    VERIFY_ARE_EQUAL(COORD({ gsl::narrow<SHORT>(100 % initialView.Width()), 1 }), termTb.GetCursor().GetPosition());
+    TestUtils::VerifyExpectedString(termTb, TestUtils::Test100CharsString, { 0, 0 });
+}
@@ -0,0 +1,192 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "ApiLatency.hpp"
+
+#pragma hdrstop
+
+static std::atomic<bool> s_enabled{ false };
+static std::mutex s_mutex;
+static std::map<std::string, LatencyHistogram, std::less<>> s_histograms;
+
+LatencyHistogram::LatencyHistogram() noexcept :
+    _counts{},
+    _count{ 0 },
+    _max{ 0 }
+{
+}
+
+// Routine Description:
+// - Counts a value.
+// Arguments:
+// - latency - The value. Values past MaxValue are counted as MaxValue.
+// Return Value:
+// - <none>
+void LatencyHistogram::Record(const std::chrono::nanoseconds latency) noexcept
+{
+    const auto value = std::min(gsl::narrow_cast<uint64_t>(std::max(latency.count(), 0ll)), MaxValue);
+    ++_counts.at(s_BucketOf(value));
+    ++_count;
+    _max = std::max(_max, value);
+}
+
+void LatencyHistogram::Reset() noexcept
+{
+    _counts.fill(0);
+    _count = 0;
+    _max = 0;
+}
+
+uint64_t LatencyHistogram::GetCount() const noexcept
+{
+    return _count;
+}
+
+std::chrono::nanoseconds LatencyHistogram::GetMax() const noexcept
+{
+    return std::chrono::nanoseconds{ _max };
+}
+
+// Routine Description:
+// - Finds the value that the given percentage of the counted values are at or
+//      below. Like any HDR histogram, it reports the highest value that shares
+//      a bucket with it, so it errs on the slow side.
+// Arguments:
+// - percentile - Between 0 and 100. 50 is the median, 100 the max.
+// Return Value:
+// - The value. 0 if nothing was counted.
+std::chrono::nanoseconds LatencyHistogram::GetValueAtPercentile(const double percentile) const noexcept
+{
+    if (_count == 0)
+    {
+        return std::chrono::nanoseconds{ 0 };
+    }
+
+    const auto fraction = std::clamp(percentile, 0.0, 100.0) / 100.0;
+    const auto rank = std::max(gsl::narrow_cast<uint64_t>(std::ceil(fraction * _count)), 1ull);
+
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BucketCount; ++bucket)
+    {
+        seen += _counts.at(bucket);
+        if (seen >= rank)
+        {
+            return std::chrono::nanoseconds{ std::min(s_HighestValueIn(bucket), _max) };
+        }
+    }
+
+    return std::chrono::nanoseconds{ _max };
+}
+
+// Routine Description:
+// - Finds the bucket a value is counted in. The first SubBucketCount values
+//      have a bucket each. Past that, the value is shifted right until it fits
+//      in SubBucketBits bits, and its top bits pick one of the
+//      SubBucketHalfCount buckets of its order of magnitude.
+// Arguments:
+// - value - The value. No larger than MaxValue.
+// Return Value:
+// - The index of the bucket.
+size_t LatencyHistogram::s_BucketOf(const uint64_t value) noexcept
+{
+    if (value < SubBucketCount)
+    {
+        return gsl::narrow_cast<size_t>(value);
+    }
+
+    unsigned long highestBit;
+#if defined(_WIN64)
+    _BitScanReverse64(&highestBit, value);
+#else
+    if (_BitScanReverse(&highestBit, gsl::narrow_cast<unsigned long>(value >> 32)))
+    {
+        highestBit += 32;
+    }
+    else
+    {
+        _BitScanReverse(&highestBit, gsl::narrow_cast<unsigned long>(value));
+    }
+#endif
+
+    const size_t shift = highestBit + 1 - SubBucketBits;
+    const auto top = gsl::narrow_cast<size_t>(value >> shift);
+    return SubBucketCount + (shift - 1) * SubBucketHalfCount + (top - SubBucketHalfCount);
+}
+
+// Routine Description:
+// - Finds the highest value counted in a bucket.
+// Arguments:
+// - bucket - The index of the bucket.
+// Return Value:
+// - The value.
+uint64_t LatencyHistogram::s_HighestValueIn(const size_t bucket) noexcept
+{
+    if (bucket < SubBucketCount)
+    {
+        return bucket;
+    }
+
+    const auto shift = (bucket - SubBucketCount) / SubBucketHalfCount + 1;
+    const uint64_t top = (bucket - SubBucketCount) % SubBucketHalfCount + SubBucketHalfCount;
+    return ((top + 1) << shift) - 1;
+}
+
+// Routine Description:
+// - Turns measuring on or off for every IO thread. Calls that are being
+//      serviced right now are measured as it was when they started.
+// Arguments:
+// - enabled - Whether to measure.
+// Return Value:
+// - <none>
+void ApiLatency::s_SetEnabled(const bool enabled) noexcept
+{
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool ApiLatency::s_IsEnabled() noexcept
+{
+    return s_enabled.load(std::memory_order_relaxed);
+}
+
+// Routine Description:
+// - Counts how long an API call took in the histogram of that API.
+// Arguments:
+// - api - The trace name of the API.
+// - latency - How long it took.
+// Return Value:
+// - <none>
+void ApiLatency::s_Record(const std::string_view api, const std::chrono::nanoseconds latency) noexcept
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock{ s_mutex };
+        auto histogram = s_histograms.find(api);
+        if (histogram == s_histograms.end())
+        {
+            histogram = s_histograms.emplace(std::string{ api }, LatencyHistogram{}).first;
+        }
+        histogram->second.Record(latency);
+    }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Copies out the histograms, so that they can be looked at while the IO
+//      threads keep adding to them.
+// Arguments:
+// - <none>
+// Return Value:
+// - The histogram of every API that was called since the last reset, by trace name.
+std::map<std::string, LatencyHistogram, std::less<>> ApiLatency::s_Snapshot()
+{
+    std::lock_guard<std::mutex> lock{ s_mutex };
+    return s_histograms;
+}
+
+void ApiLatency::s_Reset() noexcept
+{
+    std::lock_guard<std::mutex> lock{ s_mutex };
+    s_histograms.clear();
+}
@@ -0,0 +1,65 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ApiLatency.hpp
+
+Abstract:
+- Measures how long the console server takes to service each API call, so that
+    the API layer can be benchmarked, and regressions in it caught, without a
+    live driver. See ReplayDeviceComm.
+- There's a histogram per API, named after the trace name the API sorter gives
+    the call. A call is timed from the moment it's dispatched until it returns,
+    including the wait for the console lock.
+- The histograms are HDR-style: values are bucketed by their order of magnitude
+    first, and then linearly within it. Every value is kept to within a fixed
+    relative error, no matter how large it is, in a fixed amount of space.
+- Measuring is off by default. When it's off, the only cost to an API call is
+    reading a flag.
+--*/
+
+#pragma once
+
+class LatencyHistogram final
+{
+public:
+    LatencyHistogram() noexcept;
+
+    void Record(const std::chrono::nanoseconds latency) noexcept;
+    void Reset() noexcept;
+
+    uint64_t GetCount() const noexcept;
+    std::chrono::nanoseconds GetMax() const noexcept;
+    std::chrono::nanoseconds GetValueAtPercentile(const double percentile) const noexcept;
+
+    static size_t s_BucketOf(const uint64_t value) noexcept;
+    static uint64_t s_HighestValueIn(const size_t bucket) noexcept;
+
+    // Values up to this are counted exactly.
+    static constexpr size_t SubBucketBits = 6;
+    static constexpr size_t SubBucketCount = 1 << SubBucketBits;
+    // Above it, every doubling of the value is split into this many buckets, so
+    // a value is reported at most 1 part in 32 too high.
+    static constexpr size_t SubBucketHalfCount = SubBucketCount / 2;
+    // About 18 minutes in nanoseconds. Anything longer is counted as this.
+    static constexpr size_t MaxValueBits = 40;
+    static constexpr uint64_t MaxValue = (1ull << MaxValueBits) - 1;
+    static constexpr size_t BucketCount = SubBucketCount + (MaxValueBits - SubBucketBits) * SubBucketHalfCount;
+
+private:
+    std::array<uint64_t, BucketCount> _counts;
+    uint64_t _count;
+    uint64_t _max;
+};
+
+class ApiLatency final
+{
+public:
+    static void s_SetEnabled(const bool enabled) noexcept;
+    static bool s_IsEnabled() noexcept;
+
+    static void s_Record(const std::string_view api, const std::chrono::nanoseconds latency) noexcept;
+    static std::map<std::string, LatencyHistogram, std::less<>> s_Snapshot();
+    static void s_Reset() noexcept;
+};
@@ -0,0 +1,349 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "HistoryStore.hpp"
+
+#pragma hdrstop
+
+HistoryStore::HistoryStore(std::filesystem::path path) noexcept :
+    _path{ std::move(path) },
+    _records{ 0 }
+{
+}
+
+// Routine Description:
+// - Finds the log of an app, in the local app data of the user. The directory
+//      is created if it doesn't exist yet. The log itself is created by the
+//      first append.
+// Arguments:
+// - appName - The exe name the history is kept for.
+// Return Value:
+// - The path of the log of the app.
+std::filesystem::path HistoryStore::s_GetPathForApp(const std::wstring_view appName)
+{
+    const auto directory = wil::ExpandEnvironmentStringsW<std::wstring>(L"%LOCALAPPDATA%\\Microsoft\\Console\\History");
+    // The variable isn't set, e.g. for a service. There's nowhere to keep the log.
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_ENVVAR_NOT_FOUND), directory.find(L'%') != std::wstring::npos);
+
+    // App names are matched case insensitively, so the file names are, too.
+    std::wstring fileName{ appName };
+    std::transform(fileName.begin(), fileName.end(), fileName.begin(), [](const wchar_t wch) {
+        if (wch < L' ' || std::wstring_view{ L"\\/:*?\"<>|" }.find(wch) != std::wstring_view::npos)
+        {
+            return L'_';
+        }
+        return gsl::narrow_cast<wchar_t>(::towlower(wch));
+    });
+    THROW_HR_IF(E_INVALIDARG, fileName.empty());
+
+    std::filesystem::create_directories(directory);
+    return std::filesystem::path{ directory } / (fileName + L".history");
+}
+
+// Routine Description:
+// - Reads back the commands that are in the log, oldest first. Commands that
+//      were added before the last Clear aren't returned. A record that was cut
+//      short, because a session went away while appending it, ends the log.
+// Arguments:
+// - <none>
+// Return Value:
+// - The commands. Empty if there's no log yet.
+std::vector<std::wstring> HistoryStore::Load()
+{
+    _records = 0;
+
+    wil::unique_hfile file{ CreateFileW(_path.c_str(),
+                                        GENERIC_READ,
+                                        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                        nullptr,
+                                        OPEN_EXISTING,
+                                        FILE_ATTRIBUTE_NORMAL,
+                                        nullptr) };
+    if (!file)
+    {
+        const auto error = GetLastError();
+        if (error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND)
+        {
+            return {};
+        }
+        THROW_WIN32(error);
+    }
+
+    LARGE_INTEGER size;
+    THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &size));
+    const auto fileSize = gsl::narrow<uint64_t>(size.QuadPart);
+    if (fileSize < sizeof(Magic) || fileSize > MaxLogSize)
+    {
+        return {};
+    }
+
+    wil::unique_handle mapping{ CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr) };
+    THROW_LAST_ERROR_IF(!mapping);
+    wil::unique_mapview_ptr<BYTE> view{ static_cast<BYTE*>(MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0)) };
+    THROW_LAST_ERROR_IF(!view);
+
+    const gsl::span<const BYTE> log{ view.get(), gsl::narrow<ptrdiff_t>(fileSize) };
+
+    uint32_t magic;
+    memcpy(&magic, log.data(), sizeof(magic));
+    if (magic != Magic)
+    {
+        return {};
+    }
+
+    std::vector<std::wstring> commands;
+    auto remaining = log.subspan(sizeof(magic));
+    while (remaining.size() >= gsl::narrow_cast<ptrdiff_t>(sizeof(uint16_t)))
+    {
+        uint16_t length;
+        memcpy(&length, remaining.data(), sizeof(length));
+        remaining = remaining.subspan(sizeof(length));
+
+        const auto bytes = gsl::narrow_cast<ptrdiff_t>(length * sizeof(wchar_t));
+        if (remaining.size() < bytes)
+        {
+            break;
+        }
+
+        if (length == 0)
+        {
+            commands.clear();
+        }
+        else
+        {
+            auto& command = commands.emplace_back(length, UNICODE_NULL);
+            memcpy(command.data(), remaining.data(), bytes);
+        }
+
+        remaining = remaining.subspan(bytes);
+        ++_records;
+    }
+
+    return commands;
+}
+
+// Routine Description:
+// - Adds a command to the end of the log.
+// Arguments:
+// - command - The command. Empty commands aren't kept in the history, and
+//      neither are commands too long to fit a record.
+// Return Value:
+// - <none>
+void HistoryStore::Append(const std::wstring_view command)
+{
+    if (command.empty() || command.size() > UINT16_MAX)
+    {
+        return;
+    }
+
+    _Add(command);
+}
+
+// Routine Description:
+// - Records that the history was emptied. Nothing before this is loaded again.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void HistoryStore::Clear()
+{
+    _Add({});
+}
+
+// Routine Description:
+// - Rewrites the log so that it holds just the given commands. The new log is
+//      written next to the old one and then moved over it.
+// - Appends that are still pending are dropped, the commands hold them already.
+// Arguments:
+// - commands - The commands that are in the history, oldest first.
+// Return Value:
+// - <none>
+void HistoryStore::Compact(const std::deque<std::wstring>& commands)
+{
+    std::vector<BYTE> data(sizeof(Magic));
+    memcpy(data.data(), &Magic, sizeof(Magic));
+
+    size_t count = 0;
+    for (const auto& command : commands)
+    {
+        if (!command.empty() && command.size() <= UINT16_MAX)
+        {
+            s_AddRecord(data, command);
+            ++count;
+        }
+    }
+
+    auto temporary = _path;
+    temporary += L".tmp";
+
+    const std::lock_guard<std::mutex> writeLock{ _writeLock };
+    {
+        const std::lock_guard<std::mutex> pendingLock{ _pendingLock };
+        _pending.clear();
+    }
+
+    // No sharing: if another session is compacting right now, let it finish.
+    wil::unique_hfile file{ CreateFileW(temporary.c_str(),
+                                        GENERIC_WRITE,
+                                        0,
+                                        nullptr,
+                                        CREATE_ALWAYS,
+                                        FILE_ATTRIBUTE_NORMAL,
+                                        nullptr) };
+    THROW_LAST_ERROR_IF(!file);
+
+    // The temporary file is ours now. Don't leave it behind if we can't finish.
+    auto removeTemporary = wil::scope_exit([&]() noexcept {
+        file.reset();
+        LOG_IF_WIN32_BOOL_FALSE(DeleteFileW(temporary.c_str()));
+    });
+
+    DWORD written;
+    THROW_IF_WIN32_BOOL_FALSE(WriteFile(file.get(), data.data(), gsl::narrow<DWORD>(data.size()), &written, nullptr));
+    file.reset();
+
+    THROW_IF_WIN32_BOOL_FALSE(MoveFileExW(temporary.c_str(), _path.c_str(), MOVEFILE_REPLACE_EXISTING));
+    removeTemporary.release();
+    _records = count;
+}
+
+// Routine Description:
+// - Waits until the appends so far have been written to the log.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void HistoryStore::Flush()
+{
+    if (_writeWork)
+    {
+        WaitForThreadpoolWorkCallbacks(_writeWork.get(), FALSE);
+    }
+}
+
+// Routine Description:
+// - Gets how many records are in the log, including the ones that don't
+//      matter anymore. Used to decide when to compact.
+// Arguments:
+// - <none>
+// Return Value:
+// - The number of records appended since the log was loaded or compacted,
+//      plus what it held back then.
+size_t HistoryStore::GetRecordCount() const noexcept
+{
+    return _records;
+}
+
+const std::filesystem::path& HistoryStore::GetPath() const noexcept
+{
+    return _path;
+}
+
+// Routine Description:
+// - Queues a record to be appended to the log. If no write is queued yet,
+//      one is, otherwise the record goes out with the ones before it.
+// Arguments:
+// - command - The command. Empty for a Clear.
+// Return Value:
+// - <none>
+void HistoryStore::_Add(const std::wstring_view command)
+{
+    if (!_writeWork)
+    {
+        _writeWork.reset(CreateThreadpoolWork(&s_WriteCallback, this, nullptr));
+        THROW_LAST_ERROR_IF(!_writeWork);
+    }
+
+    bool queued;
+    {
+        const std::lock_guard<std::mutex> lock{ _pendingLock };
+        queued = !_pending.empty();
+        s_AddRecord(_pending, command);
+    }
+    ++_records;
+
+    if (!queued)
+    {
+        SubmitThreadpoolWork(_writeWork.get());
+    }
+}
+
+// Routine Description:
+// - Appends the pending records to the log in a single write, so that records
+//      of sessions sharing the log don't tear. A new log starts with the header.
+// - Records that fail to be written are dropped.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void HistoryStore::_WritePending()
+{
+    const std::lock_guard<std::mutex> writeLock{ _writeLock };
+
+    std::vector<BYTE> records;
+    {
+        const std::lock_guard<std::mutex> pendingLock{ _pendingLock };
+        records.swap(_pending);
+    }
+
+    if (records.empty())
+    {
+        // A compaction got to them first.
+        return;
+    }
+
+    wil::unique_hfile file{ CreateFileW(_path.c_str(),
+                                        FILE_APPEND_DATA,
+                                        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                        nullptr,
+                                        OPEN_ALWAYS,
+                                        FILE_ATTRIBUTE_NORMAL,
+                                        nullptr) };
+    THROW_LAST_ERROR_IF(!file);
+    const auto created = GetLastError() != ERROR_ALREADY_EXISTS;
+
+    if (created)
+    {
+        records.insert(records.begin(), sizeof(Magic), 0);
+        memcpy(records.data(), &Magic, sizeof(Magic));
+    }
+
+    DWORD written;
+    THROW_IF_WIN32_BOOL_FALSE(WriteFile(file.get(), records.data(), gsl::narrow<DWORD>(records.size()), &written, nullptr));
+}
+
+// Routine Description:
+// - Writes the pending records of a store on the threadpool.
+// Arguments:
+// - instance - Unused.
+// - context - The store.
+// - work - Unused.
+// Return Value:
+// - <none>
+void CALLBACK HistoryStore::s_WriteCallback(PTP_CALLBACK_INSTANCE /*instance*/, PVOID context, PTP_WORK /*work*/) noexcept
+{
+    try
+    {
+        static_cast<HistoryStore*>(context)->_WritePending();
+    }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Serializes a record: the length of the command in characters, followed by
+//      the characters. A record of length 0 marks a Clear.
+// Arguments:
+// - records - Where to add the record.
+// - command - The command.
+// Return Value:
+// - <none>
+void HistoryStore::s_AddRecord(std::vector<BYTE>& records, const std::wstring_view command)
+{
+    const auto length = gsl::narrow<uint16_t>(command.size());
+    const auto offset = records.size();
+    records.resize(offset + sizeof(length) + command.size() * sizeof(wchar_t));
+    memcpy(records.data() + offset, &length, sizeof(length));
+    memcpy(records.data() + offset + sizeof(length), command.data(), command.size() * sizeof(wchar_t));
+}
@@ -0,0 +1,74 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- HistoryStore.hpp
+
+Abstract:
+- Keeps the command history of an app on disk, so that it survives the console
+    session. This is opt-in, see CONSOLE_REGISTRY_HISTORYPERSIST.
+- Each app has a log of its own. The log is only ever appended to: once for
+    every command that's added to the history, and once whenever the history is
+    emptied. It's read back through a read-only mapping of the file the first
+    time a history is allocated for that app.
+- Appends are written out by a threadpool callback, so that adding a command
+    never waits for the disk while the console is locked. Appends that pile up
+    while a write is in flight go out together.
+- Appends are cheap, but the log keeps growing, so the history rewrites it from
+    scratch every now and then. A rewrite goes through a temporary file that
+    replaces the log, so a session that ends half way through never leaves a
+    damaged log behind.
+- Sessions that run the same app at the same time share the log. Their appends
+    interleave. If they both rewrite it, the last one wins.
+- All methods throw on failure. Losing the persisted history should never get
+    in the way of the console, so callers log and carry on. Writing appended
+    records fails on the threadpool, where it's only logged.
+--*/
+
+#pragma once
+
+class HistoryStore final
+{
+public:
+    explicit HistoryStore(std::filesystem::path path) noexcept;
+
+    static std::filesystem::path s_GetPathForApp(const std::wstring_view appName);
+
+    std::vector<std::wstring> Load();
+    void Append(const std::wstring_view command);
+    void Clear();
+    void Compact(const std::deque<std::wstring>& commands);
+    void Flush();
+
+    size_t GetRecordCount() const noexcept;
+    const std::filesystem::path& GetPath() const noexcept;
+
+private:
+    // Marks a file as a history log.
+    static constexpr uint32_t Magic = 0x31484343; // "CCH1"
+    // A log larger than this is ignored rather than mapped.
+    static constexpr uint64_t MaxLogSize = 64 * 1024 * 1024;
+
+    std::filesystem::path _path;
+    // How many records the log holds, as far as this session knows.
+    // This counts the records that are still pending, too.
+    size_t _records;
+
+    // Guards the records that were appended, but aren't in the log yet.
+    // It's never held while the disk is busy.
+    std::mutex _pendingLock;
+    std::vector<BYTE> _pending;
+    // Held while the log is written, so that a compaction and the appends
+    // that went before it don't get mixed up.
+    std::mutex _writeLock;
+    // Writes the pending records. It's declared last, so that it's waited
+    // for before anything it uses goes away.
+    wil::unique_threadpool_work _writeWork;
+
+    void _Add(const std::wstring_view command);
+    void _WritePending();
+
+    static void CALLBACK s_WriteCallback(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_WORK work) noexcept;
+    static void s_AddRecord(std::vector<BYTE>& records, const std::wstring_view command);
+};
@@ -232,7 +232,10 @@ bool VtIo::IsUsingVt() const
         try
         {
             g.pRender->AddRenderEngine(_pVtRenderEngine.get());
-            g.getConsoleInformation().GetActiveOutputBuffer().SetTerminalConnection(_pVtRenderEngine.get());
+
+            // Strings are passed through to the terminal by way of us,
+            // so that they don't land in the middle of a frame.
+            g.getConsoleInformation().GetActiveOutputBuffer().SetTerminalConnection(this);
         }
         CATCH_RETURN();
     }
@@ -249,7 +252,11 @@ bool VtIo::IsUsingVt() const
     //      (so they can't get the DSR) or they can't write the response to us.
     if (_lookingForCursorPosition && _pVtRenderEngine && _pVtInputThread)
     {
-        LOG_IF_FAILED(_pVtRenderEngine->RequestCursor());
+        {
+            const auto lock = _LockRenderEngine();
+            LOG_IF_FAILED(_pVtRenderEngine->RequestCursor());
+        }
+
         while (_lookingForCursorPosition)
         {
             _pVtInputThread->DoReadInput(false);
@@ -317,6 +324,7 @@ bool VtIo::IsUsingVt() const
 [[nodiscard]] HRESULT VtIo::SuppressResizeRepaint()
 {
     HRESULT hr = S_OK;
+    const auto lock = _LockRenderEngine();
     if (_pVtRenderEngine)
     {
         hr = _pVtRenderEngine->SuppressResizeRepaint();
@@ -337,6 +345,7 @@ bool VtIo::IsUsingVt() const
     HRESULT hr = S_OK;
     if (_lookingForCursorPosition)
     {
+        const auto lock = _LockRenderEngine();
         if (_pVtRenderEngine)
         {
             hr = _pVtRenderEngine->InheritCursor(coordCursor);
@@ -412,6 +421,7 @@ void VtIo::_ShutdownIfNeeded()
 // - <none>
 void VtIo::BeginResize()
 {
+    const auto lock = _LockRenderEngine();
     if (_pVtRenderEngine)
     {
         _pVtRenderEngine->BeginResizeRequest();
@@ -428,12 +438,60 @@ void VtIo::BeginResize()
 // - <none>
 void VtIo::EndResize()
 {
+    const auto lock = _LockRenderEngine();
     if (_pVtRenderEngine)
     {
         _pVtRenderEngine->EndResizeRequest();
     }
 }
 
+// Method Description:
+// - Passes a string that the console didn't understand through to the
+//      terminal. It's added to the output of the VT renderer, which mustn't be
+//      touched while it paints a frame, so this waits for that frame if needed.
+// Arguments:
+// - str - The UTF-8 string to write.
+// Return Value:
+// - S_OK, or an appropriate HRESULT if the write failed.
+[[nodiscard]] HRESULT VtIo::WriteTerminalUtf8(const std::string_view str)
+{
+    const auto lock = _LockRenderEngine();
+    RETURN_HR_IF(E_NOT_VALID_STATE, !_pVtRenderEngine);
+    return _pVtRenderEngine->WriteTerminalUtf8(str);
+}
+
+// Method Description:
+// - Passes a string that the console didn't understand through to the
+//      terminal. See WriteTerminalUtf8.
+// Arguments:
+// - wstr - The string to write.
+// Return Value:
+// - S_OK, or an appropriate HRESULT if the write failed.
+[[nodiscard]] HRESULT VtIo::WriteTerminalW(const std::wstring_view wstr)
+{
+    const auto lock = _LockRenderEngine();
+    RETURN_HR_IF(E_NOT_VALID_STATE, !_pVtRenderEngine);
+    return _pVtRenderEngine->WriteTerminalW(wstr);
+}
+
+// Method Description:
+// - Keeps the renderer from painting a frame while the VT renderer is changed.
+//      The renderer paints without holding the console lock, so holding that
+//      isn't enough.
+// Arguments:
+// - <none>
+// Return Value:
+// - The lock, or an empty one if there's no renderer, like in some tests.
+std::unique_lock<std::mutex> VtIo::_LockRenderEngine() const
+{
+    auto& g = ServiceLocator::LocateGlobals();
+    if (!g.pRender)
+    {
+        return {};
+    }
+    return g.pRender->LockForEngineChanges();
+}
+
 #ifdef UNIT_TESTING
 // Method Description:
 // - This is a test helper method. It can be used to trick VtIo into responding
@@ -5,6 +5,7 @@
 
 #include "..\inc\VtIoModes.hpp"
 #include "..\inc\ITerminalOwner.hpp"
+#include "..\inc\ITerminalOutputConnection.hpp"
 #include "..\renderer\vt\vtrenderer.hpp"
 #include "VtInputThread.hpp"
 #include "PtySignalInputThread.hpp"
@@ -13,7 +14,7 @@ class ConsoleArguments;
 
 namespace Microsoft::Console::VirtualTerminal
 {
-    class VtIo : public Microsoft::Console::ITerminalOwner
+    class VtIo : public Microsoft::Console::ITerminalOwner, public Microsoft::Console::ITerminalOutputConnection
     {
     public:
         VtIo();
@@ -36,6 +37,9 @@ namespace Microsoft::Console::VirtualTerminal
         void CloseInput() override;
         void CloseOutput() override;
 
+        [[nodiscard]] HRESULT WriteTerminalUtf8(const std::string_view str) override;
+        [[nodiscard]] HRESULT WriteTerminalW(const std::wstring_view wstr) override;
+
         void BeginResize();
         void EndResize();
 
@@ -69,6 +73,8 @@ namespace Microsoft::Console::VirtualTerminal
 
         void _ShutdownIfNeeded();
 
+        std::unique_lock<std::mutex> _LockRenderEngine() const;
+
 #ifdef UNIT_TESTING
         friend class VtIoTests;
 #endif
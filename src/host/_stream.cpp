@@ -347,6 +347,11 @@ constexpr unsigned int LOCAL_BUFFER_SIZE = 100;
     // Must not adjust cursor here. It has to stay on for many write scenarios. Consumers should call for the
     // cursor to be turned off if they want that.
 
+    // We do defer redrawing it though. The cursor moves once for every run of text (and every wrap), but
+    // only needs to be redrawn where it started and where it ends up.
+    cursor.StartDeferDrawing();
+    auto endDeferDrawing = wil::scope_exit([&]() noexcept { cursor.EndDeferDrawing(); });
+
     const TextAttribute Attributes = screenInfo.GetAttributes();
     const size_t BufferSize = *pcb;
     *pcb = 0;
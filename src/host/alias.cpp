@@ -24,33 +24,17 @@
 
 using Microsoft::Console::Interactivity::ServiceLocator;
 
-struct case_insensitive_hash
+// The aliases of one exe, by case folded source.
+struct AliasExe
 {
-    std::size_t operator()(const std::wstring& key) const
-    {
-        std::wstring lower(key);
-        std::transform(lower.begin(), lower.end(), lower.begin(), ::towlower);
-        std::hash<std::wstring> hash;
-        return hash(lower);
-    }
+    // The exe name as it was given, to hand back by GetConsoleAliasExes.
+    std::wstring Name;
+    std::unordered_map<std::wstring, Alias::CompiledTarget> Aliases;
 };
 
-struct case_insensitive_equality
-{
-    bool operator()(const std::wstring& lhs, const std::wstring& rhs) const
-    {
-        return 0 == _wcsicmp(lhs.data(), rhs.data());
-    }
-};
-
-std::unordered_map<std::wstring,
-                   std::unordered_map<std::wstring,
-                                      std::wstring,
-                                      case_insensitive_hash,
-                                      case_insensitive_equality>,
-                   case_insensitive_hash,
-                   case_insensitive_equality>
-    g_aliasData;
+// Exe names and sources are case folded before they're stored or looked up.
+// See Alias::s_Fold.
+std::unordered_map<std::wstring, AliasExe> g_aliasData;
 
 // Routine Description:
 // - Adds a command line alias to the global set.
@@ -98,27 +82,7 @@ std::unordered_map<std::wstring,
 
     try
     {
-        std::wstring exeNameString(exeName);
-        std::wstring sourceString(source);
-        std::wstring targetString(target);
-
-        std::transform(exeNameString.begin(), exeNameString.end(), exeNameString.begin(), towlower);
-        std::transform(sourceString.begin(), sourceString.end(), sourceString.begin(), towlower);
-
-        if (targetString.size() == 0)
-        {
-            // Only try to dig in and erase if the exeName exists.
-            auto exeData = g_aliasData.find(exeNameString);
-            if (exeData != g_aliasData.end())
-            {
-                g_aliasData[exeNameString].erase(sourceString);
-            }
-        }
-        else
-        {
-            // Map will auto-create each level as necessary
-            g_aliasData[exeNameString][sourceString] = targetString;
-        }
+        Alias::s_SetAlias(exeName, source, target);
     }
     CATCH_RETURN();
 
@@ -152,17 +116,10 @@ std::unordered_map<std::wstring,
         target.value().at(0) = UNICODE_NULL;
     }
 
-    std::wstring exeNameString(exeName);
-    std::wstring sourceString(source);
-
     // For compatibility, return ERROR_GEN_FAILURE for any result where the alias can't be found.
-    // We use .find for the iterators then dereference to search without creating entries.
-    const auto exeIter = g_aliasData.find(exeNameString);
-    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), exeIter == g_aliasData.end());
-    const auto exeData = exeIter->second;
-    const auto sourceIter = exeData.find(sourceString);
-    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), sourceIter == exeData.end());
-    const auto targetString = sourceIter->second;
+    const auto alias = Alias::s_FindAlias(exeName, source);
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), alias == nullptr);
+    const auto& targetString = alias->Text;
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), targetString.size() == 0);
 
     // TargetLength is a byte count, convert to characters.
@@ -318,8 +275,6 @@ static std::wstring aliasesSeparator(L"=");
 
     try
     {
-        const std::wstring exeNameString(exeName);
-
         size_t cchNeeded = 0;
 
         // Each of the aliases will be made up of the source, a separator, the target, then a null character.
@@ -333,21 +288,21 @@ static std::wstring aliasesSeparator(L"=");
         }
 
         // Find without creating.
-        auto exeIter = g_aliasData.find(exeNameString);
+        auto exeIter = g_aliasData.find(Alias::s_Fold(exeName));
         if (exeIter != g_aliasData.end())
         {
-            auto list = exeIter->second;
-            for (auto& pair : list)
+            const auto& list = exeIter->second.Aliases;
+            for (const auto& pair : list)
             {
                 // Alias stores lengths in bytes.
-                size_t cchSource = pair.first.size();
-                size_t cchTarget = pair.second.size();
+                size_t cchSource = pair.second.Source.size();
+                size_t cchTarget = pair.second.Text.size();
 
                 // If we're counting how much multibyte space will be needed, trial convert the source and target strings before we add.
                 if (!countInUnicode)
                 {
-                    cchSource = GetALengthFromW(codepage, pair.first);
-                    cchTarget = GetALengthFromW(codepage, pair.second);
+                    cchSource = GetALengthFromW(codepage, pair.second.Source);
+                    cchTarget = GetALengthFromW(codepage, pair.second.Text);
                 }
 
                 // Accumulate all sizes to the final string count.
@@ -416,6 +371,77 @@ static std::wstring aliasesSeparator(L"=");
     CATCH_RETURN();
 }
 
+// Routine Description:
+// - Case folds an exe name or an alias source the way they're stored.
+// Arguments:
+// - str - The name to fold
+// Return Value:
+// - The folded name
+std::wstring Alias::s_Fold(const std::wstring_view str)
+{
+    std::wstring folded(str);
+    std::transform(folded.begin(), folded.end(), folded.begin(), towlower);
+    return folded;
+}
+
+// Routine Description:
+// - Adds an alias to the global set, replacing any with the same source, or removes it.
+// - The macros in the target are parsed here, so that they don't have to be on every match.
+// Arguments:
+// - exeName - The client EXE application to whom this alias will apply
+// - source - The shorthand/alias
+// - target - The destination/expansion. Empty to remove the alias.
+void Alias::s_SetAlias(const std::wstring_view exeName,
+                       const std::wstring_view source,
+                       const std::wstring_view target)
+{
+    auto exeNameString = s_Fold(exeName);
+    auto sourceString = s_Fold(source);
+
+    if (target.empty())
+    {
+        // Only try to dig in and erase if the exeName exists.
+        const auto exeData = g_aliasData.find(exeNameString);
+        if (exeData != g_aliasData.end())
+        {
+            exeData->second.Aliases.erase(sourceString);
+        }
+    }
+    else
+    {
+        auto compiled = s_CompileTarget(target);
+        compiled.Source = source;
+
+        // Map will auto-create each level as necessary.
+        // The names are handed back in the case they were last given in.
+        auto& exeData = g_aliasData[std::move(exeNameString)];
+        exeData.Name = exeName;
+        exeData.Aliases.insert_or_assign(std::move(sourceString), std::move(compiled));
+    }
+}
+
+// Routine Description:
+// - Finds an alias in the global set.
+// Arguments:
+// - exeName - The client EXE application whose set we should check
+// - source - The shorthand/alias, in any case
+// Return Value:
+// - The target, or nullptr if there is no such alias. Valid until the set changes.
+const Alias::CompiledTarget* Alias::s_FindAlias(const std::wstring_view exeName,
+                                                const std::wstring_view source)
+{
+    // Find without creating.
+    const auto exeIter = g_aliasData.find(s_Fold(exeName));
+    if (exeIter == g_aliasData.end())
+    {
+        return nullptr;
+    }
+
+    const auto& exeData = exeIter->second.Aliases;
+    const auto sourceIter = exeData.find(s_Fold(source));
+    return sourceIter == exeData.end() ? nullptr : &sourceIter->second;
+}
+
 // Routine Description:
 // - Clears all aliases on CMD.exe.
 void Alias::s_ClearCmdExeAliases()
@@ -424,7 +450,7 @@ void Alias::s_ClearCmdExeAliases()
     auto exeIter = g_aliasData.find(L"cmd.exe");
     if (exeIter != g_aliasData.end())
     {
-        exeIter->second.clear();
+        exeIter->second.Aliases.clear();
     }
 }
 
@@ -454,8 +480,6 @@ void Alias::s_ClearCmdExeAliases()
         aliasBuffer.value().at(0) = UNICODE_NULL;
     }
 
-    std::wstring exeNameString(exeName);
-
     LPWSTR AliasesBufferPtrW = aliasBuffer.has_value() ? aliasBuffer.value().data() : nullptr;
     size_t cchTotalLength = 0; // accumulate the characters we need/have copied as we walk the list
 
@@ -464,15 +488,15 @@ void Alias::s_ClearCmdExeAliases()
     size_t const cchNull = 1;
 
     // Find without creating.
-    auto exeIter = g_aliasData.find(exeNameString);
+    auto exeIter = g_aliasData.find(Alias::s_Fold(exeName));
     if (exeIter != g_aliasData.end())
     {
-        auto list = exeIter->second;
-        for (auto& pair : list)
+        const auto& list = exeIter->second.Aliases;
+        for (const auto& pair : list)
         {
             // Alias stores lengths in bytes.
-            size_t const cchSource = pair.first.size();
-            size_t const cchTarget = pair.second.size();
+            size_t const cchSource = pair.second.Source.size();
+            size_t const cchTarget = pair.second.Text.size();
 
             // Add up how many characters we will need for the full alias data.
             size_t cchNeeded = 0;
@@ -494,7 +518,7 @@ void Alias::s_ClearCmdExeAliases()
                 size_t cchAliasBufferRemaining;
                 RETURN_IF_FAILED(SizeTSub(aliasBuffer.value().size(), cchTotalLength, &cchAliasBufferRemaining));
 
-                RETURN_IF_FAILED(StringCchCopyNW(AliasesBufferPtrW, cchAliasBufferRemaining, pair.first.data(), cchSource));
+                RETURN_IF_FAILED(StringCchCopyNW(AliasesBufferPtrW, cchAliasBufferRemaining, pair.second.Source.data(), cchSource));
                 RETURN_IF_FAILED(SizeTSub(cchAliasBufferRemaining, cchSource, &cchAliasBufferRemaining));
                 AliasesBufferPtrW += cchSource;
 
@@ -502,7 +526,7 @@ void Alias::s_ClearCmdExeAliases()
                 RETURN_IF_FAILED(SizeTSub(cchAliasBufferRemaining, aliasesSeparator.size(), &cchAliasBufferRemaining));
                 AliasesBufferPtrW += aliasesSeparator.size();
 
-                RETURN_IF_FAILED(StringCchCopyNW(AliasesBufferPtrW, cchAliasBufferRemaining, pair.second.data(), cchTarget));
+                RETURN_IF_FAILED(StringCchCopyNW(AliasesBufferPtrW, cchAliasBufferRemaining, pair.second.Text.data(), cchTarget));
                 RETURN_IF_FAILED(SizeTSub(cchAliasBufferRemaining, cchTarget, &cchAliasBufferRemaining));
                 AliasesBufferPtrW += cchTarget;
 
@@ -630,12 +654,12 @@ void Alias::s_ClearCmdExeAliases()
 
     for (auto& pair : g_aliasData)
     {
-        size_t cchExe = pair.first.size();
+        size_t cchExe = pair.second.Name.size();
 
         // If we're counting how much multibyte space will be needed, trial convert the exe string before we add.
         if (!countInUnicode)
         {
-            cchExe = GetALengthFromW(codepage, pair.first);
+            cchExe = GetALengthFromW(codepage, pair.second.Name);
         }
 
         // Accumulate to total
@@ -709,7 +733,7 @@ void Alias::s_ClearCmdExeAliases()
     for (auto& pair : g_aliasData)
     {
         // AliasList stores length in bytes. Add 1 for null terminator.
-        size_t const cchExe = pair.first.size();
+        size_t const cchExe = pair.second.Name.size();
 
         size_t cchNeeded;
         RETURN_IF_FAILED(SizeTAdd(cchExe, cchNull, &cchNeeded));
@@ -727,7 +751,7 @@ void Alias::s_ClearCmdExeAliases()
             size_t cchRemaining;
             RETURN_IF_FAILED(SizeTSub(aliasExesBuffer.value().size(), cchTotalLength, &cchRemaining));
 
-            RETURN_IF_FAILED(StringCchCopyNW(AliasExesBufferPtrW, cchRemaining, pair.first.data(), cchExe));
+            RETURN_IF_FAILED(StringCchCopyNW(AliasExesBufferPtrW, cchRemaining, pair.second.Name.data(), cchExe));
             AliasExesBufferPtrW += cchNeeded;
         }
 
@@ -850,18 +874,18 @@ void Alias::s_TrimTrailingCrLf(std::wstring& str)
 // Arguments:
 // - str - String to tokenize
 // Return Value:
-// - Collection of tokenized strings
-std::deque<std::wstring> Alias::s_Tokenize(const std::wstring& str)
+// - Collection of tokenized strings, as views into str
+Alias::Tokens Alias::s_Tokenize(const std::wstring_view str)
 {
-    std::deque<std::wstring> result;
+    Tokens result;
 
     size_t prevIndex = 0;
     auto spaceIndex = str.find(L' ');
-    while (std::wstring::npos != spaceIndex)
+    while (std::wstring_view::npos != spaceIndex)
     {
         const auto length = spaceIndex - prevIndex;
 
-        result.emplace_back(str.substr(prevIndex, length));
+        result.push_back(str.substr(prevIndex, length));
 
         spaceIndex++;
         prevIndex = spaceIndex;
@@ -870,7 +894,7 @@ std::deque<std::wstring> Alias::s_Tokenize(const std::wstring& str)
     }
 
     // Place the final one into the set.
-    result.emplace_back(str.substr(prevIndex));
+    result.push_back(str.substr(prevIndex));
 
     return result;
 }
@@ -882,11 +906,11 @@ std::deque<std::wstring> Alias::s_Tokenize(const std::wstring& str)
 // - str - String to split into just args
 // Return Value:
 // - Only the arguments part of the string or empty if there are no arguments.
-std::wstring Alias::s_GetArgString(const std::wstring& str)
+std::wstring_view Alias::s_GetArgString(const std::wstring_view str)
 {
-    std::wstring result;
+    std::wstring_view result;
     auto firstSpace = str.find_first_of(L' ');
-    if (std::wstring::npos != firstSpace)
+    if (std::wstring_view::npos != firstSpace)
     {
         firstSpace++;
         if (firstSpace < str.size())
@@ -910,7 +934,7 @@ std::wstring Alias::s_GetArgString(const std::wstring& str)
 // - False if the given character doesn't match this macro.
 bool Alias::s_TryReplaceNumberedArgMacro(const wchar_t ch,
                                          std::wstring& appendToStr,
-                                         const std::deque<std::wstring>& tokens)
+                                         const Tokens& tokens)
 {
     if (ch >= L'1' && ch <= L'9')
     {
@@ -940,7 +964,7 @@ bool Alias::s_TryReplaceNumberedArgMacro(const wchar_t ch,
 // - False if the given character doesn't match this macro.
 bool Alias::s_TryReplaceWildcardArgMacro(const wchar_t ch,
                                          std::wstring& appendToStr,
-                                         const std::wstring fullArgString)
+                                         const std::wstring_view fullArgString)
 {
     if (L'*' == ch)
     {
@@ -1052,36 +1076,40 @@ void Alias::s_AppendCrLf(std::wstring& appendToStr,
 }
 
 // Routine Description:
-// - Searches through the given string for macros and replaces them
-//   with the matching action
+// - Parses the macros of an alias target. Macros that come out the same no matter
+//   the command line are replaced right away. Argument macros are noted down, to
+//   be replaced with the arguments of each command line the alias matches.
 // Arguments:
-// - str - On input, the string to search. On output, the string is replaced.
-// - tokens - The tokenized command line input. 0 is the alias, 1-N are arguments.
-// - fullArgString - Shorthand to 1-N argument string in case of wildcard match.
+// - target - The target as it was given
 // Return Value:
-// - The number of commands in the final string (line feeds, CRLFs)
-size_t Alias::s_ReplaceMacros(std::wstring& str,
-                              const std::deque<std::wstring>& tokens,
-                              const std::wstring& fullArgString)
+// - The parsed target. See s_ExpandTarget.
+Alias::CompiledTarget Alias::s_CompileTarget(const std::wstring_view target)
 {
-    size_t lineCount = 0;
-    std::wstring finalText;
+    CompiledTarget compiled;
+    compiled.Text = target;
+    compiled.LineCount = 0;
+    compiled.NeedsTokens = false;
+
+    auto& finalText = compiled.Literals;
 
     // The target text may contain substitution macros indicated by $.
     // Walk through and substitute them as appropriate.
-    for (auto ch = str.cbegin(); ch < str.cend(); ch++)
+    for (auto ch = target.cbegin(); ch < target.cend(); ch++)
     {
         if (L'$' == *ch)
         {
             // Attempt to read ahead by one character.
             const auto chNext = ch + 1;
 
-            if (chNext < str.cend())
+            if (chNext < target.cend())
             {
-                auto isProcessed = s_TryReplaceNumberedArgMacro(*chNext, finalText, tokens);
-                if (!isProcessed)
+                auto isProcessed = false;
+                if ((*chNext >= L'1' && *chNext <= L'9') || L'*' == *chNext)
                 {
-                    isProcessed = s_TryReplaceWildcardArgMacro(*chNext, finalText, fullArgString);
+                    // The arguments aren't known until the alias is used.
+                    compiled.Arguments.emplace_back(finalText.size(), *chNext);
+                    compiled.NeedsTokens = compiled.NeedsTokens || L'*' != *chNext;
+                    isProcessed = true;
                 }
                 if (!isProcessed)
                 {
@@ -1097,7 +1125,7 @@ size_t Alias::s_ReplaceMacros(std::wstring& str,
                 }
                 if (!isProcessed)
                 {
-                    isProcessed = s_TryReplaceNextCommandMacro(*chNext, finalText, lineCount);
+                    isProcessed = s_TryReplaceNextCommandMacro(*chNext, finalText, compiled.LineCount);
                 }
                 if (!isProcessed)
                 {
@@ -1124,11 +1152,43 @@ size_t Alias::s_ReplaceMacros(std::wstring& str,
     }
 
     // We always terminate with a CRLF to symbolize end of command.
-    s_AppendCrLf(finalText, lineCount);
+    s_AppendCrLf(finalText, compiled.LineCount);
 
-    // Give back the final text and count.
-    str.swap(finalText);
-    return lineCount;
+    return compiled;
+}
+
+// Routine Description:
+// - Expands a parsed alias target for the given command line.
+// Arguments:
+// - target - The parsed target
+// - commandLine - The command line the alias matched, without leading spaces or trailing CRLF.
+// Return Value:
+// - The expansion. It ends in a CRLF.
+std::wstring Alias::s_ExpandTarget(const CompiledTarget& target,
+                                   const std::wstring_view commandLine)
+{
+    // Only split the command line if a macro needs it.
+    // $* is shorthand for the string of all parameters.
+    const auto tokens = target.NeedsTokens ? s_Tokenize(commandLine) : Tokens{};
+    const auto allParams = s_GetArgString(commandLine);
+
+    std::wstring finalText;
+    finalText.reserve(target.Literals.size() + commandLine.size());
+
+    size_t copied = 0;
+    for (const auto& [offset, macro] : target.Arguments)
+    {
+        finalText.append(target.Literals, copied, offset - copied);
+        copied = offset;
+
+        if (!s_TryReplaceNumberedArgMacro(macro, finalText, tokens))
+        {
+            s_TryReplaceWildcardArgMacro(macro, finalText, allParams);
+        }
+    }
+    finalText.append(target.Literals, copied, std::wstring::npos);
+
+    return finalText;
 }
 
 // Routine Description:
@@ -1154,53 +1214,21 @@ std::wstring Alias::s_MatchAndCopyAlias(const std::wstring& sourceText,
     // Trim leading spaces off of sourceCopy if it has any.
     s_TrimLeadingSpaces(sourceCopy);
 
-    // Check if we have an EXE in the list that matches the request first.
-    auto exeIter = g_aliasData.find(exeName);
-    if (exeIter == g_aliasData.end())
-    {
-        // We found no data for this exe. Give back an empty string.
-        return std::wstring();
-    }
-
-    auto exeList = exeIter->second;
-    if (exeList.size() == 0)
-    {
-        // If there's no match, give back an empty string.
-        return std::wstring();
-    }
-
-    // Tokenize the text by spaces
-    const auto tokens = s_Tokenize(sourceCopy);
-
-    // If there are no tokens, return an empty string
-    if (tokens.size() == 0)
-    {
-        return std::wstring();
-    }
+    // The alias is everything up to the first space.
+    const std::wstring_view commandLine{ sourceCopy };
+    const auto alias = commandLine.substr(0, commandLine.find(L' '));
 
     // Find alias. If there isn't one, return an empty string
-    const auto alias = tokens.front();
-    const auto aliasIter = exeList.find(alias);
-    if (aliasIter == exeList.end())
+    const auto target = s_FindAlias(exeName, alias);
+    if (target == nullptr)
     {
         // We found no alias pair with this name. Give back an empty string.
         return std::wstring();
     }
 
-    const auto target = aliasIter->second;
-    if (target.size() == 0)
-    {
-        return std::wstring();
-    }
-
-    // Get the string of all parameters as a shorthand for $* later.
-    const auto allParams = s_GetArgString(sourceCopy);
-
     // The final text will be the target but with macros replaced.
-    std::wstring finalText(target);
-    lineCount = s_ReplaceMacros(finalText, tokens, allParams);
-
-    return finalText;
+    lineCount = target->LineCount;
+    return s_ExpandTarget(*target, commandLine);
 }
 
 // Routine Description:
@@ -1257,11 +1285,11 @@ void Alias::s_MatchAndCopyAliasLegacy(_In_reads_bytes_(cbSource) PWCHAR pwchSour
 }
 
 #ifdef UNIT_TESTING
-void Alias::s_TestAddAlias(std::wstring& exe,
-                           std::wstring& alias,
-                           std::wstring& target)
+void Alias::s_TestAddAlias(const std::wstring& exe,
+                           const std::wstring& alias,
+                           const std::wstring& target)
 {
-    g_aliasData[exe][alias] = target;
+    s_SetAlias(exe, alias, target);
 }
 
 void Alias::s_TestClearAliases()
@@ -8,12 +8,44 @@ Module Name:
 Abstract:
 - Encapsulates the cmdline functions and structures specifically related to
         command alias functionality.
+- Aliases are looked up on every line a cooked read returns, so exe names and
+        sources are stored case folded, and targets are stored with their
+        macros already parsed. Matching a line is one hash lookup and a copy.
 --*/
 #pragma once
 
 class Alias
 {
 public:
+    // The command line split at spaces. 0 is the alias, 1-N are the arguments.
+    using Tokens = til::small_vector<std::wstring_view, 10>;
+
+    // A target, with its macros parsed when the alias was set.
+    struct CompiledTarget
+    {
+        // The source as it was given, to hand back by GetConsoleAliases.
+        // It's only looked up case folded.
+        std::wstring Source;
+        // The target as it was given, to hand back by GetConsoleAlias(es).
+        std::wstring Text;
+        // The expansion with every macro that doesn't depend on the command line
+        // replaced already, including the CRLF that ends it.
+        std::wstring Literals;
+        // Where in Literals an argument macro goes, and which one ($1-$9 or $*), in order.
+        std::vector<std::pair<size_t, wchar_t>> Arguments;
+        // The number of commands in the expansion.
+        size_t LineCount;
+        // Whether any of the argument macros is numbered.
+        bool NeedsTokens;
+    };
+
+    static std::wstring s_Fold(const std::wstring_view str);
+    static void s_SetAlias(const std::wstring_view exeName,
+                           const std::wstring_view source,
+                           const std::wstring_view target);
+    static const CompiledTarget* s_FindAlias(const std::wstring_view exeName,
+                                             const std::wstring_view source);
+
     static void s_ClearCmdExeAliases();
 
     static void s_MatchAndCopyAliasLegacy(_In_reads_bytes_(cbSource) PWCHAR pwchSource,
@@ -31,18 +63,18 @@ public:
 private:
     static void s_TrimLeadingSpaces(std::wstring& str);
     static void s_TrimTrailingCrLf(std::wstring& str);
-    static std::deque<std::wstring> s_Tokenize(const std::wstring& str);
-    static std::wstring s_GetArgString(const std::wstring& str);
-    static size_t s_ReplaceMacros(std::wstring& str,
-                                  const std::deque<std::wstring>& tokens,
-                                  const std::wstring& fullArgString);
+    static Tokens s_Tokenize(const std::wstring_view str);
+    static std::wstring_view s_GetArgString(const std::wstring_view str);
+    static CompiledTarget s_CompileTarget(const std::wstring_view target);
+    static std::wstring s_ExpandTarget(const CompiledTarget& target,
+                                       const std::wstring_view commandLine);
 
     static bool s_TryReplaceNumberedArgMacro(const wchar_t ch,
                                              std::wstring& appendToStr,
-                                             const std::deque<std::wstring>& tokens);
+                                             const Tokens& tokens);
     static bool s_TryReplaceWildcardArgMacro(const wchar_t ch,
                                              std::wstring& appendToStr,
-                                             const std::wstring fullArgString);
+                                             const std::wstring_view fullArgString);
 
     static bool s_TryReplaceInputRedirMacro(const wchar_t ch,
                                             std::wstring& appendToStr);
@@ -59,9 +91,9 @@ private:
                              size_t& lineCount);
 
 #ifdef UNIT_TESTING
-    static void s_TestAddAlias(std::wstring& exe,
-                               std::wstring& alias,
-                               std::wstring& target);
+    static void s_TestAddAlias(const std::wstring& exe,
+                               const std::wstring& alias,
+                               const std::wstring& target);
 
     static void s_TestClearAliases();
 
@@ -41,42 +41,118 @@ CONSOLE_INFORMATION::CONSOLE_INFORMATION() :
 {
     ZeroMemory((void*)&CPInfo, sizeof(CPInfo));
     ZeroMemory((void*)&OutputCPInfo, sizeof(OutputCPInfo));
-    InitializeCriticalSection(&_csConsoleLock);
+    InitializeSRWLock(&_consoleLock);
+    _exclusiveOwner = 0;
+    _exclusiveRecursion = 0;
 }
 
 CONSOLE_INFORMATION::~CONSOLE_INFORMATION()
 {
-    DeleteCriticalSection(&_csConsoleLock);
 }
 
+thread_local ULONG CONSOLE_INFORMATION::s_sharedRecursion = 0;
+
+// Routine Description:
+// - Returns true if the current thread holds the lock, either exclusively or shared.
 bool CONSOLE_INFORMATION::IsConsoleLocked() const
 {
-    // The critical section structure's OwningThread field contains the ThreadId despite having the HANDLE type.
-    // This requires us to hard cast the ID to compare.
-    return _csConsoleLock.OwningThread == (HANDLE)GetCurrentThreadId();
+    return _exclusiveOwner == GetCurrentThreadId() || s_sharedRecursion != 0;
 }
 
+// Routine Description:
+// - Takes the lock exclusively. The lock is recursive: a thread that already
+//      holds it exclusively can take it again.
+// - A thread that holds the lock shared can't take it exclusively. Everything
+//      that runs under a shared lock has to stick to reading.
 #pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
 void CONSOLE_INFORMATION::LockConsole()
 {
-    EnterCriticalSection(&_csConsoleLock);
+    const auto thread = GetCurrentThreadId();
+    if (_exclusiveOwner == thread)
+    {
+        ++_exclusiveRecursion;
+        return;
+    }
+
+    FAIL_FAST_IF(s_sharedRecursion != 0);
+    AcquireSRWLockExclusive(&_consoleLock);
+    _exclusiveOwner = thread;
+    _exclusiveRecursion = 1;
 }
 
 #pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
 bool CONSOLE_INFORMATION::TryLockConsole()
 {
-    return !!TryEnterCriticalSection(&_csConsoleLock);
+    const auto thread = GetCurrentThreadId();
+    if (_exclusiveOwner == thread)
+    {
+        ++_exclusiveRecursion;
+        return true;
+    }
+
+    FAIL_FAST_IF(s_sharedRecursion != 0);
+    if (!TryAcquireSRWLockExclusive(&_consoleLock))
+    {
+        return false;
+    }
+    _exclusiveOwner = thread;
+    _exclusiveRecursion = 1;
+    return true;
 }
 
 #pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
 void CONSOLE_INFORMATION::UnlockConsole()
 {
-    LeaveCriticalSection(&_csConsoleLock);
+    if (--_exclusiveRecursion == 0)
+    {
+        _exclusiveOwner = 0;
+        ReleaseSRWLockExclusive(&_consoleLock);
+    }
+}
+
+// Routine Description:
+// - Takes the lock shared, for reading. Any number of threads can hold it
+//      shared at the same time, but not while another thread holds it
+//      exclusively. A thread that already holds the lock, either way, can
+//      take it shared again.
+#pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
+void CONSOLE_INFORMATION::LockConsoleShared()
+{
+    if (_exclusiveOwner == GetCurrentThreadId())
+    {
+        // Reading is fine while we're the only one in there anyway.
+        ++_exclusiveRecursion;
+        return;
+    }
+
+    // Slim reader/writer locks can't be taken shared recursively: with a
+    // writer waiting, the second acquire would wait on it forever.
+    if (s_sharedRecursion++ == 0)
+    {
+        AcquireSRWLockShared(&_consoleLock);
+    }
+}
+
+#pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
+void CONSOLE_INFORMATION::UnlockConsoleShared()
+{
+    // A thread that holds the lock shared can't take it exclusively, so if
+    // this thread owns it, LockConsoleShared took it as another exclusive turn.
+    if (s_sharedRecursion == 0)
+    {
+        UnlockConsole();
+        return;
+    }
+
+    if (--s_sharedRecursion == 0)
+    {
+        ReleaseSRWLockShared(&_consoleLock);
+    }
 }
 
 ULONG CONSOLE_INFORMATION::GetCSRecursionCount()
 {
-    return _csConsoleLock.RecursionCount;
+    return _exclusiveOwner == GetCurrentThreadId() ? _exclusiveRecursion : 0;
 }
 
 // Routine Description:
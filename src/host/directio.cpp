@@ -861,40 +861,46 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
         // We will start reading the buffer at the point of the top left corner (origin) of the (potentially adjusted) request
         const auto sourcePoint = clippedRequestRectangle.Origin();
 
-        // Get an iterator to the beginning of the return buffer
-        // We might have to seek this forward or skip around if we clipped the request.
-        auto targetIter = targetBuffer.begin();
-        COORD targetPos = { 0 };
-        const auto targetLimit = Viewport::FromDimensions(targetPoint, clippedRequestRectangle.Dimensions());
-
-        // Get an iterator to the beginning of the request inside the screen buffer
-        // This should walk exactly along every cell of the clipped request.
-        auto sourceIter = storageBuffer.GetCellDataAt(sourcePoint, clippedRequestRectangle);
-
-        // Walk through every cell of the target, advancing the buffer.
-        // Validate that we always still have a valid iterator to the backing store,
-        // that we always are writing inside the user's buffer (before the end)
-        // and we're always targeting the user's buffer inside its original bounds.
-        while (sourceIter && targetIter < targetBuffer.end())
+        // Whatever is left of the request has to be inside the buffer.
+        RETURN_HR_IF(E_INVALIDARG, !storageBuffer.GetBufferSize().IsInBounds(clippedRequestRectangle));
+
+        // Copy the clipped request a row at a time, into the matching row of the user's buffer.
+        // Cells of the user's buffer that we clipped away are left alone.
+        const auto width = clippedRequestRectangle.Width();
+        std::optional<TextAttribute> lastAttr;
+        WORD lastLegacyAttr = 0;
+        for (SHORT row = 0; row < clippedRequestRectangle.Height(); ++row)
         {
-            // If the point we're trying to write is inside the limited buffer write zone...
-            if (targetLimit.IsInBounds(targetPos))
+            ptrdiff_t targetOffset;
+            RETURN_IF_FAILED(PtrdiffTMult(targetPoint.Y + row, targetSize.X, &targetOffset));
+            RETURN_IF_FAILED(PtrdiffTAdd(targetOffset, targetPoint.X, &targetOffset));
+            if (targetOffset >= targetBuffer.size())
             {
-                // Copy the data into position...
-                *targetIter = gci.AsCharInfo(*sourceIter);
-                // ... and advance the read iterator.
-                sourceIter++;
+                break;
             }
+            const auto targetRow = targetBuffer.subspan(targetOffset, std::min<ptrdiff_t>(width, targetBuffer.size() - targetOffset));
 
-            // Always advance the write iterator, we might have skipped it due to clipping.
-            targetIter++;
-
-            // Increment the target
-            targetPos.X++;
-            if (targetPos.X >= targetSize.X)
+            const COORD sourceRowOrigin{ sourcePoint.X, gsl::narrow<SHORT>(sourcePoint.Y + row) };
+            auto sourceIter = storageBuffer.GetCellDataAt(sourceRowOrigin, Viewport::FromDimensions(sourceRowOrigin, { width, 1 }));
+            for (auto& target : targetRow)
             {
-                targetPos.X = 0;
-                targetPos.Y++;
+                if (!sourceIter)
+                {
+                    break;
+                }
+
+                // Neighboring cells mostly share their colors. Only work out the legacy form of
+                // a color when it changes, since it takes a search of the color table for RGB ones.
+                const auto& attr = sourceIter->TextAttr();
+                if (lastAttr != attr)
+                {
+                    lastAttr = attr;
+                    lastLegacyAttr = gci.GenerateLegacyAttributes(attr);
+                }
+
+                target.Char.UnicodeChar = Utf16ToUcs2(sourceIter->Chars());
+                target.Attributes = lastLegacyAttr | sourceIter->DbcsAttr().GeneratePublicApiAttributeFormat();
+                ++sourceIter;
             }
         }
 
@@ -911,8 +917,8 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
                                                           const Microsoft::Console::Types::Viewport& sourceRectangle,
                                                           Microsoft::Console::Types::Viewport& readRectangle) noexcept
 {
-    LockConsole();
-    auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+    LockConsoleShared();
+    auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
     try
     {
@@ -933,8 +939,8 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
                                                           const Microsoft::Console::Types::Viewport& sourceRectangle,
                                                           Microsoft::Console::Types::Viewport& readRectangle) noexcept
 {
-    LockConsole();
-    auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+    LockConsoleShared();
+    auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
     try
     {
@@ -1045,9 +1051,15 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
             // Convert to a CHAR_INFO view to fit into the iterator
             const auto charInfos = std::basic_string_view<CHAR_INFO>(subspan.data(), subspan.size());
 
-            // Make the iterator and write to the target position.
-            OutputCellIterator it(charInfos);
-            storageBuffer.Write(it, target);
+            // Apps that draw the whole screen every frame mostly send cells we already have.
+            // Only write the spans that change, so that only those get repainted
+            // (and sent on by the VT renderer) too.
+            const auto& row = storageBuffer.GetTextBuffer().GetRowByOffset(target.Y);
+            for (const auto& [begin, end] : row.GetChangedSpans(OutputCellIterator(charInfos), target.X))
+            {
+                const auto span = charInfos.substr(begin - target.X, end - begin);
+                storageBuffer.Write(OutputCellIterator(span), { gsl::narrow<SHORT>(begin), target.Y });
+            }
         }
 
         // Since we've managed to write part of the request, return the clamped part that we actually used.
@@ -1113,8 +1125,8 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 {
     written = 0;
 
-    LockConsole();
-    auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+    LockConsoleShared();
+    auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
     try
     {
@@ -1134,8 +1146,8 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 {
     written = 0;
 
-    LockConsole();
-    auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+    LockConsoleShared();
+    auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
     try
     {
@@ -1163,8 +1175,8 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 {
     written = 0;
 
-    LockConsole();
-    auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+    LockConsoleShared();
+    auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
     try
     {
@@ -32,20 +32,34 @@ using Microsoft::Console::Interactivity::ServiceLocator;
 // for maintaining LRU, then this datatype can be changed.
 std::list<CommandHistory> CommandHistory::s_historyLists;
 
+// The allocated histories, by the process they're allocated to. These point into
+// s_historyLists, which is only ever rearranged by splicing, so they stay valid.
+std::unordered_map<HANDLE, CommandHistory*> CommandHistory::s_historiesByProcess;
+
 CommandHistory* CommandHistory::s_Find(const HANDLE processHandle)
 {
-    for (auto& historyList : s_historyLists)
+    const auto it = s_historiesByProcess.find(processHandle);
+    if (it != s_historiesByProcess.end())
     {
-        if (historyList._processHandle == processHandle)
-        {
-            FAIL_FAST_IF(WI_IsFlagClear(historyList.Flags, CLE_ALLOCATED));
-            return &historyList;
-        }
+        FAIL_FAST_IF(WI_IsFlagClear(it->second->Flags, CLE_ALLOCATED));
+        return it->second;
     }
 
     return nullptr;
 }
 
+// Routine Description:
+// - Hands a history to a process, so that s_Find can find it.
+// Arguments:
+// - history - The history, which must be in s_historyLists.
+// - processHandle - handle to client process.
+void CommandHistory::s_SetProcess(CommandHistory& history, const HANDLE processHandle)
+{
+    s_historiesByProcess.insert_or_assign(processHandle, &history);
+    history._processHandle = processHandle;
+    WI_SetFlag(history.Flags, CLE_ALLOCATED);
+}
+
 // Routine Description:
 // - This routine marks the command history buffer freed.
 // Arguments:
@@ -55,6 +69,8 @@ void CommandHistory::s_Free(const HANDLE processHandle)
     CommandHistory* const History = CommandHistory::s_Find(processHandle);
     if (History)
     {
+        s_historiesByProcess.erase(processHandle);
+        History->_SaveStore();
         WI_ClearFlag(History->Flags, CLE_ALLOCATED);
         History->_processHandle = nullptr;
     }
@@ -82,6 +98,71 @@ bool CommandHistory::IsAppNameMatch(const std::wstring_view other) const
     return std::equal(_appName.cbegin(), _appName.cend(), other.cbegin(), other.cend(), CaseInsensitiveEquality);
 }
 
+// Routine Description:
+// - Lowercases a command, the same way CaseInsensitiveEquality compares it.
+// Arguments:
+// - command - The command.
+// Return Value:
+// - The key of the command in the index.
+std::wstring CommandHistory::s_Fold(const std::wstring_view command)
+{
+    std::wstring folded{ command };
+    std::transform(folded.begin(), folded.end(), folded.begin(), [](const wchar_t wch) {
+        return gsl::narrow_cast<wchar_t>(::towlower(wch));
+    });
+    return folded;
+}
+
+// Routine Description:
+// - Records that a command was added to _commands.
+// Arguments:
+// - command - The command.
+void CommandHistory::_IndexAdd(const std::wstring_view command)
+{
+    _index[s_Fold(command)]++;
+}
+
+// Routine Description:
+// - Records that a command was removed from _commands.
+// Arguments:
+// - command - The command.
+void CommandHistory::_IndexRemove(const std::wstring_view command)
+{
+    const auto it = _index.find(s_Fold(command));
+    if (it != _index.end() && --it->second == 0)
+    {
+        _index.erase(it);
+    }
+}
+
+// Routine Description:
+// - Records that _commands was emptied.
+void CommandHistory::_IndexClear() noexcept
+{
+    _index.clear();
+}
+
+// Routine Description:
+// - Checks whether FindMatchingCommand could find anything, without walking the commands.
+// Arguments:
+// - command - The command or prefix to look for.
+// - options - Whether the whole command has to match, or just its beginning.
+// Return Value:
+// - True if a command matches, ignoring case.
+bool CommandHistory::_IndexContains(const std::wstring_view command, const MatchOptions options) const
+{
+    const auto folded = s_Fold(command);
+
+    if (WI_IsFlagSet(options, MatchOptions::ExactMatch))
+    {
+        return _index.find(folded) != _index.end();
+    }
+
+    // Every command that starts with the prefix sorts at or right after it.
+    const auto it = _index.lower_bound(folded);
+    return it != _index.end() && it->first.compare(0, folded.size(), folded) == 0;
+}
+
 // Routine Description:
 // - This routine is called when escape is entered or a command is added.
 void CommandHistory::_Reset()
@@ -112,7 +193,8 @@ void CommandHistory::_Reset()
         {
             std::wstring reuse{};
 
-            if (suppressDuplicates)
+            // Most commands are new, and the index knows that without walking the history.
+            if (suppressDuplicates && _IndexContains(newCommand, CommandHistory::MatchOptions::ExactMatch))
             {
                 SHORT index;
                 if (FindMatchingCommand(newCommand, LastDisplayed, index, CommandHistory::MatchOptions::ExactMatch))
@@ -124,7 +206,8 @@ void CommandHistory::_Reset()
             // find free record.  if all records are used, free the lru one.
             if ((SHORT)_commands.size() == _maxCommands)
             {
-                _commands.erase(_commands.cbegin());
+                _IndexRemove(_commands.front());
+                _commands.pop_front();
                 // move LastDisplayed back one in order to stay synced with the
                 // command it referred to before erasing the lru one
                 --LastDisplayed;
@@ -139,6 +222,23 @@ void CommandHistory::_Reset()
             {
                 _commands.emplace_back(newCommand);
             }
+            _IndexAdd(_commands.back());
+
+            if (_store)
+            {
+                try
+                {
+                    _store->Append(_commands.back());
+
+                    // Every now and then, drop what the log holds beyond the history.
+                    if (_store->GetRecordCount() > _MaxStoreRecords())
+                    {
+                        _store->Compact(_commands);
+                        _storeStale = false;
+                    }
+                }
+                CATCH_LOG();
+            }
 
             if (LastDisplayed == -1 ||
                 _commands.at(LastDisplayed).size() != newCommand.size() ||
@@ -249,8 +349,18 @@ std::wstring_view CommandHistory::GetLastCommand() const
 void CommandHistory::Empty()
 {
     _commands.clear();
+    _IndexClear();
     LastDisplayed = -1;
     WI_SetFlag(Flags, CLE_RESET);
+
+    if (_store)
+    {
+        try
+        {
+            _store->Clear();
+        }
+        CATCH_LOG();
+    }
 }
 
 bool CommandHistory::AtFirstCommand() const
@@ -284,11 +394,14 @@ void CommandHistory::Realloc(const size_t commands)
 
     const auto oldCommands = _commands;
     const auto newNumberOfCommands = gsl::narrow<SHORT>(std::min(_commands.size(), commands));
+    _storeStale = _storeStale || gsl::narrow_cast<size_t>(newNumberOfCommands) < oldCommands.size();
 
     _commands.clear();
+    _IndexClear();
     for (SHORT i = 0; i < newNumberOfCommands; i++)
     {
         _commands.emplace_back(oldCommands[i]);
+        _IndexAdd(_commands.back());
     }
 
     WI_SetFlag(Flags, CLE_RESET);
@@ -302,11 +415,10 @@ void CommandHistory::s_ReallocExeToFront(const std::wstring_view appName, const
     {
         if (WI_IsFlagSet(it->Flags, CLE_ALLOCATED) && it->IsAppNameMatch(appName))
         {
-            CommandHistory backup = *it;
-            backup.Realloc(commands);
+            it->Realloc(commands);
 
-            s_historyLists.erase(it);
-            s_historyLists.push_front(backup);
+            // Splicing keeps the history where it is in memory, so s_Find still finds it.
+            s_historyLists.splice(s_historyLists.begin(), s_historyLists, it);
 
             return;
         }
@@ -341,19 +453,18 @@ CommandHistory* CommandHistory::s_Allocate(const std::wstring_view appName, cons
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
     // Reuse a history buffer.  The buffer must be !CLE_ALLOCATED.
     // If possible, the buffer should have the same app name.
-    std::optional<CommandHistory> BestCandidate;
+    auto BestCandidate = s_historyLists.end();
     bool SameApp = false;
 
-    for (auto it = s_historyLists.cbegin(); it != s_historyLists.cend(); it++)
+    for (auto it = s_historyLists.begin(); it != s_historyLists.end(); it++)
     {
         if (WI_IsFlagClear(it->Flags, CLE_ALLOCATED))
         {
             // use LRU history buffer with same app name
             if (it->IsAppNameMatch(appName))
             {
-                BestCandidate = *it;
+                BestCandidate = it;
                 SameApp = true;
-                s_historyLists.erase(it);
                 break;
             }
         }
@@ -366,40 +477,62 @@ CommandHistory* CommandHistory::s_Allocate(const std::wstring_view appName, cons
         CommandHistory History;
 
         History._appName = appName;
-        History.Flags = CLE_ALLOCATED;
+        History.Flags = 0;
         History.LastDisplayed = -1;
         History._maxCommands = gsl::narrow<SHORT>(gci.GetHistoryBufferSize());
-        History._processHandle = processHandle;
-        return &s_historyLists.emplace_front(History);
+        History._processHandle = nullptr;
+
+        auto& allocated = s_historyLists.emplace_front(std::move(History));
+        auto removeAllocated = wil::scope_exit([&]() {
+            s_historyLists.pop_front();
+        });
+
+        s_SetProcess(allocated, processHandle);
+        removeAllocated.release();
+
+        if (gci.GetPersistHistory())
+        {
+            allocated._LoadStore(WI_IsFlagSet(gci.Flags, CONSOLE_HISTORY_NODUP));
+        }
+
+        return &allocated;
     }
-    else if (!BestCandidate.has_value() && s_historyLists.size() > 0)
+    else if (BestCandidate == s_historyLists.end() && s_historyLists.size() > 0)
     {
         // If we have no candidate already and we need one, take the LRU (which is the back/last one) which isn't allocated.
-        for (auto it = s_historyLists.crbegin(); it != s_historyLists.crend(); it++)
+        for (auto it = s_historyLists.rbegin(); it != s_historyLists.rend(); it++)
         {
             if (WI_IsFlagClear(it->Flags, CLE_ALLOCATED))
             {
-                BestCandidate = *it;
-                s_historyLists.erase(std::next(it).base()); // trickery to turn reverse iterator into forward iterator for erase.
+                BestCandidate = std::next(it).base(); // trickery to turn reverse iterator into forward iterator.
                 break;
             }
         }
     }
 
     // If the app name doesn't match, copy in the new app name and free the old commands.
-    if (BestCandidate.has_value())
+    if (BestCandidate != s_historyLists.end())
     {
+        s_SetProcess(*BestCandidate, processHandle);
+
         if (!SameApp)
         {
             BestCandidate->_commands.clear();
+            BestCandidate->_IndexClear();
             BestCandidate->LastDisplayed = -1;
             BestCandidate->_appName = appName;
+            BestCandidate->_store.reset();
+
+            if (gci.GetPersistHistory())
+            {
+                BestCandidate->_LoadStore(WI_IsFlagSet(gci.Flags, CONSOLE_HISTORY_NODUP));
+            }
         }
 
-        BestCandidate->_processHandle = processHandle;
-        WI_SetFlag(BestCandidate->Flags, CLE_ALLOCATED);
+        // Move it to the front without moving it in memory.
+        s_historyLists.splice(s_historyLists.begin(), s_historyLists, BestCandidate);
 
-        return &s_historyLists.emplace_front(BestCandidate.value());
+        return &*BestCandidate;
     }
 
     return nullptr;
@@ -471,6 +604,8 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
     try
     {
         const auto str = _commands.at(iDel);
+        _IndexRemove(str);
+        _storeStale = true;
 
         if (iDel < iLast)
         {
@@ -529,6 +664,12 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
 
     try
     {
+        // Don't walk the whole history just to find out that nothing matches.
+        if (!_IndexContains(givenCommand, options))
+        {
+            return false;
+        }
+
         for (size_t i = 0; i < _commands.size(); i++)
         {
             const auto& storedCommand = _commands.at(indexFound);
@@ -552,9 +693,90 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
     return false;
 }
 
+// Routine Description:
+// - Fills a history that was just handed to a new app with the commands the app
+//      ran in previous sessions. From now on, the commands added to it are kept, too.
+// - The store is opened on first use rather than up front, so that apps that
+//      never allocate a history never touch the disk.
+// Arguments:
+// - suppressDuplicates - Whether to drop older duplicates while loading, like Add does.
+// Return Value:
+// - <none>
+void CommandHistory::_LoadStore(const bool suppressDuplicates) noexcept
+{
+    if (_maxCommands == 0)
+    {
+        return;
+    }
+
+    try
+    {
+        // Adding the loaded commands mustn't append them to the log again,
+        // so the store is only hooked up to the history once they're in.
+        auto store = std::make_unique<HistoryStore>(HistoryStore::s_GetPathForApp(_appName));
+        for (const auto& command : store->Load())
+        {
+            LOG_IF_FAILED(Add(command, suppressDuplicates));
+        }
+
+        _store = std::move(store);
+        _storeStale = false;
+
+        // Start this session from a log that holds no more than the history.
+        if (_store->GetRecordCount() > _commands.size())
+        {
+            _store->Compact(_commands);
+        }
+    }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Rewrites the store of a history that's being freed, if what's in it has
+//      drifted too far from the history, or can't be reconstructed from it anymore.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void CommandHistory::_SaveStore() noexcept
+{
+    if (!_store)
+    {
+        return;
+    }
+
+    try
+    {
+        if (_storeStale || _store->GetRecordCount() > _MaxStoreRecords())
+        {
+            _store->Compact(_commands);
+            _storeStale = false;
+        }
+        else
+        {
+            _store->Flush();
+        }
+    }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Gets how large the store may grow before it's compacted. Compacting at
+//      twice the size of the history keeps the log small while rewriting it only
+//      once for every so many commands.
+// Arguments:
+// - <none>
+// Return Value:
+// - The number of records.
+size_t CommandHistory::_MaxStoreRecords() const noexcept
+{
+    return 2 * gsl::narrow_cast<size_t>(std::max<SHORT>(_maxCommands, 1));
+}
+
 #ifdef UNIT_TESTING
 void CommandHistory::s_ClearHistoryListStorage()
 {
+    s_historiesByProcess.clear();
     s_historyLists.clear();
 }
 #endif
@@ -567,6 +789,7 @@ void CommandHistory::s_ClearHistoryListStorage()
 void CommandHistory::Swap(const short indexA, const short indexB)
 {
     std::swap(_commands.at(indexA), _commands.at(indexB));
+    _storeStale = true;
 }
 
 // Routine Description:
@@ -12,6 +12,8 @@ Abstract:
 
 #pragma once
 
+#include "HistoryStore.hpp"
+
 class CommandHistory
 {
 public:
@@ -83,13 +85,36 @@ private:
     void _Dec(SHORT& ind) const;
     void _Inc(SHORT& ind) const;
 
-    std::vector<std::wstring> _commands;
+    void _IndexAdd(const std::wstring_view command);
+    void _IndexRemove(const std::wstring_view command);
+    void _IndexClear() noexcept;
+    bool _IndexContains(const std::wstring_view command, const MatchOptions options) const;
+
+    void _LoadStore(const bool suppressDuplicates) noexcept;
+    void _SaveStore() noexcept;
+    size_t _MaxStoreRecords() const noexcept;
+
+    static std::wstring s_Fold(const std::wstring_view command);
+    static void s_SetProcess(CommandHistory& history, const HANDLE processHandle);
+
+    // Oldest first. The oldest command is dropped once this is full.
+    std::deque<std::wstring> _commands;
     SHORT _maxCommands;
 
+    // Counts how often each command occurs in _commands, keyed by its lowercase form.
+    // It's sorted, so that it can tell whether any command starts with a given prefix.
+    std::map<std::wstring, size_t> _index;
+
     std::wstring _appName;
     HANDLE _processHandle;
 
+    // Where the commands are kept across sessions, if they are.
+    std::unique_ptr<HistoryStore> _store;
+    // Set when the history changed in a way that appending to the store can't express.
+    bool _storeStale = false;
+
     static std::list<CommandHistory> s_historyLists;
+    static std::unordered_map<HANDLE, CommandHistory*> s_historiesByProcess;
 
 public:
     DWORD Flags;
@@ -24,8 +24,8 @@ using Microsoft::Console::VirtualTerminal::TerminalInput;
 // - A new instance of InputBuffer
 InputBuffer::InputBuffer() :
     InputMode{ INPUT_BUFFER_DEFAULT_INPUT_MODE },
-    WaitQueue{},
-    _termInput(std::bind(&InputBuffer::_HandleTerminalInputCallback, this, std::placeholders::_1))
+    WaitQueue{ true }, // Closing an input handle only wakes the reads on it.
+    _termInput(TerminalInput::WriteInputEvents{ std::bind(&InputBuffer::_HandleTerminalInputCallback, this, std::placeholders::_1) })
 {
     // The _termInput's constructor takes a reference to this object's _HandleTerminalInputCallback.
     // We need to use std::bind to create a reference to that function without a reference to this InputBuffer
@@ -92,23 +92,32 @@ static void _CopyRectangle(SCREEN_INFORMATION& screenInfo,
         }
     }
 
-    // 2. We can move any other scenario in-place without copying. We just have to carefully
-    //    choose which direction we walk through filling up the target so it doesn't accidentally
-    //    erase the source material before it can be copied/moved to the new location.
+    // 2. Any other scenario is moved a row at a time. We read a whole row of the source
+    //    before writing any of it to the target, so it doesn't matter if they overlap
+    //    horizontally. Vertically, we have to carefully choose which direction we walk
+    //    through the rows so we don't accidentally erase source rows before they're moved.
     {
         const auto target = Viewport::FromDimensions(targetOrigin, source.Dimensions());
-        const auto walkDirection = Viewport::DetermineWalkDirection(source, target);
+        const auto bottomUp = target.Top() > source.Top();
 
-        auto sourcePos = source.GetWalkOrigin(walkDirection);
-        auto targetPos = target.GetWalkOrigin(walkDirection);
+        std::vector<OutputCell> rowData;
+        rowData.reserve(source.Width());
 
-        do
+        for (SHORT i = 0; i < source.Height(); i++)
         {
-            const auto data = OutputCell(*screenInfo.GetCellDataAt(sourcePos));
-            screenInfo.Write(OutputCellIterator({ &data, 1 }), targetPos);
+            const auto rowOffset = gsl::narrow_cast<SHORT>(bottomUp ? source.Height() - 1 - i : i);
 
-            source.WalkInBounds(sourcePos, walkDirection);
-        } while (target.WalkInBounds(targetPos, walkDirection));
+            rowData.clear();
+            auto it = screenInfo.GetCellDataAt({ source.Left(), gsl::narrow_cast<SHORT>(source.Top() + rowOffset) });
+            for (SHORT col = 0; col < source.Width(); col++, ++it)
+            {
+                rowData.emplace_back(*it);
+            }
+
+            const COORD targetRowOrigin{ target.Left(), gsl::narrow_cast<SHORT>(target.Top() + rowOffset) };
+            screenInfo.WriteRect(OutputCellIterator({ rowData.data(), rowData.size() }),
+                                 Viewport::FromDimensions(targetRowOrigin, { source.Width(), 1 }));
+        }
     }
 }
 
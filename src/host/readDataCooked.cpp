@@ -579,6 +579,9 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
         bool CallWrite = true;
         const SHORT sScreenBufferSizeX = _screenInfo.GetBufferSize().Width();
 
+        // the first char that changes. the cursor is where it's drawn.
+        size_t redrawFrom = _currentPosition;
+
         // processing in the middle of the line is more complex:
 
         // calculate new cursor position
@@ -642,6 +645,7 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
                         loop = true;
                     }
                 }
+                redrawFrom = _currentPosition;
             }
             else
             {
@@ -707,29 +711,13 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
             CursorPosition = _screenInfo.GetTextBuffer().GetCursor().GetPosition();
             CursorPosition.X = (SHORT)(CursorPosition.X + NumSpaces);
 
-            // clear the current command line from the screen
-            // clang-format off
-#pragma prefast(suppress: __WARNING_BUFFER_OVERFLOW, "Not sure why prefast doesn't like this call.")
-            // clang-format on
-            DeleteCommandLine(*this, FALSE);
-
-            // write the new command line to the screen
-            NumToWrite = _bytesRead;
-
+            // write the changed part of the command line to the screen
             DWORD dwFlags = WC_DESTRUCTIVE_BACKSPACE | WC_ECHO;
             if (wch == UNICODE_CARRIAGERETURN)
             {
                 dwFlags |= WC_KEEP_CURSOR_VISIBLE;
             }
-            status = WriteCharsLegacy(_screenInfo,
-                                      _backupLimit,
-                                      _backupLimit,
-                                      _backupLimit,
-                                      &NumToWrite,
-                                      &_visibleCharCount,
-                                      _originalCursorPosition.X,
-                                      dwFlags,
-                                      &ScrollY);
+            status = _redrawTail(redrawFrom, dwFlags, ScrollY);
             if (!NT_SUCCESS(status))
             {
                 RIPMSG1(RIP_WARNING, "WriteCharsLegacy failed 0x%x", status);
@@ -815,6 +803,67 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
     return false;
 }
 
+// Routine Description:
+// - Redraws the prompt line from the given char on, after it was edited in the middle.
+//   The chars before it didn't change, so they're left as they are on the screen,
+//   instead of erasing and rewriting the whole line. Only the tail gets repainted,
+//   which matters when the line is sent on by the VT renderer on every keystroke.
+// - The cursor has to be where the given char is drawn. It ends up after the last char.
+// Arguments:
+// - from - the first char that changed
+// - flags - how to write the chars. See WriteCharsLegacy.
+// - scrollY - receives how far the buffer scrolled while writing
+// Return Value:
+// - STATUS_SUCCESS, or the failure of WriteCharsLegacy
+[[nodiscard]] NTSTATUS COOKED_READ_DATA::_redrawTail(const size_t from, const DWORD flags, SHORT& scrollY)
+{
+    const COORD cursorPosition = _screenInfo.GetTextBuffer().GetCursor().GetPosition();
+    const SHORT sScreenBufferSizeX = _screenInfo.GetBufferSize().Width();
+
+    // the cells the unchanged chars take up, counting from where the edit line starts.
+    const auto unchangedCells = gsl::narrow_cast<size_t>(std::max<ptrdiff_t>(0,
+                                                                             (cursorPosition.Y - _originalCursorPosition.Y) * sScreenBufferSizeX +
+                                                                                 (cursorPosition.X - _originalCursorPosition.X)));
+
+    // clear what's left of the old line, like DeleteCommandLine does for all of it.
+    size_t CharsToWrite = 0;
+    if (_visibleCharCount > unchangedCells)
+    {
+        CharsToWrite = _visibleCharCount - unchangedCells;
+        if (!CheckBisectStringW(_backupLimit,
+                                _visibleCharCount,
+                                sScreenBufferSizeX - _originalCursorPosition.X))
+        {
+            CharsToWrite++;
+        }
+    }
+
+    try
+    {
+        if (CharsToWrite > 0)
+        {
+            _screenInfo.Write(OutputCellIterator(UNICODE_SPACE, CharsToWrite), cursorPosition);
+        }
+    }
+    CATCH_LOG();
+
+    // write the new tail. the cursor is already where it starts.
+    size_t NumToWrite = _bytesRead - (from * sizeof(WCHAR));
+    size_t NumSpaces = 0;
+    const auto status = WriteCharsLegacy(_screenInfo,
+                                         _backupLimit,
+                                         _backupLimit + from,
+                                         _backupLimit + from,
+                                         &NumToWrite,
+                                         &NumSpaces,
+                                         _originalCursorPosition.X,
+                                         flags,
+                                         &scrollY);
+
+    _visibleCharCount = unchangedCells + NumSpaces;
+    return status;
+}
+
 // Routine Description:
 // - Writes string to current position in prompt line. can overwrite text to the right of the cursor.
 // Arguments:
@@ -157,4 +157,6 @@ private:
     [[nodiscard]] NTSTATUS _readCharInputLoop(const bool isUnicode, size_t& numBytes) noexcept;
 
     [[nodiscard]] NTSTATUS _handlePostCharInputLoop(const bool isUnicode, size_t& numBytes, ULONG& controlKeyState) noexcept;
+
+    [[nodiscard]] NTSTATUS _redrawTail(const size_t from, const DWORD flags, SHORT& scrollY);
 };
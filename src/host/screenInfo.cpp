@@ -51,6 +51,7 @@ SCREEN_INFORMATION::SCREEN_INFORMATION(
     _viewport(Viewport::Empty()),
     _psiAlternateBuffer{ nullptr },
     _psiMainBuffer{ nullptr },
+    _psiSpareAltBuffer{ nullptr },
     _rcAltSavedClientNew{ 0 },
     _rcAltSavedClientOld{ 0 },
     _fAltWindowChanged{ false },
@@ -197,13 +198,27 @@ void SCREEN_INFORMATION::s_InsertScreenBuffer(_In_ SCREEN_INFORMATION* const pSc
 }
 
 // Routine Description:
-// - This routine removes the screen buffer pointer from the console's list of screen buffers.
+// - This routine removes the screen buffer pointer from the console's list of screen buffers and frees it.
 // Arguments:
 // - ScreenInfo - Pointer to screen information structure.
 // Return Value:
 // Note:
 // - The console lock must be held when calling this routine.
 void SCREEN_INFORMATION::s_RemoveScreenBuffer(_In_ SCREEN_INFORMATION* const pScreenInfo)
+{
+    s_UnlinkScreenBuffer(pScreenInfo);
+    delete pScreenInfo;
+}
+
+// Routine Description:
+// - This routine removes the screen buffer pointer from the console's list of screen buffers,
+//   making another one active if it was the active one, but leaves it allocated.
+// Arguments:
+// - ScreenInfo - Pointer to screen information structure.
+// Return Value:
+// Note:
+// - The console lock must be held when calling this routine.
+void SCREEN_INFORMATION::s_UnlinkScreenBuffer(_In_ SCREEN_INFORMATION* const pScreenInfo)
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
     if (pScreenInfo == gci.ScreenBuffers)
@@ -241,8 +256,6 @@ void SCREEN_INFORMATION::s_RemoveScreenBuffer(_In_ SCREEN_INFORMATION* const pSc
             gci.pCurrentScreenBuffer = nullptr;
         }
     }
-
-    delete pScreenInfo;
 }
 
 #pragma endregion
@@ -283,6 +296,10 @@ void SCREEN_INFORMATION::_FreeOutputStateMachine()
             s_RemoveScreenBuffer(_psiAlternateBuffer);
         }
 
+        // The spare isn't in the list of screen buffers.
+        delete _psiSpareAltBuffer;
+        _psiSpareAltBuffer = nullptr;
+
         _stateMachine.reset();
     }
 }
@@ -1797,6 +1814,11 @@ const SCREEN_INFORMATION& SCREEN_INFORMATION::GetMainBuffer() const
 // - Instantiates a new buffer to be used as an alternate buffer. This buffer
 //     does not have a driver handle associated with it and shares a state
 //     machine with the main buffer it belongs to.
+// - If the last alternate buffer of the main buffer is still around and is
+//     the right size, it's reset and used instead. Applications like less and
+//     vim switch in and out all the time, and resetting the rows is much
+//     cheaper than allocating them all again, along with a state machine that
+//     is thrown away right after.
 // TODO: MSFT:19817348 Don't create alt screenbuffer's via an out SCREEN_INFORMATION**
 // Parameters:
 // - ppsiNewScreenBuffer - a pointer to receive the newly created buffer.
@@ -1814,13 +1836,39 @@ const SCREEN_INFORMATION& SCREEN_INFORMATION::GetMainBuffer() const
     auto initAttributes = GetAttributes();
     initAttributes.SetStandardErase();
 
-    NTSTATUS Status = SCREEN_INFORMATION::CreateInstance(WindowSize,
-                                                         existingFont,
-                                                         WindowSize,
-                                                         initAttributes,
-                                                         *GetPopupAttributes(),
-                                                         Cursor::CURSOR_SMALL_SIZE,
-                                                         ppsiNewScreenBuffer);
+    NTSTATUS Status = STATUS_SUCCESS;
+    SCREEN_INFORMATION* const psiSpare = std::exchange(GetMainBuffer()._psiSpareAltBuffer, nullptr);
+    if (psiSpare != nullptr && psiSpare->GetBufferSize().Dimensions() == WindowSize)
+    {
+        try
+        {
+            psiSpare->_ReinitializeAltBuffer(existingFont, initAttributes, *GetPopupAttributes());
+            *ppsiNewScreenBuffer = psiSpare;
+        }
+        catch (...)
+        {
+            delete psiSpare;
+            Status = NTSTATUS_FROM_HRESULT(wil::ResultFromCaughtException());
+        }
+    }
+    else
+    {
+        delete psiSpare;
+        Status = SCREEN_INFORMATION::CreateInstance(WindowSize,
+                                                    existingFont,
+                                                    WindowSize,
+                                                    initAttributes,
+                                                    *GetPopupAttributes(),
+                                                    Cursor::CURSOR_SMALL_SIZE,
+                                                    ppsiNewScreenBuffer);
+        if (NT_SUCCESS(Status))
+        {
+            // delete the alt buffer's state machine. We don't want it.
+            (*ppsiNewScreenBuffer)->_FreeOutputStateMachine(); // this has to be done before we give it a main buffer
+            // we'll attach the GetSet, etc once we successfully make this buffer the active buffer.
+        }
+    }
+
     if (NT_SUCCESS(Status))
     {
         // Update the alt buffer's cursor style to match our own.
@@ -1830,10 +1878,6 @@ const SCREEN_INFORMATION& SCREEN_INFORMATION::GetMainBuffer() const
 
         s_InsertScreenBuffer(createdBuffer);
 
-        // delete the alt buffer's state machine. We don't want it.
-        createdBuffer->_FreeOutputStateMachine(); // this has to be done before we give it a main buffer
-        // we'll attach the GetSet, etc once we successfully make this buffer the active buffer.
-
         // Set up the new buffers references to our current state machine, dispatcher, getset, etc.
         createdBuffer->_stateMachine = _stateMachine;
     }
@@ -1873,7 +1917,7 @@ const SCREEN_INFORMATION& SCREEN_INFORMATION::GetMainBuffer() const
 
         if (psiOldAltBuffer != nullptr)
         {
-            s_RemoveScreenBuffer(psiOldAltBuffer); // this will also delete the old alt buffer
+            siMain._RetireAltBuffer(psiOldAltBuffer);
         }
 
         ::SetActiveScreenBuffer(*psiNewAltBuffer);
@@ -1914,14 +1958,77 @@ void SCREEN_INFORMATION::UseMainScreenBuffer()
 
         SCREEN_INFORMATION* psiAlt = psiMain->_psiAlternateBuffer;
         psiMain->_psiAlternateBuffer = nullptr;
-        s_RemoveScreenBuffer(psiAlt); // this will also delete the alt buffer
-        // deleting the alt buffer will give the GetSet back to its main
+        psiMain->_RetireAltBuffer(psiAlt); // this keeps the alt buffer around for the next one
 
         // Tell the VT MouseInput handler that we're in the main buffer now
         gci.GetActiveInputBuffer()->GetTerminalInput().UseMainScreenBuffer();
     }
 }
 
+// Routine Description:
+// - Takes an alternate buffer that's no longer in use out of the console's
+//     list of screen buffers, and keeps it so that the next alternate buffer
+//     can reuse it. Only the last one is kept.
+// Parameters:
+// - psiAltBuffer - The alternate buffer. It must belong to this buffer.
+// Return value:
+// - <none>
+void SCREEN_INFORMATION::_RetireAltBuffer(_In_ SCREEN_INFORMATION* const psiAltBuffer)
+{
+    FAIL_FAST_IF(psiAltBuffer->_psiMainBuffer != this);
+
+    s_UnlinkScreenBuffer(psiAltBuffer);
+    delete std::exchange(_psiSpareAltBuffer, psiAltBuffer);
+}
+
+// Routine Description:
+// - Resets a retired alternate buffer to the state CreateInstance would have
+//     created it in, keeping its rows, its render target and its main buffer.
+//     It must not be in the console's list of screen buffers.
+// Parameters:
+// - fontInfo - The font to use.
+// - defaultAttributes - The attributes to fill the buffer with.
+// - popupAttributes - The attributes to draw popups with.
+// Return value:
+// - <none>
+void SCREEN_INFORMATION::_ReinitializeAltBuffer(const FontInfo& fontInfo,
+                                                const TextAttribute defaultAttributes,
+                                                const TextAttribute popupAttributes)
+{
+    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+    _textBuffer->Reinitialize(defaultAttributes, Cursor::CURSOR_SMALL_SIZE);
+    _textBuffer->GetCursor().SetColor(gci.GetCursorColor());
+    _textBuffer->GetCursor().SetType(gci.GetCursorType());
+
+    OutputMode = ENABLE_PROCESSED_OUTPUT | ENABLE_WRAP_AT_EOL_OUTPUT;
+    if (gci.GetVirtTermLevel() != 0)
+    {
+        OutputMode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
+    }
+
+    ResizingWindow = 0;
+    WheelDelta = 0;
+    HWheelDelta = 0;
+    WriteConsoleDbcsLeadByte[0] = 0;
+    WriteConsoleDbcsLeadByte[1] = 0;
+    FillOutDbcsLeadChar = 0;
+    ConvScreenInfo = nullptr;
+    ScrollScale = 1ul;
+
+    _scrollMargins = Viewport::FromCoord({ 0 });
+    _viewport = Viewport::FromDimensions({ 0, 0 }, GetBufferSize().Dimensions());
+    UpdateBottom();
+
+    _rcAltSavedClientNew = { 0 };
+    _rcAltSavedClientOld = { 0 };
+    _fAltWindowChanged = false;
+
+    _PopupAttributes = popupAttributes;
+    _currentFont = fontInfo;
+    _desiredFont = FontInfoDesired{ fontInfo };
+}
+
 // Routine Description:
 // - Helper indicating if the buffer has a main buffer, meaning that this is an alternate buffer.
 // Parameters:
@@ -268,6 +268,12 @@ private:
     void _FreeOutputStateMachine();
 
     [[nodiscard]] NTSTATUS _CreateAltBuffer(_Out_ SCREEN_INFORMATION** const ppsiNewScreenBuffer);
+    void _RetireAltBuffer(_In_ SCREEN_INFORMATION* const psiAltBuffer);
+    void _ReinitializeAltBuffer(const FontInfo& fontInfo,
+                                const TextAttribute defaultAttributes,
+                                const TextAttribute popupAttributes);
+
+    static void s_UnlinkScreenBuffer(_In_ SCREEN_INFORMATION* const pScreenInfo);
 
     bool _IsAltBuffer() const;
     bool _IsInPtyMode() const;
@@ -283,6 +289,7 @@ private:
 
     SCREEN_INFORMATION* _psiAlternateBuffer; // The VT "Alternate" screen buffer.
     SCREEN_INFORMATION* _psiMainBuffer; // A pointer to the main buffer, if this is the alternate buffer.
+    SCREEN_INFORMATION* _psiSpareAltBuffer; // The last alternate buffer, kept to be reused by the next one.
 
     RECT _rcAltSavedClientNew;
     RECT _rcAltSavedClientOld;
@@ -109,6 +109,8 @@ public:
     void LockConsole();
     bool TryLockConsole();
     void UnlockConsole();
+    void LockConsoleShared();
+    void UnlockConsoleShared();
     bool IsConsoleLocked() const;
     ULONG GetCSRecursionCount();
 
@@ -150,7 +152,13 @@ public:
     RenderData renderData;
 
 private:
-    CRITICAL_SECTION _csConsoleLock; // serialize input and output using this
+    SRWLOCK _consoleLock; // serialize input and output using this
+    // The thread that holds the lock exclusively, and how many times it took it.
+    // Only the owner ever finds its own id here, so it can read it without racing.
+    std::atomic<DWORD> _exclusiveOwner;
+    ULONG _exclusiveRecursion;
+    // How many times the current thread took the lock shared.
+    static thread_local ULONG s_sharedRecursion;
     std::wstring _Title;
     std::wstring _TitlePrefix; // Eg Select, Mark - things that we manually prepend to the title.
     std::wstring _OriginalTitle;
@@ -59,7 +59,8 @@ Settings::Settings() :
     _DefaultForeground(INVALID_COLOR),
     _DefaultBackground(INVALID_COLOR),
     _fUseDx(false),
-    _fCopyColor(false)
+    _fCopyColor(false),
+    _fPersistHistory(false)
 {
     _dwScreenBufferSize.X = 80;
     _dwScreenBufferSize.Y = 25;
@@ -986,3 +987,15 @@ bool Settings::GetCopyColor() const noexcept
 {
     return _fCopyColor;
 }
+
+// Routine Description:
+// - Whether command histories are kept on disk across sessions, see HistoryStore.
+bool Settings::GetPersistHistory() const noexcept
+{
+    return _fPersistHistory;
+}
+
+void Settings::SetPersistHistory(const bool fPersistHistory) noexcept
+{
+    _fPersistHistory = fPersistHistory;
+}
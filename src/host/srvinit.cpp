@@ -30,6 +30,7 @@ using namespace Microsoft::Console::Render;
 
 const UINT CONSOLE_EVENT_FAILURE_ID = 21790;
 const UINT CONSOLE_LPC_PORT_FAILURE_ID = 21791;
+const UINT CONSOLE_MAX_IO_THREADS = 4;
 
 [[nodiscard]] HRESULT ConsoleServerInitialization(_In_ HANDLE Server, const ConsoleArguments* const args)
 {
@@ -269,9 +270,16 @@ void ConsoleCheckDebug()
     ServerInformation.InputAvailableEvent = ServiceLocator::LocateGlobals().hInputEvent.get();
     RETURN_IF_FAILED(g.pDeviceComm->SetServerInformation(&ServerInformation));
 
-    HANDLE const hThread = CreateThread(nullptr, 0, ConsoleIoThread, nullptr, 0, nullptr);
-    RETURN_HR_IF(E_HANDLE, hThread == nullptr);
-    LOG_IF_WIN32_BOOL_FALSE(CloseHandle(hThread)); // The thread will run on its own and close itself. Free the associated handle.
+    // APIs that only read can be serviced at the same time (see ApiSorter), so that a client that
+    // polls the console doesn't hold up another one that writes to it. One thread is always enough
+    // for everything else, so there's no use in more than a few.
+    const auto ioThreadCount = std::clamp(std::thread::hardware_concurrency(), 1u, CONSOLE_MAX_IO_THREADS);
+    for (auto i = 0u; i < ioThreadCount; ++i)
+    {
+        HANDLE const hThread = CreateThread(nullptr, 0, ConsoleIoThread, nullptr, 0, nullptr);
+        RETURN_HR_IF(E_HANDLE, hThread == nullptr);
+        LOG_IF_WIN32_BOOL_FALSE(CloseHandle(hThread)); // The thread will run on its own and close itself. Free the associated handle.
+    }
 
     // See MSFT:19918626
     // Make sure to always set up the signal thread if we need to.
@@ -435,8 +443,8 @@ PWSTR TranslateConsoleTitle(_In_ PCWSTR pwszConsoleTitle, const BOOL fUnexpand,
     try
     {
         const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+        LockConsoleShared();
+        auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
         // This fails a lot and it's totally expected. It only works for a few East Asian code pages.
         // As such, just return it. Do NOT use a wil macro here. It is very noisy.
@@ -650,7 +658,7 @@ PWSTR TranslateConsoleTitle(_In_ PCWSTR pwszConsoleTitle, const BOOL fUnexpand,
 }
 
 // Routine Description:
-// - This routine is the main one in the console server IO thread.
+// - This routine is the main one in the console server IO threads.
 // - It reads IO requests submitted by clients through the driver, services and completes them in a loop.
 // Arguments:
 // - <none>
@@ -660,37 +668,12 @@ DWORD WINAPI ConsoleIoThread(LPVOID /*lpParameter*/)
 {
     auto& globals = ServiceLocator::LocateGlobals();
 
-    CONSOLE_API_MSG ReceiveMsg;
-    ReceiveMsg._pApiRoutines = &globals.api;
-    ReceiveMsg._pDeviceComm = globals.pDeviceComm;
-    PCONSOLE_API_MSG ReplyMsg = nullptr;
+    // This only returns once the driver is gone.
+    const HRESULT hr = IoSorter::ServiceIo(*globals.pDeviceComm, globals.api);
+    LOG_HR_IF(hr, hr != HRESULT_FROM_WIN32(ERROR_PIPE_NOT_CONNECTED));
 
-    bool fShouldExit = false;
-    while (!fShouldExit)
-    {
-        if (ReplyMsg != nullptr)
-        {
-            LOG_IF_FAILED(ReplyMsg->ReleaseMessageBuffers());
-        }
-
-        // TODO: 9115192 correct mixed NTSTATUS/HRESULT
-        HRESULT hr = ServiceLocator::LocateGlobals().pDeviceComm->ReadIo(ReplyMsg, &ReceiveMsg);
-        if (FAILED(hr))
-        {
-            if (hr == HRESULT_FROM_WIN32(ERROR_PIPE_NOT_CONNECTED))
-            {
-                fShouldExit = true;
-
-                // This will not return. Terminate immediately when disconnected.
-                ServiceLocator::RundownAndExit(STATUS_SUCCESS);
-            }
-            RIPMSG1(RIP_WARNING, "DeviceIoControl failed with Result 0x%x", hr);
-            ReplyMsg = nullptr;
-            continue;
-        }
-
-        IoSorter::ServiceIoOperation(&ReceiveMsg, &ReplyMsg);
-    }
+    // This will not return. Terminate immediately when disconnected.
+    ServiceLocator::RundownAndExit(STATUS_SUCCESS);
 
     return 0;
 }
@@ -164,20 +164,21 @@ void Telemetry::LogApiCall(const ApiCall api, const BOOLEAN fUnicode)
     // to use an array which has very quick access times.
     // The downside is we have to create an enum type, and then convert them to strings when we finally
     // send out the telemetry, but the upside is we should have very good performance.
+    // APIs that only read are serviced by several IO threads at once, so the counts are bumped atomically.
     if (fUnicode)
     {
-        _rguiTimesApiUsed[api]++;
+        InterlockedIncrement(&_rguiTimesApiUsed[api]);
     }
     else
     {
-        _rguiTimesApiUsedAnsi[api]++;
+        InterlockedIncrement(&_rguiTimesApiUsedAnsi[api]);
     }
 }
 
 // Log an API call was used.
 void Telemetry::LogApiCall(const ApiCall api)
 {
-    _rguiTimesApiUsed[api]++;
+    InterlockedIncrement(&_rguiTimesApiUsed[api]);
 }
 
 // Log usage of the Find Dialog.
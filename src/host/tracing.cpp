@@ -3,6 +3,7 @@
 
 #include "precomp.h"
 #include "tracing.hpp"
+#include "ApiLatency.hpp"
 #include "../types/UiaTextRangeBase.hpp"
 #include "../types/ScreenInfoUiaProviderBase.h"
 
@@ -49,6 +50,7 @@ Tracing::~Tracing()
 // - Provides generic tracing for all API call types in the form of
 //   start/stop period events for timing and region-of-interest purposes
 //   while doing performance analysis.
+// - If API latencies are being measured, also times the call. See ApiLatency.
 // Arguments:
 // - result - Reference to the area where the result code from the Api call
 //            will be stored for use in the stop event.
@@ -67,7 +69,16 @@ Tracing Tracing::s_TraceApiCall(const NTSTATUS& result, PCSTR traceName)
         TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
         TraceLoggingKeyword(TraceKeywords::API));
 
-    return Tracing([traceName, &result] {
+    // The clock is only read when someone's measuring. This is on the path of every API call.
+    const auto measured = ApiLatency::s_IsEnabled();
+    const auto start = measured ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+
+    return Tracing([traceName, &result, measured, start] {
+        if (measured)
+        {
+            ApiLatency::s_Record(traceName, std::chrono::steady_clock::now() - start);
+        }
+
         TraceLoggingWrite(
             g_hConhostV2EventTraceProvider,
             "ApiCall",
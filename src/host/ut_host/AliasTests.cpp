@@ -6,6 +6,7 @@
 #include "..\..\inc\consoletaeftemplates.hpp"
 
 #include "alias.h"
+#include "ApiRoutines.h"
 
 using namespace WEX::Common;
 using namespace WEX::Logging;
@@ -408,7 +409,7 @@ class AliasTests
 
         for (size_t i = 0; i < tokensExpected.size(); i++)
         {
-            VERIFY_ARE_EQUAL(String(tokensExpected[i].data()), String(tokensActual[i].data()));
+            VERIFY_ARE_EQUAL(String(tokensExpected[i].data()), String(tokensActual[i].data(), gsl::narrow<int>(tokensActual[i].size())));
         }
     }
 
@@ -424,7 +425,7 @@ class AliasTests
 
         for (size_t i = 0; i < tokensExpected.size(); i++)
         {
-            VERIFY_ARE_EQUAL(String(tokensExpected[i].data()), String(tokensActual[i].data()));
+            VERIFY_ARE_EQUAL(String(tokensExpected[i].data()), String(tokensActual[i].data(), gsl::narrow<int>(tokensActual[i].size())));
         }
     }
 
@@ -442,7 +443,7 @@ class AliasTests
         std::wstring expected;
         _RetrieveTargetExpectedPair(target, expected);
 
-        std::wstring actual = Alias::s_GetArgString(target);
+        const std::wstring actual{ Alias::s_GetArgString(target) };
 
         VERIFY_ARE_EQUAL(String(expected.data()), String(actual.data()));
     }
@@ -470,18 +471,7 @@ class AliasTests
         std::wstring expected;
         _RetrieveTargetExpectedPair(target, expected);
 
-        std::deque<std::wstring> tokens;
-        tokens.emplace_back(L"alias");
-        tokens.emplace_back(L"one");
-        tokens.emplace_back(L"two");
-        tokens.emplace_back(L"three");
-        tokens.emplace_back(L"four");
-        tokens.emplace_back(L"five");
-        tokens.emplace_back(L"six");
-        tokens.emplace_back(L"seven");
-        tokens.emplace_back(L"eight");
-        tokens.emplace_back(L"nine");
-        tokens.emplace_back(L"ten");
+        const Alias::Tokens tokens{ L"alias", L"one", L"two", L"three", L"four", L"five", L"six", L"seven", L"eight", L"nine", L"ten" };
 
         // if we expect non-empty results, then we should get a bool back saying it was processed
         const bool returnExpected = !expected.empty();
@@ -647,4 +637,101 @@ class AliasTests
         VERIFY_ARE_EQUAL(String(expected.data()), String(actual.data()));
         VERIFY_ARE_EQUAL(lineCountExpected, lineCountActual);
     }
+
+    TEST_METHOD(AliasesAreCaseFolded)
+    {
+        Alias::s_TestAddAlias(L"Test.EXE", L"Foo", L"bar $1");
+
+        size_t lineCount = 0;
+        auto actual = Alias::s_MatchAndCopyAlias(L"FOO one\r\n", L"test.exe", lineCount);
+        VERIFY_ARE_EQUAL(String(L"bar one\r\n"), String(actual.data()));
+        VERIFY_ARE_EQUAL(1u, lineCount);
+
+        const auto alias = Alias::s_FindAlias(L"TEST.exe", L"fOO");
+        VERIFY_IS_NOT_NULL(alias);
+        VERIFY_ARE_EQUAL(String(L"bar $1"), String(alias->Text.data()));
+
+        Log::Comment(L"Setting it again in any case replaces it.");
+        Alias::s_TestAddAlias(L"test.exe", L"foo", L"baz$tqux $*");
+        actual = Alias::s_MatchAndCopyAlias(L"foo one two", L"TEST.EXE", lineCount);
+        VERIFY_ARE_EQUAL(String(L"baz\r\nqux one two\r\n"), String(actual.data()));
+        VERIFY_ARE_EQUAL(2u, lineCount);
+
+        Log::Comment(L"Setting it to nothing removes it.");
+        Alias::s_SetAlias(L"TEST.exe", L"FOO", L"");
+        VERIFY_IS_NULL(Alias::s_FindAlias(L"test.exe", L"foo"));
+        actual = Alias::s_MatchAndCopyAlias(L"foo one", L"test.exe", lineCount);
+        VERIFY_IS_TRUE(actual.empty());
+    }
+
+    TEST_METHOD(GetAliasesKeepsTheirCase)
+    {
+        Alias::s_TestAddAlias(L"Test.EXE", L"FooBar", L"Baz $1");
+
+        ApiRoutines routines;
+        std::array<wchar_t, 64> buffer;
+        size_t written = 0;
+
+        Log::Comment(L"The aliases are found by an exe name in any case, but come back in the case they were given in.");
+        const std::wstring_view expectedAliases{ L"FooBar=Baz $1" };
+        size_t needed = 0;
+        VERIFY_SUCCEEDED(routines.GetConsoleAliasesLengthWImpl(L"TEST.exe", needed));
+        VERIFY_ARE_EQUAL(expectedAliases.size() + 1, needed);
+        VERIFY_SUCCEEDED(routines.GetConsoleAliasesWImpl(L"TEST.exe", buffer, written));
+        VERIFY_ARE_EQUAL(expectedAliases.size() + 1, written);
+        VERIFY_ARE_EQUAL(String(expectedAliases.data()), String(buffer.data()));
+
+        const std::wstring_view expectedExes{ L"Test.EXE" };
+        VERIFY_SUCCEEDED(routines.GetConsoleAliasExesLengthWImpl(needed));
+        VERIFY_ARE_EQUAL(expectedExes.size() + 1, needed);
+        VERIFY_SUCCEEDED(routines.GetConsoleAliasExesWImpl(buffer, written));
+        VERIFY_ARE_EQUAL(expectedExes.size() + 1, written);
+        VERIFY_ARE_EQUAL(String(expectedExes.data()), String(buffer.data()));
+
+        Log::Comment(L"Setting the alias again in another case replaces it, names and all.");
+        Alias::s_TestAddAlias(L"test.Exe", L"FOOBAR", L"Qux");
+        VERIFY_SUCCEEDED(routines.GetConsoleAliasesWImpl(L"test.exe", buffer, written));
+        VERIFY_ARE_EQUAL(String(L"FOOBAR=Qux"), String(buffer.data()));
+        VERIFY_SUCCEEDED(routines.GetConsoleAliasExesWImpl(buffer, written));
+        VERIFY_ARE_EQUAL(String(L"test.Exe"), String(buffer.data()));
+    }
+
+    TEST_METHOD(MatchAndCopyManyAliasesPerf)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        // Doskey macro files for cmd.exe commonly carry hundreds of these.
+        constexpr size_t aliasCount = 500;
+        constexpr size_t matchCount = 100000;
+
+        std::vector<std::wstring> lines;
+        for (size_t i = 0; i < aliasCount; ++i)
+        {
+            const auto source = String().Format(L"Macro%zu", i);
+            const auto target = String().Format(L"command%zu $1 --flag $2$goutput%zu.log$tTYPE output%zu.log $b findstr $*", i, i, i);
+            Alias::s_TestAddAlias(L"cmd.exe", static_cast<const wchar_t*>(source), static_cast<const wchar_t*>(target));
+            lines.emplace_back(static_cast<const wchar_t*>(String().Format(L"macro%zu first second third\r\n", i)));
+        }
+
+        size_t totalLength = 0;
+        const auto now = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < matchCount; ++i)
+        {
+            size_t lineCount = 0;
+            totalLength += Alias::s_MatchAndCopyAlias(lines.at(i % aliasCount), L"CMD.EXE", lineCount).size();
+        }
+
+        const auto delta = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - now).count();
+
+        size_t lineCount = 0;
+        const auto actual = Alias::s_MatchAndCopyAlias(lines.at(7), L"cmd.exe", lineCount);
+        VERIFY_ARE_EQUAL(String(L"command7 first --flag second>output7.log\r\nTYPE output7.log | findstr first second third\r\n"), String(actual.data()));
+        VERIFY_ARE_EQUAL(2u, lineCount);
+        VERIFY_IS_GREATER_THAN(totalLength, 0u);
+
+        Log::Comment(String().Format(L"%zu matches against %zu aliases: %lld ns per match", matchCount, aliasCount, delta / gsl::narrow<long long>(matchCount)));
+    }
 };
@@ -865,4 +865,161 @@ class ApiRoutinesTests
 
         ValidateComplexScreen(si, background, fill, scrollRect, Viewport::FromInclusive(scroll), destination, clipViewport);
     }
+
+    TEST_METHOD(ApiWriteReadConsoleOutputW)
+    {
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+
+        const COORD size{ 10, 4 };
+        VERIFY_SUCCEEDED(si.GetTextBuffer().ResizeTraditional(size), L"Make the buffer small so this doesn't take forever.");
+
+        gci.LockConsole();
+        auto Unlock = wil::scope_exit([&] { gci.UnlockConsole(); });
+
+        // Every row has three colors, in runs of 3, 3 and 4 columns.
+        std::vector<CHAR_INFO> cells(size.X * size.Y);
+        for (size_t i = 0; i < cells.size(); ++i)
+        {
+            const auto column = i % size.X;
+            cells.at(i).Char.UnicodeChar = gsl::narrow_cast<wchar_t>(L'A' + i % 26);
+            cells.at(i).Attributes = column < 3 ? 0x07 : column < 6 ? 0x1E : 0x4F;
+        }
+
+        const auto region = Viewport::FromDimensions({ 0, 0 }, size);
+        const auto verifyBuffer = [&]() {
+            std::vector<CHAR_INFO> read(cells.size());
+            Viewport readRegion;
+            VERIFY_SUCCEEDED(_pApiRoutines->ReadConsoleOutputWImpl(si, read, region, readRegion));
+            VERIFY_ARE_EQUAL(region.ToInclusive(), readRegion.ToInclusive());
+            for (size_t i = 0; i < cells.size(); ++i)
+            {
+                VERIFY_ARE_EQUAL(cells.at(i).Char.UnicodeChar, read.at(i).Char.UnicodeChar);
+                VERIFY_ARE_EQUAL(cells.at(i).Attributes, read.at(i).Attributes);
+            }
+        };
+
+        Log::Comment(L"Write the whole buffer. Every row gets its colors as three runs.");
+        Viewport written;
+        VERIFY_SUCCEEDED(_pApiRoutines->WriteConsoleOutputWImpl(si, cells, region, written));
+        VERIFY_ARE_EQUAL(region.ToInclusive(), written.ToInclusive());
+        for (SHORT row = 0; row < size.Y; ++row)
+        {
+            VERIFY_ARE_EQUAL(3u, si.GetTextBuffer().GetRowByOffset(row).GetAttrRow().GetNumberOfRuns());
+        }
+        verifyBuffer();
+
+        Log::Comment(L"Rows match the cells they were written from, and no others.");
+        const auto changedSpans = [&](const SHORT row, const SHORT from) {
+            const std::basic_string_view<CHAR_INFO> rowCells{ cells.data() + from * size.X, gsl::narrow<size_t>(size.X) };
+            return si.GetTextBuffer().GetRowByOffset(row).GetChangedSpans(OutputCellIterator{ rowCells }, 0);
+        };
+        VERIFY_IS_TRUE(changedSpans(2, 2).empty());
+        auto spans = changedSpans(1, 2);
+        VERIFY_ARE_EQUAL(1u, spans.size());
+        VERIFY_ARE_EQUAL(0u, spans.at(0).first);
+        VERIFY_ARE_EQUAL(10u, spans.at(0).second);
+
+        Log::Comment(L"Change the color of one cell and the text of another. Only those are written again.");
+        cells.at(2 * size.X + 4).Attributes = 0x2A;
+        cells.at(3 * size.X + 9).Char.UnicodeChar = L'z';
+        spans = changedSpans(2, 2);
+        VERIFY_ARE_EQUAL(1u, spans.size());
+        VERIFY_ARE_EQUAL(4u, spans.at(0).first);
+        VERIFY_ARE_EQUAL(5u, spans.at(0).second);
+        spans = changedSpans(3, 3);
+        VERIFY_ARE_EQUAL(1u, spans.size());
+        VERIFY_ARE_EQUAL(9u, spans.at(0).first);
+        VERIFY_ARE_EQUAL(10u, spans.at(0).second);
+        VERIFY_SUCCEEDED(_pApiRoutines->WriteConsoleOutputWImpl(si, cells, region, written));
+        VERIFY_ARE_EQUAL(5u, si.GetTextBuffer().GetRowByOffset(2).GetAttrRow().GetNumberOfRuns());
+        verifyBuffer();
+
+        Log::Comment(L"A rectangle hanging off the top left is clipped, and the rest of it lands in the corner.");
+        std::vector<CHAR_INFO> corner(4, CHAR_INFO{ { L'#' }, 0x5D });
+        VERIFY_SUCCEEDED(_pApiRoutines->WriteConsoleOutputWImpl(si, corner, Viewport::FromDimensions({ -1, -1 }, { 2, 2 }), written));
+        VERIFY_ARE_EQUAL(Viewport::FromDimensions({ 0, 0 }, { 1, 1 }).ToInclusive(), written.ToInclusive());
+        cells.at(0) = corner.at(3);
+        verifyBuffer();
+
+        Log::Comment(L"A changed half of a double byte character takes the other half along.");
+        cells.at(size.X + 5) = CHAR_INFO{ { L'\x3042' }, gsl::narrow_cast<WORD>(0x1E | COMMON_LVB_LEADING_BYTE) };
+        cells.at(size.X + 6) = CHAR_INFO{ { L'\x3042' }, gsl::narrow_cast<WORD>(0x4F | COMMON_LVB_TRAILING_BYTE) };
+        spans = changedSpans(1, 1);
+        VERIFY_ARE_EQUAL(1u, spans.size());
+        VERIFY_ARE_EQUAL(5u, spans.at(0).first);
+        VERIFY_ARE_EQUAL(7u, spans.at(0).second);
+        VERIFY_SUCCEEDED(_pApiRoutines->WriteConsoleOutputWImpl(si, cells, region, written));
+        VERIFY_IS_TRUE(changedSpans(1, 1).empty());
+        verifyBuffer();
+    }
+
+    TEST_METHOD(ApiWriteReadConsoleOutputWPerf)
+    {
+        // Full screen apps like file managers draw the whole screen with WriteConsoleOutput
+        // every frame, and some read it all back, but only a few rows change between frames.
+
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES();
+
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+
+        const COORD size{ 240, 80 };
+        VERIFY_SUCCEEDED(si.GetTextBuffer().ResizeTraditional(size));
+
+        gci.LockConsole();
+        auto Unlock = wil::scope_exit([&] { gci.UnlockConsole(); });
+
+        // Two panels of file names with a highlighted line in one of them.
+        std::vector<CHAR_INFO> cells(size.X * size.Y);
+        const auto paintRow = [&](const SHORT row, const bool selected) {
+            for (SHORT column = 0; column < size.X; ++column)
+            {
+                auto& cell = cells.at(row * size.X + column);
+                cell.Char.UnicodeChar = column % (size.X / 2) == 0 ? L'|' : gsl::narrow_cast<wchar_t>(L'a' + (row + column) % 26);
+                cell.Attributes = selected && column < size.X / 2 ? 0x30 : column % 12 < 8 ? 0x1B : 0x1F;
+            }
+        };
+        for (SHORT row = 0; row < size.Y; ++row)
+        {
+            paintRow(row, false);
+        }
+
+        const auto region = Viewport::FromDimensions({ 0, 0 }, size);
+        std::vector<CHAR_INFO> read(cells.size());
+        const auto frames = 200;
+
+        Log::Comment(L"Working. Please wait...");
+        const auto now = std::chrono::steady_clock::now();
+
+        for (auto frame = 0; frame < frames; ++frame)
+        {
+            // Move the highlight down a line.
+            const auto selected = gsl::narrow_cast<SHORT>(frame % size.Y);
+            paintRow(gsl::narrow_cast<SHORT>((selected + size.Y - 1) % size.Y), false);
+            paintRow(selected, true);
+
+            Viewport written;
+            VERIFY_SUCCEEDED(_pApiRoutines->WriteConsoleOutputWImpl(si, cells, region, written));
+            Viewport readRegion;
+            VERIFY_SUCCEEDED(_pApiRoutines->ReadConsoleOutputWImpl(si, read, region, readRegion));
+        }
+
+        const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+
+        for (size_t i = 0; i < cells.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(cells.at(i).Char.UnicodeChar, read.at(i).Char.UnicodeChar);
+            VERIFY_ARE_EQUAL(cells.at(i).Attributes, read.at(i).Attributes);
+        }
+
+        Log::Comment(WEX::Common::String().Format(L"%d frames of %dx%d written and read back took %lld us. Avg %lld us per frame",
+                                                  frames,
+                                                  size.X,
+                                                  size.Y,
+                                                  delta,
+                                                  delta / frames));
+    }
 };
@@ -0,0 +1,540 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "..\..\inc\consoletaeftemplates.hpp"
+
+#include "CommonState.hpp"
+
+#include "ApiRoutines.h"
+#include "ApiLatency.hpp"
+
+#include "..\server\IoSorter.h"
+#include "..\server\IWaitRoutine.h"
+#include "..\server\ReplayDeviceComm.h"
+#include "..\server\WaitQueue.h"
+
+#include "..\interactivity\inc\ServiceLocator.hpp"
+
+#include <condition_variable>
+#include <mutex>
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using Microsoft::Console::Interactivity::ServiceLocator;
+
+// The layer and the index of the call within it. See ApiSorter.
+static constexpr ULONG ApiNumberGetConsoleCP = 0x01000000;
+static constexpr ULONG ApiNumberReadConsole = 0x01000005;
+static constexpr ULONG ApiNumberWriteConsole = 0x01000006;
+static constexpr ULONG ApiNumberSetConsoleCP = 0x02000004;
+static constexpr ULONG ApiNumberSetConsoleCursorPosition = 0x0200000A;
+static constexpr ULONG ApiNumberReadConsoleOutput = 0x02000013;
+
+// Stands in for the console driver. The messages that were posted are handed out in order, to
+// whichever IO thread asks first, and the replies are kept for the test to look at.
+class MessageQueueDeviceComm final : public IDeviceComm
+{
+public:
+    struct Reply
+    {
+        ULONG identifier;
+        NTSTATUS status;
+        std::vector<BYTE> payload;
+    };
+
+    void Post(const CONSOLE_API_MSG& message)
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        _messages.push_back(message);
+        _posted.notify_one();
+    }
+
+    // Once the posted messages are gone, the IO threads are told the driver disconnected.
+    void Disconnect()
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        _disconnected = true;
+        _posted.notify_all();
+    }
+
+    std::vector<Reply> GetReplies() const
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        return _replies;
+    }
+
+    [[nodiscard]] HRESULT SetServerInformation(_In_ CD_IO_SERVER_INFORMATION* const /*pServerInfo*/) const override
+    {
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT ReadIo(_In_opt_ PCONSOLE_API_MSG const pReplyMsg,
+                                 _Out_ CONSOLE_API_MSG* const pMessage) const override
+    {
+        std::unique_lock<std::mutex> lock{ _mutex };
+        if (pReplyMsg != nullptr)
+        {
+            _Complete(pReplyMsg->Complete);
+        }
+
+        _posted.wait(lock, [&] { return !_messages.empty() || _disconnected; });
+        if (_messages.empty())
+        {
+            return HRESULT_FROM_WIN32(ERROR_PIPE_NOT_CONNECTED);
+        }
+
+        // Only the packet data travels, like it does through the driver.
+        memcpy(&pMessage->Descriptor,
+               &_messages.front().Descriptor,
+               sizeof(CONSOLE_API_MSG) - FIELD_OFFSET(CONSOLE_API_MSG, Descriptor));
+        _messages.pop_front();
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT CompleteIo(_In_ CD_IO_COMPLETE* const pCompletion) const override
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        _Complete(*pCompletion);
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT ReadInput(_In_ CD_IO_OPERATION* const /*pIoOperation*/) const override
+    {
+        return E_NOTIMPL;
+    }
+
+    [[nodiscard]] HRESULT WriteOutput(_In_ CD_IO_OPERATION* const /*pIoOperation*/) const override
+    {
+        return E_NOTIMPL;
+    }
+
+    [[nodiscard]] HRESULT AllowUIAccess() const override
+    {
+        return S_OK;
+    }
+
+private:
+    mutable std::mutex _mutex;
+    mutable std::condition_variable _posted;
+    mutable std::deque<CONSOLE_API_MSG> _messages;
+    mutable std::vector<Reply> _replies;
+    bool _disconnected = false;
+
+    void _Complete(const CD_IO_COMPLETE& completion) const
+    {
+        const auto data = static_cast<const BYTE*>(completion.Write.Data);
+        _replies.push_back({ completion.Identifier.LowPart,
+                             completion.IoStatus.Status,
+                             { data, data + completion.Write.Size } });
+    }
+};
+
+// Stands in for a read that waits for data on a handle. Like a real one, it holds the read count of the
+// handle up while it waits. Data never satisfies it, only being told to terminate does.
+class TerminatingReadWaiter final : public IWaitRoutine
+{
+public:
+    TerminatingReadWaiter(_In_ INPUT_READ_HANDLE_DATA* const pReadHandleData, size_t& notifyCount) :
+        IWaitRoutine(ReplyDataType::Read),
+        _pReadHandleData(pReadHandleData),
+        _notifyCount(notifyCount)
+    {
+        _pReadHandleData->IncrementReadCount();
+    }
+
+    ~TerminatingReadWaiter() override
+    {
+        _pReadHandleData->DecrementReadCount();
+    }
+
+    bool Notify(const WaitTerminationReason TerminationReason,
+                const bool /*fIsUnicode*/,
+                _Out_ NTSTATUS* const pReplyStatus,
+                _Out_ size_t* const pNumBytes,
+                _Out_ DWORD* const pControlKeyState,
+                _Out_ void* const /*pOutputData*/) override
+    {
+        ++_notifyCount;
+        *pReplyStatus = STATUS_ALERTED;
+        *pNumBytes = 0;
+        *pControlKeyState = 0;
+        return TerminationReason != WaitTerminationReason::NoReason;
+    }
+
+private:
+    INPUT_READ_HANDLE_DATA* const _pReadHandleData;
+    size_t& _notifyCount;
+};
+
+class ApiServerTests
+{
+    TEST_CLASS(ApiServerTests);
+
+    TEST_METHOD(SharedLockAdmitsReaders)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        gci.LockConsoleShared();
+        VERIFY_IS_TRUE(gci.IsConsoleLocked());
+
+        bool otherReaderGotIn = false;
+        bool otherWriterGotIn = true;
+        std::thread other{ [&] {
+            gci.LockConsoleShared();
+            otherReaderGotIn = gci.IsConsoleLocked();
+            gci.UnlockConsoleShared();
+
+            otherWriterGotIn = gci.TryLockConsole();
+            if (otherWriterGotIn)
+            {
+                gci.UnlockConsole();
+            }
+        } };
+        other.join();
+
+        Log::Comment(L"Another reader can come in, but a writer can't.");
+        VERIFY_IS_TRUE(otherReaderGotIn);
+        VERIFY_IS_FALSE(otherWriterGotIn);
+
+        gci.UnlockConsoleShared();
+        VERIFY_IS_FALSE(gci.IsConsoleLocked());
+
+        std::thread writer{ [&] {
+            otherWriterGotIn = gci.TryLockConsole();
+            if (otherWriterGotIn)
+            {
+                gci.UnlockConsole();
+            }
+        } };
+        writer.join();
+
+        Log::Comment(L"Once the reader is gone, the writer can come in.");
+        VERIFY_IS_TRUE(otherWriterGotIn);
+    }
+
+    TEST_METHOD(SharedLockNestsInExclusiveLock)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        gci.LockConsole();
+        VERIFY_ARE_EQUAL(1ul, gci.GetCSRecursionCount());
+
+        gci.LockConsoleShared();
+        VERIFY_ARE_EQUAL(2ul, gci.GetCSRecursionCount());
+        gci.UnlockConsoleShared();
+
+        Log::Comment(L"Reading under an exclusive lock leaves it exclusive.");
+        VERIFY_ARE_EQUAL(1ul, gci.GetCSRecursionCount());
+        VERIFY_IS_TRUE(gci.IsConsoleLocked());
+
+        gci.UnlockConsole();
+        VERIFY_ARE_EQUAL(0ul, gci.GetCSRecursionCount());
+        VERIFY_IS_FALSE(gci.IsConsoleLocked());
+    }
+
+    TEST_METHOD(IoThreadsServiceEveryMessage)
+    {
+        auto& globals = ServiceLocator::LocateGlobals();
+        auto& gci = globals.getConsoleInformation();
+
+        MessageQueueDeviceComm deviceComm;
+        ApiRoutines routines;
+
+        // Waits complete their IO through the globals rather than through the message.
+        const auto savedDeviceComm = std::exchange(globals.pDeviceComm, &deviceComm);
+        const auto savedCodepage = gci.CP;
+        auto restore = wil::scope_exit([&] {
+            globals.pDeviceComm = savedDeviceComm;
+            gci.CP = savedCodepage;
+        });
+
+        const std::array<ULONG, 2> codepages{ 437u, 850u };
+        const ULONG messageCount = 200;
+        for (ULONG i = 0; i < messageCount; ++i)
+        {
+            CONSOLE_API_MSG message;
+            message.Descriptor.Identifier.LowPart = i;
+            message.Descriptor.Function = CONSOLE_IO_USER_DEFINED;
+            if (i % 4 == 0)
+            {
+                message.msgHeader.ApiNumber = ApiNumberSetConsoleCP;
+                message.msgHeader.ApiDescriptorSize = sizeof(CONSOLE_SETCP_MSG);
+                message.u.consoleMsgL2.SetConsoleCP.CodePage = codepages.at((i / 4) % codepages.size());
+            }
+            else
+            {
+                message.msgHeader.ApiNumber = ApiNumberGetConsoleCP;
+                message.msgHeader.ApiDescriptorSize = sizeof(CONSOLE_GETCP_MSG);
+            }
+            message.Descriptor.InputSize = sizeof(CONSOLE_MSG_HEADER) + message.msgHeader.ApiDescriptorSize;
+            deviceComm.Post(message);
+        }
+        deviceComm.Disconnect();
+
+        std::array<HRESULT, 4> results;
+        std::vector<std::thread> threads;
+        for (auto& result : results)
+        {
+            threads.emplace_back([&] { result = IoSorter::ServiceIo(deviceComm, routines); });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (const auto result : results)
+        {
+            VERIFY_ARE_EQUAL(HRESULT_FROM_WIN32(ERROR_PIPE_NOT_CONNECTED), result);
+        }
+
+        Log::Comment(L"Every message got exactly one reply.");
+        auto replies = deviceComm.GetReplies();
+        VERIFY_ARE_EQUAL(messageCount, gsl::narrow<ULONG>(replies.size()));
+        std::sort(replies.begin(), replies.end(), [](const auto& a, const auto& b) { return a.identifier < b.identifier; });
+        for (ULONG i = 0; i < messageCount; ++i)
+        {
+            const auto& reply = replies.at(i);
+            VERIFY_ARE_EQUAL(i, reply.identifier);
+            VERIFY_ARE_EQUAL(STATUS_SUCCESS, static_cast<DWORD>(reply.status));
+
+            if (i % 4 != 0)
+            {
+                Log::Comment(L"A read sees the code page from before the writes, or one of the written ones.");
+                CONSOLE_GETCP_MSG got;
+                VERIFY_ARE_EQUAL(sizeof(got), reply.payload.size());
+                memcpy(&got, reply.payload.data(), sizeof(got));
+                VERIFY_IS_TRUE(got.CodePage == savedCodepage ||
+                               std::find(codepages.cbegin(), codepages.cend(), got.CodePage) != codepages.cend());
+            }
+        }
+    }
+
+    TEST_METHOD(LatencyHistogramKeepsRelativeError)
+    {
+        Log::Comment(L"Small values have a bucket each.");
+        for (uint64_t value = 0; value < LatencyHistogram::SubBucketCount; ++value)
+        {
+            VERIFY_ARE_EQUAL(value, LatencyHistogram::s_HighestValueIn(LatencyHistogram::s_BucketOf(value)));
+        }
+
+        Log::Comment(L"Larger values are reported at most 1 part in 32 too high.");
+        for (uint64_t value = LatencyHistogram::SubBucketCount; value <= LatencyHistogram::MaxValue; value = value * 3 / 2 + 1)
+        {
+            const auto bucket = LatencyHistogram::s_BucketOf(value);
+            VERIFY_IS_LESS_THAN(bucket, LatencyHistogram::BucketCount);
+
+            const auto reported = LatencyHistogram::s_HighestValueIn(bucket);
+            VERIFY_IS_GREATER_THAN_OR_EQUAL(reported, value);
+            VERIFY_IS_LESS_THAN_OR_EQUAL(reported - value, value / LatencyHistogram::SubBucketHalfCount);
+        }
+        VERIFY_ARE_EQUAL(LatencyHistogram::BucketCount - 1, LatencyHistogram::s_BucketOf(LatencyHistogram::MaxValue));
+
+        LatencyHistogram histogram;
+        for (int i = 1; i <= 100; ++i)
+        {
+            histogram.Record(std::chrono::microseconds{ i });
+        }
+        VERIFY_ARE_EQUAL(100ull, histogram.GetCount());
+
+        Log::Comment(L"The median is the 50th value, give or take the error of its bucket.");
+        const auto median = histogram.GetValueAtPercentile(50).count();
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(median, 50000ll);
+        VERIFY_IS_LESS_THAN_OR_EQUAL(median, 50000ll + 50000ll / 32);
+
+        Log::Comment(L"The 100th percentile is the max, exactly.");
+        VERIFY_ARE_EQUAL(100000ll, histogram.GetMax().count());
+        VERIFY_ARE_EQUAL(100000ll, histogram.GetValueAtPercentile(100).count());
+
+        histogram.Reset();
+        VERIFY_ARE_EQUAL(0ull, histogram.GetCount());
+        VERIFY_ARE_EQUAL(0ll, histogram.GetValueAtPercentile(50).count());
+    }
+
+    TEST_METHOD(ReplayMeasuresLatencyPerApi)
+    {
+        CommonState state;
+        state.PrepareGlobalFont();
+        state.PrepareGlobalScreenBuffer();
+        state.PrepareGlobalInputBuffer();
+        auto cleanupState = wil::scope_exit([&] {
+            state.CleanupGlobalInputBuffer();
+            state.CleanupGlobalScreenBuffer();
+            state.CleanupGlobalFont();
+        });
+
+        auto& globals = ServiceLocator::LocateGlobals();
+        auto& gci = globals.getConsoleInformation();
+        auto& screenInfo = gci.GetActiveOutputBuffer();
+
+        // The recorded messages come from this process, writing to the screen buffer.
+        ConsoleProcessHandle* process = nullptr;
+        std::unique_ptr<ConsoleHandleData> output;
+        gci.LockConsole();
+        VERIFY_SUCCEEDED(gci.ProcessHandleList.AllocProcessData(GetCurrentProcessId(), GetCurrentThreadId(), 0, nullptr, &process));
+        VERIFY_SUCCEEDED(screenInfo.AllocateIoHandle(ConsoleHandleData::HandleType::Output,
+                                                     GENERIC_READ | GENERIC_WRITE,
+                                                     FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                                     output));
+        gci.UnlockConsole();
+        auto cleanupHandles = wil::scope_exit([&] {
+            gci.LockConsole();
+            // Closing the handle would remove the screen buffer, which belongs to the common state.
+            LOG_IF_FAILED(screenInfo.FreeIoHandle(output.get()));
+            output.release();
+            gci.ProcessHandleList.FreeProcessData(process);
+            gci.UnlockConsole();
+        });
+
+        static constexpr ULONG_PTR RecordedProcess = 0x1000;
+        static constexpr ULONG_PTR RecordedOutput = 0x2000;
+        static constexpr SHORT CellsRead = 10;
+
+        std::vector<ReplayDeviceComm::Record> records;
+
+        CONSOLE_WRITECONSOLE_MSG writeConsole{};
+        writeConsole.Unicode = TRUE;
+        const std::wstring_view text{ L"The quick brown fox jumps over the lazy dog.\r\n" };
+        const gsl::span<const BYTE> textBytes{ reinterpret_cast<const BYTE*>(text.data()),
+                                               gsl::narrow<ptrdiff_t>(text.size() * sizeof(wchar_t)) };
+        records.push_back(ReplayDeviceComm::s_MakeUserDefined(ApiNumberWriteConsole, &writeConsole, sizeof(writeConsole), textBytes, 0));
+
+        CONSOLE_SETCURSORPOSITION_MSG setCursorPosition{};
+        setCursorPosition.CursorPosition = { 0, 0 };
+        records.push_back(ReplayDeviceComm::s_MakeUserDefined(ApiNumberSetConsoleCursorPosition, &setCursorPosition, sizeof(setCursorPosition), {}, 0));
+
+        CONSOLE_READCONSOLEOUTPUT_MSG readConsoleOutput{};
+        readConsoleOutput.CharRegion = { 0, 0, CellsRead - 1, 0 };
+        readConsoleOutput.Unicode = TRUE;
+        records.push_back(ReplayDeviceComm::s_MakeUserDefined(ApiNumberReadConsoleOutput, &readConsoleOutput, sizeof(readConsoleOutput), {}, CellsRead * sizeof(CHAR_INFO)));
+
+        for (auto& record : records)
+        {
+            record.Packet.Descriptor.Process = RecordedProcess;
+            record.Packet.Descriptor.Object = RecordedOutput;
+        }
+
+        const ULONG passes = 100;
+        ReplayDeviceComm deviceComm{ std::move(records), passes };
+        deviceComm.MapProcess(RecordedProcess, process);
+        deviceComm.MapObject(RecordedOutput, output.get());
+
+        ApiRoutines routines;
+        const auto savedDeviceComm = std::exchange(globals.pDeviceComm, &deviceComm);
+        ApiLatency::s_Reset();
+        ApiLatency::s_SetEnabled(true);
+        auto restore = wil::scope_exit([&] {
+            ApiLatency::s_SetEnabled(false);
+            globals.pDeviceComm = savedDeviceComm;
+        });
+
+        VERIFY_ARE_EQUAL(HRESULT_FROM_WIN32(ERROR_PIPE_NOT_CONNECTED), IoSorter::ServiceIo(deviceComm, routines));
+
+        Log::Comment(L"Every replayed call succeeded.");
+        VERIFY_ARE_EQUAL(3 * passes, gsl::narrow<ULONG>(deviceComm.GetCompletedCount()));
+        VERIFY_ARE_EQUAL(0ul, gsl::narrow<ULONG>(deviceComm.GetFailedCount()));
+        VERIFY_ARE_EQUAL(passes * CellsRead * sizeof(CHAR_INFO), deviceComm.GetOutputBytes());
+
+        Log::Comment(L"Every call was measured, under the trace name of its API.");
+        const auto histograms = ApiLatency::s_Snapshot();
+        for (const auto api : { "WriteConsole", "SetConsoleCursorPosition", "ReadConsoleOutput" })
+        {
+            const auto histogram = histograms.find(api);
+            VERIFY_IS_TRUE(histogram != histograms.end());
+            VERIFY_ARE_EQUAL(static_cast<uint64_t>(passes), histogram->second.GetCount());
+
+            const auto median = histogram->second.GetValueAtPercentile(50);
+            const auto tail = histogram->second.GetValueAtPercentile(99);
+            VERIFY_IS_LESS_THAN_OR_EQUAL(median.count(), tail.count());
+            VERIFY_IS_LESS_THAN_OR_EQUAL(tail.count(), histogram->second.GetMax().count());
+
+            Log::Comment(NoThrowString().Format(L"%hs: median %lldns, 99th percentile %lldns, max %lldns",
+                                                api,
+                                                median.count(),
+                                                tail.count(),
+                                                histogram->second.GetMax().count()));
+        }
+    }
+
+    TEST_METHOD(ClosingAHandleOnlyWakesTheReadsWaitingOnIt)
+    {
+        CommonState state;
+        state.PrepareGlobalInputBuffer();
+        auto cleanupState = wil::scope_exit([&] { state.CleanupGlobalInputBuffer(); });
+
+        auto& globals = ServiceLocator::LocateGlobals();
+        auto& gci = globals.getConsoleInformation();
+
+        MessageQueueDeviceComm deviceComm;
+        const auto savedDeviceComm = std::exchange(globals.pDeviceComm, &deviceComm);
+        auto restore = wil::scope_exit([&] { globals.pDeviceComm = savedDeviceComm; });
+
+        gci.LockConsole();
+        auto unlock = wil::scope_exit([&] { gci.UnlockConsole(); });
+
+        static constexpr size_t HandleCount = 16;
+        static constexpr size_t WaitsPerHandle = 32;
+
+        ConsoleProcessHandle* process = nullptr;
+        std::vector<std::unique_ptr<ConsoleHandleData>> inputs(HandleCount);
+        VERIFY_SUCCEEDED(gci.ProcessHandleList.AllocProcessData(GetCurrentProcessId(), GetCurrentThreadId(), 0, nullptr, &process));
+        for (auto& input : inputs)
+        {
+            VERIFY_SUCCEEDED(gci.pInputBuffer->AllocateIoHandle(ConsoleHandleData::HandleType::Input,
+                                                                GENERIC_READ | GENERIC_WRITE,
+                                                                FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                                                input));
+        }
+        auto cleanupHandles = wil::scope_exit([&] {
+            // Closing the handles that are left alerts the reads that are left.
+            inputs.clear();
+            gci.ProcessHandleList.FreeProcessData(process);
+        });
+
+        Log::Comment(L"Queue reads on every handle, interleaved, as if that many clients were blocked in ReadConsole.");
+        size_t notifyCount = 0;
+        for (size_t i = 0; i < HandleCount * WaitsPerHandle; ++i)
+        {
+            const auto& input = inputs.at(i % HandleCount);
+
+            CONSOLE_API_MSG message;
+            message.Descriptor.Identifier.LowPart = gsl::narrow<DWORD>(i);
+            message.Complete.Identifier = message.Descriptor.Identifier;
+            message.Descriptor.Process = reinterpret_cast<ULONG_PTR>(process);
+            message.Descriptor.Object = reinterpret_cast<ULONG_PTR>(input.get());
+            message.msgHeader.ApiNumber = ApiNumberReadConsole;
+            VERIFY_SUCCEEDED(ConsoleWaitQueue::s_CreateWait(&message, new TerminatingReadWaiter(input->GetClientInput(), notifyCount)));
+        }
+
+        Log::Comment(L"Input arriving only tries the read at the head of the queue.");
+        VERIFY_IS_FALSE(gci.pInputBuffer->WaitQueue.NotifyWaiters(false));
+        VERIFY_ARE_EQUAL(1u, notifyCount);
+        VERIFY_IS_TRUE(deviceComm.GetReplies().empty());
+        notifyCount = 0;
+
+        Log::Comment(L"Closing a handle alerts the reads waiting on it, in the order they were queued, and no others.");
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t closed = 0; closed < HandleCount; ++closed)
+        {
+            inputs.at(closed).reset();
+
+            VERIFY_ARE_EQUAL((closed + 1) * WaitsPerHandle, notifyCount);
+            const auto replies = deviceComm.GetReplies();
+            VERIFY_ARE_EQUAL((closed + 1) * WaitsPerHandle, replies.size());
+            for (size_t i = 0; i < WaitsPerHandle; ++i)
+            {
+                const auto& reply = replies.at(closed * WaitsPerHandle + i);
+                VERIFY_ARE_EQUAL(gsl::narrow<ULONG>(i * HandleCount + closed), reply.identifier);
+                VERIFY_ARE_EQUAL(STATUS_ALERTED, reply.status);
+            }
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        Log::Comment(NoThrowString().Format(L"Closed %zu handles with %zu waiting reads each in %lldus",
+                                            HandleCount,
+                                            WaitsPerHandle,
+                                            std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+    }
+};
@@ -78,11 +78,35 @@ class AttrRowTests
     TextAttribute _DefaultAttr = TextAttribute(__wDefaultAttr);
     TextAttribute _DefaultChainAttr = TextAttribute(__wDefaultChainAttr);
 
+    TextAttributeTable _table;
+
+    // ATTR_ROW stores its runs as ids into the attribute table. These let us
+    // set up and inspect rows in terms of the attributes themselves.
+    void SetRuns(ATTR_ROW& row, const std::vector<TextAttributeRun>& runs)
+    {
+        row._list.clear();
+        for (const auto& run : runs)
+        {
+            row._list.push_back(TextAttributeIdRun(run.GetLength(), row._table->Intern(run.GetAttributes())));
+        }
+        row._UpdateRunEnds();
+    }
+
+    std::vector<TextAttributeRun> GetRuns(const ATTR_ROW& row)
+    {
+        std::vector<TextAttributeRun> runs;
+        for (const auto& run : row._list)
+        {
+            runs.emplace_back(run.GetLength(), row._table->Get(run.GetAttributeId()));
+        }
+        return runs;
+    }
+
     TEST_CLASS(AttrRowTests);
 
     TEST_METHOD_SETUP(MethodSetup)
     {
-        pSingle = new ATTR_ROW(_sDefaultLength, _DefaultAttr);
+        pSingle = new ATTR_ROW(_sDefaultLength, _DefaultAttr, _table);
 
         // Segment length is the expected length divided by the row length
         // E.g. row of 80, 4 segments, 20 segment length each
@@ -102,13 +126,13 @@ class AttrRowTests
         }
 
         // Create the chain
-        pChain = new ATTR_ROW(_sDefaultLength, _DefaultAttr);
-        pChain->_list.resize(sChainSegmentsNeeded);
+        pChain = new ATTR_ROW(_sDefaultLength, _DefaultAttr, _table);
+        std::vector<TextAttributeRun> chain(sChainSegmentsNeeded);
 
         // Attach all chain segments that are even multiples of the row length
         for (short iChain = 0; iChain < _sDefaultChainLength; iChain++)
         {
-            TextAttributeRun* pRun = &pChain->_list[iChain];
+            TextAttributeRun* pRun = &chain[iChain];
 
             pRun->SetAttributesFromLegacy(iChain); // Just use the chain position as the value
             pRun->SetLength(sChainSegLength);
@@ -118,12 +142,14 @@ class AttrRowTests
         {
             // If we had a leftover, then this chain is one longer than we expected (the default length)
             // So use it as the index (because indices start at 0)
-            TextAttributeRun* pRun = &pChain->_list[_sDefaultChainLength];
+            TextAttributeRun* pRun = &chain[_sDefaultChainLength];
 
             pRun->SetAttributes(_DefaultChainAttr);
             pRun->SetLength(sChainLeftover);
         }
 
+        SetRuns(*pChain, chain);
+
         return true;
     }
 
@@ -152,7 +178,7 @@ class AttrRowTests
             pUnderTest->Reset(attr);
 
             VERIFY_ARE_EQUAL(pUnderTest->_list.size(), 1u);
-            VERIFY_ARE_EQUAL(pUnderTest->_list[0].GetAttributes(), attr);
+            VERIFY_ARE_EQUAL(GetRuns(*pUnderTest)[0].GetAttributes(), attr);
             VERIFY_ARE_EQUAL(pUnderTest->_list[0].GetLength(), (unsigned int)_sDefaultLength);
         }
     }
@@ -266,16 +292,17 @@ class AttrRowTests
 
         // Set up our "original row" that we are going to try to insert into.
         // This will represent a 10 column run of R3->B5->G2 that we will use for all tests.
-        ATTR_ROW originalRow{ static_cast<UINT>(_sDefaultLength), _DefaultAttr };
-        originalRow._list.resize(3);
+        ATTR_ROW originalRow{ static_cast<UINT>(_sDefaultLength), _DefaultAttr, _table };
+        std::vector<TextAttributeRun> original(3);
         originalRow._cchRowWidth = 10;
-        originalRow._list[0].SetAttributesFromLegacy('R');
-        originalRow._list[0].SetLength(3);
-        originalRow._list[1].SetAttributesFromLegacy('B');
-        originalRow._list[1].SetLength(5);
-        originalRow._list[2].SetAttributesFromLegacy('G');
-        originalRow._list[2].SetLength(2);
-        LogChain(L"Original: ", originalRow._list);
+        original[0].SetAttributesFromLegacy('R');
+        original[0].SetLength(3);
+        original[1].SetAttributesFromLegacy('B');
+        original[1].SetLength(5);
+        original[2].SetAttributesFromLegacy('G');
+        original[2].SetLength(2);
+        SetRuns(originalRow, original);
+        LogChain(L"Original: ", original);
 
         // Set up our "insertion run"
         size_t cInsertRow = 1;
@@ -352,12 +379,14 @@ class AttrRowTests
         std::vector<TextAttributeRun> packedRunExpected;
         std::copy_n(packedRun.get(), cPackedRun, std::back_inserter(packedRunExpected));
 
+        auto actual = GetRuns(originalRow);
+
         LogChain(L"Expected: ", packedRunExpected);
-        LogChain(L"Actual: ", originalRow._list);
+        LogChain(L"Actual: ", actual);
 
         for (size_t testIndex = 0; testIndex < cPackedRun; testIndex++)
         {
-            VERIFY_ARE_EQUAL(packedRun[testIndex], originalRow._list[testIndex]);
+            VERIFY_ARE_EQUAL(packedRun[testIndex], actual[testIndex]);
         }
     }
 
@@ -451,6 +480,51 @@ class AttrRowTests
         }
     }
 
+    TEST_METHOD(TestInsertAttrRunsManyRuns)
+    {
+        // Runs are looked up from the end of the row closer to the column. Make sure
+        // both ends find the right run in a row with lots of them, as we splice runs in and out.
+        const UINT width = 120;
+        ATTR_ROW row{ width, _DefaultAttr, _table };
+        std::vector<TextAttribute> expected(width, _DefaultAttr);
+
+        const auto insert = [&](const UINT start, const UINT length, const TextAttribute attr) {
+            const TextAttributeRun run(length, attr);
+            VERIFY_SUCCEEDED(row.InsertAttrRuns({ &run, 1 }, start, start + length - 1, width));
+            std::fill_n(expected.begin() + start, length, attr);
+
+            for (UINT col = 0; col < width; col++)
+            {
+                VERIFY_ARE_EQUAL(expected.at(col), row.GetAttrByColumn(col));
+            }
+            VERIFY_ARE_EQUAL(ATTR_ROW::PackAttrs(expected).size(), row.GetNumberOfRuns());
+        };
+
+        Log::Comment(L"Stripe the row with alternating single columns.");
+        for (UINT col = 0; col < width; col += 2)
+        {
+            insert(col, 1, TextAttribute(FOREGROUND_RED));
+        }
+        VERIFY_ARE_EQUAL(static_cast<size_t>(width), row.GetNumberOfRuns());
+
+        Log::Comment(L"Cover several runs at once, starting and ending in the middle of runs.");
+        insert(11, 7, TextAttribute(FOREGROUND_GREEN));
+
+        Log::Comment(L"Cover runs so that the insertion merges with both neighbors.");
+        insert(31, 7, TextAttribute(FOREGROUND_RED));
+
+        Log::Comment(L"Split a run in the middle.");
+        insert(14, 1, TextAttribute(FOREGROUND_BLUE));
+
+        Log::Comment(L"Do the same in the right half of the row, which is searched from the right.");
+        insert(81, 7, TextAttribute(FOREGROUND_GREEN));
+        insert(84, 1, TextAttribute(FOREGROUND_BLUE));
+
+        Log::Comment(L"Insert at both ends of the row.");
+        insert(0, 3, TextAttribute(FOREGROUND_BLUE));
+        insert(width - 3, 3, TextAttribute(FOREGROUND_GREEN));
+    }
+
     TEST_METHOD(TestUnpackAttrs)
     {
         Log::Comment(L"Checking unpack of a single color for the entire length");
@@ -539,29 +613,31 @@ class AttrRowTests
         Log::Comment(L"Reverse iterate through ubuntu prompt");
         {
             // Create attr row representing a buffer that's 121 wide.
-            auto chain = std::make_unique<ATTR_ROW>(121, _DefaultAttr);
+            auto chain = std::make_unique<ATTR_ROW>(121, _DefaultAttr, _table);
 
             // The repro case had 4 chain segments.
-            chain->_list.resize(4);
+            std::vector<TextAttributeRun> runs(4);
 
             // The color 10 went for the first 18.
-            chain->_list[0].SetAttributes(TextAttribute(0xA));
-            chain->_list[0].SetLength(18);
+            runs[0].SetAttributes(TextAttribute(0xA));
+            runs[0].SetLength(18);
 
             // Default color for the next 1
-            chain->_list[1].SetAttributes(TextAttribute());
-            chain->_list[1].SetLength(1);
+            runs[1].SetAttributes(TextAttribute());
+            runs[1].SetLength(1);
 
             // Color 12 for the next 29
-            chain->_list[2].SetAttributes(TextAttribute(0xC));
-            chain->_list[2].SetLength(29);
+            runs[2].SetAttributes(TextAttribute(0xC));
+            runs[2].SetLength(29);
 
             // Then default color to end the run
-            chain->_list[3].SetAttributes(TextAttribute());
-            chain->_list[3].SetLength(73);
+            runs[3].SetAttributes(TextAttribute());
+            runs[3].SetLength(73);
+
+            SetRuns(*chain, runs);
 
             // The sum of the lengths should be 121.
-            VERIFY_ARE_EQUAL(chain->_cchRowWidth, chain->_list[0]._cchLength + chain->_list[1]._cchLength + chain->_list[2]._cchLength + chain->_list[3]._cchLength);
+            VERIFY_ARE_EQUAL(chain->_cchRowWidth, runs[0].GetLength() + runs[1].GetLength() + runs[2].GetLength() + runs[3].GetLength());
 
             auto index = chain->_list[0].GetLength();
             auto stepSize = 1;
@@ -571,25 +647,27 @@ class AttrRowTests
         Log::Comment(L"Reverse iterate across a text run in the chain");
         {
             // Create attr row representing a buffer that's 3 wide.
-            auto chain = std::make_unique<ATTR_ROW>(3, _DefaultAttr);
+            auto chain = std::make_unique<ATTR_ROW>(3, _DefaultAttr, _table);
 
             // The repro case had 3 chain segments.
-            chain->_list.resize(3);
+            std::vector<TextAttributeRun> runs(3);
 
             // The color 10 went for the first 1.
-            chain->_list[0].SetAttributes(TextAttribute(0xA));
-            chain->_list[0].SetLength(1);
+            runs[0].SetAttributes(TextAttribute(0xA));
+            runs[0].SetLength(1);
 
             // The color 11 for the next 1
-            chain->_list[1].SetAttributes(TextAttribute(0xB));
-            chain->_list[1].SetLength(1);
+            runs[1].SetAttributes(TextAttribute(0xB));
+            runs[1].SetLength(1);
 
             // Color 12 for the next 1
-            chain->_list[2].SetAttributes(TextAttribute(0xC));
-            chain->_list[2].SetLength(1);
+            runs[2].SetAttributes(TextAttribute(0xC));
+            runs[2].SetLength(1);
+
+            SetRuns(*chain, runs);
 
             // The sum of the lengths should be 3.
-            VERIFY_ARE_EQUAL(chain->_cchRowWidth, chain->_list[0]._cchLength + chain->_list[1]._cchLength + chain->_list[2]._cchLength);
+            VERIFY_ARE_EQUAL(chain->_cchRowWidth, runs[0].GetLength() + runs[1].GetLength() + runs[2].GetLength());
 
             // on 'ABC', step from B to A
             auto index = 1;
@@ -600,25 +678,27 @@ class AttrRowTests
         Log::Comment(L"Reverse iterate across two text runs in the chain");
         {
             // Create attr row representing a buffer that's 3 wide.
-            auto chain = std::make_unique<ATTR_ROW>(3, _DefaultAttr);
+            auto chain = std::make_unique<ATTR_ROW>(3, _DefaultAttr, _table);
 
             // The repro case had 3 chain segments.
-            chain->_list.resize(3);
+            std::vector<TextAttributeRun> runs(3);
 
             // The color 10 went for the first 1.
-            chain->_list[0].SetAttributes(TextAttribute(0xA));
-            chain->_list[0].SetLength(1);
+            runs[0].SetAttributes(TextAttribute(0xA));
+            runs[0].SetLength(1);
 
             // The color 11 for the next 1
-            chain->_list[1].SetAttributes(TextAttribute(0xB));
-            chain->_list[1].SetLength(1);
+            runs[1].SetAttributes(TextAttribute(0xB));
+            runs[1].SetLength(1);
 
             // Color 12 for the next 1
-            chain->_list[2].SetAttributes(TextAttribute(0xC));
-            chain->_list[2].SetLength(1);
+            runs[2].SetAttributes(TextAttribute(0xC));
+            runs[2].SetLength(1);
+
+            SetRuns(*chain, runs);
 
             // The sum of the lengths should be 3.
-            VERIFY_ARE_EQUAL(chain->_cchRowWidth, chain->_list[0]._cchLength + chain->_list[1]._cchLength + chain->_list[2]._cchLength);
+            VERIFY_ARE_EQUAL(chain->_cchRowWidth, runs[0].GetLength() + runs[1].GetLength() + runs[2].GetLength());
 
             // on 'ABC', step from C to A
             auto index = 2;
@@ -642,10 +722,10 @@ class AttrRowTests
         // Was 1 (single), should now have 2 segments
         VERIFY_ARE_EQUAL(pSingle->_list.size(), 2u);
 
-        VERIFY_ARE_EQUAL(pSingle->_list[0].GetAttributes(), _DefaultAttr);
+        VERIFY_ARE_EQUAL(GetRuns(*pSingle)[0].GetAttributes(), _DefaultAttr);
         VERIFY_ARE_EQUAL(pSingle->_list[0].GetLength(), (unsigned int)(_sDefaultLength - (_sDefaultLength - iTestIndex)));
 
-        VERIFY_ARE_EQUAL(pSingle->_list[1].GetAttributes(), TestAttr);
+        VERIFY_ARE_EQUAL(GetRuns(*pSingle)[1].GetAttributes(), TestAttr);
         VERIFY_ARE_EQUAL(pSingle->_list[1].GetLength(), (unsigned int)(_sDefaultLength - iTestIndex));
 
         Log::Comment(L"SetAttrToEnd for existing chain of multiple colors.");
@@ -655,19 +735,19 @@ class AttrRowTests
         VERIFY_ARE_EQUAL(pChain->_list.size(), 5u);
 
         // Verify chain colors and lengths
-        VERIFY_ARE_EQUAL(TextAttribute(0), pChain->_list[0].GetAttributes());
+        VERIFY_ARE_EQUAL(TextAttribute(0), GetRuns(*pChain)[0].GetAttributes());
         VERIFY_ARE_EQUAL(pChain->_list[0].GetLength(), (unsigned int)13);
 
-        VERIFY_ARE_EQUAL(TextAttribute(1), pChain->_list[1].GetAttributes());
+        VERIFY_ARE_EQUAL(TextAttribute(1), GetRuns(*pChain)[1].GetAttributes());
         VERIFY_ARE_EQUAL(pChain->_list[1].GetLength(), (unsigned int)13);
 
-        VERIFY_ARE_EQUAL(TextAttribute(2), pChain->_list[2].GetAttributes());
+        VERIFY_ARE_EQUAL(TextAttribute(2), GetRuns(*pChain)[2].GetAttributes());
         VERIFY_ARE_EQUAL(pChain->_list[2].GetLength(), (unsigned int)13);
 
-        VERIFY_ARE_EQUAL(TextAttribute(3), pChain->_list[3].GetAttributes());
+        VERIFY_ARE_EQUAL(TextAttribute(3), GetRuns(*pChain)[3].GetAttributes());
         VERIFY_ARE_EQUAL(pChain->_list[3].GetLength(), (unsigned int)11);
 
-        VERIFY_ARE_EQUAL(TestAttr, pChain->_list[4].GetAttributes());
+        VERIFY_ARE_EQUAL(TestAttr, GetRuns(*pChain)[4].GetAttributes());
         VERIFY_ARE_EQUAL(pChain->_list[4].GetLength(), (unsigned int)30);
 
         Log::Comment(L"SECOND: Set index to 0 to test replacing anything with a single");
@@ -684,7 +764,7 @@ class AttrRowTests
             VERIFY_ARE_EQUAL(pUnderTest->_list.size(), 1u);
 
             // singular pair should contain the color
-            VERIFY_ARE_EQUAL(pUnderTest->_list[0].GetAttributes(), TestAttr);
+            VERIFY_ARE_EQUAL(GetRuns(*pUnderTest)[0].GetAttributes(), TestAttr);
 
             // and its length should be the length of the whole string
             VERIFY_ARE_EQUAL(pUnderTest->_list[0].GetLength(), (unsigned int)_sDefaultLength);
@@ -705,6 +785,46 @@ class AttrRowTests
         }
     }
 
+    // Checks FindAttrIndex for every column of the row against the runs themselves.
+    void VerifyFindAttrIndex(const ATTR_ROW& row)
+    {
+        size_t runStart = 0;
+        for (size_t runPos = 0; runPos < row._list.size(); ++runPos)
+        {
+            const auto runEnd = runStart + row._list[runPos].GetLength();
+            for (auto column = runStart; column < runEnd; ++column)
+            {
+                size_t applies = 0;
+                VERIFY_ARE_EQUAL(runPos, row.FindAttrIndex(column, &applies));
+                VERIFY_ARE_EQUAL(runEnd - column, applies);
+            }
+            runStart = runEnd;
+        }
+        VERIFY_ARE_EQUAL(row._cchRowWidth, runStart);
+    }
+
+    TEST_METHOD(TestFindAttrIndex)
+    {
+        Log::Comment(L"Find every column in the rows as they were set up.");
+        VerifyFindAttrIndex(*pSingle);
+        VerifyFindAttrIndex(*pChain);
+
+        Log::Comment(L"Splitting a run has to move the ends of the runs after it.");
+        const TextAttributeRun insert(3, _DefaultChainAttr);
+        VERIFY_SUCCEEDED(pChain->InsertAttrRuns({ &insert, 1 }, 5, 7, _sDefaultLength));
+        VerifyFindAttrIndex(*pChain);
+
+        Log::Comment(L"Resizing the row has to move the end of the last run.");
+        pChain->Resize(_sDefaultLength * 2);
+        VerifyFindAttrIndex(*pChain);
+        pChain->Resize(_sDefaultLength / 2);
+        VerifyFindAttrIndex(*pChain);
+
+        Log::Comment(L"Resetting the row leaves a single run.");
+        pChain->Reset(_DefaultAttr);
+        VerifyFindAttrIndex(*pChain);
+    }
+
     TEST_METHOD(TestResize)
     {
         CommonState state;
@@ -537,4 +537,78 @@ class CommandLineTests
             }
         }
     }
+
+    TEST_METHOD(EditingMidLineOnlyRedrawsTheTail)
+    {
+        auto buffer = std::make_unique<wchar_t[]>(PROMPT_SIZE);
+        VERIFY_IS_NOT_NULL(buffer.get());
+        auto& consoleInfo = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& screenInfo = consoleInfo.GetActiveOutputBuffer();
+        auto& cookedReadData = consoleInfo.CookedReadData();
+        InitCookedReadData(cookedReadData, m_pHistory, buffer.get(), PROMPT_SIZE);
+        cookedReadData.OriginalCursorPosition() = screenInfo.GetTextBuffer().GetCursor().GetPosition();
+        const auto origin = cookedReadData.OriginalCursorPosition();
+
+        const auto verifyLine = [&](const std::wstring_view expected, const size_t cursorColumn) {
+            const auto row = screenInfo.GetTextBuffer().GetRowByOffset(origin.Y).GetText();
+            VERIFY_ARE_EQUAL(String(expected.data(), gsl::narrow<int>(expected.size())),
+                             String(row.data() + origin.X, gsl::narrow<int>(expected.size())));
+            VERIFY_ARE_EQUAL(gsl::narrow<SHORT>(origin.X + cursorColumn), screenInfo.GetTextBuffer().GetCursor().GetPosition().X);
+        };
+
+        cookedReadData.Write(L"hello world");
+        VERIFY_ARE_EQUAL(11u, cookedReadData.VisibleCharCount());
+
+        Log::Comment(L"Mark the cells of \"hello\" with colors that nothing writes. Every edit below starts right of them, so they must keep those colors.");
+        const TextAttribute poison{ FOREGROUND_RED | BACKGROUND_GREEN | BACKGROUND_INTENSITY };
+        VERIFY_ARE_NOT_EQUAL(poison.GetLegacyAttributes(), screenInfo.GetAttributes().GetLegacyAttributes());
+        const auto prefixStart = gsl::narrow<size_t>(origin.X);
+        const auto prefixEnd = prefixStart + 5;
+        auto& attrRow = screenInfo.GetTextBuffer().GetRowByOffset(origin.Y).GetAttrRow();
+        const TextAttributeRun poisonRun{ prefixEnd - prefixStart, poison };
+        VERIFY_SUCCEEDED(attrRow.InsertAttrRuns({ &poisonRun, 1 },
+                                                prefixStart,
+                                                prefixEnd - 1,
+                                                gsl::narrow<size_t>(screenInfo.GetTextBuffer().GetSize().Width())));
+
+        const auto verifyPrefixUntouched = [&]() {
+            for (auto column = prefixStart; column < prefixEnd; ++column)
+            {
+                VERIFY_ARE_EQUAL(poison.GetLegacyAttributes(), attrRow.GetAttrByColumn(column).GetLegacyAttributes());
+            }
+        };
+        verifyPrefixUntouched();
+
+        Log::Comment(L"Move back to the space and insert a comma.");
+        auto& commandLine = CommandLine::Instance();
+        for (auto i = 0; i < 6; ++i)
+        {
+            VERIFY_ARE_EQUAL(STATUS_SUCCESS, commandLine.ProcessCommandLine(cookedReadData, VK_LEFT, 0));
+        }
+        cookedReadData.SetInsertMode(true);
+        NTSTATUS status;
+        cookedReadData.ProcessInput(L',', 0, status);
+        VERIFY_ARE_EQUAL(STATUS_SUCCESS, status);
+        VerifyPromptText(cookedReadData, L"hello, world");
+        verifyLine(L"hello, world", 6);
+        verifyPrefixUntouched();
+        VERIFY_ARE_EQUAL(12u, cookedReadData.VisibleCharCount());
+
+        Log::Comment(L"Backspace over it again. The cell the line shrank by is blanked.");
+        cookedReadData.ProcessInput(UNICODE_BACKSPACE, 0, status);
+        VERIFY_ARE_EQUAL(STATUS_SUCCESS, status);
+        VerifyPromptText(cookedReadData, L"hello world");
+        verifyLine(L"hello world ", 5);
+        verifyPrefixUntouched();
+        VERIFY_ARE_EQUAL(11u, cookedReadData.VisibleCharCount());
+
+        Log::Comment(L"Overwrite the space.");
+        cookedReadData.SetInsertMode(false);
+        cookedReadData.ProcessInput(L'_', 0, status);
+        VERIFY_ARE_EQUAL(STATUS_SUCCESS, status);
+        VerifyPromptText(cookedReadData, L"hello_world");
+        verifyLine(L"hello_world ", 6);
+        verifyPrefixUntouched();
+        VERIFY_ARE_EQUAL(11u, cookedReadData.VisibleCharCount());
+    }
 };
@@ -0,0 +1,169 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "..\..\inc\consoletaeftemplates.hpp"
+
+#include "..\..\renderer\base\DirtySpans.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace Microsoft::Console::Render;
+
+class DirtySpansTests
+{
+    TEST_CLASS(DirtySpansTests);
+
+    TEST_METHOD(EmptyRegionsAreIgnored);
+    TEST_METHOD(AdjacentRegionsAreMerged);
+    TEST_METHOD(ContainedRegionsAreMerged);
+    TEST_METHOD(CompactKeepsTheSameCells);
+    TEST_METHOD(ScatteredRegionsOverflowToARedrawAll);
+
+    // Adds every other cell of the given area, like a checkerboard.
+    // None of them touch, so they can't be merged.
+    static void _AddCheckerboard(DirtySpans& spans, const SHORT width, const SHORT height)
+    {
+        for (SHORT y = 0; y < height; y++)
+        {
+            for (SHORT x = y % 2; x < width; x += 2)
+            {
+                spans.Add({ x, y, gsl::narrow_cast<SHORT>(x + 1), gsl::narrow_cast<SHORT>(y + 1) });
+            }
+        }
+    }
+};
+
+void DirtySpansTests::EmptyRegionsAreIgnored()
+{
+    DirtySpans spans;
+    VERIFY_IS_TRUE(spans.empty());
+
+    spans.Add({ 5, 0, 5, 10 });
+    spans.Add({ 0, 3, 10, 3 });
+    spans.Add({ 8, 4, 2, 6 });
+    VERIFY_IS_TRUE(spans.empty());
+    VERIFY_IS_TRUE(spans.Compact().empty());
+}
+
+void DirtySpansTests::AdjacentRegionsAreMerged()
+{
+    DirtySpans spans;
+
+    Log::Comment(L"Text written left to right grows a single region.");
+    for (SHORT x = 0; x < 80; x++)
+    {
+        spans.Add({ x, 2, gsl::narrow_cast<SHORT>(x + 1), 3 });
+    }
+
+    Log::Comment(L"So does a column that's written top to bottom.");
+    for (SHORT y = 3; y < 10; y++)
+    {
+        spans.Add({ 0, y, 80, gsl::narrow_cast<SHORT>(y + 1) });
+    }
+
+    const auto& regions = spans.Compact();
+    VERIFY_ARE_EQUAL(1u, regions.size());
+    VERIFY_ARE_EQUAL((SMALL_RECT{ 0, 2, 80, 10 }), regions.at(0));
+}
+
+void DirtySpansTests::ContainedRegionsAreMerged()
+{
+    DirtySpans spans;
+
+    Log::Comment(L"A region within the last one is merged right away.");
+    spans.Add({ 0, 0, 10, 5 });
+    spans.Add({ 2, 2, 4, 3 });
+    VERIFY_ARE_EQUAL(1u, spans.Compact().size());
+
+    Log::Comment(L"One that's contained by an earlier one is merged by Compact.");
+    spans.Add({ 20, 0, 21, 1 });
+    spans.Add({ 3, 1, 6, 4 });
+
+    const auto& regions = spans.Compact();
+    VERIFY_ARE_EQUAL(2u, regions.size());
+    VERIFY_ARE_EQUAL((SMALL_RECT{ 0, 0, 10, 5 }), regions.at(0));
+    VERIFY_ARE_EQUAL((SMALL_RECT{ 20, 0, 21, 1 }), regions.at(1));
+}
+
+void DirtySpansTests::CompactKeepsTheSameCells()
+{
+    constexpr SHORT width = 40;
+    constexpr SHORT height = 20;
+    const std::vector<SMALL_RECT> added{
+        { 0, 0, 5, 3 },
+        { 3, 1, 12, 2 },
+        { 30, 5, 40, 20 },
+        { 10, 10, 11, 11 },
+        { 2, 2, 8, 6 },
+        { 31, 6, 32, 7 },
+        { 11, 10, 20, 11 },
+        { 0, 19, 40, 20 },
+    };
+
+    DirtySpans spans;
+    std::vector<bool> expected(width * height);
+    for (const auto& region : added)
+    {
+        spans.Add(region);
+        for (auto y = region.Top; y < region.Bottom; y++)
+        {
+            for (auto x = region.Left; x < region.Right; x++)
+            {
+                expected.at(y * width + x) = true;
+            }
+        }
+    }
+
+    const auto& regions = spans.Compact();
+    VERIFY_IS_LESS_THAN(regions.size(), added.size());
+
+    // Every invalid cell is covered exactly once, and nothing else is.
+    std::vector<int> actual(width * height);
+    for (const auto& region : regions)
+    {
+        for (auto y = region.Top; y < region.Bottom; y++)
+        {
+            for (auto x = region.Left; x < region.Right; x++)
+            {
+                actual.at(y * width + x)++;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        VERIFY_ARE_EQUAL(expected.at(i) ? 1 : 0, actual.at(i), NoThrowString().Format(L"Cell %d,%d", i % width, i / width));
+    }
+}
+
+void DirtySpansTests::ScatteredRegionsOverflowToARedrawAll()
+{
+    DirtySpans spans;
+
+    Log::Comment(L"A couple thousand scattered cells are still tracked one by one.");
+    _AddCheckerboard(spans, 100, 30);
+    VERIFY_IS_FALSE(spans.Overflowed());
+    VERIFY_ARE_EQUAL(1500u, spans.Compact().size());
+
+    Log::Comment(L"Past that, everything is invalid instead.");
+    spans.Clear();
+    _AddCheckerboard(spans, 200, 50);
+    VERIFY_IS_TRUE(spans.Overflowed());
+    VERIFY_IS_FALSE(spans.empty());
+    VERIFY_IS_TRUE(spans.Compact().empty());
+
+    Log::Comment(L"Nothing else is collected until the next Clear.");
+    spans.Add({ 0, 0, 1, 1 });
+    VERIFY_IS_TRUE(spans.Compact().empty());
+
+    spans.Clear();
+    VERIFY_IS_FALSE(spans.Overflowed());
+    VERIFY_IS_TRUE(spans.empty());
+
+    spans.Add({ 0, 0, 1, 1 });
+    VERIFY_ARE_EQUAL(1u, spans.Compact().size());
+}
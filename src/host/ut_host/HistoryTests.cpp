@@ -242,7 +242,182 @@ class HistoryTests
         VERIFY_ARE_EQUAL(2ul, history->GetNumberOfCommands());
     }
 
+    TEST_METHOD(AddFullDropsOldestAndMovesDuplicateToEnd)
+    {
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+
+        for (const auto& item : _manyHistoryItems)
+        {
+            VERIFY_SUCCEEDED(history->Add(item, true));
+        }
+
+        Log::Comment(L"The oldest commands were dropped to make room.");
+        VERIFY_ARE_EQUAL(s_BufferSize, history->GetNumberOfCommands());
+        VERIFY_ARE_EQUAL(String(_manyHistoryItems[2].data()), String(history->GetNth(0).data()));
+
+        SHORT index;
+        VERIFY_IS_FALSE(history->FindMatchingCommand(_manyHistoryItems[0], history->LastDisplayed, index, CommandHistory::MatchOptions::ExactMatch));
+
+        Log::Comment(L"Adding a command that's already there moves it to the end, regardless of case.");
+        VERIFY_SUCCEEDED(history->Add(L"IPCONFIG", true));
+        VERIFY_ARE_EQUAL(s_BufferSize, history->GetNumberOfCommands());
+        VERIFY_ARE_EQUAL(String(L"ipconfig"), String(history->GetNth(gsl::narrow<SHORT>(s_BufferSize - 1)).data()));
+        VERIFY_ARE_EQUAL(String(_manyHistoryItems[2].data()), String(history->GetNth(0).data()));
+    }
+
+    TEST_METHOD(FindMatchingCommandByPrefix)
+    {
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+
+        VERIFY_SUCCEEDED(history->Add(L"dir", false));
+        VERIFY_SUCCEEDED(history->Add(L"cd ..", false));
+        VERIFY_SUCCEEDED(history->Add(L"Dir /w", false));
+        VERIFY_SUCCEEDED(history->Add(L"git push", false));
+
+        Log::Comment(L"The most recent command with the prefix is found first, regardless of case.");
+        SHORT index;
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"DI", history->LastDisplayed, index, CommandHistory::MatchOptions::None));
+        VERIFY_ARE_EQUAL(2, index);
+
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"di", index, index, CommandHistory::MatchOptions::None));
+        VERIFY_ARE_EQUAL(0, index);
+
+        VERIFY_IS_FALSE(history->FindMatchingCommand(L"ping", history->LastDisplayed, index, CommandHistory::MatchOptions::None));
+
+        Log::Comment(L"An exact match has to match the whole command.");
+        VERIFY_IS_FALSE(history->FindMatchingCommand(L"git", history->LastDisplayed, index, CommandHistory::MatchOptions::ExactMatch));
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"GIT PUSH", history->LastDisplayed, index, CommandHistory::MatchOptions::ExactMatch));
+        VERIFY_ARE_EQUAL(3, index);
+    }
+
+    TEST_METHOD(FindByProcessAfterReallocate)
+    {
+        const auto first = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(first);
+        const auto second = CommandHistory::s_Allocate(_manyApps[1], _MakeHandle(1));
+        VERIFY_IS_NOT_NULL(second);
+
+        VERIFY_IS_TRUE(first == CommandHistory::s_Find(_MakeHandle(0)));
+        VERIFY_IS_TRUE(second == CommandHistory::s_Find(_MakeHandle(1)));
+
+        Log::Comment(L"A history that's handed to another process of the same app stays where it is.");
+        CommandHistory::s_Free(_MakeHandle(0));
+        VERIFY_IS_NULL(CommandHistory::s_Find(_MakeHandle(0)));
+
+        const auto reused = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(2));
+        VERIFY_IS_TRUE(first == reused);
+        VERIFY_IS_TRUE(first == CommandHistory::s_Find(_MakeHandle(2)));
+        VERIFY_IS_NULL(CommandHistory::s_Find(_MakeHandle(0)));
+
+        CommandHistory::s_ReallocExeToFront(_manyApps[1], 5);
+        VERIFY_IS_TRUE(second == CommandHistory::s_Find(_MakeHandle(1)));
+    }
+
+    TEST_METHOD(StoreLoadsWhatWasAppended)
+    {
+        const auto path = _MakeStorePath();
+        auto removeLog = wil::scope_exit([&]() {
+            std::filesystem::remove(path);
+        });
+
+        HistoryStore store{ path };
+        VERIFY_ARE_EQUAL(0ul, store.Load().size(), L"There's no log yet.");
+
+        store.Append(L"dir");
+        store.Append(L"cd ..");
+        store.Clear();
+        store.Append(L"git push");
+        store.Append(L"ipconfig /all");
+        store.Flush();
+
+        Log::Comment(L"Only the commands after the last clear come back.");
+        HistoryStore reopened{ path };
+        auto commands = reopened.Load();
+        VERIFY_ARE_EQUAL(2ul, commands.size());
+        VERIFY_ARE_EQUAL(String(L"git push"), String(commands.at(0).c_str()));
+        VERIFY_ARE_EQUAL(String(L"ipconfig /all"), String(commands.at(1).c_str()));
+        VERIFY_ARE_EQUAL(5ul, reopened.GetRecordCount());
+
+        Log::Comment(L"A record that was cut short is ignored.");
+        {
+            std::ofstream log{ path, std::ios::binary | std::ios::app };
+            const uint16_t length = 10;
+            log.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            log.write("ab", 2);
+        }
+        commands = reopened.Load();
+        VERIFY_ARE_EQUAL(2ul, commands.size());
+
+        Log::Comment(L"Compacting leaves just the given commands.");
+        reopened.Compact({ L"ping 127.0.0.1" });
+        VERIFY_ARE_EQUAL(1ul, reopened.GetRecordCount());
+        commands = HistoryStore{ path }.Load();
+        VERIFY_ARE_EQUAL(1ul, commands.size());
+        VERIFY_ARE_EQUAL(String(L"ping 127.0.0.1"), String(commands.at(0).c_str()));
+    }
+
+    TEST_METHOD(StoreCompactLeavesNoTemporaryFileBehind)
+    {
+        const auto path = _MakeStorePath();
+        auto temporary = path;
+        temporary += L".tmp";
+        auto removeLog = wil::scope_exit([&]() {
+            std::filesystem::remove(path);
+            std::filesystem::remove(temporary);
+        });
+
+        Log::Comment(L"A directory where the log should be makes moving the new log into place fail.");
+        VERIFY_IS_TRUE(std::filesystem::create_directory(path));
+
+        HistoryStore store{ path };
+        VERIFY_THROWS(store.Compact({ L"dir" }), wil::ResultException);
+        VERIFY_IS_FALSE(std::filesystem::exists(temporary));
+    }
+
+    TEST_METHOD(StoreFollowsHistory)
+    {
+        const auto path = _MakeStorePath();
+        auto removeLog = wil::scope_exit([&]() {
+            std::filesystem::remove(path);
+        });
+
+        const auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+        history->_store = std::make_unique<HistoryStore>(path);
+
+        for (const auto& item : _manyHistoryItems)
+        {
+            VERIFY_SUCCEEDED(history->Add(item, true));
+        }
+
+        Log::Comment(L"The log never grows much beyond the history.");
+        VERIFY_IS_LESS_THAN_OR_EQUAL(history->_store->GetRecordCount(), gsl::narrow_cast<size_t>(2 * s_BufferSize));
+
+        Log::Comment(L"Edits the log can't express are written out when the history is freed.");
+        history->Remove(0);
+        history->Swap(0, 1);
+        std::deque<std::wstring> expected{ history->_commands };
+        CommandHistory::s_Free(_MakeHandle(0));
+
+        const auto commands = HistoryStore{ path }.Load();
+        VERIFY_ARE_EQUAL(expected.size(), commands.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(String(expected.at(i).c_str()), String(commands.at(i).c_str()));
+        }
+    }
+
 private:
+    std::filesystem::path _MakeStorePath()
+    {
+        auto path = std::filesystem::temp_directory_path();
+        path /= L"HistoryTests." + std::to_wstring(GetCurrentProcessId()) + L".history";
+        std::filesystem::remove(path);
+        return path;
+    }
+
     const std::array<std::wstring, 5> _manyApps = {
         L"foo.exe",
         L"bar.exe",
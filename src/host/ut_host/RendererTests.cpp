@@ -3,22 +3,178 @@
 
 #include "precomp.h"
 #include "WexTestClass.h"
+#include "..\..\inc\consoletaeftemplates.hpp"
 
 #include "CommonState.hpp"
 
-#include "..\..\host\renderData.hpp"
 #include "..\..\renderer\base\renderer.hpp"
+#include "..\..\renderer\inc\RenderEngineBase.hpp"
 
+using namespace WEX::Common;
 using namespace WEX::Logging;
 using namespace WEX::TestExecution;
 
+using namespace Microsoft::Console::Interactivity;
+using namespace Microsoft::Console::Render;
+
+// An engine that doesn't draw anything. It only records what the renderer
+// asked it to do, and can hold on to its frame or ask for a retry.
+class FakeRenderEngine final : public RenderEngineBase
+{
+public:
+    // If set, PaintBackground signals it and then waits for partnerPainting.
+    HANDLE painting = nullptr;
+    HANDLE partnerPainting = nullptr;
+    bool sawPartnerPainting = false;
+    // If set, PaintBackground signals it once it's done.
+    HANDLE painted = nullptr;
+    // How many of the next calls to Present ask for a retry.
+    size_t presentRetries = 0;
+
+    size_t paintCount = 0;
+    size_t presentCount = 0;
+    DWORD paintThreadId = 0;
+
+    // Whether a frame was started and not presented yet.
+    bool inFrame = false;
+    size_t invalidationsInFrame = 0;
+    size_t invalidateAllCount = 0;
+
+    [[nodiscard]] HRESULT StartPaint() noexcept override
+    {
+        paintCount++;
+        inFrame = true;
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT EndPaint() noexcept override { return S_OK; }
+
+    [[nodiscard]] HRESULT Present() noexcept override
+    {
+        inFrame = false;
+        presentCount++;
+        if (presentRetries > 0)
+        {
+            presentRetries--;
+            return E_PENDING;
+        }
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept override
+    {
+        *pForcePaint = false;
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT ScrollFrame() noexcept override { return S_OK; }
+    [[nodiscard]] HRESULT Invalidate(const SMALL_RECT* const /*psrRegion*/) noexcept override { return _Invalidated(); }
+    [[nodiscard]] HRESULT InvalidateCursor(const COORD* const /*pcoordCursor*/) noexcept override { return _Invalidated(); }
+    [[nodiscard]] HRESULT InvalidateSystem(const RECT* const /*prcDirtyClient*/) noexcept override { return _Invalidated(); }
+    [[nodiscard]] HRESULT InvalidateSelection(const std::vector<SMALL_RECT>& /*rectangles*/) noexcept override { return _Invalidated(); }
+    [[nodiscard]] HRESULT InvalidateScroll(const COORD* const /*pcoordDelta*/) noexcept override { return _Invalidated(); }
+
+    [[nodiscard]] HRESULT InvalidateAll() noexcept override
+    {
+        invalidateAllCount++;
+        return _Invalidated();
+    }
+
+    [[nodiscard]] HRESULT InvalidateCircling(_Out_ bool* const pForcePaint) noexcept override
+    {
+        *pForcePaint = false;
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT PaintBackground() noexcept override
+    {
+        paintThreadId = GetCurrentThreadId();
+
+        if (painting)
+        {
+            SetEvent(painting);
+            sawPartnerPainting = WaitForSingleObject(partnerPainting, 5000) == WAIT_OBJECT_0;
+        }
+
+        if (painted)
+        {
+            SetEvent(painted);
+        }
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT PaintBufferLine(std::basic_string_view<Cluster> const /*clusters*/,
+                                          const COORD /*coord*/,
+                                          const bool /*fTrimLeft*/,
+                                          const bool /*lineWrapped*/) noexcept override
+    {
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT PaintBufferGridLines(const GridLines /*lines*/,
+                                               const COLORREF /*color*/,
+                                               const size_t /*cchLine*/,
+                                               const COORD /*coordTarget*/) noexcept override
+    {
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT PaintSelection(const SMALL_RECT /*rect*/) noexcept override { return S_OK; }
+    [[nodiscard]] HRESULT PaintCursor(const CursorOptions& /*options*/) noexcept override { return S_OK; }
+
+    [[nodiscard]] HRESULT UpdateDrawingBrushes(const COLORREF /*colorForeground*/,
+                                               const COLORREF /*colorBackground*/,
+                                               const WORD /*legacyColorAttribute*/,
+                                               const ExtendedAttributes /*extendedAttrs*/,
+                                               const bool /*isSettingDefaultBrushes*/) noexcept override
+    {
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT UpdateFont(const FontInfoDesired& /*FontInfoDesired*/, _Out_ FontInfo& /*FontInfo*/) noexcept override { return S_OK; }
+    [[nodiscard]] HRESULT UpdateDpi(const int /*iDpi*/) noexcept override { return S_OK; }
+    [[nodiscard]] HRESULT UpdateViewport(const SMALL_RECT /*srNewViewport*/) noexcept override { return S_OK; }
+
+    [[nodiscard]] HRESULT GetProposedFont(const FontInfoDesired& /*FontInfoDesired*/,
+                                          _Out_ FontInfo& /*FontInfo*/,
+                                          const int /*iDpi*/) noexcept override
+    {
+        return S_OK;
+    }
+
+    std::vector<til::rectangle> GetDirtyArea() override { return {}; }
+
+    [[nodiscard]] HRESULT GetFontSize(_Out_ COORD* const pFontSize) noexcept override
+    {
+        *pFontSize = { 8, 16 };
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT IsGlyphWideByFont(const std::wstring_view /*glyph*/, _Out_ bool* const pResult) noexcept override
+    {
+        *pResult = false;
+        return S_OK;
+    }
+
+protected:
+    [[nodiscard]] HRESULT _DoUpdateTitle(const std::wstring& /*newTitle*/) noexcept override { return S_OK; }
+
+private:
+    HRESULT _Invalidated() noexcept
+    {
+        if (inFrame)
+        {
+            invalidationsInFrame++;
+        }
+        return S_OK;
+    }
+};
+
 class RendererTests
 {
     TEST_CLASS(RendererTests);
 
     std::unique_ptr<CommonState> m_state;
-    std::unique_ptr<RenderData> m_renderData;
-    std::unique_ptr<Renderer> m_renderer;
 
     TEST_CLASS_SETUP(ClassSetup)
     {
@@ -26,20 +182,14 @@ class RendererTests
 
         m_state->PrepareGlobalFont();
         m_state->PrepareGlobalScreenBuffer();
-
         m_state->PrepareGlobalInputBuffer();
 
-        m_renderData = std::make_unique<RenderData>();
-
         return true;
     }
 
     TEST_CLASS_CLEANUP(ClassCleanup)
     {
-        m_renderData.reset(nullptr);
-
         m_state->CleanupGlobalInputBuffer();
-
         m_state->CleanupGlobalScreenBuffer();
         m_state->CleanupGlobalFont();
 
@@ -48,24 +198,268 @@ class RendererTests
         return true;
     }
 
-    TEST_METHOD_SETUP(MethodSetup)
-    {
-        Renderer* pRenderer = nullptr;
-        Globals& g = ServiceLocator::LocateGlobals();
-        CONSOLE_INFORMATION& gci = g.getConsoleInformation();
-        VERIFY_SUCCEEDED(Renderer::s_CreateInstance(gci.renderData, &pRenderer));
-        m_renderer.reset(pRenderer);
-        return true;
-    }
-
-    TEST_METHOD_CLEANUP(MethodCleanup)
-    {
-        m_renderer.reset(nullptr);
-        return true;
-    }
+    TEST_METHOD(EnginesPaintConcurrently);
+    TEST_METHOD(FrameTakesAsLongAsSlowestEngine);
+    TEST_METHOD(RetryRepaintsOnlyThatEngine);
+    TEST_METHOD(InvalidationsWaitForFrame);
+    TEST_METHOD(OutputDoesNotWaitForSlowFrames);
+    TEST_METHOD(EngineChangesWaitForFrame);
 
-    TEST_METHOD(Sample)
+    static std::unique_ptr<Renderer> _CreateRenderer(std::initializer_list<FakeRenderEngine*> engines)
     {
-        m_renderer->TriggerTitleChange();
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto renderer = std::make_unique<Renderer>(&gci.renderData, nullptr, 0, nullptr);
+        for (const auto engine : engines)
+        {
+            renderer->AddRenderEngine(engine);
+        }
+        return renderer;
     }
 };
+
+void RendererTests::EnginesPaintConcurrently()
+{
+    // Each engine waits in PaintBackground until the other one has started painting
+    // too. If they were painted one after the other, the first would time out.
+    wil::unique_event firstPainting{ wil::EventOptions::ManualReset };
+    wil::unique_event secondPainting{ wil::EventOptions::ManualReset };
+
+    FakeRenderEngine first;
+    first.painting = firstPainting.get();
+    first.partnerPainting = secondPainting.get();
+
+    FakeRenderEngine second;
+    second.painting = secondPainting.get();
+    second.partnerPainting = firstPainting.get();
+
+    auto renderer = _CreateRenderer({ &first, &second });
+    VERIFY_SUCCEEDED(renderer->PaintFrame());
+
+    VERIFY_IS_TRUE(first.sawPartnerPainting);
+    VERIFY_IS_TRUE(second.sawPartnerPainting);
+    VERIFY_ARE_NOT_EQUAL(first.paintThreadId, second.paintThreadId);
+
+    Log::Comment(L"The first engine is still painted on the thread that asked for the frame.");
+    VERIFY_ARE_EQUAL(GetCurrentThreadId(), first.paintThreadId);
+
+    VERIFY_ARE_EQUAL(1u, first.presentCount);
+    VERIFY_ARE_EQUAL(1u, second.presentCount);
+}
+
+void RendererTests::FrameTakesAsLongAsSlowestEngine()
+{
+    wil::unique_event fastPainting{ wil::EventOptions::ManualReset };
+    wil::unique_event fastPainted{ wil::EventOptions::ManualReset };
+    wil::unique_event slowPainting{ wil::EventOptions::ManualReset };
+    wil::unique_event resume{ wil::EventOptions::ManualReset };
+
+    // The fast engine can only finish once the slow one has started painting,
+    // which it can't do if it has to wait for the fast one to finish first.
+    FakeRenderEngine fast;
+    fast.painting = fastPainting.get();
+    fast.partnerPainting = slowPainting.get();
+    fast.painted = fastPainted.get();
+
+    // The slow engine stays in its frame until it's told to resume.
+    FakeRenderEngine slow;
+    slow.painting = slowPainting.get();
+    slow.partnerPainting = resume.get();
+
+    auto renderer = _CreateRenderer({ &fast, &slow });
+
+    auto hr = E_FAIL;
+    std::atomic<bool> frameDone{ false };
+    std::thread paintThread{ [&]() {
+        hr = renderer->PaintFrame();
+        frameDone = true;
+    } };
+    auto joinPaintThread = wil::scope_exit([&]() {
+        resume.SetEvent();
+        paintThread.join();
+    });
+
+    VERIFY_IS_TRUE(fastPainted.wait(5000));
+    VERIFY_IS_TRUE(fast.sawPartnerPainting, L"The fast engine was painted while the slow one was.");
+
+    Log::Comment(L"The frame isn't done as long as the slow engine is still painting.");
+    VERIFY_IS_FALSE(frameDone);
+
+    joinPaintThread.reset();
+
+    VERIFY_SUCCEEDED(hr);
+    VERIFY_IS_TRUE(frameDone);
+    VERIFY_IS_TRUE(slow.sawPartnerPainting);
+
+    VERIFY_ARE_EQUAL(1u, fast.paintCount);
+    VERIFY_ARE_EQUAL(1u, slow.paintCount);
+    VERIFY_ARE_EQUAL(1u, fast.presentCount);
+    VERIFY_ARE_EQUAL(1u, slow.presentCount);
+}
+
+void RendererTests::RetryRepaintsOnlyThatEngine()
+{
+    FakeRenderEngine first;
+    FakeRenderEngine second;
+    second.presentRetries = 1;
+
+    auto renderer = _CreateRenderer({ &first, &second });
+    VERIFY_SUCCEEDED(renderer->PaintFrame());
+
+    VERIFY_ARE_EQUAL(1u, first.paintCount);
+    VERIFY_ARE_EQUAL(1u, first.presentCount);
+
+    Log::Comment(L"The engine that asked for a retry got painted and presented again.");
+    VERIFY_ARE_EQUAL(2u, second.paintCount);
+    VERIFY_ARE_EQUAL(2u, second.presentCount);
+}
+
+void RendererTests::InvalidationsWaitForFrame()
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+    wil::unique_event painting{ wil::EventOptions::ManualReset };
+    wil::unique_event resume{ wil::EventOptions::ManualReset };
+
+    // The engine stays in its frame until it's told to resume.
+    FakeRenderEngine engine;
+    engine.painting = painting.get();
+    engine.partnerPainting = resume.get();
+
+    auto renderer = _CreateRenderer({ &engine });
+
+    auto hr = E_FAIL;
+    std::thread paintThread{ [&]() {
+        hr = renderer->PaintFrame();
+    } };
+    auto joinPaintThread = wil::scope_exit([&]() {
+        resume.SetEvent();
+        paintThread.join();
+    });
+
+    VERIFY_IS_TRUE(painting.wait(5000));
+
+    Log::Comment(L"The console isn't locked while the engine paints.");
+    VERIFY_IS_TRUE(gci.TryLockConsole());
+    renderer->TriggerRedrawAll();
+    gci.UnlockConsole();
+
+    Log::Comment(L"The engine is only told once it's done with the frame.");
+    VERIFY_ARE_EQUAL(0u, engine.invalidateAllCount);
+
+    joinPaintThread.reset();
+
+    VERIFY_SUCCEEDED(hr);
+    VERIFY_ARE_EQUAL(1u, engine.invalidateAllCount);
+    VERIFY_ARE_EQUAL(0u, engine.invalidationsInFrame);
+}
+
+void RendererTests::OutputDoesNotWaitForSlowFrames()
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+    wil::unique_event painting{ wil::EventOptions::ManualReset };
+    wil::unique_event resume{ wil::EventOptions::ManualReset };
+    wil::unique_event written{ wil::EventOptions::ManualReset };
+
+    // The engine stays in its frame until it's told to resume.
+    FakeRenderEngine engine;
+    engine.painting = painting.get();
+    engine.partnerPainting = resume.get();
+
+    auto renderer = _CreateRenderer({ &engine });
+
+    auto hr = E_FAIL;
+    std::atomic<bool> frameDone{ false };
+    std::thread paintThread{ [&]() {
+        hr = renderer->PaintFrame();
+        frameDone = true;
+    } };
+
+    // Once the engine is painting, the writer takes the console lock for
+    // every single write, just like the output of a client application.
+    size_t writes = 0;
+    std::thread writeThread{ [&]() {
+        if (!painting.wait(5000))
+        {
+            return;
+        }
+
+        for (SHORT x = 0; x < 80; x++)
+        {
+            gci.LockConsole();
+            const COORD coord{ x, 0 };
+            renderer->TriggerRedraw(&coord);
+            writes++;
+            gci.UnlockConsole();
+        }
+        written.SetEvent();
+    } };
+
+    auto joinThreads = wil::scope_exit([&]() {
+        resume.SetEvent();
+        writeThread.join();
+        paintThread.join();
+    });
+
+    VERIFY_IS_TRUE(painting.wait(5000));
+
+    Log::Comment(L"The writer gets the lock while the engine is still stuck in its frame.");
+    VERIFY_IS_TRUE(written.wait(5000));
+    VERIFY_IS_FALSE(frameDone);
+    VERIFY_ARE_EQUAL(80u, writes);
+
+    joinThreads.reset();
+
+    VERIFY_SUCCEEDED(hr);
+    VERIFY_ARE_EQUAL(0u, engine.invalidationsInFrame);
+}
+
+void RendererTests::EngineChangesWaitForFrame()
+{
+    wil::unique_event painting{ wil::EventOptions::ManualReset };
+    wil::unique_event resume{ wil::EventOptions::ManualReset };
+    wil::unique_event locked{ wil::EventOptions::ManualReset };
+
+    // The engine stays in its frame until it's told to resume.
+    FakeRenderEngine engine;
+    engine.painting = painting.get();
+    engine.partnerPainting = resume.get();
+
+    auto renderer = _CreateRenderer({ &engine });
+
+    auto hr = E_FAIL;
+    std::thread paintThread{ [&]() {
+        hr = renderer->PaintFrame();
+    } };
+
+    // This is what the host does before it changes the VT engine directly.
+    size_t presentsWhenLocked = 0;
+    std::thread changeThread{ [&]() {
+        if (!painting.wait(5000))
+        {
+            return;
+        }
+
+        const auto lock = renderer->LockForEngineChanges();
+        presentsWhenLocked = engine.presentCount;
+        locked.SetEvent();
+    } };
+
+    auto joinThreads = wil::scope_exit([&]() {
+        resume.SetEvent();
+        changeThread.join();
+        paintThread.join();
+    });
+
+    VERIFY_IS_TRUE(painting.wait(5000));
+    VERIFY_IS_FALSE(locked.is_signaled(), L"The engine can't be changed in the middle of its frame.");
+
+    resume.SetEvent();
+    VERIFY_IS_TRUE(locked.wait(5000));
+
+    joinThreads.reset();
+
+    VERIFY_SUCCEEDED(hr);
+    Log::Comment(L"The lock was only handed out once the frame was presented.");
+    VERIFY_ARE_EQUAL(1u, presentsWhenLocked);
+}
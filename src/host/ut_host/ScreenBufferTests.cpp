@@ -194,6 +194,8 @@ class ScreenBufferTests
     TEST_METHOD(SnapCursorWithTerminalScrolling);
 
     TEST_METHOD(ClearAlternateBuffer);
+    TEST_METHOD(ReuseAlternateBuffer);
+    TEST_METHOD(AlternateBufferSwitchPerf);
 
     TEST_METHOD(TestExtendedTextAttributes);
     TEST_METHOD(TestExtendedTextAttributesWithColors);
@@ -5008,6 +5010,116 @@ void ScreenBufferTests::ClearAlternateBuffer()
     VerifyText(siMain.GetTextBuffer());
 }
 
+void ScreenBufferTests::ReuseAlternateBuffer()
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    gci.LockConsole(); // Lock must be taken to manipulate buffer.
+    auto unlock = wil::scope_exit([&] { gci.UnlockConsole(); });
+
+    auto& siMain = gci.GetActiveOutputBuffer();
+    auto& stateMachine = siMain.GetStateMachine();
+
+    Log::Comment(L"Leave an alternate buffer behind with text, colors, margins and a moved cursor.");
+    stateMachine.ProcessString(L"\x1b[?1049h");
+    SCREEN_INFORMATION* const psiFirstAlternate = siMain._psiAlternateBuffer;
+    VERIFY_IS_NOT_NULL(psiFirstAlternate);
+    stateMachine.ProcessString(L"\x1b[31;44mfoo\x1b[2;5r\x1b[4;7H");
+    VERIFY_IS_TRUE(psiFirstAlternate->AreMarginsSet());
+    stateMachine.ProcessString(L"\x1b[?1049l");
+    VERIFY_IS_NULL(siMain._psiAlternateBuffer);
+    VERIFY_ARE_EQUAL(psiFirstAlternate, siMain._psiSpareAltBuffer);
+
+    auto VerifyNewAlternateBuffer = [&](const SCREEN_INFORMATION& altBuffer) {
+        auto expectedAttr = siMain.GetAttributes();
+        expectedAttr.SetStandardErase();
+
+        VERIFY_ARE_EQUAL(siMain.GetViewport().Dimensions(), altBuffer.GetBufferSize().Dimensions());
+        VERIFY_ARE_EQUAL(altBuffer.GetBufferSize().ToInclusive(), altBuffer.GetViewport().ToInclusive());
+        VERIFY_ARE_EQUAL(altBuffer._viewport.BottomInclusive(), altBuffer._virtualBottom);
+        VERIFY_IS_FALSE(altBuffer.AreMarginsSet());
+        VERIFY_ARE_EQUAL(expectedAttr, altBuffer.GetAttributes());
+        VERIFY_ARE_EQUAL(COORD({ 0, 0 }), altBuffer.GetTextBuffer().GetCursor().GetPosition());
+
+        size_t dirtyCells = 0;
+        for (auto iter = altBuffer.GetCellDataAt({ 0, 0 }); iter; ++iter)
+        {
+            if (iter->Chars() != L" " || iter->TextAttr() != expectedAttr)
+            {
+                ++dirtyCells;
+            }
+        }
+        VERIFY_ARE_EQUAL(0u, dirtyCells);
+    };
+
+    Log::Comment(L"The next alternate buffer is the same one, reset as if it were new.");
+    stateMachine.ProcessString(L"\x1b[?1049h");
+    VERIFY_ARE_EQUAL(psiFirstAlternate, siMain._psiAlternateBuffer);
+    VERIFY_IS_NULL(siMain._psiSpareAltBuffer);
+    VERIFY_ARE_EQUAL(psiFirstAlternate, &gci.GetActiveOutputBuffer());
+    VerifyNewAlternateBuffer(*psiFirstAlternate);
+    stateMachine.ProcessString(L"\x1b[?1049l");
+
+    Log::Comment(L"Once the main buffer changes size, the one that was left behind doesn't fit anymore.");
+    auto newSize = siMain.GetViewport().Dimensions();
+    newSize.X -= 10;
+    newSize.Y -= 5;
+    siMain.SetViewport(Viewport::FromDimensions(newSize), true);
+
+    stateMachine.ProcessString(L"\x1b[?1049h");
+    auto useMain = wil::scope_exit([&] { stateMachine.ProcessString(L"\x1b[?1049l"); });
+    VERIFY_IS_NOT_NULL(siMain._psiAlternateBuffer);
+    VERIFY_IS_NULL(siMain._psiSpareAltBuffer);
+    VERIFY_ARE_EQUAL(newSize, siMain._psiAlternateBuffer->GetBufferSize().Dimensions());
+    VerifyNewAlternateBuffer(*siMain._psiAlternateBuffer);
+}
+
+void ScreenBufferTests::AlternateBufferSwitchPerf()
+{
+    // Pagers and editors switch to the alternate buffer when they start and
+    // back when they're done. Paging through git log or man pages does that
+    // over and over.
+
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES();
+
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    gci.LockConsole(); // Lock must be taken to manipulate buffer.
+    auto unlock = wil::scope_exit([&] { gci.UnlockConsole(); });
+
+    auto& siMain = gci.GetActiveOutputBuffer();
+    auto& stateMachine = siMain.GetStateMachine();
+
+    const size_t switches = 1000;
+    std::chrono::nanoseconds switchingIn{ 0 };
+    std::chrono::nanoseconds switchingOut{ 0 };
+    for (size_t i = 0; i < switches; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        stateMachine.ProcessString(L"\x1b[?1049h");
+        const auto switchedIn = std::chrono::steady_clock::now();
+
+        stateMachine.ProcessString(L"\x1b[2J\x1b[H\x1b[7m page \x1b[m");
+
+        const auto leaving = std::chrono::steady_clock::now();
+        stateMachine.ProcessString(L"\x1b[?1049l");
+        const auto switchedOut = std::chrono::steady_clock::now();
+
+        switchingIn += switchedIn - start;
+        switchingOut += switchedOut - leaving;
+    }
+
+    VERIFY_IS_FALSE(gci.GetActiveOutputBuffer()._IsAltBuffer());
+    VERIFY_IS_NULL(siMain._psiAlternateBuffer);
+
+    Log::Comment(NoThrowString().Format(L"%zu switches of a %dx%d viewport: %lldns in, %lldns out on average",
+                                        switches,
+                                        siMain.GetViewport().Width(),
+                                        siMain.GetViewport().Height(),
+                                        switchingIn.count() / gsl::narrow<long long>(switches),
+                                        switchingOut.count() / gsl::narrow<long long>(switches)));
+}
+
 void ScreenBufferTests::TestExtendedTextAttributes()
 {
     // This is a test for microsoft/terminal#2554. Refer to that issue for more
@@ -140,6 +140,7 @@ class TextBufferTests
 
     TEST_METHOD(ResizeTraditionalRotationPreservesHighUnicode);
     TEST_METHOD(ScrollBufferRotationPreservesHighUnicode);
+    TEST_METHOD(ScrollBufferRotationWithCircularFirstRow);
 
     TEST_METHOD(ResizeTraditionalHighUnicodeRowRemoval);
     TEST_METHOD(ResizeTraditionalHighUnicodeColumnRemoval);
@@ -148,10 +149,13 @@ class TextBufferTests
 
     void WriteLinesToBuffer(const std::vector<std::wstring>& text, TextBuffer& buffer);
     TEST_METHOD(GetWordBoundaries);
+    TEST_METHOD(GetWordBoundariesAfterChanges);
     TEST_METHOD(GetGlyphBoundaries);
 
     TEST_METHOD(GetTextRects);
     TEST_METHOD(GetText);
+    TEST_METHOD(VisitTextRuns);
+    TEST_METHOD(VisitTextFormattedPerf);
 };
 
 void TextBufferTests::TestBufferCreate()
@@ -1931,6 +1935,78 @@ void TextBufferTests::ScrollBufferRotationPreservesHighUnicode()
     VERIFY_ARE_EQUAL(String(fire), String(shouldBeFireText.data(), gsl::narrow<int>(shouldBeFireText.size())));
 }
 
+// This tests that scrolling a region still moves rows and their high unicode storage correctly
+// when the circular buffer's first row isn't at the top of storage, both when the scrolled range
+// fits within storage and when it wraps around its end.
+void TextBufferTests::ScrollBufferRotationWithCircularFirstRow()
+{
+    const COORD bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    const auto fire = L"\xD83D\xDD25";
+    const COORD pos{ 2, 1 };
+    const SHORT delta = 5;
+    const COORD newPos{ pos.X, pos.Y + delta };
+
+    // The rows that change places are the one at pos.Y and the delta rows below it.
+    // They start in storage at firstRow + pos.Y. Once that plus their count passes the
+    // end of storage, the storage has to be straightened out before they can be rotated.
+    Log::Comment(L"Test 1 = Scrolled range starts at the wrapped around part of storage");
+    Log::Comment(L"Test 2 = Scrolled range sits in the middle of storage");
+    Log::Comment(L"Test 3 = Scrolled range runs past the end of storage");
+    const SHORT rgFirstRows[] = { bufferSize.Y - 1, 2, 6 };
+
+    for (const auto firstRow : rgFirstRows)
+    {
+        Log::Comment(NoThrowString().Format(L"First row is %d", firstRow));
+
+        auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+        _buffer->_firstRow = firstRow;
+        _buffer->_RefreshRowIDs(std::nullopt);
+
+        // Tag every row with a letter so that we can tell where they all went.
+        for (SHORT y = 0; y < bufferSize.Y; y++)
+        {
+            _buffer->GetRowByOffset(y).GetCharRow().GlyphAt(0) = std::wstring(1, static_cast<wchar_t>(L'A' + y));
+        }
+
+        auto position = _buffer->GetRowByOffset(pos.Y).GetCharRow().GlyphAt(pos.X);
+        position = fire;
+
+        const auto straightens = (firstRow + pos.Y) % bufferSize.Y + 1 + delta > bufferSize.Y;
+        _buffer->ScrollRows(pos.Y, 1, delta);
+
+        VERIFY_ARE_EQUAL(straightens ? SHORT{ 0 } : firstRow, _buffer->_firstRow);
+
+        const auto shouldBeEmptyText = *_buffer->GetTextDataAt(pos);
+        const auto shouldBeFireText = *_buffer->GetTextDataAt(newPos);
+
+        VERIFY_ARE_EQUAL(String(L" "), String(shouldBeEmptyText.data(), gsl::narrow<int>(shouldBeEmptyText.size())));
+        VERIFY_ARE_EQUAL(String(fire), String(shouldBeFireText.data(), gsl::narrow<int>(shouldBeFireText.size())));
+
+        for (SHORT y = 0; y < bufferSize.Y; y++)
+        {
+            // The row at pos.Y moved down to newPos.Y, and the rows it passed moved up one to make room.
+            SHORT from = y;
+            if (y == newPos.Y)
+            {
+                from = pos.Y;
+            }
+            else if (y >= pos.Y && y < newPos.Y)
+            {
+                from = y + 1;
+            }
+
+            const auto tag = *_buffer->GetTextDataAt({ 0, y });
+            VERIFY_ARE_EQUAL(String(std::wstring(1, static_cast<wchar_t>(L'A' + from)).c_str()), String(tag.data(), gsl::narrow<int>(tag.size())));
+
+            const auto& row = _buffer->GetRowByOffset(y);
+            VERIFY_ARE_EQUAL(gsl::narrow<SHORT>((_buffer->_firstRow + y) % bufferSize.Y), row.GetId());
+            VERIFY_ARE_EQUAL(&row.GetCharRow(), &_buffer->_storage.at(row.GetId()).GetCharRow());
+        }
+    }
+}
+
 // This tests that rows removed from the buffer while resizing traditionally will also drop the high unicode
 // characters from the Unicode Storage buffer
 void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
@@ -2468,3 +2544,189 @@ void TextBufferTests::GetText()
         VERIFY_ARE_EQUAL(expectedText, result);
     }
 }
+
+void TextBufferTests::VisitTextRuns()
+{
+    // VisitText() streams each row to a sink in runs of the same color,
+    // which is what the HTML and RTF clipboard formats are built from.
+
+    // Records every call made to it, one string per call.
+    class RecordingSink final : public ITextSink
+    {
+    public:
+        std::vector<std::wstring> calls;
+
+        void BeginRow() override
+        {
+            calls.emplace_back(L"<row>");
+        }
+
+        void AppendText(const std::wstring_view text, const COLORREF foreground, const COLORREF background) override
+        {
+            calls.emplace_back(std::wstring{ text } + L"|" + std::to_wstring(foreground) + L"|" + std::to_wstring(background));
+        }
+
+        void AppendLineBreak() override
+        {
+            calls.emplace_back(L"<crlf>");
+        }
+    };
+
+    COORD bufferSize{ 10, 20 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    _buffer->Write(OutputCellIterator{ L"aaa", TextAttribute{ 0x1e } }, { 0, 0 }, std::nullopt);
+    _buffer->Write(OutputCellIterator{ L"bb", TextAttribute{ 0x1e } }, { 3, 0 }, std::nullopt);
+    _buffer->Write(OutputCellIterator{ L"cc", TextAttribute{ 0x2d } }, { 5, 0 }, std::nullopt);
+
+    std::function<COLORREF(TextAttribute&)> GetForegroundColor = [](TextAttribute& textAttr) -> COLORREF {
+        return textAttr.GetLegacyAttributes() & 0x0f;
+    };
+    std::function<COLORREF(TextAttribute&)> GetBackgroundColor = [](TextAttribute& textAttr) -> COLORREF {
+        return (textAttr.GetLegacyAttributes() & 0xf0) >> 4;
+    };
+
+    const auto textRects = _buffer->GetTextRects({ 0, 0 }, { 9, 1 });
+
+    Log::Comment(L"Adjacent cells with the same colors are one run, trailing whitespace is trimmed away.");
+    RecordingSink sink;
+    _buffer->VisitText(true, true, textRects, sink, GetForegroundColor, GetBackgroundColor);
+
+    const std::vector<std::wstring> expected{ L"<row>",
+                                              L"aaabb|14|1",
+                                              L"cc|13|2",
+                                              L"<crlf>",
+                                              L"<row>" };
+    VERIFY_ARE_EQUAL(expected.size(), sink.calls.size());
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        VERIFY_ARE_EQUAL(expected.at(i), sink.calls.at(i));
+    }
+
+    Log::Comment(L"A plain text sink gets the same text that GetText() returns.");
+    PlainTextSink textSink;
+    _buffer->VisitText(true, false, textRects, textSink);
+
+    std::wstring result;
+    for (const auto& text : _buffer->GetText(true, false, textRects).text)
+    {
+        result += text;
+    }
+    VERIFY_ARE_EQUAL(result, textSink.GetText());
+
+    Log::Comment(L"A plain text sink with a maximum length stops there.");
+    PlainTextSink limitedSink{ 4 };
+    _buffer->VisitText(true, false, textRects, limitedSink);
+    VERIFY_ARE_EQUAL(std::wstring{ L"aaab" }, limitedSink.GetText());
+}
+
+void TextBufferTests::VisitTextFormattedPerf()
+{
+    // Copying with formatting has to turn the whole selection into HTML and
+    // RTF while the UI waits. This copies a full scrollback of colorized output.
+
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES();
+
+    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+    COORD bufferSize{ 120, 9001 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x07 };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    // Every row is a dozen differently colored segments, a mix of legacy and RGB colors.
+    const std::wstring_view segment{ L"0123456789" };
+    const TextAttribute segmentAttrs[]{
+        TextAttribute{ 0x07 },
+        TextAttribute{ 0x0c },
+        TextAttribute{ 0x1e },
+        TextAttribute{ RGB(0xff, 0x80, 0x00), RGB(0x20, 0x20, 0x20) },
+        TextAttribute{ 0x4f },
+    };
+
+    Log::Comment(L"Filling the buffer...");
+    for (SHORT row = 0; row < bufferSize.Y; ++row)
+    {
+        for (SHORT column = 0; column < bufferSize.X; column += gsl::narrow<SHORT>(segment.size()))
+        {
+            const auto& segmentAttr = segmentAttrs[(row + column) % std::size(segmentAttrs)];
+            _buffer->Write(OutputCellIterator{ segment, segmentAttr }, { column, row }, std::nullopt);
+        }
+    }
+
+    std::function<COLORREF(TextAttribute&)> GetForegroundColor = std::bind(&CONSOLE_INFORMATION::LookupForegroundColor, &gci, std::placeholders::_1);
+    std::function<COLORREF(TextAttribute&)> GetBackgroundColor = std::bind(&CONSOLE_INFORMATION::LookupBackgroundColor, &gci, std::placeholders::_1);
+
+    const auto textRects = _buffer->GetTextRects({ 0, 0 }, { gsl::narrow<SHORT>(bufferSize.X - 1), gsl::narrow<SHORT>(bufferSize.Y - 1) });
+
+    Log::Comment(L"Working. Please wait...");
+    const auto now = std::chrono::steady_clock::now();
+
+    PlainTextSink textSink;
+    HtmlTextSink htmlSink{ 12, L"Consolas", RGB(0x00, 0x00, 0x00), "Windows Console Host" };
+    RtfTextSink rtfSink{ 12, L"Consolas", RGB(0x00, 0x00, 0x00) };
+    TeeTextSink sink{ &textSink, &htmlSink, &rtfSink };
+    _buffer->VisitText(true, true, textRects, sink, GetForegroundColor, GetBackgroundColor);
+    const auto htmlData = htmlSink.Finish();
+    const auto rtfData = rtfSink.Finish();
+
+    const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count();
+
+    VERIFY_ARE_EQUAL(static_cast<size_t>(bufferSize.X + 2) * bufferSize.Y - 2, textSink.GetText().size());
+
+    Log::Comment(NoThrowString().Format(L"%d rows of %d columns took %lld ms. %zu bytes of HTML, %zu bytes of RTF",
+                                 bufferSize.Y,
+                                 bufferSize.X,
+                                 delta,
+                                 htmlData.size(),
+                                 rtfData.size()));
+}
+
+void TextBufferTests::GetWordBoundariesAfterChanges()
+{
+    // The delimiter classes of each row are cached. Make sure that the cache
+    // follows both the text and the word delimiters it was built for.
+
+    COORD bufferSize{ 80, 9001 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    const std::wstring_view delimiters{ L" " };
+    const std::wstring_view otherDelimiters{ L" -" };
+
+    WriteLinesToBuffer({ L"word-other more" }, *_buffer);
+
+    Log::Comment(L"'-' isn't a delimiter, so the word ends at the space.");
+    VERIFY_ARE_EQUAL(COORD({ 9, 0 }), _buffer->GetWordEnd({ 0, 0 }, delimiters));
+    VERIFY_ARE_EQUAL(COORD({ 0, 0 }), _buffer->GetWordStart({ 9, 0 }, delimiters));
+
+    Log::Comment(L"Overwriting the text changes the boundaries.");
+    _buffer->Write(OutputCellIterator{ L"word other" }, { 0, 0 }, std::nullopt);
+    VERIFY_ARE_EQUAL(COORD({ 3, 0 }), _buffer->GetWordEnd({ 0, 0 }, delimiters));
+    VERIFY_ARE_EQUAL(COORD({ 5, 0 }), _buffer->GetWordStart({ 9, 0 }, delimiters));
+
+    Log::Comment(L"Changing the delimiters changes the boundaries.");
+    _buffer->Write(OutputCellIterator{ L"word-other" }, { 0, 0 }, std::nullopt);
+    VERIFY_ARE_EQUAL(COORD({ 3, 0 }), _buffer->GetWordEnd({ 0, 0 }, otherDelimiters));
+    VERIFY_ARE_EQUAL(COORD({ 5, 0 }), _buffer->GetWordStart({ 9, 0 }, otherDelimiters));
+    VERIFY_ARE_EQUAL(COORD({ 9, 0 }), _buffer->GetWordEnd({ 0, 0 }, delimiters));
+    VERIFY_ARE_EQUAL(COORD({ 0, 0 }), _buffer->GetWordStart({ 9, 0 }, delimiters));
+
+    Log::Comment(L"Word navigation crosses rows.");
+    _buffer->GetRowByOffset(0).Reset(attr);
+    _buffer->Write(OutputCellIterator{ L"word" }, { 76, 0 }, std::nullopt);
+    _buffer->Write(OutputCellIterator{ L"next" }, { 70, 2 }, std::nullopt);
+
+    COORD pos{ 76, 0 };
+    VERIFY_IS_TRUE(_buffer->MoveToNextWord(pos, delimiters, { 73, 2 }));
+    VERIFY_ARE_EQUAL(COORD({ 70, 2 }), pos);
+
+    pos = { 1, 1 };
+    VERIFY_IS_TRUE(_buffer->MoveToPreviousWord(pos, delimiters));
+    VERIFY_ARE_EQUAL(COORD({ 75, 0 }), pos);
+}
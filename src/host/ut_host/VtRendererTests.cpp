@@ -104,6 +104,7 @@ class Microsoft::Console::Render::VtRendererTest
     TEST_METHOD(Xterm256TestColors);
     TEST_METHOD(Xterm256TestCursor);
     TEST_METHOD(Xterm256TestExtendedAttributes);
+    TEST_METHOD(Xterm256TestCombinedRendition);
 
     TEST_METHOD(XtermTestInvalidate);
     TEST_METHOD(XtermTestColors);
@@ -453,8 +454,7 @@ void VtRendererTest::Xterm256TestColors()
     Log::Comment(NoThrowString().Format(
         L"Begin by setting some test values - FG,BG = (1,2,3), (4,5,6) to start"
         L"These values were picked for ease of formatting raw COLORREF values."));
-    qExpectedInput.push_back("\x1b[38;2;1;2;3m");
-    qExpectedInput.push_back("\x1b[48;2;5;6;7m");
+    qExpectedInput.push_back("\x1b[38;2;1;2;3;48;2;5;6;7m");
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(0x00030201,
                                                   0x00070605,
                                                   0,
@@ -694,32 +694,42 @@ void VtRendererTest::Xterm256TestExtendedAttributes()
     VERIFY_SUCCEEDED(TestData::TryGetValue(L"crossedOut", crossedOut));
 
     ExtendedAttributes desiredAttrs{ ExtendedAttributes::Normal };
-    std::vector<std::string> onSequences, offSequences;
+    std::vector<std::string> onParams;
 
     // Collect up a VT sequence to set the state given the method properties
     if (italics)
     {
         WI_SetFlag(desiredAttrs, ExtendedAttributes::Italics);
-        onSequences.push_back("\x1b[3m");
-        offSequences.push_back("\x1b[23m");
+        onParams.push_back("3");
     }
     if (blink)
     {
         WI_SetFlag(desiredAttrs, ExtendedAttributes::Blinking);
-        onSequences.push_back("\x1b[5m");
-        offSequences.push_back("\x1b[25m");
+        onParams.push_back("5");
     }
     if (invisible)
     {
         WI_SetFlag(desiredAttrs, ExtendedAttributes::Invisible);
-        onSequences.push_back("\x1b[8m");
-        offSequences.push_back("\x1b[28m");
+        onParams.push_back("8");
     }
     if (crossedOut)
     {
         WI_SetFlag(desiredAttrs, ExtendedAttributes::CrossedOut);
-        onSequences.push_back("\x1b[9m");
-        offSequences.push_back("\x1b[29m");
+        onParams.push_back("9");
+    }
+
+    // All of the attributes are combined into a single sequence. Turning them
+    // off with the default colors is always cheapest as a reset.
+    std::vector<std::string> onSequences, offSequences;
+    if (!onParams.empty())
+    {
+        std::string params;
+        for (const auto& param : onParams)
+        {
+            params += (params.empty() ? "" : ";") + param;
+        }
+        onSequences.push_back("\x1b[" + params + "m");
+        offSequences.push_back("\x1b[m");
     }
 
     wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
@@ -739,27 +749,126 @@ void VtRendererTest::Xterm256TestExtendedAttributes()
     Log::Comment(NoThrowString().Format(
         L"Test changing the text attributes"));
 
+    Log::Comment(NoThrowString().Format(
+        L"Begin by setting the default colors - FG,BG = BRIGHT_WHITE,DARK_BLACK"));
+    qExpectedInput.push_back("\x1b[m");
+    VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15],
+                                                  g_ColorTable[0],
+                                                  0,
+                                                  ExtendedAttributes::Normal,
+                                                  false));
+
     Log::Comment(NoThrowString().Format(
         L"----Turn the extended attributes on----"));
     TestPaint(*engine, [&]() {
         // Merge the "on" sequences into expected input.
         std::copy(onSequences.cbegin(), onSequences.cend(), std::back_inserter(qExpectedInput));
-        VERIFY_SUCCEEDED(engine->_UpdateExtendedAttrs(desiredAttrs));
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15],
+                                                      g_ColorTable[0],
+                                                      0,
+                                                      desiredAttrs,
+                                                      false));
     });
 
     Log::Comment(NoThrowString().Format(
         L"----Turn the extended attributes off----"));
     TestPaint(*engine, [&]() {
         std::copy(offSequences.cbegin(), offSequences.cend(), std::back_inserter(qExpectedInput));
-        VERIFY_SUCCEEDED(engine->_UpdateExtendedAttrs(ExtendedAttributes::Normal));
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15],
+                                                      g_ColorTable[0],
+                                                      0,
+                                                      ExtendedAttributes::Normal,
+                                                      false));
     });
 
     Log::Comment(NoThrowString().Format(
         L"----Turn the extended attributes back on----"));
     TestPaint(*engine, [&]() {
         std::copy(onSequences.cbegin(), onSequences.cend(), std::back_inserter(qExpectedInput));
-        VERIFY_SUCCEEDED(engine->_UpdateExtendedAttrs(desiredAttrs));
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15],
+                                                      g_ColorTable[0],
+                                                      0,
+                                                      desiredAttrs,
+                                                      false));
+    });
+
+    VerifyExpectedInputsDrained();
+}
+
+void VtRendererTest::Xterm256TestCombinedRendition()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), p, SetUpViewport(), g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE));
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    // Verify the first paint emits a clear and go home
+    qExpectedInput.push_back("\x1b[2J");
+    VERIFY_IS_TRUE(engine->_firstPaint);
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"Begin by setting the default colors - FG,BG = BRIGHT_WHITE,DARK_BLACK"));
+    qExpectedInput.push_back("\x1b[m");
+    VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15],
+                                                  g_ColorTable[0],
+                                                  0,
+                                                  ExtendedAttributes::Normal,
+                                                  false));
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"----Change bold, underline, FG and BG at once----"));
+        qExpectedInput.push_back("\x1b[1;4;31;42m");
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[4],
+                                                      g_ColorTable[2],
+                                                      COMMON_LVB_UNDERSCORE,
+                                                      ExtendedAttributes::Bold,
+                                                      false));
+
+        Log::Comment(NoThrowString().Format(
+            L"----Drop the underline and change the FG - a delta is shortest----"));
+        qExpectedInput.push_back("\x1b[24;38;2;1;2;3m");
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(0x00030201,
+                                                      g_ColorTable[2],
+                                                      0,
+                                                      ExtendedAttributes::Bold,
+                                                      false));
+
+        Log::Comment(NoThrowString().Format(
+            L"----Drop everything but the BG - a reset is shortest----"));
+        qExpectedInput.push_back("\x1b[0;42m");
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15],
+                                                      g_ColorTable[2],
+                                                      0,
+                                                      ExtendedAttributes::Normal,
+                                                      false));
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"Make sure that repeated transitions come out of the cache"));
+    const auto misses = engine->_sgrEncoder.GetCacheMisses();
+    TestPaint(*engine, [&]() {
+        for (auto i = 0; i < 3; i++)
+        {
+            qExpectedInput.push_back("\x1b[1;31m");
+            VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[4],
+                                                          g_ColorTable[2],
+                                                          0,
+                                                          ExtendedAttributes::Bold,
+                                                          false));
+            qExpectedInput.push_back("\x1b[0;42m");
+            VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15],
+                                                          g_ColorTable[2],
+                                                          0,
+                                                          ExtendedAttributes::Normal,
+                                                          false));
+        }
     });
+    VERIFY_ARE_EQUAL(misses + 2u, engine->_sgrEncoder.GetCacheMisses());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(4), engine->_sgrEncoder.GetCacheHits());
 
     VerifyExpectedInputsDrained();
 }
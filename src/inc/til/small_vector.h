@@ -0,0 +1,388 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <type_traits>
+
+namespace til // Terminal Implementation Library. Also: "Today I Learned"
+{
+    // A vector that keeps its first N elements inline, and only goes to the
+    // heap once it grows beyond that. Elements are moved around with plain
+    // copies, so T has to be trivially copyable.
+    template<class T, size_t N>
+    class small_vector
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "small_vector only supports trivially copyable types");
+        static_assert(N > 0, "small_vector needs room for at least one element inline");
+
+    private:
+        std::array<T, N> _buffer;
+        std::unique_ptr<T[]> _heap;
+        T* _data;
+        size_t _size;
+        size_t _capacity;
+
+#ifdef UNIT_TESTING
+        friend class SmallVectorTests;
+#endif
+
+    public:
+        using value_type = T;
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using reference = T&;
+        using const_reference = const T&;
+
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        small_vector() noexcept :
+            _buffer{},
+            _heap{},
+            _data{ _buffer.data() },
+            _size{ 0 },
+            _capacity{ N }
+        {
+        }
+
+        small_vector(std::initializer_list<T> init) :
+            small_vector()
+        {
+            assign(init.begin(), init.end());
+        }
+
+        small_vector(const small_vector& other) :
+            small_vector()
+        {
+            assign(other.begin(), other.end());
+        }
+
+        small_vector(small_vector&& other) noexcept :
+            small_vector()
+        {
+            _steal(other);
+        }
+
+        small_vector& operator=(const small_vector& other)
+        {
+            if (this != &other)
+            {
+                assign(other.begin(), other.end());
+            }
+            return *this;
+        }
+
+        small_vector& operator=(small_vector&& other) noexcept
+        {
+            if (this != &other)
+            {
+                _heap.reset();
+                _data = _buffer.data();
+                _size = 0;
+                _capacity = N;
+                _steal(other);
+            }
+            return *this;
+        }
+
+        bool operator==(const small_vector& other) const noexcept
+        {
+            return std::equal(begin(), end(), other.begin(), other.end());
+        }
+
+        bool operator!=(const small_vector& other) const noexcept
+        {
+            return !(*this == other);
+        }
+
+        iterator begin() noexcept
+        {
+            return _data;
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return _data;
+        }
+
+        iterator end() noexcept
+        {
+            return _data + _size;
+        }
+
+        const_iterator end() const noexcept
+        {
+            return _data + _size;
+        }
+
+        const_iterator cbegin() const noexcept
+        {
+            return begin();
+        }
+
+        const_iterator cend() const noexcept
+        {
+            return end();
+        }
+
+        reverse_iterator rbegin() noexcept
+        {
+            return reverse_iterator(end());
+        }
+
+        const_reverse_iterator rbegin() const noexcept
+        {
+            return const_reverse_iterator(end());
+        }
+
+        reverse_iterator rend() noexcept
+        {
+            return reverse_iterator(begin());
+        }
+
+        const_reverse_iterator rend() const noexcept
+        {
+            return const_reverse_iterator(begin());
+        }
+
+        size_type size() const noexcept
+        {
+            return _size;
+        }
+
+        size_type capacity() const noexcept
+        {
+            return _capacity;
+        }
+
+        bool empty() const noexcept
+        {
+            return !_size;
+        }
+
+        // Returns true if the elements currently live in the inline buffer.
+        bool is_inline() const noexcept
+        {
+            return !_heap;
+        }
+
+        T* data() noexcept
+        {
+            return _data;
+        }
+
+        const T* data() const noexcept
+        {
+            return _data;
+        }
+
+        reference operator[](size_type pos) noexcept
+        {
+            return _data[pos];
+        }
+
+        const_reference operator[](size_type pos) const noexcept
+        {
+            return _data[pos];
+        }
+
+        reference at(size_type pos)
+        {
+            if (_size <= pos)
+            {
+                _outOfRange();
+            }
+            return _data[pos];
+        }
+
+        const_reference at(size_type pos) const
+        {
+            if (_size <= pos)
+            {
+                _outOfRange();
+            }
+            return _data[pos];
+        }
+
+        reference front() noexcept
+        {
+            return _data[0];
+        }
+
+        const_reference front() const noexcept
+        {
+            return _data[0];
+        }
+
+        reference back() noexcept
+        {
+            return _data[_size - 1];
+        }
+
+        const_reference back() const noexcept
+        {
+            return _data[_size - 1];
+        }
+
+        void reserve(size_type newCapacity)
+        {
+            if (newCapacity > _capacity)
+            {
+                _grow(newCapacity);
+            }
+        }
+
+        // Drops any heap storage we don't need anymore. If everything fits
+        // inline again, we move back into the inline buffer.
+        void shrink_to_fit()
+        {
+            if (_heap && _size <= N)
+            {
+                std::copy_n(_data, _size, _buffer.data());
+                _heap.reset();
+                _data = _buffer.data();
+                _capacity = N;
+            }
+        }
+
+        void clear() noexcept
+        {
+            _size = 0;
+        }
+
+        void resize(size_type newSize)
+        {
+            reserve(newSize);
+            if (newSize > _size)
+            {
+                std::fill(_data + _size, _data + newSize, T{});
+            }
+            _size = newSize;
+        }
+
+        void push_back(const T& val)
+        {
+            if (_size == _capacity)
+            {
+                // val might live inside of us. Copy it before we move.
+                const T copy = val;
+                _grow(_capacity * 2);
+                _data[_size++] = copy;
+            }
+            else
+            {
+                _data[_size++] = val;
+            }
+        }
+
+        void pop_back()
+        {
+            if (!_size)
+            {
+                _outOfRange();
+            }
+            --_size;
+        }
+
+        template<class InputIt>
+        void assign(InputIt first, InputIt last)
+        {
+            const auto count = static_cast<size_type>(std::distance(first, last));
+            if (count > _capacity)
+            {
+                // Don't bother preserving what we have, it's about to be replaced.
+                _size = 0;
+                _grow(count);
+            }
+            std::copy(first, last, _data);
+            _size = count;
+        }
+
+        iterator insert(const_iterator pos, const T& val)
+        {
+            // val might live inside of us. Copy it before we shift anything.
+            const T copy = val;
+            return insert(pos, &copy, &copy + 1);
+        }
+
+        // The inserted range must not come from this small_vector.
+        template<class InputIt>
+        iterator insert(const_iterator pos, InputIt first, InputIt last)
+        {
+            const auto offset = static_cast<size_type>(pos - cbegin());
+            const auto count = static_cast<size_type>(std::distance(first, last));
+            if (_size + count > _capacity)
+            {
+                _grow(std::max(_capacity * 2, _size + count));
+            }
+            std::copy_backward(_data + offset, _data + _size, _data + _size + count);
+            std::copy(first, last, _data + offset);
+            _size += count;
+            return _data + offset;
+        }
+
+        iterator erase(const_iterator pos)
+        {
+            return erase(pos, pos + 1);
+        }
+
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            const auto offset = static_cast<size_type>(first - cbegin());
+            const auto count = static_cast<size_type>(last - first);
+            std::copy(_data + offset + count, _data + _size, _data + offset);
+            _size -= count;
+            return _data + offset;
+        }
+
+        void swap(small_vector& other)
+        {
+            small_vector temp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(temp);
+        }
+
+    private:
+        void _grow(const size_type newCapacity)
+        {
+            auto heap = std::make_unique<T[]>(newCapacity);
+            std::copy_n(_data, _size, heap.get());
+            _heap = std::move(heap);
+            _data = _heap.get();
+            _capacity = newCapacity;
+        }
+
+        void _steal(small_vector& other) noexcept
+        {
+            if (other._heap)
+            {
+                _heap = std::move(other._heap);
+                _data = _heap.get();
+                _capacity = other._capacity;
+            }
+            else
+            {
+                std::copy_n(other._data, other._size, _buffer.data());
+            }
+            _size = other._size;
+
+            other._data = other._buffer.data();
+            other._size = 0;
+            other._capacity = N;
+        }
+
+        [[noreturn]] void _outOfRange() const
+        {
+            throw std::out_of_range("invalid small_vector<T, N> subscript");
+        }
+    };
+}
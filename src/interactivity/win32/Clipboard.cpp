@@ -221,32 +221,52 @@ void Clipboard::StoreSelectionToClipboard(bool const copyFormatting)
         includeCRLF = trimTrailingWhitespace = true;
     }
 
-    const auto text = buffer.GetText(includeCRLF,
-                                     trimTrailingWhitespace,
-                                     selectionRects,
-                                     GetForegroundColor,
-                                     GetBackgroundColor);
+    PlainTextSink textSink;
+    std::string htmlData;
+    std::string rtfData;
 
-    CopyTextToSystemClipboard(text, copyFormatting);
+    if (copyFormatting)
+    {
+        const auto& fontData = gci.GetActiveOutputBuffer().GetCurrentFont();
+        int const iFontHeightPoints = fontData.GetUnscaledSize().Y * 72 / ServiceLocator::LocateGlobals().dpi;
+        const COLORREF bgColor = gci.GetDefaultBackground();
+
+        // Read the buffer once, generating all three formats as we go.
+        HtmlTextSink htmlSink{ iFontHeightPoints, fontData.GetFaceName(), bgColor, "Windows Console Host" };
+        RtfTextSink rtfSink{ iFontHeightPoints, fontData.GetFaceName(), bgColor };
+        TeeTextSink sink{ &textSink, &htmlSink, &rtfSink };
+
+        buffer.VisitText(includeCRLF,
+                         trimTrailingWhitespace,
+                         selectionRects,
+                         sink,
+                         GetForegroundColor,
+                         GetBackgroundColor);
+
+        htmlData = htmlSink.Finish();
+        rtfData = rtfSink.Finish();
+    }
+    else
+    {
+        buffer.VisitText(includeCRLF,
+                         trimTrailingWhitespace,
+                         selectionRects,
+                         textSink);
+    }
+
+    CopyTextToSystemClipboard(textSink.GetText(), htmlData, rtfData);
 }
 
 // Routine Description:
 // - Copies the text given onto the global system clipboard.
 // Arguments:
-// - rows - Rows of text data to copy
-// - fAlsoCopyFormatting - true if the color and formatting should also be copied, false otherwise
-void Clipboard::CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows, bool const fAlsoCopyFormatting)
+// - text - The plain text to copy
+// - htmlData - The text as CF_HTML. If empty, no HTML is placed on the clipboard.
+// - rtfData - The text as RTF. If empty, no RTF is placed on the clipboard.
+void Clipboard::CopyTextToSystemClipboard(const std::wstring_view text, const std::string& htmlData, const std::string& rtfData)
 {
-    std::wstring finalString;
-
-    // Concatenate strings into one giant string to put onto the clipboard.
-    for (const auto& str : rows.text)
-    {
-        finalString += str;
-    }
-
     // allocate the final clipboard data
-    const size_t cchNeeded = finalString.size() + 1;
+    const size_t cchNeeded = text.size() + 1;
     const size_t cbNeeded = sizeof(wchar_t) * cchNeeded;
     wil::unique_hglobal globalHandle(GlobalAlloc(GMEM_MOVEABLE | GMEM_DDESHARE, cbNeeded));
     THROW_LAST_ERROR_IF_NULL(globalHandle.get());
@@ -256,7 +276,7 @@ void Clipboard::CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows,
 
     // The pattern gets a bit strange here because there's no good wil built-in for global lock of this type.
     // Try to copy then immediately unlock. Don't throw until after (so the hglobal won't be freed until we unlock).
-    const HRESULT hr = StringCchCopyW(pwszClipboard, cchNeeded, finalString.data());
+    const HRESULT hr = StringCchCopyNW(pwszClipboard, cchNeeded, text.data(), text.size());
     GlobalUnlock(globalHandle.get());
     THROW_IF_FAILED(hr);
 
@@ -271,17 +291,14 @@ void Clipboard::CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows,
         THROW_LAST_ERROR_IF(!EmptyClipboard());
         THROW_LAST_ERROR_IF_NULL(SetClipboardData(CF_UNICODETEXT, globalHandle.get()));
 
-        if (fAlsoCopyFormatting)
+        if (!htmlData.empty())
         {
-            const auto& fontData = ServiceLocator::LocateGlobals().getConsoleInformation().GetActiveOutputBuffer().GetCurrentFont();
-            int const iFontHeightPoints = fontData.GetUnscaledSize().Y * 72 / ServiceLocator::LocateGlobals().dpi;
-            const COLORREF bgColor = ServiceLocator::LocateGlobals().getConsoleInformation().GetDefaultBackground();
-
-            std::string HTMLToPlaceOnClip = TextBuffer::GenHTML(rows, iFontHeightPoints, fontData.GetFaceName(), bgColor, "Windows Console Host");
-            CopyToSystemClipboard(HTMLToPlaceOnClip, L"HTML Format");
+            CopyToSystemClipboard(htmlData, L"HTML Format");
+        }
 
-            std::string RTFToPlaceOnClip = TextBuffer::GenRTF(rows, iFontHeightPoints, fontData.GetFaceName(), bgColor);
-            CopyToSystemClipboard(RTFToPlaceOnClip, L"Rich Text Format");
+        if (!rtfData.empty())
+        {
+            CopyToSystemClipboard(rtfData, L"Rich Text Format");
         }
     }
 
@@ -24,6 +24,9 @@
 #define CM_CONSOLE_MSG           (WM_USER+16)
 #define CM_UPDATE_EDITKEYS       (WM_USER+17)
 
+// Timers
+#define ID_MOUSE_MOTION_TIMER    1
+
 #ifdef DBG
 #define CM_SET_KEY_STATE         (WM_USER+18)
 #define CM_SET_KEYBOARD_LAYOUT   (WM_USER+19)
@@ -6,6 +6,7 @@
 #include "windowio.hpp"
 
 #include "ConsoleControl.hpp"
+#include "CustomWindowMessages.h"
 #include "find.h"
 #include "clipboard.hpp"
 #include "consoleKeyInfo.hpp"
@@ -123,12 +124,42 @@ bool HandleTerminalMouseEvent(const COORD cMousePosition,
     // Virtual terminal input mode
     if (IsInVirtualTerminalInputMode())
     {
-        fWasHandled = gci.GetActiveInputBuffer()->GetTerminalInput().HandleMouse(cMousePosition, uiButton, sModifierKeystate, sWheelDelta);
+        auto& terminalInput = gci.GetActiveInputBuffer()->GetTerminalInput();
+        fWasHandled = terminalInput.HandleMouse(cMousePosition, uiButton, sModifierKeystate, sWheelDelta);
+
+        // If a motion report was held back, make sure it's sent once it's due,
+        // even if the mouse doesn't move anymore.
+        const auto now = std::chrono::steady_clock::now();
+        const auto due = terminalInput.FlushMouseMotion(now);
+        if (due.has_value())
+        {
+            const auto delay = std::chrono::ceil<std::chrono::milliseconds>(due.value() - now);
+            SetTimer(ServiceLocator::LocateConsoleWindow()->GetWindowHandle(),
+                     ID_MOUSE_MOTION_TIMER,
+                     gsl::narrow_cast<UINT>(std::max<std::chrono::milliseconds::rep>(delay.count(), USER_TIMER_MINIMUM)),
+                     nullptr);
+        }
     }
 
     return fWasHandled;
 }
 
+// Routine Description:
+// - Sends the mouse motion report that the terminal input held back, once it's due.
+// Arguments:
+// - hWnd - The console window, which owns the timer.
+// Return Value:
+// - <none>
+void HandleMouseMotionTimer(const HWND hWnd)
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    const auto due = gci.GetActiveInputBuffer()->GetTerminalInput().FlushMouseMotion(std::chrono::steady_clock::now());
+    if (!due.has_value())
+    {
+        KillTimer(hWnd, ID_MOUSE_MOTION_TIMER);
+    }
+}
+
 void HandleKeyEvent(const HWND hWnd,
                     const UINT Message,
                     const WPARAM wParam,
@@ -23,6 +23,7 @@ BOOL HandleMouseEvent(const SCREEN_INFORMATION& ScreenInfo,
                       const UINT Message,
                       const WPARAM wParam,
                       const LPARAM lParam);
+void HandleMouseMotionTimer(const HWND hWnd);
 
 VOID SetConsoleWindowOwner(const HWND hwnd, _Inout_opt_ ConsoleProcessHandle* pProcessData);
 DWORD WINAPI ConsoleInputThreadProcWin32(LPVOID lpParameter);
@@ -662,6 +662,17 @@ using namespace Microsoft::Console::Types;
         break;
     }
 
+    case WM_TIMER:
+    {
+        if (wParam != ID_MOUSE_MOTION_TIMER)
+        {
+            goto CallDefWin;
+        }
+
+        HandleMouseMotionTimer(hWnd);
+        break;
+    }
+
     case CM_SET_WINDOW_SIZE:
     {
         Status = _InternalSetWindowSize();
@@ -0,0 +1,211 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "DirtySpans.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+// Routine Description:
+// - Marks a region as invalid. Writes usually continue right where the last
+//      one stopped, so this is merged into the last region if possible.
+// Arguments:
+// - region - Exclusive rectangle, in viewport coordinates.
+// Return Value:
+// - <none>
+void DirtySpans::Add(const SMALL_RECT& region)
+{
+    if (_overflowed || region.Left >= region.Right || region.Top >= region.Bottom)
+    {
+        return;
+    }
+
+    if (!_regions.empty() && s_TryMerge(_regions.back(), region))
+    {
+        return;
+    }
+
+    _regions.push_back(region);
+
+    if (_regions.size() >= _compactThreshold)
+    {
+        Compact();
+
+        // If that didn't help much, the invalid area is just that fragmented.
+        // Don't compact again right away, and give up on it eventually.
+        if (_regions.size() >= _compactThreshold / 2)
+        {
+            if (_compactThreshold >= MaxCompactThreshold)
+            {
+                _regions.clear();
+                _overflowed = true;
+                return;
+            }
+            _compactThreshold *= 2;
+        }
+    }
+}
+
+// Routine Description:
+// - Forgets every invalid region, e.g. because they've been handed to the
+//      engines or because everything is invalid anyways.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void DirtySpans::Clear() noexcept
+{
+    _regions.clear();
+    _compactThreshold = InitialCompactThreshold;
+    _overflowed = false;
+}
+
+// Routine Description:
+// - Checks whether anything is invalid.
+// Arguments:
+// - <none>
+// Return Value:
+// - True if nothing was added since the last Clear.
+bool DirtySpans::empty() const noexcept
+{
+    return _regions.empty() && !_overflowed;
+}
+
+// Routine Description:
+// - Checks whether there were too many regions to keep track of. From then on
+//      until the next Clear, everything is invalid and Compact returns nothing.
+// Arguments:
+// - <none>
+// Return Value:
+// - True if the whole viewport has to be redrawn.
+bool DirtySpans::Overflowed() const noexcept
+{
+    return _overflowed;
+}
+
+// Routine Description:
+// - Merges the invalid regions into as few rectangles as is easily possible.
+//      Every region is split into spans of one row each. Overlapping or
+//      touching spans on the same row are merged, and spans with the same
+//      columns on consecutive rows are stacked back into rectangles.
+// Arguments:
+// - <none>
+// Return Value:
+// - The invalid regions, as exclusive rectangles that don't overlap.
+const std::vector<SMALL_RECT>& DirtySpans::Compact()
+{
+    if (_regions.size() <= 1)
+    {
+        return _regions;
+    }
+
+    struct Span
+    {
+        SHORT row;
+        SHORT left;
+        SHORT right;
+    };
+
+    std::vector<Span> spans;
+    for (const auto& region : _regions)
+    {
+        for (auto row = region.Top; row < region.Bottom; ++row)
+        {
+            spans.push_back({ row, region.Left, region.Right });
+        }
+    }
+
+    std::sort(spans.begin(), spans.end(), [](const Span& a, const Span& b) noexcept {
+        return a.row < b.row || (a.row == b.row && a.left < b.left);
+    });
+
+    // Merge the spans on each row.
+    auto merged = spans.begin();
+    for (auto it = spans.begin() + 1; it != spans.end(); ++it)
+    {
+        if (it->row == merged->row && it->left <= merged->right)
+        {
+            merged->right = std::max(merged->right, it->right);
+        }
+        else
+        {
+            *++merged = *it;
+        }
+    }
+    spans.erase(merged + 1, spans.end());
+
+    // Stack spans with the same columns on consecutive rows. Only the
+    // rectangles that reached down to the previous row can be extended.
+    _regions.clear();
+    std::vector<size_t> previousRow;
+    std::vector<size_t> currentRow;
+    auto row = spans.front().row;
+    for (const auto& span : spans)
+    {
+        if (span.row != row)
+        {
+            previousRow.swap(currentRow);
+            currentRow.clear();
+            row = span.row;
+        }
+
+        const auto bottom = gsl::narrow_cast<SHORT>(span.row + 1);
+        const auto above = std::find_if(previousRow.begin(), previousRow.end(), [&](const size_t index) {
+            const auto& rect = _regions.at(index);
+            return rect.Bottom == span.row && rect.Left == span.left && rect.Right == span.right;
+        });
+
+        if (above != previousRow.end())
+        {
+            _regions.at(*above).Bottom = bottom;
+            currentRow.push_back(*above);
+        }
+        else
+        {
+            currentRow.push_back(_regions.size());
+            _regions.push_back({ span.left, span.row, span.right, bottom });
+        }
+    }
+
+    return _regions;
+}
+
+// Routine Description:
+// - Grows target to cover region as well, if the two together are a
+//      rectangle. That's the case if one contains the other, or if they line up
+//      on two sides and overlap or touch on the others.
+// Arguments:
+// - target - The region to grow.
+// - region - The region to add to it.
+// Return Value:
+// - True if target now covers region.
+bool DirtySpans::s_TryMerge(SMALL_RECT& target, const SMALL_RECT& region) noexcept
+{
+    const auto sameRows = target.Top == region.Top && target.Bottom == region.Bottom;
+    const auto sameColumns = target.Left == region.Left && target.Right == region.Right;
+
+    if (region.Left >= target.Left && region.Right <= target.Right &&
+        region.Top >= target.Top && region.Bottom <= target.Bottom)
+    {
+        return true;
+    }
+
+    if (sameRows && region.Left <= target.Right && region.Right >= target.Left)
+    {
+        target.Left = std::min(target.Left, region.Left);
+        target.Right = std::max(target.Right, region.Right);
+        return true;
+    }
+
+    if (sameColumns && region.Top <= target.Bottom && region.Bottom >= target.Top)
+    {
+        target.Top = std::min(target.Top, region.Top);
+        target.Bottom = std::max(target.Bottom, region.Bottom);
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,52 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- DirtySpans.hpp
+
+Abstract:
+- Collects the regions of the viewport that were invalidated since they were
+    last handed to the render engines.
+- Writing text invalidates the buffer one small piece at a time, often the
+    same row over and over again. Rather than making a virtual call into every
+    engine for each of those, the renderer adds them here, and the engines are
+    told about the merged result once: before the next frame, or before any
+    other notification whose order matters relative to these.
+- Merging never changes the set of cells that are invalid. Two regions are
+    only merged if their union is a rectangle. If the regions are so scattered
+    that even compacting them doesn't keep their number in check, the set
+    overflows and everything counts as invalid instead.
+- This isn't synchronized. The renderer guards it with a lock of its own,
+    since not every caller that triggers a redraw holds the console lock.
+--*/
+
+#pragma once
+
+namespace Microsoft::Console::Render
+{
+    class DirtySpans final
+    {
+    public:
+        void Add(const SMALL_RECT& region);
+        void Clear() noexcept;
+        bool empty() const noexcept;
+        bool Overflowed() const noexcept;
+
+        const std::vector<SMALL_RECT>& Compact();
+
+    private:
+        // Exclusive rectangles, in viewport coordinates.
+        std::vector<SMALL_RECT> _regions;
+        // Compact runs when this many regions have piled up,
+        // so that a long run of scattered writes can't grow this forever.
+        size_t _compactThreshold = InitialCompactThreshold;
+        // Set once there were too many regions to keep track of.
+        bool _overflowed = false;
+
+        static constexpr size_t InitialCompactThreshold = 256;
+        static constexpr size_t MaxCompactThreshold = 4096;
+
+        static bool s_TryMerge(SMALL_RECT& target, const SMALL_RECT& region) noexcept;
+    };
+}
@@ -0,0 +1,427 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "RenderSnapshot.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Console::Types;
+
+// Routine Description:
+// - Creates an iterator over some of the cells of a row.
+// Arguments:
+// - row - The row to walk.
+// - index - The first cell.
+// - end - One past the last cell.
+RowSnapshot::Iterator::Iterator(const RowSnapshot& row, const size_t index, const size_t end) noexcept :
+    _row{ &row },
+    _index{ index },
+    _end{ end }
+{
+}
+
+// Routine Description:
+// - Checks whether the iterator still points at a cell.
+// Arguments:
+// - <none>
+// Return Value:
+// - True if there is a cell, false once the end was reached.
+RowSnapshot::Iterator::operator bool() const noexcept
+{
+    return _index < _end;
+}
+
+// Routine Description:
+// - Moves the iterator to the right. It stops at the end.
+// Arguments:
+// - movement - The number of cells to move.
+// Return Value:
+// - A reference to this iterator.
+RowSnapshot::Iterator& RowSnapshot::Iterator::operator+=(const ptrdiff_t movement) noexcept
+{
+    const auto remaining = _end - _index;
+    _index += std::min(gsl::narrow_cast<size_t>(std::max<ptrdiff_t>(movement, 0)), remaining);
+    return *this;
+}
+
+// Routine Description:
+// - Gets the text of the current cell.
+// Arguments:
+// - <none>
+// Return Value:
+// - The text. It's only valid for as long as the snapshot is.
+std::wstring_view RowSnapshot::Iterator::Chars() const noexcept
+{
+    const auto& cell = til::at(_row->_cells, _index);
+    return std::wstring_view{ _row->_text }.substr(cell.textBegin, cell.textLength);
+}
+
+// Routine Description:
+// - Gets whether the current cell is half of a two column character.
+// Arguments:
+// - <none>
+// Return Value:
+// - The double byte attribute of the cell.
+DbcsAttribute RowSnapshot::Iterator::DbcsAttr() const noexcept
+{
+    return til::at(_row->_cells, _index).dbcsAttr;
+}
+
+// Routine Description:
+// - Reports how many columns the text of the current cell takes up, the same
+//      way OutputCellView does.
+// Arguments:
+// - <none>
+// Return Value:
+// - 2 for the left half of a two column character, 1 otherwise.
+size_t RowSnapshot::Iterator::Columns() const noexcept
+{
+    return DbcsAttr().IsLeading() ? 2 : 1;
+}
+
+// Routine Description:
+// - Gets the id of the current cell's brush within the row.
+// Arguments:
+// - <none>
+// Return Value:
+// - The id. Cells with the same attributes have the same id.
+size_t RowSnapshot::Iterator::GetBrushId() const noexcept
+{
+    return til::at(_row->_cells, _index).brushId;
+}
+
+// Routine Description:
+// - Gets the attributes of the current cell, and the colors they resolve to.
+// Arguments:
+// - <none>
+// Return Value:
+// - The brush.
+const SnapshotBrush& RowSnapshot::Iterator::GetBrush() const noexcept
+{
+    return til::at(_row->_brushes, GetBrushId());
+}
+
+// Routine Description:
+// - Copies the cells of a row, until the given iterator reaches its end.
+// Arguments:
+// - data - Resolves the colors of the text attributes.
+// - it - The first cell to copy. It has to be limited to a single row.
+// - left - The buffer column of the first cell.
+// - wrapForced - Whether the row wrapped onto the next one.
+RowSnapshot::RowSnapshot(const IRenderData& data, TextBufferCellIterator it, const SHORT left, const bool wrapForced) :
+    _left{ left },
+    _wrapForced{ wrapForced }
+{
+    // The buffer's attribute id changes exactly when the attributes do, and
+    // that's cheaper to compare than looking up the brush for every cell.
+    std::optional<TextAttributeId> lastAttributeId;
+    uint16_t brushId = 0;
+
+    while (it)
+    {
+        const auto attributeId = it.GetAttributeId();
+        if (attributeId != lastAttributeId)
+        {
+            brushId = _FindOrAddBrush(data, it->TextAttr());
+            lastAttributeId = attributeId;
+        }
+
+        const auto chars = it->Chars();
+        _cells.push_back({ _text.size(), gsl::narrow<uint16_t>(chars.size()), brushId, it->DbcsAttr() });
+        _text.append(chars);
+
+        ++it;
+    }
+}
+
+// Routine Description:
+// - Gets an iterator over the copied cells within the given columns.
+// Arguments:
+// - left - The buffer column to start at.
+// - right - The buffer column to stop before.
+// Return Value:
+// - The iterator. It's empty if none of those columns were copied.
+RowSnapshot::Iterator RowSnapshot::GetCells(const SHORT left, const SHORT right) const noexcept
+{
+    const auto clamp = [&](const SHORT column) noexcept {
+        return gsl::narrow_cast<size_t>(std::clamp<ptrdiff_t>(column - _left, 0, gsl::narrow_cast<ptrdiff_t>(_cells.size())));
+    };
+
+    const auto begin = clamp(left);
+    return { *this, begin, std::max(begin, clamp(right)) };
+}
+
+// Routine Description:
+// - Gets an iterator over the copied cells from the given column to the end.
+// Arguments:
+// - left - The buffer column to start at.
+// Return Value:
+// - The iterator.
+RowSnapshot::Iterator RowSnapshot::GetCells(const SHORT left) const noexcept
+{
+    return GetCells(left, std::numeric_limits<SHORT>::max());
+}
+
+// Routine Description:
+// - Checks whether the row wrapped onto the next one when it was copied.
+// Arguments:
+// - <none>
+// Return Value:
+// - True if the row was wrapped.
+bool RowSnapshot::WasWrapForced() const noexcept
+{
+    return _wrapForced;
+}
+
+// Routine Description:
+// - Gets the brush for some attributes, resolving their colors if this row
+//      didn't use them yet.
+// Arguments:
+// - data - Resolves the colors of the text attributes.
+// - attr - The attributes.
+// Return Value:
+// - The id of the brush within this row.
+uint16_t RowSnapshot::_FindOrAddBrush(const IRenderData& data, const TextAttribute& attr)
+{
+    // Rows rarely have more than a handful of different attributes.
+    const auto it = std::find_if(_brushes.begin(), _brushes.end(), [&](const SnapshotBrush& brush) noexcept {
+        return brush.attr == attr;
+    });
+    if (it != _brushes.end())
+    {
+        return gsl::narrow_cast<uint16_t>(it - _brushes.begin());
+    }
+
+    _brushes.push_back({ attr, data.GetForegroundColor(attr), data.GetBackgroundColor(attr) });
+    return gsl::narrow<uint16_t>(_brushes.size() - 1);
+}
+
+// Routine Description:
+// - Copies everything that's needed to paint a frame. The console has to be
+//      locked for this.
+// Arguments:
+// - data - The console to copy from.
+// - dirtyRows - One entry for each row of the viewport. Rows that are true are copied.
+// - selection - The selection rectangles, relative to the viewport.
+// - version - Tells this snapshot apart from the ones taken before it.
+RenderSnapshot::RenderSnapshot(IRenderData& data,
+                               const std::vector<bool>& dirtyRows,
+                               std::vector<SMALL_RECT> selection,
+                               const size_t version) :
+    _version{ version },
+    _viewport{ data.GetViewport() },
+    _bufferWidth{ data.GetTextBuffer().GetSize().Width() },
+    _defaultBrush{},
+    _screenReversed{ data.IsScreenReversed() },
+    _gridLinesAllowed{ data.IsGridLineDrawingAllowed() },
+    _selection{ std::move(selection) },
+    _cursor{ s_GetCursor(data, _viewport) },
+    _title{ data.GetConsoleTitle() }
+{
+    const auto defaultAttr = data.GetDefaultBrushColors();
+    _defaultBrush = { defaultAttr, data.GetForegroundColor(defaultAttr), data.GetBackgroundColor(defaultAttr) };
+
+    const auto& buffer = data.GetTextBuffer();
+    _rows.resize(gsl::narrow_cast<size_t>(_viewport.Height()));
+    for (size_t row = 0; row < _rows.size() && row < dirtyRows.size(); row++)
+    {
+        if (!dirtyRows.at(row))
+        {
+            continue;
+        }
+
+        const COORD origin{ _viewport.Left(), gsl::narrow_cast<SHORT>(_viewport.Top() + row) };
+        const auto line = Viewport::FromDimensions(origin, { _viewport.Width(), 1 });
+        const auto wrapForced = buffer.GetRowByOffset(origin.Y).GetCharRow().WasWrapForced();
+        _rows.at(row).emplace(data, buffer.GetCellDataAt(origin, line), origin.X, wrapForced);
+    }
+
+    // Overlays are small, like the IME composition string. They're copied whole.
+    for (const auto& overlay : data.GetOverlays())
+    {
+        auto& copy = _overlays.emplace_back(Overlay{ overlay.origin, overlay.region, {} });
+        for (auto row = overlay.region.Top(); row <= overlay.region.BottomInclusive(); row++)
+        {
+            const COORD origin{ overlay.region.Left(), row };
+            copy.rows.emplace_back(data, overlay.buffer.GetCellLineDataAt(origin), origin.X, false);
+        }
+    }
+}
+
+// Routine Description:
+// - Gets the version that the renderer gave this snapshot.
+// Arguments:
+// - <none>
+// Return Value:
+// - The version. Later snapshots have higher versions.
+size_t RenderSnapshot::GetVersion() const noexcept
+{
+    return _version;
+}
+
+// Routine Description:
+// - Gets the viewport at the time of the snapshot.
+// Arguments:
+// - <none>
+// Return Value:
+// - The viewport, in buffer coordinates.
+const Viewport& RenderSnapshot::GetViewport() const noexcept
+{
+    return _viewport;
+}
+
+// Routine Description:
+// - Gets the width of the text buffer at the time of the snapshot.
+// Arguments:
+// - <none>
+// Return Value:
+// - The width, in columns.
+SHORT RenderSnapshot::GetBufferWidth() const noexcept
+{
+    return _bufferWidth;
+}
+
+// Routine Description:
+// - Gets a row of the viewport.
+// Arguments:
+// - viewportRow - The row, relative to the top of the viewport.
+// Return Value:
+// - The copy of the row, or nullptr if it wasn't dirty when the snapshot was taken.
+const RowSnapshot* RenderSnapshot::GetRow(const SHORT viewportRow) const noexcept
+{
+    if (viewportRow < 0 || gsl::narrow_cast<size_t>(viewportRow) >= _rows.size())
+    {
+        return nullptr;
+    }
+
+    const auto& row = til::at(_rows, gsl::narrow_cast<size_t>(viewportRow));
+    return row ? &*row : nullptr;
+}
+
+// Routine Description:
+// - Gets the default attributes and their colors.
+// Arguments:
+// - <none>
+// Return Value:
+// - The default brush.
+const SnapshotBrush& RenderSnapshot::GetDefaultBrush() const noexcept
+{
+    return _defaultBrush;
+}
+
+// Routine Description:
+// - Gets whether the screen was shown in reverse video.
+// Arguments:
+// - <none>
+// Return Value:
+// - True if the screen was reversed.
+bool RenderSnapshot::IsScreenReversed() const noexcept
+{
+    return _screenReversed;
+}
+
+// Routine Description:
+// - Gets whether grid lines may be drawn.
+// Arguments:
+// - <none>
+// Return Value:
+// - True if grid lines may be drawn.
+bool RenderSnapshot::IsGridLineDrawingAllowed() const noexcept
+{
+    return _gridLinesAllowed;
+}
+
+// Routine Description:
+// - Gets the overlays that are drawn on top of the buffer.
+// Arguments:
+// - <none>
+// Return Value:
+// - The overlays.
+const std::vector<RenderSnapshot::Overlay>& RenderSnapshot::GetOverlays() const noexcept
+{
+    return _overlays;
+}
+
+// Routine Description:
+// - Gets the selection.
+// Arguments:
+// - <none>
+// Return Value:
+// - Exclusive rectangles, relative to the viewport.
+const std::vector<SMALL_RECT>& RenderSnapshot::GetSelectionRects() const noexcept
+{
+    return _selection;
+}
+
+// Routine Description:
+// - Gets how to draw the cursor.
+// Arguments:
+// - <none>
+// Return Value:
+// - The cursor options, or nullopt if the cursor isn't drawn.
+const std::optional<IRenderEngine::CursorOptions>& RenderSnapshot::GetCursor() const noexcept
+{
+    return _cursor;
+}
+
+// Routine Description:
+// - Gets the title of the window.
+// Arguments:
+// - <none>
+// Return Value:
+// - The title.
+const std::wstring& RenderSnapshot::GetTitle() const noexcept
+{
+    return _title;
+}
+
+// Routine Description:
+// - Builds the parameters for drawing the cursor.
+// Arguments:
+// - data - The console to get the cursor from.
+// - view - The viewport.
+// Return Value:
+// - The cursor options, relative to the viewport, or nullopt if the cursor
+//      isn't visible.
+std::optional<IRenderEngine::CursorOptions> RenderSnapshot::s_GetCursor(IRenderData& data, const Viewport& view)
+{
+    if (!data.IsCursorVisible())
+    {
+        return std::nullopt;
+    }
+
+    // Get cursor position in buffer
+    COORD coordCursor = data.GetCursorPosition();
+
+    // GH#3166: Only draw the cursor if it's actually in the viewport. It
+    // might be on the line that's in that partially visible row at the
+    // bottom of the viewport, the space that's not quite a full line in
+    // height. Since we don't draw that text, we shouldn't draw the cursor
+    // there either.
+    if (!view.IsInBounds(coordCursor))
+    {
+        return std::nullopt;
+    }
+
+    // Adjust cursor to viewport
+    view.ConvertToOrigin(&coordCursor);
+
+    COLORREF cursorColor = data.GetCursorColor();
+    bool useColor = cursorColor != INVALID_COLOR;
+
+    // Build up the cursor parameters including position, color, and drawing options
+    IRenderEngine::CursorOptions options;
+    options.coordCursor = coordCursor;
+    options.ulCursorHeightPercent = data.GetCursorHeight();
+    options.cursorPixelWidth = data.GetCursorPixelWidth();
+    options.fIsDoubleWidth = data.IsCursorDoubleWidth();
+    options.cursorType = data.GetCursorStyle();
+    options.fUseColor = useColor;
+    options.cursorColor = cursorColor;
+    options.isOn = data.IsCursorOn();
+
+    return options;
+}
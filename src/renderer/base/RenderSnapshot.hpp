@@ -0,0 +1,144 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- RenderSnapshot.hpp
+
+Abstract:
+- An immutable copy of everything the renderer needs to paint a frame: the
+    dirty rows of the viewport, the overlays, the selection, the cursor, the
+    title and the colors that the text attributes resolve to.
+- It's taken while the console is locked, right after the engines were told to
+    start painting. The engines then paint from the copy, and the console is
+    unlocked while they do. Output doesn't have to wait for a frame to finish,
+    and a frame doesn't have to wait for output.
+- Only the rows that at least one engine is going to paint are copied, and
+    every engine paints from the same snapshot.
+--*/
+
+#pragma once
+
+#include "../inc/IRenderData.hpp"
+#include "../inc/IRenderEngine.hpp"
+
+#include "../../buffer/out/textBuffer.hpp"
+
+namespace Microsoft::Console::Render
+{
+    // A text attribute, along with the colors it resolved to when it was copied.
+    struct SnapshotBrush
+    {
+        TextAttribute attr;
+        COLORREF foreground;
+        COLORREF background;
+    };
+
+    // The cells of one row, or of the right part of it.
+    class RowSnapshot final
+    {
+    public:
+        // Walks the copied cells the way TextBufferCellIterator walks the buffer.
+        class Iterator final
+        {
+        public:
+            Iterator(const RowSnapshot& row, const size_t index, const size_t end) noexcept;
+
+            operator bool() const noexcept;
+            Iterator& operator+=(const ptrdiff_t movement) noexcept;
+
+            std::wstring_view Chars() const noexcept;
+            DbcsAttribute DbcsAttr() const noexcept;
+            size_t Columns() const noexcept;
+
+            // Two cells have the same brush id if and only if they have the same attributes.
+            size_t GetBrushId() const noexcept;
+            const SnapshotBrush& GetBrush() const noexcept;
+
+        private:
+            const RowSnapshot* _row;
+            size_t _index;
+            size_t _end;
+        };
+
+        RowSnapshot(const IRenderData& data, TextBufferCellIterator it, const SHORT left, const bool wrapForced);
+
+        Iterator GetCells(const SHORT left, const SHORT right) const noexcept;
+        Iterator GetCells(const SHORT left) const noexcept;
+
+        bool WasWrapForced() const noexcept;
+
+    private:
+        struct Cell
+        {
+            size_t textBegin;
+            uint16_t textLength;
+            uint16_t brushId;
+            DbcsAttribute dbcsAttr;
+        };
+
+        // The text of every cell, one after the other.
+        std::wstring _text;
+        std::vector<Cell> _cells;
+        std::vector<SnapshotBrush> _brushes;
+        // The buffer column of the first cell.
+        SHORT _left;
+        bool _wrapForced;
+
+        uint16_t _FindOrAddBrush(const IRenderData& data, const TextAttribute& attr);
+    };
+
+    class RenderSnapshot final
+    {
+    public:
+        struct Overlay
+        {
+            // Where the top left of the overlay's buffer goes, relative to the viewport.
+            COORD origin;
+            // The part of the overlay's buffer that is used.
+            Microsoft::Console::Types::Viewport region;
+            // One row for each row of the region, from its left edge to the end of the line.
+            std::vector<RowSnapshot> rows;
+        };
+
+        RenderSnapshot(IRenderData& data,
+                       const std::vector<bool>& dirtyRows,
+                       std::vector<SMALL_RECT> selection,
+                       const size_t version);
+
+        size_t GetVersion() const noexcept;
+
+        const Microsoft::Console::Types::Viewport& GetViewport() const noexcept;
+        SHORT GetBufferWidth() const noexcept;
+        const RowSnapshot* GetRow(const SHORT viewportRow) const noexcept;
+
+        const SnapshotBrush& GetDefaultBrush() const noexcept;
+        bool IsScreenReversed() const noexcept;
+        bool IsGridLineDrawingAllowed() const noexcept;
+
+        const std::vector<Overlay>& GetOverlays() const noexcept;
+        const std::vector<SMALL_RECT>& GetSelectionRects() const noexcept;
+        const std::optional<IRenderEngine::CursorOptions>& GetCursor() const noexcept;
+        const std::wstring& GetTitle() const noexcept;
+
+    private:
+        size_t _version;
+
+        Microsoft::Console::Types::Viewport _viewport;
+        SHORT _bufferWidth;
+        // One entry per row of the viewport. Rows that nobody is going to paint aren't copied.
+        std::vector<std::optional<RowSnapshot>> _rows;
+
+        SnapshotBrush _defaultBrush;
+        bool _screenReversed;
+        bool _gridLinesAllowed;
+
+        std::vector<Overlay> _overlays;
+        // Exclusive rectangles, relative to the viewport.
+        std::vector<SMALL_RECT> _selection;
+        std::optional<IRenderEngine::CursorOptions> _cursor;
+        std::wstring _title;
+
+        static std::optional<IRenderEngine::CursorOptions> s_GetCursor(IRenderData& data, const Microsoft::Console::Types::Viewport& view);
+    };
+}
@@ -50,6 +50,87 @@ Renderer::~Renderer()
     _pThread.reset();
 }
 
+// Routine Description:
+// - Hands an invalidation to every engine. While the engines are painting a
+//      frame, it's queued instead, and handed to them in the same order once
+//      they're done.
+// Arguments:
+// - invalidate - Called with each engine. It's copied if it has to be queued,
+//      so it must not capture anything by reference.
+// Return Value:
+// - <none>
+template<typename T>
+void Renderer::_InvalidateEngines(T&& invalidate)
+{
+    const std::lock_guard<std::mutex> guard{ _invalidationLock };
+
+    if (_enginesBusy)
+    {
+        try
+        {
+            _pendingInvalidations.emplace_back(std::forward<T>(invalidate));
+        }
+        catch (...)
+        {
+            LOG_CAUGHT_EXCEPTION();
+
+            // Whatever couldn't be queued has to be repainted anyways.
+            _invalidationsLost = true;
+        }
+        return;
+    }
+
+    for (IRenderEngine* const pEngine : _rgpEngines)
+    {
+        invalidate(*pEngine);
+    }
+}
+
+// Routine Description:
+// - Marks the engines as busy with a frame. From now on, invalidations are
+//      queued until _SetEnginesIdle is called.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_SetEnginesBusy() noexcept
+{
+    const std::lock_guard<std::mutex> guard{ _invalidationLock };
+    _enginesBusy = true;
+}
+
+// Routine Description:
+// - Marks the engines as done with their frame, and hands them everything
+//      that was invalidated in the meantime.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_SetEnginesIdle() noexcept
+{
+    const std::lock_guard<std::mutex> guard{ _invalidationLock };
+
+    for (const auto& invalidate : _pendingInvalidations)
+    {
+        for (IRenderEngine* const pEngine : _rgpEngines)
+        {
+            invalidate(*pEngine);
+        }
+    }
+
+    if (_invalidationsLost)
+    {
+        for (IRenderEngine* const pEngine : _rgpEngines)
+        {
+            LOG_IF_FAILED(pEngine->InvalidateAll());
+        }
+    }
+
+    _pendingInvalidations.clear();
+    _invalidationsLost = false;
+    _enginesBusy = false;
+}
+
 // Routine Description:
 // - Walks through the console data structures to compose a new frame based on the data that has changed since last call and outputs it to the connected rendering engine.
 // Arguments:
@@ -63,33 +144,237 @@ Renderer::~Renderer()
         return S_FALSE;
     }
 
-    for (IRenderEngine* const pEngine : _rgpEngines)
+    return _PaintFrameForAllEngines();
+}
+
+// Routine Description:
+// - Paints a frame for every engine at once.
+// - The console is only locked while the engines start their frame and the
+//      parts of the console they're about to paint are copied into a snapshot.
+//      Painting from the snapshot and presenting happen after the lock is
+//      released, so output doesn't have to wait for them.
+// - The engines don't depend on each other. Each one paints on a thread pool
+//      thread of its own, except for the first, which paints on this thread,
+//      and the frame only takes as long as the slowest of them.
+// - An engine that asks for a retry gets its whole frame painted again, the
+//      others aren't painted twice.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, or S_FALSE if the renderer is going away.
+[[nodiscard]] HRESULT Renderer::_PaintFrameForAllEngines()
+{
+    auto firstTry = true;
+    auto tries = maxRetriesForRenderEngine;
+    while (true)
     {
-        auto tries = maxRetriesForRenderEngine;
-        while (tries > 0)
+        if (_destructing)
         {
-            if (_destructing)
-            {
-                return S_FALSE;
-            }
+            return S_FALSE;
+        }
 
-            const auto hr = _PaintFrameForEngine(pEngine);
-            if (E_PENDING == hr)
+        std::unique_lock<std::mutex> paintLock;
+
+        {
+            _pData->LockConsole();
+            auto unlock = wil::scope_exit([&]() {
+                _pData->UnlockConsole();
+            });
+
+            // The paint lock comes second. Whoever else takes it might already hold the console lock.
+            paintLock = std::unique_lock<std::mutex>{ _paintLock };
+
+            if (firstTry)
             {
-                if (--tries == 0)
+                for (auto& worker : _engineWorkers)
                 {
-                    FAIL_FAST_HR_MSG(E_UNEXPECTED, "A rendering engine required too many retries.");
+                    worker.pending = true;
                 }
+                firstTry = false;
+            }
+
+            // Last chance check if anything scrolled without an explicit invalidate notification since the last frame.
+            _CheckViewportAndScroll();
+
+            _StartPaintLocked();
+
+            // From here on, the engines only paint what's in the snapshot.
+            // Whatever happens to the console in the meantime is for the next frame.
+            _SetEnginesBusy();
+        }
+
+        auto idle = wil::scope_exit([&]() {
+            _snapshot.reset();
+            _SetEnginesIdle();
+        });
+
+        _RunEngineWorkers(false);
+
+        // Trigger out-of-lock presentation for the engines that painted something.
+        _RunEngineWorkers(true);
+
+        idle.reset();
+
+        auto retry = false;
+        for (auto& worker : _engineWorkers)
+        {
+            if (!worker.pending)
+            {
                 continue;
             }
-            LOG_IF_FAILED(hr);
-            break;
+
+            if (E_PENDING == worker.hr)
+            {
+                retry = true;
+                continue;
+            }
+
+            LOG_IF_FAILED(worker.hr);
+            worker.pending = false;
+        }
+
+        if (!retry)
+        {
+            return S_OK;
+        }
+
+        if (--tries == 0)
+        {
+            FAIL_FAST_HR_MSG(E_UNEXPECTED, "A rendering engine required too many retries.");
         }
     }
+}
 
-    return S_OK;
+// Routine Description:
+// - Starts a frame for every pending engine, and takes the snapshot they're
+//      going to paint. The console has to be locked.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_StartPaintLocked() noexcept
+{
+    for (auto& worker : _engineWorkers)
+    {
+        if (worker.pending)
+        {
+            // S_FALSE means there's nothing to paint.
+            // The renderer itself tracks if there's something to do with the title, the
+            //      engine won't know that.
+            worker.hr = worker.engine->StartPaint();
+        }
+    }
+
+    try
+    {
+        std::vector<IRenderEngine*> engines;
+        for (const auto& worker : _engineWorkers)
+        {
+            if (worker.pending && worker.hr == S_OK)
+            {
+                engines.push_back(worker.engine);
+            }
+        }
+
+        if (!engines.empty())
+        {
+            _snapshot.emplace(_TakeSnapshot(engines));
+        }
+    }
+    catch (...)
+    {
+        const auto hr = LOG_CAUGHT_EXCEPTION();
+
+        // There's nothing to paint from. Let the engines finish the frame they started.
+        for (auto& worker : _engineWorkers)
+        {
+            if (worker.pending && worker.hr == S_OK)
+            {
+                LOG_IF_FAILED(worker.engine->EndPaint());
+                worker.hr = hr;
+            }
+        }
+    }
 }
 
+// Routine Description:
+// - Runs one half of the frame for every engine that completed the step
+//      before, and waits for all of them to finish.
+// Arguments:
+// - present - False to paint from the snapshot. True to present what was painted.
+// Return Value:
+// - <none>
+void Renderer::_RunEngineWorkers(const bool present) noexcept
+{
+    EngineWorker* local = nullptr;
+    for (auto& worker : _engineWorkers)
+    {
+        if (!worker.pending || worker.hr != S_OK)
+        {
+            worker.submitted = false;
+            continue;
+        }
+
+        worker.present = present;
+        if (!local)
+        {
+            // Keep the first engine on the render thread, like it always was,
+            // instead of leaving this thread idle while the others work.
+            worker.submitted = false;
+            local = &worker;
+        }
+        else
+        {
+            worker.submitted = true;
+            SubmitThreadpoolWork(worker.work.get());
+        }
+    }
+
+    if (local)
+    {
+        _RunEngineWorker(*local);
+    }
+
+    for (auto& worker : _engineWorkers)
+    {
+        if (worker.submitted)
+        {
+            WaitForThreadpoolWorkCallbacks(worker.work.get(), FALSE);
+        }
+    }
+}
+
+// Routine Description:
+// - Runs one half of the frame for an engine: either painting it, or
+//      presenting what was painted.
+// Arguments:
+// - worker - The engine and what to do with it. Receives the result.
+// Return Value:
+// - <none>
+void Renderer::_RunEngineWorker(EngineWorker& worker) noexcept
+{
+    worker.hr = worker.present ? worker.engine->Present() : _PaintSnapshot(worker.engine, *_snapshot);
+}
+
+// Routine Description:
+// - The thread pool callback for an engine's worker.
+// Arguments:
+// - context - The EngineWorker to run.
+// Return Value:
+// - <none>
+void CALLBACK Renderer::s_EngineWorkerCallback(PTP_CALLBACK_INSTANCE /*instance*/, PVOID context, PTP_WORK /*work*/) noexcept
+{
+    auto& worker = *static_cast<EngineWorker*>(context);
+    worker.renderer->_RunEngineWorker(worker);
+}
+
+// Routine Description:
+// - Paints and presents a frame for a single engine, right away. The caller
+//      has to hold the paint lock, or make sure that no frame can be painted.
+// Arguments:
+// - pEngine - The engine to paint.
+// Return Value:
+// - S_OK, or an error.
 [[nodiscard]] HRESULT Renderer::_PaintFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept
 try
 {
@@ -108,8 +393,6 @@ try
     RETURN_IF_FAILED(hr);
 
     // Return early if there's nothing to paint.
-    // The renderer itself tracks if there's something to do with the title, the
-    //      engine won't know that.
     if (S_FALSE == hr)
     {
         return S_OK;
@@ -119,8 +402,71 @@ try
         LOG_IF_FAILED(pEngine->EndPaint());
     });
 
+    const auto snapshot = _TakeSnapshot({ pEngine });
+
+    // Painting from the snapshot ends the frame.
+    endPaint.release();
+
+    // Force scope exit unlock to let go of global lock so other threads can run
+    unlock.reset();
+
+    RETURN_IF_FAILED(_PaintSnapshot(pEngine, snapshot));
+
+    // Trigger out-of-lock presentation for renderers that can support it
+    RETURN_IF_FAILED(pEngine->Present());
+
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Copies everything the given engines are going to paint. The console has
+//      to be locked, and the engines must have started their frame already,
+//      so that they know which parts of it are dirty.
+// Arguments:
+// - engines - The engines that are going to paint from the snapshot.
+// Return Value:
+// - The snapshot. Only the rows that are dirty for at least one of the engines are copied.
+RenderSnapshot Renderer::_TakeSnapshot(const std::vector<IRenderEngine*>& engines)
+{
+    const auto height = _pData->GetViewport().Height();
+
+    std::vector<bool> dirtyRows(gsl::narrow_cast<size_t>(height), false);
+    for (IRenderEngine* const pEngine : engines)
+    {
+        for (const auto& dirtyRect : pEngine->GetDirtyArea())
+        {
+            const auto top = std::max<ptrdiff_t>(dirtyRect.top(), 0);
+            const auto bottom = std::min<ptrdiff_t>(dirtyRect.bottom(), height);
+            for (auto row = top; row < bottom; row++)
+            {
+                dirtyRows.at(gsl::narrow_cast<size_t>(row)) = true;
+            }
+        }
+    }
+
+    return RenderSnapshot{ *_pData, dirtyRows, _GetSelectionRects(), ++_snapshotVersion };
+}
+
+// Routine Description:
+// - Paints a frame for an engine from a snapshot, and ends the frame. The
+//      engine must have started it already. The console doesn't have to be locked.
+// Arguments:
+// - pEngine - The engine to paint.
+// - snapshot - What to paint.
+// Return Value:
+// - S_OK if the engine has to present what was painted, or an error.
+[[nodiscard]] HRESULT Renderer::_PaintSnapshot(_In_ IRenderEngine* const pEngine, const RenderSnapshot& snapshot) noexcept
+try
+{
+    FAIL_FAST_IF_NULL(pEngine); // This is a programming error. Fail fast.
+
+    auto endPaint = wil::scope_exit([&]() {
+        LOG_IF_FAILED(pEngine->EndPaint());
+    });
+
     // A. Prep Colors
-    RETURN_IF_FAILED(_UpdateDrawingBrushes(pEngine, _pData->GetDefaultBrushColors(), true));
+    RETURN_IF_FAILED(_UpdateDrawingBrushes(pEngine, snapshot.GetDefaultBrush(), true));
 
     // B. Perform Scroll Operations
     RETURN_IF_FAILED(_PerformScrolling(pEngine));
@@ -129,30 +475,23 @@ try
     RETURN_IF_FAILED(_PaintBackground(pEngine));
 
     // 2. Paint Rows of Text
-    _PaintBufferOutput(pEngine);
+    _PaintBufferOutput(pEngine, snapshot);
 
     // 3. Paint overlays that reside above the text buffer
-    _PaintOverlays(pEngine);
+    _PaintOverlays(pEngine, snapshot);
 
     // 4. Paint Selection
-    _PaintSelection(pEngine);
+    _PaintSelection(pEngine, snapshot);
 
     // 5. Paint Cursor
-    _PaintCursor(pEngine);
+    _PaintCursor(pEngine, snapshot);
 
     // 6. Paint window title
-    RETURN_IF_FAILED(_PaintTitle(pEngine));
+    RETURN_IF_FAILED(_PaintTitle(pEngine, snapshot));
 
     // Force scope exit end paint to finish up collecting information and possibly painting
     endPaint.reset();
 
-    // Force scope exit unlock to let go of global lock so other threads can run
-    unlock.reset();
-
-    // Trigger out-of-lock presentation for renderers that can support it
-    RETURN_IF_FAILED(pEngine->Present());
-
-    // As we leave the scope, EndPaint will be called (declared above)
     return S_OK;
 }
 CATCH_RETURN()
@@ -175,8 +514,12 @@ void Renderer::_NotifyPaintFrame()
 // - <none>
 void Renderer::TriggerSystemRedraw(const RECT* const prcDirtyClient)
 {
-    std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
-        LOG_IF_FAILED(pEngine->InvalidateSystem(prcDirtyClient));
+    // This comes from the window, which doesn't lock the console for it. The
+    // client area doesn't move along with the viewport, so the collected
+    // regions don't have to be handed over first anyways.
+    const auto dirtyClient = *prcDirtyClient;
+    _InvalidateEngines([dirtyClient](IRenderEngine& engine) {
+        LOG_IF_FAILED(engine.InvalidateSystem(&dirtyClient));
     });
 
     _NotifyPaintFrame();
@@ -184,6 +527,8 @@ void Renderer::TriggerSystemRedraw(const RECT* const prcDirtyClient)
 
 // Routine Description:
 // - Called when a particular region within the console buffer has changed.
+// - The engines aren't told right away. The region is collected with the
+//      others and handed to them once, before the next frame.
 // Arguments:
 // - <none>
 // Return Value:
@@ -196,14 +541,76 @@ void Renderer::TriggerRedraw(const Viewport& region)
     if (view.TrimToViewport(&srUpdateRegion))
     {
         view.ConvertToOrigin(&srUpdateRegion);
-        std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
-            LOG_IF_FAILED(pEngine->Invalidate(&srUpdateRegion));
-        });
+        try
+        {
+            const std::lock_guard<std::mutex> lock{ _dirtySpansLock };
+            _dirtySpans.Add(srUpdateRegion);
+        }
+        catch (...)
+        {
+            LOG_CAUGHT_EXCEPTION();
+
+            // Don't lose the region just because we couldn't hold on to it.
+            _InvalidateEngines([srUpdateRegion](IRenderEngine& engine) {
+                LOG_IF_FAILED(engine.Invalidate(&srUpdateRegion));
+            });
+        }
 
         _NotifyPaintFrame();
     }
 }
 
+// Routine Description:
+// - Hands the regions collected by TriggerRedraw to every engine. This has to
+//      happen before any other notification that could change what those
+//      regions mean to an engine, like a scroll.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_FlushDirtySpans()
+{
+    // Stay locked until the engines have them, so that
+    // two flushes can't hand them over out of order.
+    const std::lock_guard<std::mutex> lock{ _dirtySpansLock };
+
+    if (_dirtySpans.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        // The engines might be busy with a frame and only get these afterwards.
+        if (_dirtySpans.Overflowed())
+        {
+            _InvalidateEngines([](IRenderEngine& engine) {
+                LOG_IF_FAILED(engine.InvalidateAll());
+            });
+        }
+        else
+        {
+            _InvalidateEngines([regions = _dirtySpans.Compact()](IRenderEngine& engine) {
+                for (const auto& region : regions)
+                {
+                    LOG_IF_FAILED(engine.Invalidate(&region));
+                }
+            });
+        }
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+
+        // Whatever couldn't be handed over has to be repainted anyways.
+        _InvalidateEngines([](IRenderEngine& engine) {
+            LOG_IF_FAILED(engine.InvalidateAll());
+        });
+    }
+
+    _dirtySpans.Clear();
+}
+
 // Routine Description:
 // - Called when a particular coordinate within the console buffer has changed.
 // Arguments:
@@ -226,23 +633,26 @@ void Renderer::TriggerRedraw(const COORD* const pcoord)
 // - <none>
 void Renderer::TriggerRedrawCursor(const COORD* const pcoord)
 {
+    _FlushDirtySpans();
+
     Viewport view = _pData->GetViewport();
     COORD updateCoord = *pcoord;
 
     if (view.IsInBounds(updateCoord))
     {
         view.ConvertToOrigin(&updateCoord);
-        for (IRenderEngine* pEngine : _rgpEngines)
-        {
-            LOG_IF_FAILED(pEngine->InvalidateCursor(&updateCoord));
+        const auto doubleWidth = _pData->IsCursorDoubleWidth();
+        _InvalidateEngines([updateCoord, doubleWidth](IRenderEngine& engine) {
+            auto coord = updateCoord;
+            LOG_IF_FAILED(engine.InvalidateCursor(&coord));
 
             // Double-wide cursors need to invalidate the right half as well.
-            if (_pData->IsCursorDoubleWidth())
+            if (doubleWidth)
             {
-                updateCoord.X++;
-                LOG_IF_FAILED(pEngine->InvalidateCursor(&updateCoord));
+                coord.X++;
+                LOG_IF_FAILED(engine.InvalidateCursor(&coord));
             }
-        }
+        });
 
         _NotifyPaintFrame();
     }
@@ -257,8 +667,14 @@ void Renderer::TriggerRedrawCursor(const COORD* const pcoord)
 // - <none>
 void Renderer::TriggerRedrawAll()
 {
-    std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
-        LOG_IF_FAILED(pEngine->InvalidateAll());
+    // Everything is about to be invalid, there's no point in handing out parts of it.
+    {
+        const std::lock_guard<std::mutex> lock{ _dirtySpansLock };
+        _dirtySpans.Clear();
+    }
+
+    _InvalidateEngines([](IRenderEngine& engine) {
+        LOG_IF_FAILED(engine.InvalidateAll());
     });
 
     _NotifyPaintFrame();
@@ -276,6 +692,8 @@ void Renderer::TriggerTeardown()
     // We need to shut down the paint thread on teardown.
     _pThread->WaitForPaintCompletionAndDisable(INFINITE);
 
+    _FlushDirtySpans();
+
     // Then walk through and do one final paint on the caller's thread.
     for (IRenderEngine* const pEngine : _rgpEngines)
     {
@@ -300,12 +718,14 @@ void Renderer::TriggerSelection()
 {
     try
     {
+        _FlushDirtySpans();
+
         // Get selection rectangles
         const auto rects = _GetSelectionRects();
 
-        std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
-            LOG_IF_FAILED(pEngine->InvalidateSelection(_previousSelection));
-            LOG_IF_FAILED(pEngine->InvalidateSelection(rects));
+        _InvalidateEngines([previous = _previousSelection, rects](IRenderEngine& engine) {
+            LOG_IF_FAILED(engine.InvalidateSelection(previous));
+            LOG_IF_FAILED(engine.InvalidateSelection(rects));
         });
 
         _previousSelection = rects;
@@ -323,6 +743,10 @@ void Renderer::TriggerSelection()
 // - True if something changed and we scrolled. False otherwise.
 bool Renderer::_CheckViewportAndScroll()
 {
+    // The collected regions are relative to the viewport the engines know
+    // about, so they have to be handed over before it's updated.
+    _FlushDirtySpans();
+
     SMALL_RECT const srOldViewport = _srViewportPrevious;
     SMALL_RECT const srNewViewport = _pData->GetViewport().ToInclusive();
 
@@ -330,9 +754,9 @@ bool Renderer::_CheckViewportAndScroll()
     coordDelta.X = srOldViewport.Left - srNewViewport.Left;
     coordDelta.Y = srOldViewport.Top - srNewViewport.Top;
 
-    std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
-        LOG_IF_FAILED(pEngine->UpdateViewport(srNewViewport));
-        LOG_IF_FAILED(pEngine->InvalidateScroll(&coordDelta));
+    _InvalidateEngines([srNewViewport, coordDelta](IRenderEngine& engine) {
+        LOG_IF_FAILED(engine.UpdateViewport(srNewViewport));
+        LOG_IF_FAILED(engine.InvalidateScroll(&coordDelta));
     });
     _srViewportPrevious = srNewViewport;
 
@@ -365,8 +789,11 @@ void Renderer::TriggerScroll()
 // - <none>
 void Renderer::TriggerScroll(const COORD* const pcoordDelta)
 {
-    std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
-        LOG_IF_FAILED(pEngine->InvalidateScroll(pcoordDelta));
+    _FlushDirtySpans();
+
+    const auto delta = *pcoordDelta;
+    _InvalidateEngines([delta](IRenderEngine& engine) {
+        LOG_IF_FAILED(engine.InvalidateScroll(&delta));
     });
 
     _NotifyPaintFrame();
@@ -381,6 +808,11 @@ void Renderer::TriggerScroll(const COORD* const pcoordDelta)
 // - <none>
 void Renderer::TriggerCircling()
 {
+    // A forced paint has to wait for the frame that's in flight, if any.
+    const std::lock_guard<std::mutex> lock{ _paintLock };
+
+    _FlushDirtySpans();
+
     for (IRenderEngine* const pEngine : _rgpEngines)
     {
         bool fEngineRequestsRepaint = false;
@@ -403,11 +835,9 @@ void Renderer::TriggerCircling()
 // - <none>
 void Renderer::TriggerTitleChange()
 {
-    const std::wstring newTitle = _pData->GetConsoleTitle();
-    for (IRenderEngine* const pEngine : _rgpEngines)
-    {
-        LOG_IF_FAILED(pEngine->InvalidateTitle(newTitle));
-    }
+    _InvalidateEngines([newTitle = _pData->GetConsoleTitle()](IRenderEngine& engine) {
+        LOG_IF_FAILED(engine.InvalidateTitle(newTitle));
+    });
     _NotifyPaintFrame();
 }
 
@@ -415,12 +845,12 @@ void Renderer::TriggerTitleChange()
 // - Update the title for a particular engine.
 // Arguments:
 // - pEngine: the engine to update the title for.
+// - snapshot: the frame that's being painted.
 // Return Value:
 // - the HRESULT of the underlying engine's UpdateTitle call.
-HRESULT Renderer::_PaintTitle(IRenderEngine* const pEngine)
+HRESULT Renderer::_PaintTitle(IRenderEngine* const pEngine, const RenderSnapshot& snapshot)
 {
-    const std::wstring newTitle = _pData->GetConsoleTitle();
-    return pEngine->UpdateTitle(newTitle);
+    return pEngine->UpdateTitle(snapshot.GetTitle());
 }
 
 // Routine Description:
@@ -433,6 +863,9 @@ HRESULT Renderer::_PaintTitle(IRenderEngine* const pEngine)
 // - <none>
 void Renderer::TriggerFontChange(const int iDpi, const FontInfoDesired& FontInfoDesired, _Out_ FontInfo& FontInfo)
 {
+    // The engines can't change their font in the middle of a frame.
+    const std::lock_guard<std::mutex> lock{ _paintLock };
+
     std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
         LOG_IF_FAILED(pEngine->UpdateDpi(iDpi));
         LOG_IF_FAILED(pEngine->UpdateFont(FontInfoDesired, FontInfo));
@@ -461,6 +894,9 @@ void Renderer::TriggerFontChange(const int iDpi, const FontInfoDesired& FontInfo
         return E_FAIL;
     }
 
+    // The engines can only be asked between frames.
+    const std::lock_guard<std::mutex> lock{ _paintLock };
+
     // There will only every really be two engines - the real head and the VT
     //      renderer. We won't know which is which, so iterate over them.
     //      Only return the result of the successful one if it's not S_FALSE (which is the VT renderer)
@@ -493,6 +929,9 @@ bool Renderer::IsGlyphWideByFont(const std::wstring_view glyph)
 {
     bool fIsFullWidth = false;
 
+    // The engines can only measure glyphs between frames.
+    const std::lock_guard<std::mutex> lock{ _paintLock };
+
     // There will only every really be two engines - the real head and the VT
     //      renderer. We won't know which is which, so iterate over them.
     //      Only return the result of the successful one if it's not S_FALSE (which is the VT renderer)
@@ -511,6 +950,20 @@ bool Renderer::IsGlyphWideByFont(const std::wstring_view glyph)
     return fIsFullWidth;
 }
 
+// Routine Description:
+// - Waits for the frame in flight, if any, and keeps the next one from starting
+//      until the returned lock is released. Whoever changes the state of an
+//      engine directly, rather than through one of the triggers, has to hold it,
+//      since the engines paint their frames without the console lock.
+// Arguments:
+// - <none>
+// Return Value:
+// - The paint lock, held.
+[[nodiscard]] std::unique_lock<std::mutex> Renderer::LockForEngineChanges()
+{
+    return std::unique_lock<std::mutex>{ _paintLock };
+}
+
 // Routine Description:
 // - Sets an event in the render thread that allows it to proceed, thus enabling painting.
 // Arguments:
@@ -551,15 +1004,15 @@ void Renderer::WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs)
 // - This portion primarily handles figuring the current viewport, comparing it/trimming it versus the invalid portion of the frame, and queuing up, row by row, which pieces of text need to be further processed.
 // - See also: Helper functions that separate out each complexity of text rendering.
 // Arguments:
-// - <none>
+// - snapshot - The frame that's being painted.
 // Return Value:
 // - <none>
-void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
+void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine, const RenderSnapshot& snapshot)
 {
     // This is the subsection of the entire screen buffer that is currently being presented.
     // It can move left/right or top/bottom depending on how the viewport is scrolled
     // relative to the entire buffer.
-    const auto view = _pData->GetViewport();
+    const auto view = snapshot.GetViewport();
 
     // This is effectively the number of cells on the visible screen that need to be redrawn.
     // The origin is always 0, 0 because it represents the screen itself, not the underlying buffer.
@@ -581,9 +1034,6 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
         // Shortcut: don't bother redrawing if the width is 0.
         if (redraw.Width() > 0)
         {
-            // Retrieve the text buffer so we can read information out of it.
-            const auto& buffer = _pData->GetTextBuffer();
-
             // Now walk through each row of text that we need to redraw.
             for (auto row = redraw.Top(); row < redraw.BottomExclusive(); row++)
             {
@@ -598,18 +1048,25 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
                 // This means that we need 14,27 out of the backing buffer to fill in the 1,1 cell of the screen.
                 const auto screenLine = Viewport::Offset(bufferLine, -view.Origin());
 
+                // The snapshot holds a copy of every row that was dirty when the frame started.
+                const auto source = snapshot.GetRow(screenLine.Top());
+                if (!source)
+                {
+                    continue;
+                }
+
                 // Retrieve the cell information iterator limited to just this line we want to redraw.
-                auto it = buffer.GetCellDataAt(bufferLine.Origin(), bufferLine);
+                auto it = source->GetCells(bufferLine.Left(), bufferLine.RightExclusive());
 
                 // Calculate if two things are true:
                 // 1. this row wrapped
                 // 2. We're painting the last col of the row.
                 // In that case, set lineWrapped=true for the _PaintBufferOutputHelper call.
-                const auto lineWrapped = (buffer.GetRowByOffset(bufferLine.Origin().Y).GetCharRow().WasWrapForced()) &&
-                                         (bufferLine.RightExclusive() == buffer.GetSize().Width());
+                const auto lineWrapped = source->WasWrapForced() &&
+                                         (bufferLine.RightExclusive() == snapshot.GetBufferWidth());
 
                 // Ask the helper to paint through this specific line.
-                _PaintBufferOutputHelper(pEngine, it, screenLine.Origin(), lineWrapped);
+                _PaintBufferOutputHelper(pEngine, it, screenLine.Origin(), lineWrapped, snapshot);
             }
         }
     }
@@ -622,11 +1079,12 @@ static bool _IsAllSpaces(const std::wstring_view v)
 }
 
 void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
-                                        TextBufferCellIterator it,
+                                        RowSnapshot::Iterator it,
                                         const COORD target,
-                                        const bool lineWrapped)
+                                        const bool lineWrapped,
+                                        const RenderSnapshot& snapshot)
 {
-    auto globalInvert{ _pData->IsScreenReversed() };
+    auto globalInvert{ snapshot.IsScreenReversed() };
 
     // If we have valid data, let's figure out how to draw it.
     if (it)
@@ -638,8 +1096,10 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
         std::vector<Cluster> clusters;
         size_t cols = 0;
 
-        // Retrieve the first color.
-        auto color = it->TextAttr();
+        // Retrieve the first color. Within a row, the brush id changes
+        // exactly when the color does, and that's cheaper to compare.
+        auto color = &it.GetBrush();
+        auto colorId = it.GetBrushId();
 
         // And hold the point where we should start drawing.
         auto screenPoint = target;
@@ -651,7 +1111,7 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             // We'll be changing the persistent one as we run through the inner loops to detect
             // when a run changes, but we will still need to know this color at the bottom
             // when we go to draw gridlines for the length of the run.
-            const auto currentRunColor = color;
+            const auto& currentRunColor = *color;
 
             // Update the drawing brushes with our color.
             THROW_IF_FAILED(_UpdateDrawingBrushes(pEngine, currentRunColor, false));
@@ -672,14 +1132,15 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             // When the color changes, it will save the new color off and break.
             do
             {
-                if (color != it->TextAttr())
+                if (colorId != it.GetBrushId())
                 {
-                    auto newAttr{ it->TextAttr() };
+                    const auto& newColor = it.GetBrush();
                     // foreground doesn't matter for runs of spaces (!)
                     // if we trick it . . . we call Paint far fewer times for cmatrix
-                    if (!_IsAllSpaces(it->Chars()) || !newAttr.HasIdenticalVisualRepresentationForBlankSpace(color, globalInvert))
+                    if (!_IsAllSpaces(it.Chars()) || !newColor.attr.HasIdenticalVisualRepresentationForBlankSpace(color->attr, globalInvert))
                     {
-                        color = newAttr;
+                        color = &newColor;
+                        colorId = it.GetBrushId();
                         break; // vend this run
                     }
                 }
@@ -688,7 +1149,7 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
 
                 // If we're on the first cluster to be added and it's marked as "trailing"
                 // (a.k.a. the right half of a two column character), then we need some special handling.
-                if (clusters.empty() && it->DbcsAttr().IsTrailing())
+                if (clusters.empty() && it.DbcsAttr().IsTrailing())
                 {
                     // If we have room to move to the left to start drawing...
                     if (screenPoint.X > 0)
@@ -698,7 +1159,7 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
                         // And tell the next function to trim off the left half of it.
                         trimLeft = true;
                         // And add one to the number of columns we expect it to take as we insert it.
-                        clusters.emplace_back(it->Chars(), it->Columns() + 1);
+                        clusters.emplace_back(it.Chars(), it.Columns() + 1);
                     }
                     else
                     {
@@ -710,7 +1171,7 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
                 // Otherwise if it's not a special case, just insert it as is.
                 else
                 {
-                    clusters.emplace_back(it->Chars(), it->Columns());
+                    clusters.emplace_back(it.Chars(), it.Columns());
                 }
 
                 // Advance the cluster and column counts.
@@ -724,7 +1185,7 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             THROW_IF_FAILED(pEngine->PaintBufferLine({ clusters.data(), clusters.size() }, screenPoint, trimLeft, lineWrapped));
 
             // If we're allowed to do grid drawing, draw that now too (since it will be coupled with the color data)
-            if (_pData->IsGridLineDrawingAllowed())
+            if (snapshot.IsGridLineDrawingAllowed())
             {
                 // We're only allowed to draw the grid lines under certain circumstances.
                 _PaintBufferOutputGridLineHelper(pEngine, currentRunColor, cols, screenPoint);
@@ -772,20 +1233,20 @@ IRenderEngine::GridLines Renderer::s_GetGridlines(const TextAttribute& textAttri
 // - This particular helper sets up the various box drawing lines that can be inscribed around any character in the buffer (left, right, top, underline).
 // - See also: All related helpers and buffer output functions.
 // Arguments:
-// - textAttribute - The line/box drawing attributes to use for this particular run.
+// - brush - The line/box drawing attributes to use for this particular run, and their color.
 // - cchLine - The length of both pwsLine and pbKAttrsLine.
 // - coordTarget - The X/Y coordinate position in the buffer which we're attempting to start rendering from.
 // Return Value:
 // - <none>
 void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngine,
-                                                const TextAttribute textAttribute,
+                                                const SnapshotBrush& brush,
                                                 const size_t cchLine,
                                                 const COORD coordTarget)
 {
-    const COLORREF rgb = _pData->GetForegroundColor(textAttribute);
+    const COLORREF rgb = brush.foreground;
 
     // Convert console grid line representations into rendering engine enum representations.
-    IRenderEngine::GridLines lines = Renderer::s_GetGridlines(textAttribute);
+    IRenderEngine::GridLines lines = Renderer::s_GetGridlines(brush.attr);
 
     // Draw the lines
     LOG_IF_FAILED(pEngine->PaintBufferGridLines(lines, rgb, cchLine, coordTarget));
@@ -794,44 +1255,17 @@ void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngin
 // Routine Description:
 // - Paint helper to draw the cursor within the buffer.
 // Arguments:
-// - <none>
+// - snapshot - The frame that's being painted.
 // Return Value:
 // - <none>
-void Renderer::_PaintCursor(_In_ IRenderEngine* const pEngine)
+void Renderer::_PaintCursor(_In_ IRenderEngine* const pEngine, const RenderSnapshot& snapshot)
 {
-    if (_pData->IsCursorVisible())
+    // The snapshot only has cursor options if the cursor is visible and within the viewport.
+    const auto& options = snapshot.GetCursor();
+    if (options)
     {
-        // Get cursor position in buffer
-        COORD coordCursor = _pData->GetCursorPosition();
-
-        // GH#3166: Only draw the cursor if it's actually in the viewport. It
-        // might be on the line that's in that partially visible row at the
-        // bottom of the viewport, the space that's not quite a full line in
-        // height. Since we don't draw that text, we shouldn't draw the cursor
-        // there either.
-        Viewport view = _pData->GetViewport();
-        if (view.IsInBounds(coordCursor))
-        {
-            // Adjust cursor to viewport
-            view.ConvertToOrigin(&coordCursor);
-
-            COLORREF cursorColor = _pData->GetCursorColor();
-            bool useColor = cursorColor != INVALID_COLOR;
-
-            // Build up the cursor parameters including position, color, and drawing options
-            IRenderEngine::CursorOptions options;
-            options.coordCursor = coordCursor;
-            options.ulCursorHeightPercent = _pData->GetCursorHeight();
-            options.cursorPixelWidth = _pData->GetCursorPixelWidth();
-            options.fIsDoubleWidth = _pData->IsCursorDoubleWidth();
-            options.cursorType = _pData->GetCursorStyle();
-            options.fUseColor = useColor;
-            options.cursorColor = cursorColor;
-            options.isOn = _pData->IsCursorOn();
-
-            // Draw it within the viewport
-            LOG_IF_FAILED(pEngine->PaintCursor(options));
-        }
+        // Draw it within the viewport
+        LOG_IF_FAILED(pEngine->PaintCursor(*options));
     }
 }
 
@@ -841,17 +1275,16 @@ void Renderer::_PaintCursor(_In_ IRenderEngine* const pEngine)
 // Arguments:
 // - engine - The render engine that we're targeting.
 // - overlay - The overlay to draw.
+// - snapshot - The frame that's being painted.
 // Return Value:
 // - <none>
 void Renderer::_PaintOverlay(IRenderEngine& engine,
-                             const RenderOverlay& overlay)
+                             const RenderSnapshot::Overlay& overlay,
+                             const RenderSnapshot& snapshot)
 {
     try
     {
-        // First get the screen buffer's viewport.
-        Viewport view = _pData->GetViewport();
-
-        // Now get the overlay's viewport and adjust it to where it is supposed to be relative to the window.
+        // Get the overlay's viewport and adjust it to where it is supposed to be relative to the window.
 
         SMALL_RECT srCaView = overlay.region.ToInclusive();
         srCaView.Top += overlay.origin.Y;
@@ -877,9 +1310,10 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
                     const COORD target{ viewDirty.Left(), iRow };
                     const auto source = target - overlay.origin;
 
-                    auto it = overlay.buffer.GetCellLineDataAt(source);
+                    const auto& row = gsl::at(overlay.rows, source.Y - overlay.region.Top());
+                    auto it = row.GetCells(source.X);
 
-                    _PaintBufferOutputHelper(&engine, it, target, false);
+                    _PaintBufferOutputHelper(&engine, it, target, false, snapshot);
                 }
             }
         }
@@ -892,18 +1326,16 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
 // - This specifically is the string that appears at the cursor on the input line showing what the user is currently typing.
 // - See also: Generic Paint IME helper method.
 // Arguments:
-// - <none>
+// - snapshot - The frame that's being painted.
 // Return Value:
 // - <none>
-void Renderer::_PaintOverlays(_In_ IRenderEngine* const pEngine)
+void Renderer::_PaintOverlays(_In_ IRenderEngine* const pEngine, const RenderSnapshot& snapshot)
 {
     try
     {
-        const auto overlays = _pData->GetOverlays();
-
-        for (const auto& overlay : overlays)
+        for (const auto& overlay : snapshot.GetOverlays())
         {
-            _PaintOverlay(*pEngine, overlay);
+            _PaintOverlay(*pEngine, overlay, snapshot);
         }
     }
     CATCH_LOG();
@@ -912,17 +1344,17 @@ void Renderer::_PaintOverlays(_In_ IRenderEngine* const pEngine)
 // Routine Description:
 // - Paint helper to draw the selected area of the window.
 // Arguments:
-// - <none>
+// - snapshot - The frame that's being painted.
 // Return Value:
 // - <none>
-void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
+void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine, const RenderSnapshot& snapshot)
 {
     try
     {
         auto dirtyAreas = pEngine->GetDirtyArea();
 
         // Get selection rectangles
-        const auto rectangles = _GetSelectionRects();
+        const auto& rectangles = snapshot.GetSelectionRects();
         for (auto rect : rectangles)
         {
             for (auto dirtyRect : dirtyAreas)
@@ -942,19 +1374,19 @@ void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
 // - Helper to convert the text attributes to actual RGB colors and update the rendering pen/brush within the rendering engine before the next draw operation.
 // Arguments:
 // - pEngine - Which engine is being updated
-// - textAttributes - The 16 color foreground/background combination to set
+// - brush - The 16 color foreground/background combination to set, and the colors it resolved to
 // - isSettingDefaultBrushes - Alerts that the default brushes are being set which will
 //                             impact whether or not to include the hung window/erase window brushes in this operation
 //                             and can affect other draw state that wants to know the default color scheme.
 //                             (Usually only happens when the default is changed, not when each individual color is swapped in a multi-color run.)
 // Return Value:
 // - <none>
-[[nodiscard]] HRESULT Renderer::_UpdateDrawingBrushes(_In_ IRenderEngine* const pEngine, const TextAttribute textAttributes, const bool isSettingDefaultBrushes)
+[[nodiscard]] HRESULT Renderer::_UpdateDrawingBrushes(_In_ IRenderEngine* const pEngine, const SnapshotBrush& brush, const bool isSettingDefaultBrushes)
 {
-    const COLORREF rgbForeground = _pData->GetForegroundColor(textAttributes);
-    const COLORREF rgbBackground = _pData->GetBackgroundColor(textAttributes);
-    const WORD legacyAttributes = textAttributes.GetLegacyAttributes();
-    const auto extendedAttrs = textAttributes.GetExtendedAttributes();
+    const COLORREF rgbForeground = brush.foreground;
+    const COLORREF rgbBackground = brush.background;
+    const WORD legacyAttributes = brush.attr.GetLegacyAttributes();
+    const auto extendedAttrs = brush.attr.GetExtendedAttributes();
 
     // The last color needs to be each engine's responsibility. If it's local to this function,
     //      then on the next engine we might not update the color.
@@ -1014,5 +1446,24 @@ std::vector<SMALL_RECT> Renderer::_GetSelectionRects() const
 void Renderer::AddRenderEngine(_In_ IRenderEngine* const pEngine)
 {
     THROW_HR_IF_NULL(E_INVALIDARG, pEngine);
-    _rgpEngines.push_back(pEngine);
+
+    // The engines can't change in the middle of a frame.
+    const std::lock_guard<std::mutex> lock{ _paintLock };
+
+    // The deque never moves its elements, so the worker can be handed to the thread pool by address.
+    auto& worker = _engineWorkers.emplace_back();
+    auto removeWorker = wil::scope_exit([&]() {
+        _engineWorkers.pop_back();
+    });
+
+    worker.renderer = this;
+    worker.engine = pEngine;
+    worker.work.reset(CreateThreadpoolWork(&s_EngineWorkerCallback, &worker, nullptr));
+    THROW_LAST_ERROR_IF(!worker.work);
+
+    {
+        const std::lock_guard<std::mutex> guard{ _invalidationLock };
+        _rgpEngines.push_back(pEngine);
+    }
+    removeWorker.release();
 }
@@ -21,6 +21,8 @@ Author(s):
 #include "../inc/IRenderData.hpp"
 
 #include "thread.hpp"
+#include "DirtySpans.hpp"
+#include "RenderSnapshot.hpp"
 
 #include "../../buffer/out/textBuffer.hpp"
 #include "../../buffer/out/CharRow.hpp"
@@ -76,6 +78,8 @@ namespace Microsoft::Console::Render
 
         void AddRenderEngine(_In_ IRenderEngine* const pEngine) override;
 
+        [[nodiscard]] std::unique_lock<std::mutex> LockForEngineChanges() override;
+
     private:
         std::deque<IRenderEngine*> _rgpEngines;
 
@@ -86,42 +90,101 @@ namespace Microsoft::Console::Render
 
         void _NotifyPaintFrame();
 
+        // Paints one engine's frame on the thread pool, so that the engines
+        // don't have to wait for each other.
+        struct EngineWorker
+        {
+            Renderer* renderer = nullptr;
+            IRenderEngine* engine = nullptr;
+            // Whether to present, rather than paint, when run.
+            bool present = false;
+            // Whether the engine still needs this frame.
+            bool pending = false;
+            // Whether the work was handed to the thread pool this time.
+            bool submitted = false;
+            // The result of the last step. Only engines at S_OK take the next one.
+            HRESULT hr = S_OK;
+            wil::unique_threadpool_work work;
+        };
+
+        std::deque<EngineWorker> _engineWorkers;
+
+        // Held while a frame is painted and presented, and by everything else
+        // that needs the engines to itself. Taken after the console lock.
+        std::mutex _paintLock;
+
+        // While the engines are busy painting a frame without the console
+        // lock, invalidations are queued instead of being handed to them.
+        // Taken after the paint lock.
+        std::mutex _invalidationLock;
+        bool _enginesBusy = false;
+        // Set if an invalidation couldn't be queued. Everything is repainted then.
+        bool _invalidationsLost = false;
+        std::vector<std::function<void(IRenderEngine&)>> _pendingInvalidations;
+
+        // The frame that the engines are painting right now.
+        std::optional<RenderSnapshot> _snapshot;
+        size_t _snapshotVersion = 0;
+
+        template<typename T>
+        void _InvalidateEngines(T&& invalidate);
+        void _SetEnginesBusy() noexcept;
+        void _SetEnginesIdle() noexcept;
+
+        [[nodiscard]] HRESULT _PaintFrameForAllEngines();
+        void _StartPaintLocked() noexcept;
+        void _RunEngineWorkers(const bool present) noexcept;
+        void _RunEngineWorker(EngineWorker& worker) noexcept;
+        static void CALLBACK s_EngineWorkerCallback(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_WORK work) noexcept;
+
         [[nodiscard]] HRESULT _PaintFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept;
 
+        RenderSnapshot _TakeSnapshot(const std::vector<IRenderEngine*>& engines);
+        [[nodiscard]] HRESULT _PaintSnapshot(_In_ IRenderEngine* const pEngine, const RenderSnapshot& snapshot) noexcept;
+
         bool _CheckViewportAndScroll();
 
+        void _FlushDirtySpans();
+
         [[nodiscard]] HRESULT _PaintBackground(_In_ IRenderEngine* const pEngine);
 
-        void _PaintBufferOutput(_In_ IRenderEngine* const pEngine);
+        void _PaintBufferOutput(_In_ IRenderEngine* const pEngine, const RenderSnapshot& snapshot);
 
         void _PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
-                                      TextBufferCellIterator it,
+                                      RowSnapshot::Iterator it,
                                       const COORD target,
-                                      const bool lineWrapped);
+                                      const bool lineWrapped,
+                                      const RenderSnapshot& snapshot);
 
         static IRenderEngine::GridLines s_GetGridlines(const TextAttribute& textAttribute) noexcept;
 
         void _PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngine,
-                                              const TextAttribute textAttribute,
+                                              const SnapshotBrush& brush,
                                               const size_t cchLine,
                                               const COORD coordTarget);
 
-        void _PaintSelection(_In_ IRenderEngine* const pEngine);
-        void _PaintCursor(_In_ IRenderEngine* const pEngine);
+        void _PaintSelection(_In_ IRenderEngine* const pEngine, const RenderSnapshot& snapshot);
+        void _PaintCursor(_In_ IRenderEngine* const pEngine, const RenderSnapshot& snapshot);
 
-        void _PaintOverlays(_In_ IRenderEngine* const pEngine);
-        void _PaintOverlay(IRenderEngine& engine, const RenderOverlay& overlay);
+        void _PaintOverlays(_In_ IRenderEngine* const pEngine, const RenderSnapshot& snapshot);
+        void _PaintOverlay(IRenderEngine& engine, const RenderSnapshot::Overlay& overlay, const RenderSnapshot& snapshot);
 
-        [[nodiscard]] HRESULT _UpdateDrawingBrushes(_In_ IRenderEngine* const pEngine, const TextAttribute attr, const bool isSettingDefaultBrushes);
+        [[nodiscard]] HRESULT _UpdateDrawingBrushes(_In_ IRenderEngine* const pEngine, const SnapshotBrush& brush, const bool isSettingDefaultBrushes);
 
         [[nodiscard]] HRESULT _PerformScrolling(_In_ IRenderEngine* const pEngine);
 
         SMALL_RECT _srViewportPrevious;
 
+        // The terminal control triggers selection changes and full redraws from
+        // its UI thread without holding the terminal lock, so the collected
+        // regions can't rely on the console lock.
+        std::mutex _dirtySpansLock;
+        DirtySpans _dirtySpans;
+
         std::vector<SMALL_RECT> _GetSelectionRects() const;
         std::vector<SMALL_RECT> _previousSelection;
 
-        [[nodiscard]] HRESULT _PaintTitle(IRenderEngine* const pEngine);
+        [[nodiscard]] HRESULT _PaintTitle(IRenderEngine* const pEngine, const RenderSnapshot& snapshot);
 
         // Helper functions to diagnose issues with painting and layout.
         // These are only actually effective/on in Debug builds when the flag is set using an attached debugger.
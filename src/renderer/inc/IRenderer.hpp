@@ -61,6 +61,8 @@ namespace Microsoft::Console::Render
 
         virtual void AddRenderEngine(_In_ IRenderEngine* const pEngine) = 0;
 
+        [[nodiscard]] virtual std::unique_lock<std::mutex> LockForEngineChanges() = 0;
+
     protected:
         IRenderer() = default;
     };
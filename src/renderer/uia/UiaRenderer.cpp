@@ -21,8 +21,11 @@ UiaEngine::UiaEngine(IUiaEventDispatcher* dispatcher) :
     _cursorChanged{ false },
     _isEnabled{ true },
     _prevSelection{},
+    _coalescer{ dispatcher },
     RenderEngineBase()
 {
+    _flushTimer.reset(CreateThreadpoolTimer(&s_FlushTimerCallback, this, nullptr));
+    THROW_LAST_ERROR_IF(!_flushTimer);
 }
 
 // Routine Description:
@@ -32,10 +35,13 @@ UiaEngine::UiaEngine(IUiaEventDispatcher* dispatcher) :
 // Return Value:
 // - S_OK
 [[nodiscard]] HRESULT UiaEngine::Enable() noexcept
+try
 {
+    std::unique_lock lock{ _coalescerLock };
     _isEnabled = true;
     return S_OK;
 }
+CATCH_RETURN();
 
 // Routine Description:
 // - Sets this engine to disabled to prevent presentation from occurring
@@ -44,10 +50,55 @@ UiaEngine::UiaEngine(IUiaEventDispatcher* dispatcher) :
 // Return Value:
 // - S_OK
 [[nodiscard]] HRESULT UiaEngine::Disable() noexcept
+try
 {
+    std::unique_lock lock{ _coalescerLock };
+
+    // Nobody is listening to this engine anymore,
+    // so anything that was held back is stale.
+    _coalescer.DiscardPending();
     _isEnabled = false;
     return S_OK;
 }
+CATCH_RETURN();
+
+// Routine Description:
+// - Sets how often each kind of event may be raised.
+// Arguments:
+// - minInterval - the least amount of time between two events of the same kind.
+//      Zero raises an event on every frame that had one.
+// - quietPeriod - how long the output has to stop before an event that was
+//      held back is raised, once its minimum interval has passed.
+// Return Value:
+// - <none>
+void UiaEngine::SetEventRateLimit(const std::chrono::milliseconds minInterval,
+                                  const std::chrono::milliseconds quietPeriod) noexcept
+{
+    try
+    {
+        std::unique_lock lock{ _coalescerLock };
+        _coalescer.SetMinInterval(minInterval);
+        _coalescer.SetQuietPeriod(quietPeriod);
+    }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Gets how many events were raised and how many were merged into others.
+// Arguments:
+// - <none>
+// Return Value:
+// - The counters, summed up over every kind of event.
+UiaEventCoalescer::Counters UiaEngine::GetEventCounters() const noexcept
+{
+    try
+    {
+        std::unique_lock lock{ _coalescerLock };
+        return _coalescer.GetTotalCounters();
+    }
+    CATCH_LOG();
+    return {};
+}
 
 // Routine Description:
 // - Notifies us that the console has changed the character region specified.
@@ -226,31 +277,27 @@ CATCH_RETURN();
     RETURN_HR_IF(S_FALSE, !_isEnabled);
     RETURN_HR_IF(E_INVALIDARG, !_isPainting); // invalid to end paint when we're not painting
 
-    // Fire UIA Events here
-    if (_selectionChanged)
+    // Hand the UIA Events to the coalescer,
+    // which fires them when they're due.
+    try
     {
-        try
+        const auto now = UiaEventCoalescer::clock::now();
+        std::unique_lock lock{ _coalescerLock };
+        if (_selectionChanged)
         {
-            _dispatcher->SignalSelectionChanged();
+            _coalescer.Signal(UiaEventCoalescer::Event::SelectionChanged, now);
         }
-        CATCH_LOG();
-    }
-    if (_textBufferChanged)
-    {
-        try
+        if (_textBufferChanged)
         {
-            _dispatcher->SignalTextChanged();
+            _coalescer.Signal(UiaEventCoalescer::Event::TextChanged, now);
         }
-        CATCH_LOG();
-    }
-    if (_cursorChanged)
-    {
-        try
+        if (_cursorChanged)
         {
-            _dispatcher->SignalCursorChanged();
+            _coalescer.Signal(UiaEventCoalescer::Event::CursorChanged, now);
         }
-        CATCH_LOG();
     }
+    CATCH_LOG();
+    _FlushEvents();
 
     _selectionChanged = false;
     _textBufferChanged = false;
@@ -260,6 +307,56 @@ CATCH_RETURN();
     return S_OK;
 }
 
+// Routine Description:
+// - Fires the events that are due and schedules the
+//   timer for the ones that have been held back.
+// - The events are fired after the lock is released. Firing one calls
+//   into every automation client, which may well call back into us.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void UiaEngine::_FlushEvents() noexcept
+{
+    UiaEventCoalescer::DueEvents due;
+    try
+    {
+        std::unique_lock lock{ _coalescerLock };
+        if (!_isEnabled)
+        {
+            return;
+        }
+
+        const auto now = UiaEventCoalescer::clock::now();
+        const auto nextDue = _coalescer.Collect(now, due);
+        if (nextDue)
+        {
+            // Negative due times are relative to now, in 100ns units.
+            using filetimeDuration = std::chrono::duration<LONGLONG, std::ratio<1, 10000000>>;
+            const auto delay = std::chrono::duration_cast<filetimeDuration>(*nextDue - now).count();
+
+            LARGE_INTEGER dueTime{};
+            dueTime.QuadPart = -std::max<LONGLONG>(delay, 1);
+            FILETIME fileTime{ dueTime.LowPart, gsl::narrow_cast<DWORD>(dueTime.HighPart) };
+            SetThreadpoolTimer(_flushTimer.get(), &fileTime, 0, 0);
+        }
+    }
+    CATCH_LOG();
+
+    _coalescer.Raise(due);
+}
+
+// Routine Description:
+// - Called by the thread pool once an event that was held back is due.
+// Arguments:
+// - context - the UiaEngine
+// Return Value:
+// - <none>
+void CALLBACK UiaEngine::s_FlushTimerCallback(PTP_CALLBACK_INSTANCE /*instance*/, PVOID context, PTP_TIMER /*timer*/) noexcept
+{
+    static_cast<UiaEngine*>(context)->_FlushEvents();
+}
+
 // Routine Description:
 // - Used to perform longer running presentation steps outside the lock so the
 //      other threads can continue.
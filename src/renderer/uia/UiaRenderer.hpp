@@ -18,6 +18,7 @@ Author(s):
 #include "../../renderer/inc/RenderEngineBase.hpp"
 
 #include "../../types/IUiaEventDispatcher.h"
+#include "../../types/UiaEventCoalescer.hpp"
 #include "../../types/inc/Viewport.hpp"
 
 namespace Microsoft::Console::Render
@@ -33,6 +34,12 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT Enable() noexcept;
         [[nodiscard]] HRESULT Disable() noexcept;
 
+        // Events are coalesced so that a client isn't overwhelmed by
+        // events when there's a lot of output either.
+        void SetEventRateLimit(const std::chrono::milliseconds minInterval,
+                               const std::chrono::milliseconds quietPeriod) noexcept;
+        Microsoft::Console::Types::UiaEventCoalescer::Counters GetEventCounters() const noexcept;
+
         // IRenderEngine Members
         [[nodiscard]] HRESULT StartPaint() noexcept override;
         [[nodiscard]] HRESULT EndPaint() noexcept override;
@@ -89,5 +96,17 @@ namespace Microsoft::Console::Render
 
         std::vector<SMALL_RECT> _prevSelection;
         til::point _prevCursorPos;
+
+        // The coalescer is used by the render thread in EndPaint and by the
+        // thread pool when events that were held back become due.
+        mutable std::mutex _coalescerLock;
+        Microsoft::Console::Types::UiaEventCoalescer _coalescer;
+
+        // This must be destroyed first, since that waits for any callback
+        // that is still running.
+        wil::unique_threadpool_timer _flushTimer;
+
+        static void CALLBACK s_FlushTimerCallback(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_TIMER timer) noexcept;
+        void _FlushEvents() noexcept;
     };
 }
@@ -0,0 +1,272 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "SgrTransitionEncoder.hpp"
+
+#pragma hdrstop
+using namespace Microsoft::Console::Render;
+
+bool SgrTransitionEncoder::Color::operator==(const Color& other) const noexcept
+{
+    return kind == other.kind && value == other.value;
+}
+
+bool SgrTransitionEncoder::Color::operator!=(const Color& other) const noexcept
+{
+    return !(*this == other);
+}
+
+bool SgrTransitionEncoder::Rendition::operator==(const Rendition& other) const noexcept
+{
+    return foreground == other.foreground &&
+           background == other.background &&
+           attrs == other.attrs;
+}
+
+bool SgrTransitionEncoder::Rendition::operator!=(const Rendition& other) const noexcept
+{
+    return !(*this == other);
+}
+
+// Method Description:
+// - Gets the SGR sequence that changes the terminal's rendition from `from` to
+//      `to`. Parameters for every change are combined into a single
+//      CSI ... m, and we'll use a reset (SGR 0) instead of the individual
+//      changes when that ends up being shorter.
+// Arguments:
+// - from: The rendition the terminal currently has.
+// - to: The rendition we want the terminal to have.
+// Return Value:
+// - The sequence to write, or an empty string if nothing needs to change. The
+//      view is only valid until the next call to Encode.
+std::string_view SgrTransitionEncoder::Encode(const Rendition& from, const Rendition& to)
+{
+    if (from == to)
+    {
+        return {};
+    }
+
+    const auto hit = std::find_if(_cache.begin(), _cache.end(), [&](const auto& entry) {
+        return entry.from == from && entry.to == to;
+    });
+
+    if (hit != _cache.end())
+    {
+        _cacheHits++;
+        // Move the entry to the front. The strings are moved along with it,
+        // so only take the view once it's settled.
+        std::rotate(_cache.begin(), hit, hit + 1);
+        return _cache.front().sequence;
+    }
+
+    _cacheMisses++;
+
+    auto delta = _EncodeDelta(from, to);
+    auto reset = _EncodeReset(to);
+    // Prefer the delta on a tie, it's gentler on anything we don't track.
+    auto& sequence = delta.size() <= reset.size() ? delta : reset;
+
+    if (_cache.size() == CacheSize)
+    {
+        _cache.pop_back();
+    }
+    _cache.insert(_cache.begin(), CacheEntry{ from, to, std::move(sequence) });
+    return _cache.front().sequence;
+}
+
+// Method Description:
+// - Gets the number of transitions that were served from the cache.
+size_t SgrTransitionEncoder::GetCacheHits() const noexcept
+{
+    return _cacheHits;
+}
+
+// Method Description:
+// - Gets the number of transitions that had to be encoded from scratch.
+size_t SgrTransitionEncoder::GetCacheMisses() const noexcept
+{
+    return _cacheMisses;
+}
+
+// Routine Description:
+// - Builds a sequence containing only the parameters that changed between the
+//      two renditions.
+// Arguments:
+// - from: The rendition the terminal currently has.
+// - to: The rendition we want the terminal to have.
+// Return Value:
+// - The complete sequence.
+std::string SgrTransitionEncoder::_EncodeDelta(const Rendition& from, const Rendition& to)
+{
+    std::string params;
+
+    const auto changed = (from.attrs ^ to.attrs) & SupportedAttributes;
+    for (const auto attr : { ExtendedAttributes::Bold,
+                             ExtendedAttributes::Italics,
+                             ExtendedAttributes::Underlined,
+                             ExtendedAttributes::Blinking,
+                             ExtendedAttributes::Invisible,
+                             ExtendedAttributes::CrossedOut })
+    {
+        if (WI_IsAnyFlagSet(changed, attr))
+        {
+            _AppendAttribute(params, attr, WI_IsAnyFlagSet(to.attrs, attr));
+        }
+    }
+
+    if (from.foreground != to.foreground || from.foreground.kind == ColorKind::Unknown)
+    {
+        _AppendColor(params, to.foreground, true);
+    }
+
+    if (from.background != to.background || from.background.kind == ColorKind::Unknown)
+    {
+        _AppendColor(params, to.background, false);
+    }
+
+    return "\x1b[" + params + "m";
+}
+
+// Routine Description:
+// - Builds a sequence that resets the rendition, then sets everything in `to`
+//      that isn't the default.
+// Arguments:
+// - to: The rendition we want the terminal to have.
+// Return Value:
+// - The complete sequence.
+std::string SgrTransitionEncoder::_EncodeReset(const Rendition& to)
+{
+    std::string params;
+
+    for (const auto attr : { ExtendedAttributes::Bold,
+                             ExtendedAttributes::Italics,
+                             ExtendedAttributes::Underlined,
+                             ExtendedAttributes::Blinking,
+                             ExtendedAttributes::Invisible,
+                             ExtendedAttributes::CrossedOut })
+    {
+        if (WI_IsAnyFlagSet(to.attrs, attr))
+        {
+            _AppendAttribute(params, attr, true);
+        }
+    }
+
+    if (to.foreground.kind != ColorKind::Default)
+    {
+        _AppendColor(params, to.foreground, true);
+    }
+
+    if (to.background.kind != ColorKind::Default)
+    {
+        _AppendColor(params, to.background, false);
+    }
+
+    // A bare "\x1b[m" is a reset on its own. Otherwise, spell out the 0 - an
+    // empty leading parameter is legal, but not everyone parses it.
+    return params.empty() ? "\x1b[m" : "\x1b[0;" + params + "m";
+}
+
+// Routine Description:
+// - Appends a single numeric parameter to a parameter list, with a separator
+//      if needed.
+// Arguments:
+// - params: The parameter list to append to.
+// - parameter: The value to append.
+// Return Value:
+// - <none>
+void SgrTransitionEncoder::_AppendParameter(std::string& params, const int parameter)
+{
+    if (!params.empty())
+    {
+        params.push_back(';');
+    }
+    params.append(std::to_string(parameter));
+}
+
+// Routine Description:
+// - Appends the parameters that select the given color.
+// - Note that text brightness and boldness are different in VT. See
+//      VtEngine::_SetGraphicsRendition16Color for more details.
+// Arguments:
+// - params: The parameter list to append to.
+// - color: The color to select.
+// - isForeground: true to select the foreground, false for the background.
+// Return Value:
+// - <none>
+void SgrTransitionEncoder::_AppendColor(std::string& params, const Color& color, const bool isForeground)
+{
+    const int base = isForeground ? 30 : 40;
+    switch (color.kind)
+    {
+    case ColorKind::Indexed:
+    {
+        // Always check using the foreground flags, because the bg flags
+        // constants are a higher byte
+        const WORD index = static_cast<WORD>(color.value);
+        _AppendParameter(params,
+                         base +
+                             (WI_IsFlagSet(index, FOREGROUND_INTENSITY) ? 60 : 0) +
+                             (WI_IsFlagSet(index, FOREGROUND_RED) ? 1 : 0) +
+                             (WI_IsFlagSet(index, FOREGROUND_GREEN) ? 2 : 0) +
+                             (WI_IsFlagSet(index, FOREGROUND_BLUE) ? 4 : 0));
+        break;
+    }
+    case ColorKind::Rgb:
+        _AppendParameter(params, base + 8);
+        _AppendParameter(params, 2);
+        _AppendParameter(params, GetRValue(color.value));
+        _AppendParameter(params, GetGValue(color.value));
+        _AppendParameter(params, GetBValue(color.value));
+        break;
+    case ColorKind::Default:
+    case ColorKind::Unknown:
+    default:
+        _AppendParameter(params, base + 9);
+        break;
+    }
+}
+
+// Routine Description:
+// - Appends the parameter that turns a single attribute on or off.
+// Arguments:
+// - params: The parameter list to append to.
+// - attr: The attribute to change. Must be one of SupportedAttributes.
+// - enabled: true to turn the attribute on, false to turn it off.
+// Return Value:
+// - <none>
+void SgrTransitionEncoder::_AppendAttribute(std::string& params, const ExtendedAttributes attr, const bool enabled)
+{
+    int on = 0;
+    int off = 0;
+    switch (attr)
+    {
+    case ExtendedAttributes::Bold:
+        on = 1;
+        off = 22;
+        break;
+    case ExtendedAttributes::Italics:
+        on = 3;
+        off = 23;
+        break;
+    case ExtendedAttributes::Underlined:
+        on = 4;
+        off = 24;
+        break;
+    case ExtendedAttributes::Blinking:
+        on = 5;
+        off = 25;
+        break;
+    case ExtendedAttributes::Invisible:
+        on = 8;
+        off = 28;
+        break;
+    case ExtendedAttributes::CrossedOut:
+        on = 9;
+        off = 29;
+        break;
+    default:
+        FAIL_FAST_HR(E_INVALIDARG);
+    }
+    _AppendParameter(params, enabled ? on : off);
+}
@@ -0,0 +1,92 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- SgrTransitionEncoder.hpp
+
+Abstract:
+- Computes the single SGR sequence that moves a terminal from one graphics
+    rendition to another. Both a "delta" encoding (only the parameters that
+    changed) and a "reset" encoding (SGR 0 followed by everything that's set)
+    are built, and whichever is fewer bytes wins.
+- The most recently emitted transitions are kept in a small LRU cache, since
+    colored output tends to bounce between the same handful of attributes.
+--*/
+
+#pragma once
+
+#include "../../inc/conattrs.hpp"
+
+namespace Microsoft::Console::Render
+{
+    class SgrTransitionEncoder final
+    {
+    public:
+        // How a color is selected on the wire.
+        enum class ColorKind : BYTE
+        {
+            Unknown, // We don't know what the terminal has - always emit it.
+            Default, // SGR 39/49
+            Indexed, // One of the 16 table colors, SGR 30-37/90-97 (40-47/100-107)
+            Rgb // SGR 38;2;r;g;b (48;2;r;g;b)
+        };
+
+        struct Color
+        {
+            ColorKind kind;
+            COLORREF value; // The table index for Indexed, the color for Rgb.
+
+            bool operator==(const Color& other) const noexcept;
+            bool operator!=(const Color& other) const noexcept;
+        };
+
+        struct Rendition
+        {
+            Color foreground;
+            Color background;
+            ExtendedAttributes attrs;
+
+            bool operator==(const Rendition& other) const noexcept;
+            bool operator!=(const Rendition& other) const noexcept;
+        };
+
+        // The attributes that we know how to turn on and off individually.
+        static constexpr ExtendedAttributes SupportedAttributes = ExtendedAttributes::Bold |
+                                                                  ExtendedAttributes::Italics |
+                                                                  ExtendedAttributes::Underlined |
+                                                                  ExtendedAttributes::Blinking |
+                                                                  ExtendedAttributes::Invisible |
+                                                                  ExtendedAttributes::CrossedOut;
+
+        static constexpr size_t CacheSize = 8;
+
+        static constexpr Rendition UnknownRendition{ { ColorKind::Unknown, 0 },
+                                                     { ColorKind::Unknown, 0 },
+                                                     ExtendedAttributes::Normal };
+
+        std::string_view Encode(const Rendition& from, const Rendition& to);
+
+        size_t GetCacheHits() const noexcept;
+        size_t GetCacheMisses() const noexcept;
+
+    private:
+        struct CacheEntry
+        {
+            Rendition from;
+            Rendition to;
+            std::string sequence;
+        };
+
+        // Most recently used entry first.
+        std::vector<CacheEntry> _cache;
+        size_t _cacheHits{ 0 };
+        size_t _cacheMisses{ 0 };
+
+        static std::string _EncodeDelta(const Rendition& from, const Rendition& to);
+        static std::string _EncodeReset(const Rendition& to);
+        static void _AppendParameter(std::string& params, const int parameter);
+        static void _AppendColor(std::string& params, const Color& color, const bool isForeground);
+        static void _AppendAttribute(std::string& params, const ExtendedAttributes attr, const bool enabled);
+    };
+}
@@ -244,42 +244,6 @@ using namespace Microsoft::Console::Render;
     return _WriteFormattedString(&fmt, vtIndex);
 }
 
-// Method Description:
-// - Formats and writes a sequence to change the current text attributes to an
-//      RGB color.
-// Arguments:
-// - color: The color to emit a VT sequence for
-// - fIsForeground: true if we should emit the foreground sequence, false for background
-// Return Value:
-// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT VtEngine::_SetGraphicsRenditionRGBColor(const COLORREF color,
-                                                              const bool fIsForeground) noexcept
-{
-    const std::string fmt = fIsForeground ?
-                                "\x1b[38;2;%d;%d;%dm" :
-                                "\x1b[48;2;%d;%d;%dm";
-
-    DWORD const r = GetRValue(color);
-    DWORD const g = GetGValue(color);
-    DWORD const b = GetBValue(color);
-
-    return _WriteFormattedString(&fmt, r, g, b);
-}
-
-// Method Description:
-// - Formats and writes a sequence to change the current text attributes to the
-//      default foreground or background. Does not affect the boldness of text.
-// Arguments:
-// - fIsForeground: true if we should emit the foreground sequence, false for background
-// Return Value:
-// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT VtEngine::_SetGraphicsRenditionDefaultColor(const bool fIsForeground) noexcept
-{
-    const std::string fmt = fIsForeground ? ("\x1b[39m") : ("\x1b[49m");
-
-    return _Write(fmt);
-}
-
 // Method Description:
 // - Formats and writes a sequence to change the terminal's window size.
 // Arguments:
@@ -343,91 +307,3 @@ using namespace Microsoft::Console::Render;
 {
     return _Write("\x1b[24m");
 }
-
-// Method Description:
-// - Writes a sequence to tell the terminal to start italicizing text
-// Arguments:
-// - <none>
-// Return Value:
-// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT VtEngine::_BeginItalics() noexcept
-{
-    return _Write("\x1b[3m");
-}
-
-// Method Description:
-// - Writes a sequence to tell the terminal to stop italicizing text
-// Arguments:
-// - <none>
-// Return Value:
-// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT VtEngine::_EndItalics() noexcept
-{
-    return _Write("\x1b[23m");
-}
-
-// Method Description:
-// - Writes a sequence to tell the terminal to start blinking text
-// Arguments:
-// - <none>
-// Return Value:
-// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT VtEngine::_BeginBlink() noexcept
-{
-    return _Write("\x1b[5m");
-}
-
-// Method Description:
-// - Writes a sequence to tell the terminal to stop blinking text
-// Arguments:
-// - <none>
-// Return Value:
-// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT VtEngine::_EndBlink() noexcept
-{
-    return _Write("\x1b[25m");
-}
-
-// Method Description:
-// - Writes a sequence to tell the terminal to start marking text as invisible
-// Arguments:
-// - <none>
-// Return Value:
-// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT VtEngine::_BeginInvisible() noexcept
-{
-    return _Write("\x1b[8m");
-}
-
-// Method Description:
-// - Writes a sequence to tell the terminal to stop marking text as invisible
-// Arguments:
-// - <none>
-// Return Value:
-// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT VtEngine::_EndInvisible() noexcept
-{
-    return _Write("\x1b[28m");
-}
-
-// Method Description:
-// - Writes a sequence to tell the terminal to start crossing-out text
-// Arguments:
-// - <none>
-// Return Value:
-// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT VtEngine::_BeginCrossedOut() noexcept
-{
-    return _Write("\x1b[9m");
-}
-
-// Method Description:
-// - Writes a sequence to tell the terminal to stop crossing-out text
-// Arguments:
-// - <none>
-// Return Value:
-// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT VtEngine::_EndCrossedOut() noexcept
-{
-    return _Write("\x1b[29m");
-}
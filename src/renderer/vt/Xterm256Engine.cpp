@@ -14,13 +14,15 @@ Xterm256Engine::Xterm256Engine(_In_ wil::unique_hfile hPipe,
                                _In_reads_(cColorTable) const COLORREF* const ColorTable,
                                const WORD cColorTable) :
     XtermEngine(std::move(hPipe), colorProvider, initialViewport, ColorTable, cColorTable, false),
-    _lastExtendedAttrsState{ ExtendedAttributes::Normal }
+    _lastRendition{ SgrTransitionEncoder::UnknownRendition }
 {
 }
 
 // Routine Description:
 // - Write a VT sequence to change the current colors of text. Writes true RGB
 //      color sequences.
+// - All of the changes are combined into a single SGR sequence. See
+//      SgrTransitionEncoder for how that sequence is picked.
 // Arguments:
 // - colorForeground: The RGB Color to use to paint the foreground text.
 // - colorBackground: The RGB Color to use to paint the background of the text.
@@ -37,76 +39,54 @@ Xterm256Engine::Xterm256Engine(_In_ wil::unique_hfile hPipe,
                                                            const ExtendedAttributes extendedAttrs,
                                                            const bool /*isSettingDefaultBrushes*/) noexcept
 {
-    //When we update the brushes, check the wAttrs to see if the LVB_UNDERSCORE
-    //      flag is there. If the state of that flag is different then our
-    //      current state, change the underlining state.
-    // We have to do this here, instead of in PaintBufferGridLines, because
-    //      we'll have already painted the text by the time PaintBufferGridLines
-    //      is called.
-    // TODO:GH#2915 Treat underline separately from LVB_UNDERSCORE
-    RETURN_IF_FAILED(_UpdateUnderline(legacyColorAttribute));
+    SgrTransitionEncoder::Rendition desired{};
+    desired.foreground = _ToSgrColor(colorForeground, _colorProvider.GetDefaultForeground());
+    desired.background = _ToSgrColor(colorBackground, _colorProvider.GetDefaultBackground());
 
     // Only do extended attributes in xterm-256color, as to not break telnet.exe.
-    RETURN_IF_FAILED(_UpdateExtendedAttrs(extendedAttrs));
+    desired.attrs = extendedAttrs & SgrTransitionEncoder::SupportedAttributes;
+
+    // We underline based on the LVB_UNDERSCORE flag, not the extended
+    //      attribute.
+    // TODO:GH#2915 Treat underline separately from LVB_UNDERSCORE
+    WI_ClearFlag(desired.attrs, ExtendedAttributes::Underlined);
+    WI_SetFlagIf(desired.attrs, ExtendedAttributes::Underlined, WI_IsFlagSet(legacyColorAttribute, COMMON_LVB_UNDERSCORE));
 
-    return VtEngine::_RgbUpdateDrawingBrushes(colorForeground,
-                                              colorBackground,
-                                              WI_IsFlagSet(extendedAttrs, ExtendedAttributes::Bold),
-                                              _ColorTable,
-                                              _cColorTable);
+    try
+    {
+        const auto sequence = _sgrEncoder.Encode(_lastRendition, desired);
+        if (!sequence.empty())
+        {
+            RETURN_IF_FAILED(_Write(sequence));
+        }
+        _lastRendition = desired;
+    }
+    CATCH_RETURN();
+
+    return S_OK;
 }
 
 // Routine Description:
-// - Write a VT sequence to either start or stop underlining text.
+// - Works out how a color should be selected on the wire: as the default
+//      color, as one of the 16 colors in our table, or as an RGB value.
 // Arguments:
-// - legacyColorAttribute: A console attributes bit field containing information
-//      about the underlining state of the text.
+// - color: The color to select.
+// - defaultColor: The default color for this layer (foreground or background).
 // Return Value:
-// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT Xterm256Engine::_UpdateExtendedAttrs(const ExtendedAttributes extendedAttrs) noexcept
+// - The color, as the SgrTransitionEncoder understands it.
+SgrTransitionEncoder::Color Xterm256Engine::_ToSgrColor(const COLORREF color,
+                                                        const COLORREF defaultColor) const noexcept
 {
-    // Helper lambda to check if a state (attr) has changed since it's last
-    // value (lastState), and appropriately start/end that state with the given
-    // begin/end functions.
-    auto updateFlagAndState = [extendedAttrs, this](const ExtendedAttributes attr,
-                                                    std::function<HRESULT(Xterm256Engine*)> beginFn,
-                                                    std::function<HRESULT(Xterm256Engine*)> endFn) -> HRESULT {
-        const bool flagSet = WI_AreAllFlagsSet(extendedAttrs, attr);
-        const bool lastState = WI_AreAllFlagsSet(_lastExtendedAttrsState, attr);
-        if (flagSet != lastState)
-        {
-            if (flagSet)
-            {
-                RETURN_IF_FAILED(beginFn(this));
-            }
-            else
-            {
-                RETURN_IF_FAILED(endFn(this));
-            }
-            WI_ToggleAllFlags(_lastExtendedAttrsState, attr);
-        }
-        return S_OK;
-    };
-
-    auto hr = updateFlagAndState(ExtendedAttributes::Italics,
-                                 &Xterm256Engine::_BeginItalics,
-                                 &Xterm256Engine::_EndItalics);
-    RETURN_IF_FAILED(hr);
+    if (color == defaultColor)
+    {
+        return { SgrTransitionEncoder::ColorKind::Default, 0 };
+    }
 
-    hr = updateFlagAndState(ExtendedAttributes::Blinking,
-                            &Xterm256Engine::_BeginBlink,
-                            &Xterm256Engine::_EndBlink);
-    RETURN_IF_FAILED(hr);
+    WORD index = 0;
+    if (::FindTableIndex(color, _ColorTable, _cColorTable, &index))
+    {
+        return { SgrTransitionEncoder::ColorKind::Indexed, index };
+    }
 
-    hr = updateFlagAndState(ExtendedAttributes::Invisible,
-                            &Xterm256Engine::_BeginInvisible,
-                            &Xterm256Engine::_EndInvisible);
-    RETURN_IF_FAILED(hr);
-
-    hr = updateFlagAndState(ExtendedAttributes::CrossedOut,
-                            &Xterm256Engine::_BeginCrossedOut,
-                            &Xterm256Engine::_EndCrossedOut);
-    RETURN_IF_FAILED(hr);
-
-    return S_OK;
+    return { SgrTransitionEncoder::ColorKind::Rgb, color };
 }
@@ -17,6 +17,7 @@ Author(s):
 #pragma once
 
 #include "XtermEngine.hpp"
+#include "SgrTransitionEncoder.hpp"
 
 namespace Microsoft::Console::Render
 {
@@ -38,11 +39,14 @@ namespace Microsoft::Console::Render
                                                    const bool isSettingDefaultBrushes) noexcept override;
 
     private:
-        [[nodiscard]] HRESULT _UpdateExtendedAttrs(const ExtendedAttributes extendedAttrs) noexcept;
-
-        // We're only using Italics, Blinking, Invisible and Crossed Out for now
-        // See GH#2916 for adding a more complete implementation.
-        ExtendedAttributes _lastExtendedAttrsState;
+        SgrTransitionEncoder::Color _ToSgrColor(const COLORREF color,
+                                                const COLORREF defaultColor) const noexcept;
+
+        // We're only using Bold, Italics, Blinking, Invisible and Crossed Out
+        // (plus LVB_UNDERSCORE) for now. See GH#2916 for adding a more
+        // complete implementation.
+        SgrTransitionEncoder::Rendition _lastRendition;
+        SgrTransitionEncoder _sgrEncoder;
 
 #ifdef UNIT_TESTING
         friend class VtRendererTest;
@@ -177,9 +177,6 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _ChangeTitle(const std::string& title) noexcept;
         [[nodiscard]] HRESULT _SetGraphicsRendition16Color(const WORD wAttr,
                                                            const bool fIsForeground) noexcept;
-        [[nodiscard]] HRESULT _SetGraphicsRenditionRGBColor(const COLORREF color,
-                                                            const bool fIsForeground) noexcept;
-        [[nodiscard]] HRESULT _SetGraphicsRenditionDefaultColor(const bool fIsForeground) noexcept;
 
         [[nodiscard]] HRESULT _SetGraphicsBoldness(const bool isBold) noexcept;
 
@@ -190,26 +187,9 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _BeginUnderline() noexcept;
         [[nodiscard]] HRESULT _EndUnderline() noexcept;
 
-        [[nodiscard]] HRESULT _BeginItalics() noexcept;
-        [[nodiscard]] HRESULT _EndItalics() noexcept;
-
-        [[nodiscard]] HRESULT _BeginBlink() noexcept;
-        [[nodiscard]] HRESULT _EndBlink() noexcept;
-
-        [[nodiscard]] HRESULT _BeginInvisible() noexcept;
-        [[nodiscard]] HRESULT _EndInvisible() noexcept;
-
-        [[nodiscard]] HRESULT _BeginCrossedOut() noexcept;
-        [[nodiscard]] HRESULT _EndCrossedOut() noexcept;
-
         [[nodiscard]] HRESULT _RequestCursor() noexcept;
 
         [[nodiscard]] virtual HRESULT _MoveCursor(const COORD coord) noexcept = 0;
-        [[nodiscard]] HRESULT _RgbUpdateDrawingBrushes(const COLORREF colorForeground,
-                                                       const COLORREF colorBackground,
-                                                       const bool isBold,
-                                                       _In_reads_(cColorTable) const COLORREF* const ColorTable,
-                                                       const WORD cColorTable) noexcept;
         [[nodiscard]] HRESULT _16ColorUpdateDrawingBrushes(const COLORREF colorForeground,
                                                            const COLORREF colorBackground,
                                                            const bool isBold,
@@ -6,7 +6,7 @@
 #include <intsafe.h>
 
 #include "ApiMessage.h"
-#include "DeviceComm.h"
+#include "IDeviceComm.h"
 
 _CONSOLE_API_MSG::_CONSOLE_API_MSG() :
     _pDeviceComm(nullptr),
@@ -136,17 +136,32 @@ DeviceComm::~DeviceComm()
                                              _Out_writes_bytes_opt_(cbOutBufferSize) PVOID pOutBuffer,
                                              _In_ DWORD cbOutBufferSize) const
 {
+    // Several IO threads talk to the driver at the same time. The server handle isn't opened for
+    // synchronous IO, so without an overlapped structure every call would wait on the handle itself,
+    // which any of the calls completing signals. Instead, each thread waits on an event of its own.
+    thread_local wil::unique_event_nothrow completed;
+    if (!completed)
+    {
+        RETURN_IF_FAILED(completed.create(wil::EventOptions::ManualReset));
+    }
+
+    OVERLAPPED overlapped{};
+    overlapped.hEvent = completed.get();
+
     // See: https://msdn.microsoft.com/en-us/library/windows/desktop/aa363216(v=vs.85).aspx
-    // Written is unused but cannot be nullptr because we aren't using overlapped.
     DWORD cbWritten = 0;
-    RETURN_IF_WIN32_BOOL_FALSE(DeviceIoControl(_Server.get(),
-                                               dwIoControlCode,
-                                               pInBuffer,
-                                               cbInBufferSize,
-                                               pOutBuffer,
-                                               cbOutBufferSize,
-                                               &cbWritten,
-                                               nullptr));
+    if (!DeviceIoControl(_Server.get(),
+                         dwIoControlCode,
+                         pInBuffer,
+                         cbInBufferSize,
+                         pOutBuffer,
+                         cbOutBufferSize,
+                         &cbWritten,
+                         &overlapped))
+    {
+        RETURN_LAST_ERROR_IF(GetLastError() != ERROR_IO_PENDING);
+        RETURN_IF_WIN32_BOOL_FALSE(GetOverlappedResult(_Server.get(), &overlapped, &cbWritten, TRUE));
+    }
 
     return S_OK;
 }
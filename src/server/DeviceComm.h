@@ -16,25 +16,25 @@ Revision History:
 
 #pragma once
 
-#include "..\host\conapi.h"
+#include "IDeviceComm.h"
 
 #include <wil\resource.h>
 
-class DeviceComm
+class DeviceComm : public IDeviceComm
 {
 public:
     DeviceComm(_In_ HANDLE Server);
     ~DeviceComm();
 
-    [[nodiscard]] HRESULT SetServerInformation(_In_ CD_IO_SERVER_INFORMATION* const pServerInfo) const;
+    [[nodiscard]] HRESULT SetServerInformation(_In_ CD_IO_SERVER_INFORMATION* const pServerInfo) const override;
     [[nodiscard]] HRESULT ReadIo(_In_opt_ PCONSOLE_API_MSG const pReplyMsg,
-                                 _Out_ CONSOLE_API_MSG* const pMessage) const;
-    [[nodiscard]] HRESULT CompleteIo(_In_ CD_IO_COMPLETE* const pCompletion) const;
+                                 _Out_ CONSOLE_API_MSG* const pMessage) const override;
+    [[nodiscard]] HRESULT CompleteIo(_In_ CD_IO_COMPLETE* const pCompletion) const override;
 
-    [[nodiscard]] HRESULT ReadInput(_In_ CD_IO_OPERATION* const pIoOperation) const;
-    [[nodiscard]] HRESULT WriteOutput(_In_ CD_IO_OPERATION* const pIoOperation) const;
+    [[nodiscard]] HRESULT ReadInput(_In_ CD_IO_OPERATION* const pIoOperation) const override;
+    [[nodiscard]] HRESULT WriteOutput(_In_ CD_IO_OPERATION* const pIoOperation) const override;
 
-    [[nodiscard]] HRESULT AllowUIAccess() const;
+    [[nodiscard]] HRESULT AllowUIAccess() const override;
 
 private:
     [[nodiscard]] HRESULT _CallIoctl(_In_ DWORD dwIoControlCode,
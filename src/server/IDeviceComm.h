@@ -0,0 +1,35 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- IDeviceComm.h
+
+Abstract:
+- This file specifies how the console server talks to whatever delivers the IO of its clients.
+- That's the console driver in the product (see DeviceComm), but anything that speaks the same
+  messages will do, which lets the server be driven from a test.
+
+Revision History:
+- Split out of DeviceComm.h
+--*/
+
+#pragma once
+
+#include "..\host\conapi.h"
+
+class IDeviceComm
+{
+public:
+    virtual ~IDeviceComm() = default;
+
+    [[nodiscard]] virtual HRESULT SetServerInformation(_In_ CD_IO_SERVER_INFORMATION* const pServerInfo) const = 0;
+    [[nodiscard]] virtual HRESULT ReadIo(_In_opt_ PCONSOLE_API_MSG const pReplyMsg,
+                                         _Out_ CONSOLE_API_MSG* const pMessage) const = 0;
+    [[nodiscard]] virtual HRESULT CompleteIo(_In_ CD_IO_COMPLETE* const pCompletion) const = 0;
+
+    [[nodiscard]] virtual HRESULT ReadInput(_In_ CD_IO_OPERATION* const pIoOperation) const = 0;
+    [[nodiscard]] virtual HRESULT WriteOutput(_In_ CD_IO_OPERATION* const pIoOperation) const = 0;
+
+    [[nodiscard]] virtual HRESULT AllowUIAccess() const = 0;
+};
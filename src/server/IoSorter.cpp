@@ -13,8 +13,49 @@
 #include "..\host\globals.h"
 
 #include "..\host\getset.h"
+#include "..\host\handle.h"
 #include "..\host\stream.h"
 
+// Routine Description:
+// - Reads IO requests from the device, services and completes them in a loop.
+// - Several threads run this loop at the same time, each with a message of its own. The console
+//   lock keeps them apart, see ApiSorter.
+// Arguments:
+// - deviceComm - Where the requests come from and the replies go.
+// - apiRoutines - Services the API calls.
+// Return Value:
+// - HRESULT_FROM_WIN32(ERROR_PIPE_NOT_CONNECTED) once the device is disconnected. That's the only way out of the loop.
+[[nodiscard]] HRESULT IoSorter::ServiceIo(IDeviceComm& deviceComm, IApiRoutines& apiRoutines)
+{
+    CONSOLE_API_MSG ReceiveMsg;
+    ReceiveMsg._pApiRoutines = &apiRoutines;
+    ReceiveMsg._pDeviceComm = &deviceComm;
+    PCONSOLE_API_MSG ReplyMsg = nullptr;
+
+    for (;;)
+    {
+        if (ReplyMsg != nullptr)
+        {
+            LOG_IF_FAILED(ReplyMsg->ReleaseMessageBuffers());
+        }
+
+        // TODO: 9115192 correct mixed NTSTATUS/HRESULT
+        const HRESULT hr = deviceComm.ReadIo(ReplyMsg, &ReceiveMsg);
+        if (FAILED(hr))
+        {
+            if (hr == HRESULT_FROM_WIN32(ERROR_PIPE_NOT_CONNECTED))
+            {
+                return hr;
+            }
+            LOG_HR_MSG(hr, "DeviceIoControl failed");
+            ReplyMsg = nullptr;
+            continue;
+        }
+
+        ServiceIoOperation(&ReceiveMsg, &ReplyMsg);
+    }
+}
+
 void IoSorter::ServiceIoOperation(_In_ CONSOLE_API_MSG* const pMsg,
                                   _Out_ CONSOLE_API_MSG** ReplyMsg)
 {
@@ -53,7 +94,12 @@ void IoSorter::ServiceIoOperation(_In_ CONSOLE_API_MSG* const pMsg,
         ZeroMemory(&pMsg->u.consoleMsgL1.WriteConsole, sizeof(CONSOLE_WRITECONSOLE_MSG));
         pMsg->msgHeader.ApiNumber = API_NUMBER_WRITECONSOLE; // Required for Wait blocks to identify the right callback.
         ReplyPending = FALSE;
-        hr = ApiDispatchers::ServerWriteConsole(pMsg, &ReplyPending);
+        {
+            // Like ApiSorter does, hold the lock for the whole call.
+            LockConsole();
+            auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+            hr = ApiDispatchers::ServerWriteConsole(pMsg, &ReplyPending);
+        }
         Status = NTSTATUS_FROM_HRESULT(hr);
         if (ReplyPending)
         {
@@ -71,7 +117,11 @@ void IoSorter::ServiceIoOperation(_In_ CONSOLE_API_MSG* const pMsg,
         pMsg->msgHeader.ApiNumber = API_NUMBER_READCONSOLE; // Required for Wait blocks to identify the right callback.
         pMsg->u.consoleMsgL1.ReadConsole.ProcessControlZ = TRUE;
         ReplyPending = FALSE;
-        hr = ApiDispatchers::ServerReadConsole(pMsg, &ReplyPending);
+        {
+            LockConsole();
+            auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+            hr = ApiDispatchers::ServerReadConsole(pMsg, &ReplyPending);
+        }
         Status = NTSTATUS_FROM_HRESULT(hr);
         if (ReplyPending)
         {
@@ -86,8 +136,11 @@ void IoSorter::ServiceIoOperation(_In_ CONSOLE_API_MSG* const pMsg,
 
     case CONSOLE_IO_RAW_FLUSH:
         ReplyPending = FALSE;
-
-        Status = NTSTATUS_FROM_HRESULT(ApiDispatchers::ServerFlushConsoleInputBuffer(pMsg, &ReplyPending));
+        {
+            LockConsole();
+            auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+            Status = NTSTATUS_FROM_HRESULT(ApiDispatchers::ServerFlushConsoleInputBuffer(pMsg, &ReplyPending));
+        }
         FAIL_FAST_IF(!(!ReplyPending));
         pMsg->SetReplyStatus(Status);
         *ReplyMsg = pMsg;
@@ -18,10 +18,13 @@ Revision History:
 #pragma once
 
 #include "ApiMessage.h"
+#include "IDeviceComm.h"
 
 class IoSorter
 {
 public:
+    [[nodiscard]] static HRESULT ServiceIo(IDeviceComm& deviceComm, IApiRoutines& apiRoutines);
+
     // TODO: MSFT: 9115192 - probably not void.
     static void ServiceIoOperation(_In_ CONSOLE_API_MSG* const pMsg,
                                    _Out_ CONSOLE_API_MSG** ReplyMsg);
@@ -0,0 +1,197 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "ReplayDeviceComm.h"
+
+// Routine Description:
+// - Makes the record of an API call, as a client would have sent it.
+// Arguments:
+// - apiNumber - The layer and the number of the API. See ApiSorter.
+// - apiDescriptor - The message of the API, e.g. a CONSOLE_WRITECONSOLE_MSG.
+// - apiDescriptorSize - The size of the message, in bytes.
+// - payload - The input buffer that follows the message, e.g. the text to write.
+// - outputSize - The size of the output buffer of the client, in bytes.
+// Return Value:
+// - The record.
+ReplayDeviceComm::Record ReplayDeviceComm::s_MakeUserDefined(const ULONG apiNumber,
+                                                             _In_reads_bytes_(apiDescriptorSize) const void* const apiDescriptor,
+                                                             const ULONG apiDescriptorSize,
+                                                             const gsl::span<const BYTE> payload,
+                                                             const ULONG outputSize)
+{
+    Record record;
+    THROW_HR_IF(E_INVALIDARG, apiDescriptorSize > sizeof(record.Packet.u));
+
+    record.Packet.Descriptor.Function = CONSOLE_IO_USER_DEFINED;
+    record.Packet.msgHeader.ApiNumber = apiNumber;
+    record.Packet.msgHeader.ApiDescriptorSize = apiDescriptorSize;
+    memcpy(&record.Packet.u, apiDescriptor, apiDescriptorSize);
+
+    const auto header = reinterpret_cast<const BYTE*>(&record.Packet.msgHeader);
+    record.Input.insert(record.Input.end(), header, header + sizeof(CONSOLE_MSG_HEADER));
+    const auto descriptor = static_cast<const BYTE*>(apiDescriptor);
+    record.Input.insert(record.Input.end(), descriptor, descriptor + apiDescriptorSize);
+    record.Input.insert(record.Input.end(), payload.begin(), payload.end());
+
+    record.Packet.Descriptor.InputSize = gsl::narrow<ULONG>(record.Input.size());
+    THROW_IF_FAILED(ULongAdd(apiDescriptorSize, outputSize, &record.Packet.Descriptor.OutputSize));
+
+    return record;
+}
+
+// Routine Description:
+// - Creates a stand-in for the driver that replays the given stream.
+// Arguments:
+// - records - The stream, in the order it was recorded.
+// - passes - How many times to replay it.
+ReplayDeviceComm::ReplayDeviceComm(std::vector<Record> records, const size_t passes) :
+    _records(std::move(records)),
+    _messageCount(_records.size() * passes),
+    _next(0),
+    _completed(0),
+    _failed(0),
+    _outputBytes(0)
+{
+    // Identifiers are 32 bits. See ReadIo.
+    THROW_HR_IF(E_INVALIDARG, _messageCount > ULONG_MAX);
+}
+
+// Routine Description:
+// - Replays the messages of a recorded process as messages of a live one.
+// Arguments:
+// - recorded - The process handle in the recorded messages.
+// - live - The process to use instead.
+// Return Value:
+// - <none>
+void ReplayDeviceComm::MapProcess(const ULONG_PTR recorded, _In_ ConsoleProcessHandle* const live)
+{
+    _handles[recorded] = reinterpret_cast<ULONG_PTR>(live);
+}
+
+// Routine Description:
+// - Replays the messages to a recorded object as messages to a live one.
+// Arguments:
+// - recorded - The object handle in the recorded messages.
+// - live - The handle to use instead.
+// Return Value:
+// - <none>
+void ReplayDeviceComm::MapObject(const ULONG_PTR recorded, _In_ ConsoleHandleData* const live)
+{
+    _handles[recorded] = reinterpret_cast<ULONG_PTR>(live);
+}
+
+size_t ReplayDeviceComm::GetCompletedCount() const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    return _completed;
+}
+
+size_t ReplayDeviceComm::GetFailedCount() const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    return _failed;
+}
+
+size_t ReplayDeviceComm::GetOutputBytes() const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    return _outputBytes;
+}
+
+[[nodiscard]] HRESULT ReplayDeviceComm::SetServerInformation(_In_ CD_IO_SERVER_INFORMATION* const /*pServerInfo*/) const
+{
+    return S_OK;
+}
+
+// Routine Description:
+// - Completes the previous message, if any, and hands out the next one of the stream.
+// Arguments:
+// - pReplyMsg - Optional message to complete first.
+// - pMessage - Receives the packet data of the next message.
+// Return Value:
+// - S_OK, or HRESULT_FROM_WIN32(ERROR_PIPE_NOT_CONNECTED) once the stream ran out.
+[[nodiscard]] HRESULT ReplayDeviceComm::ReadIo(_In_opt_ PCONSOLE_API_MSG const pReplyMsg,
+                                               _Out_ CONSOLE_API_MSG* const pMessage) const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    if (pReplyMsg != nullptr)
+    {
+        _Complete(pReplyMsg->Complete);
+    }
+
+    if (_next >= _messageCount)
+    {
+        return HRESULT_FROM_WIN32(ERROR_PIPE_NOT_CONNECTED);
+    }
+
+    const auto& record = _records.at(_next % _records.size());
+    memcpy(&pMessage->Descriptor,
+           &record.Packet.Descriptor,
+           sizeof(CONSOLE_API_MSG) - FIELD_OFFSET(CONSOLE_API_MSG, Descriptor));
+    pMessage->Descriptor.Identifier.LowPart = gsl::narrow_cast<DWORD>(_next);
+    pMessage->Descriptor.Identifier.HighPart = 0;
+    pMessage->Descriptor.Process = _MapHandle(record.Packet.Descriptor.Process);
+    pMessage->Descriptor.Object = _MapHandle(record.Packet.Descriptor.Object);
+
+    ++_next;
+    return S_OK;
+}
+
+[[nodiscard]] HRESULT ReplayDeviceComm::CompleteIo(_In_ CD_IO_COMPLETE* const pCompletion) const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    _Complete(*pCompletion);
+    return S_OK;
+}
+
+// Routine Description:
+// - Reads from the recorded input buffer of a message.
+// Arguments:
+// - pIoOperation - The message, and what to read from where.
+// Return Value:
+// - S_OK, or E_INVALIDARG if that's past the end of what was recorded.
+[[nodiscard]] HRESULT ReplayDeviceComm::ReadInput(_In_ CD_IO_OPERATION* const pIoOperation) const
+{
+    // The records don't change after construction, so there's no need to lock.
+    const auto& input = _RecordOf(pIoOperation->Identifier).Input;
+
+    ULONG end;
+    RETURN_IF_FAILED(ULongAdd(pIoOperation->Buffer.Offset, pIoOperation->Buffer.Size, &end));
+    RETURN_HR_IF(E_INVALIDARG, end > input.size());
+
+    memcpy(pIoOperation->Buffer.Data, input.data() + pIoOperation->Buffer.Offset, pIoOperation->Buffer.Size);
+    return S_OK;
+}
+
+[[nodiscard]] HRESULT ReplayDeviceComm::WriteOutput(_In_ CD_IO_OPERATION* const pIoOperation) const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    _outputBytes += pIoOperation->Buffer.Size;
+    return S_OK;
+}
+
+[[nodiscard]] HRESULT ReplayDeviceComm::AllowUIAccess() const
+{
+    return S_OK;
+}
+
+const ReplayDeviceComm::Record& ReplayDeviceComm::_RecordOf(const LUID identifier) const
+{
+    return _records.at(identifier.LowPart % _records.size());
+}
+
+ULONG_PTR ReplayDeviceComm::_MapHandle(const ULONG_PTR recorded) const
+{
+    const auto handle = _handles.find(recorded);
+    return handle == _handles.end() ? recorded : handle->second;
+}
+
+void ReplayDeviceComm::_Complete(const CD_IO_COMPLETE& completion) const
+{
+    ++_completed;
+    if (!NT_SUCCESS(completion.IoStatus.Status))
+    {
+        ++_failed;
+    }
+}
@@ -0,0 +1,79 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ReplayDeviceComm.h
+
+Abstract:
+- Stands in for the console driver by replaying a recorded stream of messages,
+    so that the whole API layer (IoSorter, ApiSorter, the dispatchers and the
+    API routines) can be run and timed in-process, without a client.
+- The stream is replayed as many times as asked, in order. Every message gets a
+    fresh identifier, so messages that are replayed more than once, or that
+    pend, can still be told apart. Once the stream runs out, the IO threads are
+    told that the driver disconnected.
+- The process and object handles in a recorded message are pointers into the
+    server that recorded it. They have to be mapped onto live ones before the
+    stream is replayed.
+- The client's buffers are whatever was recorded for input. Output is thrown
+    away, after counting it.
+--*/
+
+#pragma once
+
+#include "ApiMessage.h"
+#include "IDeviceComm.h"
+
+class ReplayDeviceComm final : public IDeviceComm
+{
+public:
+    // One message, as the driver delivered it.
+    struct Record
+    {
+        // Only the packet data is replayed.
+        CONSOLE_API_MSG Packet;
+        // The input buffer of the client, starting with the message header.
+        std::vector<BYTE> Input;
+    };
+
+    static Record s_MakeUserDefined(const ULONG apiNumber,
+                                    _In_reads_bytes_(apiDescriptorSize) const void* const apiDescriptor,
+                                    const ULONG apiDescriptorSize,
+                                    const gsl::span<const BYTE> payload,
+                                    const ULONG outputSize);
+
+    ReplayDeviceComm(std::vector<Record> records, const size_t passes);
+
+    void MapProcess(const ULONG_PTR recorded, _In_ ConsoleProcessHandle* const live);
+    void MapObject(const ULONG_PTR recorded, _In_ ConsoleHandleData* const live);
+
+    size_t GetCompletedCount() const;
+    size_t GetFailedCount() const;
+    size_t GetOutputBytes() const;
+
+    [[nodiscard]] HRESULT SetServerInformation(_In_ CD_IO_SERVER_INFORMATION* const pServerInfo) const override;
+    [[nodiscard]] HRESULT ReadIo(_In_opt_ PCONSOLE_API_MSG const pReplyMsg,
+                                 _Out_ CONSOLE_API_MSG* const pMessage) const override;
+    [[nodiscard]] HRESULT CompleteIo(_In_ CD_IO_COMPLETE* const pCompletion) const override;
+
+    [[nodiscard]] HRESULT ReadInput(_In_ CD_IO_OPERATION* const pIoOperation) const override;
+    [[nodiscard]] HRESULT WriteOutput(_In_ CD_IO_OPERATION* const pIoOperation) const override;
+
+    [[nodiscard]] HRESULT AllowUIAccess() const override;
+
+private:
+    const std::vector<Record> _records;
+    const size_t _messageCount;
+    std::unordered_map<ULONG_PTR, ULONG_PTR> _handles;
+
+    mutable std::mutex _mutex;
+    mutable size_t _next;
+    mutable size_t _completed;
+    mutable size_t _failed;
+    mutable size_t _outputBytes;
+
+    const Record& _RecordOf(const LUID identifier) const;
+    ULONG_PTR _MapHandle(const ULONG_PTR recorded) const;
+    void _Complete(const CD_IO_COMPLETE& completion) const;
+};
@@ -16,22 +16,27 @@
 // Routine Description:
 // - Initializes a ConsoleWaitBlock
 // - ConsoleWaitBlocks will self-manage their position in their two queues.
-// - They will push themselves into the tail and store the iterator for constant deletion time later.
+// - They will push themselves into the tail and store the iterators for constant deletion time later.
 // Arguments:
 // - pProcessQueue - The queue attached to the client process ID that requested this action
 // - pObjectQueue - The queue attached to the console object that will service the action when data arrives
+// - pHandleData - The handle the client made the request on
 // - pWaitReplyMessage - The original API message related to the client process's service request
 // - pWaiter - The context to return to later when the wait is satisfied.
 ConsoleWaitBlock::ConsoleWaitBlock(_In_ ConsoleWaitQueue* const pProcessQueue,
                                    _In_ ConsoleWaitQueue* const pObjectQueue,
+                                   const ConsoleHandleData* const pHandleData,
                                    const CONSOLE_API_MSG* const pWaitReplyMessage,
                                    _In_ IWaitRoutine* const pWaiter) :
+    _pHandleData(THROW_HR_IF_NULL(E_INVALIDARG, pHandleData)),
     _pProcessQueue(THROW_HR_IF_NULL(E_INVALIDARG, pProcessQueue)),
     _pObjectQueue(THROW_HR_IF_NULL(E_INVALIDARG, pObjectQueue)),
     _pWaiter(THROW_HR_IF_NULL(E_INVALIDARG, pWaiter))
 {
-    _itProcessQueue = _pProcessQueue->_blocks.insert(_pProcessQueue->_blocks.end(), this);
-    _itObjectQueue = _pObjectQueue->_blocks.insert(_pObjectQueue->_blocks.end(), this);
+    _itProcessQueue = _pProcessQueue->_Add(this, _pHandleData);
+    auto removeFromProcessQueue = wil::scope_exit([&]() noexcept { _pProcessQueue->_Remove(_itProcessQueue, _pHandleData); });
+    _itObjectQueue = _pObjectQueue->_Add(this, _pHandleData);
+    removeFromProcessQueue.release();
 
     _WaitReplyMessage = *pWaitReplyMessage;
 
@@ -48,8 +53,8 @@ ConsoleWaitBlock::ConsoleWaitBlock(_In_ ConsoleWaitQueue* const pProcessQueue,
 //   constant time with the iterator acquired on construction.
 ConsoleWaitBlock::~ConsoleWaitBlock()
 {
-    _pProcessQueue->_blocks.erase(_itProcessQueue);
-    _pObjectQueue->_blocks.erase(_itObjectQueue);
+    _pProcessQueue->_Remove(_itProcessQueue, _pHandleData);
+    _pObjectQueue->_Remove(_itObjectQueue, _pHandleData);
 
     if (_pWaiter != nullptr)
     {
@@ -85,6 +90,7 @@ ConsoleWaitBlock::~ConsoleWaitBlock()
     {
         pWaitBlock = new ConsoleWaitBlock(pProcessQueue,
                                           pObjectQueue,
+                                          pHandleData,
                                           pWaitReplyMessage,
                                           pWaiter);
     }
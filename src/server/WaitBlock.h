@@ -24,10 +24,21 @@ Revision History:
 #include <list>
 
 class ConsoleWaitQueue;
+class ConsoleHandleData;
 
 class ConsoleWaitBlock
 {
 public:
+    using BlockList = std::list<ConsoleWaitBlock*>;
+
+    // Where a block is in one of its queues: in the queue itself, and among the
+    // blocks of that queue that wait on the same handle.
+    struct QueuePosition
+    {
+        BlockList::const_iterator InQueue;
+        BlockList::const_iterator OnHandle;
+    };
+
     ~ConsoleWaitBlock();
 
     bool Notify(const WaitTerminationReason TerminationReason);
@@ -38,14 +49,17 @@ public:
 private:
     ConsoleWaitBlock(_In_ ConsoleWaitQueue* const pProcessQueue,
                      _In_ ConsoleWaitQueue* const pObjectQueue,
+                     const ConsoleHandleData* const pHandleData,
                      const CONSOLE_API_MSG* const pWaitReplyMessage,
                      _In_ IWaitRoutine* const pWaiter);
 
+    const ConsoleHandleData* const _pHandleData;
+
     ConsoleWaitQueue* const _pProcessQueue;
-    std::_List_const_iterator<std::_List_val<std::_List_simple_types<ConsoleWaitBlock*>>> _itProcessQueue;
+    QueuePosition _itProcessQueue;
 
     ConsoleWaitQueue* const _pObjectQueue;
-    std::_List_const_iterator<std::_List_val<std::_List_simple_types<ConsoleWaitBlock*>>> _itObjectQueue;
+    QueuePosition _itObjectQueue;
 
     CONSOLE_API_MSG _WaitReplyMessage;
 
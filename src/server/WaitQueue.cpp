@@ -11,8 +11,13 @@
 
 // Routine Description:
 // - Instantiates a new ConsoleWaitQueue
-ConsoleWaitQueue::ConsoleWaitQueue() :
-    _blocks()
+// Arguments:
+// - fIndexByHandle - Whether to keep track of the blocks by the handle they wait on,
+//                    which NotifyWaitersOnHandle needs.
+ConsoleWaitQueue::ConsoleWaitQueue(const bool fIndexByHandle) :
+    _blocks(),
+    _fIndexByHandle(fIndexByHandle),
+    _blocksByHandle()
 {
 }
 
@@ -103,6 +108,106 @@ bool ConsoleWaitQueue::NotifyWaiters(const bool fNotifyAll,
     return fResult;
 }
 
+// Routine Description:
+// - Instructs this queue to attempt to callback the requests waiting on the given handle, and only those,
+//   and request termination with the given reason
+// - Only the blocks on that handle are walked, no matter how many wait on other handles.
+// - The queue has to index its blocks by handle.
+// Arguments:
+// - pHandleData - The handle the requests were made on.
+// - TerminationReason - A reason/message to pass to each waiter signaling it should terminate appropriately.
+// Return Value:
+// - True if any block was successfully notified. False if no blocks were successful.
+bool ConsoleWaitQueue::NotifyWaitersOnHandle(const ConsoleHandleData* const pHandleData,
+                                             const WaitTerminationReason TerminationReason)
+{
+    FAIL_FAST_IF(!_fIndexByHandle); // This is a programming error. Fail fast.
+
+    const auto blocksOnHandle = _blocksByHandle.find(pHandleData);
+    if (blocksOnHandle == _blocksByHandle.end())
+    {
+        return false;
+    }
+
+    bool fResult = false;
+
+    // Blocks that are queued while we go aren't notified.
+    auto remaining = blocksOnHandle->second.size();
+    auto it = blocksOnHandle->second.cbegin();
+    while (remaining-- > 0)
+    {
+        ConsoleWaitBlock* const WaitBlock = (*it);
+
+        // We have to capture next before it is potentially erased. Once the last block on the handle
+        // is erased, so is the list, so we mustn't touch it after that.
+        if (remaining > 0)
+        {
+            it = std::next(it);
+        }
+
+        if (_NotifyBlock(WaitBlock, TerminationReason))
+        {
+            fResult = true;
+        }
+    }
+
+    return fResult;
+}
+
+// Routine Description:
+// - Appends a block to the tail of this queue, and of the blocks in it that wait on the same handle
+//   if this queue indexes them.
+// Arguments:
+// - pWaitBlock - The block to append.
+// - pHandleData - The handle the block waits on.
+// Return Value:
+// - Where the block was put, for constant time removal later.
+ConsoleWaitBlock::QueuePosition ConsoleWaitQueue::_Add(_In_ ConsoleWaitBlock* const pWaitBlock,
+                                                       const ConsoleHandleData* const pHandleData)
+{
+    ConsoleWaitBlock::QueuePosition position;
+    position.InQueue = _blocks.insert(_blocks.end(), pWaitBlock);
+    if (!_fIndexByHandle)
+    {
+        return position;
+    }
+
+    auto removeFromQueue = wil::scope_exit([&]() noexcept { _blocks.erase(position.InQueue); });
+
+    auto& blocksOnHandle = _blocksByHandle[pHandleData];
+    position.OnHandle = blocksOnHandle.insert(blocksOnHandle.end(), pWaitBlock);
+
+    removeFromQueue.release();
+    return position;
+}
+
+// Routine Description:
+// - Removes a block from this queue, and drops the handle it waits on from the index if it was the last one.
+// Arguments:
+// - position - Where the block is. See _Add.
+// - pHandleData - The handle the block waits on.
+// Return Value:
+// - <none>
+void ConsoleWaitQueue::_Remove(const ConsoleWaitBlock::QueuePosition& position,
+                               const ConsoleHandleData* const pHandleData) noexcept
+{
+    _blocks.erase(position.InQueue);
+    if (!_fIndexByHandle)
+    {
+        return;
+    }
+
+    const auto blocksOnHandle = _blocksByHandle.find(pHandleData);
+    if (blocksOnHandle != _blocksByHandle.end())
+    {
+        blocksOnHandle->second.erase(position.OnHandle);
+        if (blocksOnHandle->second.empty())
+        {
+            _blocksByHandle.erase(blocksOnHandle);
+        }
+    }
+}
+
 // Routine Description:
 // - A helper to delete successfully notified callbacks
 // Arguments:
@@ -7,6 +7,10 @@ Module Name:
 
 Abstract:
 - This file manages a queue of wait blocks
+- Besides the queue itself, which is serviced first in, first out, a queue can
+    index its blocks by the handle they wait on, so that the waits on one handle
+    can be woken without walking the waits on every other one. Only the queues
+    that need that pay for it.
 
 Author:
 - Michael Niksa (miniksa) 17-Oct-2016
@@ -18,6 +22,7 @@ Revision History:
 #pragma once
 
 #include <list>
+#include <unordered_map>
 
 #include "..\host\conapi.h"
 
@@ -25,10 +30,12 @@ Revision History:
 #include "WaitBlock.h"
 #include "WaitTerminationReason.h"
 
+class ConsoleHandleData;
+
 class ConsoleWaitQueue
 {
 public:
-    ConsoleWaitQueue();
+    explicit ConsoleWaitQueue(const bool fIndexByHandle = false);
 
     ~ConsoleWaitQueue();
 
@@ -37,6 +44,9 @@ public:
     bool NotifyWaiters(const bool fNotifyAll,
                        const WaitTerminationReason TerminationReason);
 
+    bool NotifyWaitersOnHandle(const ConsoleHandleData* const pHandleData,
+                               const WaitTerminationReason TerminationReason);
+
     [[nodiscard]] static HRESULT s_CreateWait(_Inout_ CONSOLE_API_MSG* const pWaitReplyMessage,
                                               _In_ IWaitRoutine* const pWaiter);
 
@@ -44,7 +54,16 @@ private:
     bool _NotifyBlock(_In_ ConsoleWaitBlock* pWaitBlock,
                       const WaitTerminationReason TerminationReason);
 
-    std::list<ConsoleWaitBlock*> _blocks;
+    ConsoleWaitBlock::QueuePosition _Add(_In_ ConsoleWaitBlock* const pWaitBlock,
+                                         const ConsoleHandleData* const pHandleData);
+    void _Remove(const ConsoleWaitBlock::QueuePosition& position,
+                 const ConsoleHandleData* const pHandleData) noexcept;
+
+    ConsoleWaitBlock::BlockList _blocks;
+    // The same blocks, in the same order, by the handle they wait on. Handles without waits have no entry.
+    // Empty unless this queue was asked to index its blocks.
+    const bool _fIndexByHandle;
+    std::unordered_map<const ConsoleHandleData*, ConsoleWaitBlock::BlockList> _blocksByHandle;
 
     friend class ConsoleWaitBlock; // Blocks live in multiple queues so we let them manage the lifetime.
 };
@@ -443,6 +443,8 @@ public:
         Log::Comment(L"Starting test...");
 
         std::unique_ptr<TerminalInput> mouseInput = std::make_unique<TerminalInput>(s_MouseInputTestCallback);
+        // Every motion report is checked here, so don't hold any of them back.
+        mouseInput->SetMouseMotionInterval(TerminalInput::clock::duration::zero());
         unsigned int uiModifierKeystate = 0;
         VERIFY_SUCCEEDED_RETURN(TestData::TryGetValue(L"uiModifierKeystate", uiModifierKeystate));
         short sModifierKeystate = (SHORT)uiModifierKeystate;
@@ -633,4 +635,51 @@ public:
         mouseInput->EnableAlternateScroll(true);
         VERIFY_IS_FALSE(mouseInput->HandleMouse({ 0, 0 }, WM_MOUSEWHEEL, noModifierKeys, 1));
     }
+
+    TEST_METHOD(MotionCoalescingTests)
+    {
+        Log::Comment(L"Starting test...");
+
+        std::vector<std::wstring> writes;
+        TerminalInput mouseInput{ TerminalInput::WriteInputText{ [&](const std::wstring_view text) {
+            writes.emplace_back(text);
+        } } };
+        mouseInput.SetSGRExtendedMode(true);
+        mouseInput.EnableAnyEventTracking(true);
+
+        const auto interval = TerminalInput::DefaultMouseMotionInterval;
+        const auto start = TerminalInput::clock::now();
+        const short noModifierKeys = 0;
+
+        Log::Comment(L"The first motion is reported right away.");
+        VERIFY_IS_TRUE(mouseInput.HandleMouse({ 0, 0 }, WM_MOUSEMOVE, noModifierKeys, 0, start));
+        VERIFY_ARE_EQUAL(1u, writes.size());
+        VERIFY_ARE_EQUAL(std::wstring{ L"\x1b[<35;1;1m" }, writes.back());
+
+        Log::Comment(L"Motion within the interval is held back, and only the latest is kept.");
+        VERIFY_IS_TRUE(mouseInput.HandleMouse({ 1, 0 }, WM_MOUSEMOVE, noModifierKeys, 0, start + interval / 4));
+        VERIFY_IS_TRUE(mouseInput.HandleMouse({ 2, 0 }, WM_MOUSEMOVE, noModifierKeys, 0, start + interval / 2));
+        VERIFY_ARE_EQUAL(1u, writes.size());
+
+        const auto due = mouseInput.FlushMouseMotion(start + interval / 2);
+        VERIFY_IS_TRUE(due.has_value());
+        VERIFY_IS_TRUE(due.value() == start + interval);
+
+        Log::Comment(L"Once it's due, the latest motion is sent.");
+        VERIFY_IS_FALSE(mouseInput.FlushMouseMotion(start + interval).has_value());
+        VERIFY_ARE_EQUAL(2u, writes.size());
+        VERIFY_ARE_EQUAL(std::wstring{ L"\x1b[<35;3;1m" }, writes.back());
+
+        Log::Comment(L"A button goes out right away, along with the motion that was held back, in one write.");
+        VERIFY_IS_TRUE(mouseInput.HandleMouse({ 3, 0 }, WM_MOUSEMOVE, noModifierKeys, 0, start + interval + interval / 2));
+        VERIFY_IS_TRUE(mouseInput.HandleMouse({ 3, 0 }, WM_LBUTTONDOWN, noModifierKeys, 0, start + interval + interval / 2));
+        VERIFY_ARE_EQUAL(3u, writes.size());
+        VERIFY_ARE_EQUAL(std::wstring{ L"\x1b[<35;4;1m\x1b[<0;4;1M" }, writes.back());
+        VERIFY_IS_FALSE(mouseInput.FlushMouseMotion(start + interval + interval / 2).has_value());
+
+        const auto counters = mouseInput.GetMouseMotionCounters();
+        VERIFY_ARE_EQUAL(4u, counters.generated);
+        VERIFY_ARE_EQUAL(3u, counters.sent);
+        VERIFY_ARE_EQUAL(1u, counters.dropped);
+    }
 };
@@ -46,6 +46,7 @@ public:
     TEST_METHOD(TerminalInputNullKeyTests);
     TEST_METHOD(DifferentModifiersTest);
     TEST_METHOD(CtrlNumTest);
+    TEST_METHOD(TextSinkTest);
 
     wchar_t GetModifierChar(const bool fShift, const bool fAlt, const bool fCtrl)
     {
@@ -739,3 +740,37 @@ void InputTest::CtrlNumTest()
     s_expectedInput = L"9";
     TestKey(pInput, uiKeystate, vkey);
 }
+
+void InputTest::TextSinkTest()
+{
+    Log::Comment(L"Starting test...");
+
+    std::vector<std::wstring> writes;
+    TerminalInput input{ TerminalInput::WriteInputText{ [&](const std::wstring_view text) {
+        writes.emplace_back(text);
+    } } };
+
+    const auto verifyKey = [&](const unsigned int uiKeystate, const BYTE vkey, const wchar_t wch, const std::wstring_view expected) {
+        writes.clear();
+        TestKey(&input, uiKeystate, vkey, wch);
+        if (VERIFY_ARE_EQUAL(1u, writes.size(), L"Every key is written at once."))
+        {
+            VERIFY_ARE_EQUAL(std::wstring{ expected }, writes.at(0));
+        }
+    };
+
+    Log::Comment(L"Sending keys that encode to sequences of various lengths.");
+    verifyKey(0, VK_UP, 0, L"\x1b[A");
+    verifyKey(LEFT_CTRL_PRESSED, VK_DELETE, 0, L"\x1b[3;5~");
+    verifyKey(LEFT_ALT_PRESSED, 'A', L'a', L"\x1ba");
+    verifyKey(0, 'A', L'a', L"a");
+
+    Log::Comment(L"Ctrl+Space is a null character.");
+    verifyKey(LEFT_CTRL_PRESSED, VK_SPACE, L' ', std::wstring_view{ L"\0", 1 });
+
+    Log::Comment(L"A surrogate pair is written as a whole, once it's complete.");
+    writes.clear();
+    TestKey(&input, 0, 0, L'\xD83D');
+    VERIFY_ARE_EQUAL(0u, writes.size());
+    verifyKey(0, 0, L'\xDE00', L"\xD83D\xDE00");
+}
@@ -277,21 +277,44 @@ bool TerminalInput::IsTrackingMouseInput() const noexcept
     return (_mouseInputState.trackingMode != TrackingMode::None);
 }
 
+// Routine Description:
+// - Attempt to handle the given mouse coordinates and windows button as a VT-style mouse event,
+//     as of now. See the overload below.
+// Parameters:
+// - position - The windows coordinates (top,left = 0,0) of the mouse event
+// - button - the message to decode.
+// - modifierKeyState - the modifier keys pressed with this button
+// - delta - the amount that the scroll wheel changed (should be 0 unless button is a WM_MOUSE*WHEEL)
+// Return value:
+// - true if the event was handled and we should stop event propagation to the default window handler.
+bool TerminalInput::HandleMouse(const COORD position,
+                                const unsigned int button,
+                                const short modifierKeyState,
+                                const short delta)
+{
+    return HandleMouse(position, button, modifierKeyState, delta, clock::now());
+}
+
 // Routine Description:
 // - Attempt to handle the given mouse coordinates and windows button as a VT-style mouse event.
 //     If the event should be transmitted in the selected mouse mode, then we'll try and
 //     encode the event according to the rules of the selected ExtendedMode, and insert those characters into the input buffer.
+// - Motion reports are sent at most once per motion interval. In between, only
+//     the latest one is kept, and the caller is expected to call FlushMouseMotion
+//     once it's due.
 // Parameters:
 // - position - The windows coordinates (top,left = 0,0) of the mouse event
 // - button - the message to decode.
 // - modifierKeyState - the modifier keys pressed with this button
 // - delta - the amount that the scroll wheel changed (should be 0 unless button is a WM_MOUSE*WHEEL)
+// - now - the time of the event
 // Return value:
 // - true if the event was handled and we should stop event propagation to the default window handler.
 bool TerminalInput::HandleMouse(const COORD position,
                                 const unsigned int button,
                                 const short modifierKeyState,
-                                const short delta)
+                                const short delta,
+                                const clock::time_point now)
 {
     bool success = false;
     if (_ShouldSendAlternateScroll(button, delta))
@@ -330,7 +353,8 @@ bool TerminalInput::HandleMouse(const COORD position,
 
             if (success)
             {
-                std::wstring sequence;
+                SequenceBuffer buffer;
+                std::wstring_view sequence;
                 switch (_mouseInputState.extendedMode)
                 {
                 case ExtendedMode::None:
@@ -338,14 +362,16 @@ bool TerminalInput::HandleMouse(const COORD position,
                                                         realButton,
                                                         isHover,
                                                         modifierKeyState,
-                                                        delta);
+                                                        delta,
+                                                        buffer);
                     break;
                 case ExtendedMode::Utf8:
                     sequence = _GenerateUtf8Sequence(position,
                                                      realButton,
                                                      isHover,
                                                      modifierKeyState,
-                                                     delta);
+                                                     delta,
+                                                     buffer);
                     break;
                 case ExtendedMode::Sgr:
                     // For SGR encoding, if no physical buttons were pressed,
@@ -357,7 +383,8 @@ bool TerminalInput::HandleMouse(const COORD position,
                                                     _isButtonDown(realButton), // Use realButton here, to properly get the up/down state
                                                     isHover,
                                                     modifierKeyState,
-                                                    delta);
+                                                    delta,
+                                                    buffer);
                     break;
                 case ExtendedMode::Urxvt:
                 default:
@@ -369,8 +396,14 @@ bool TerminalInput::HandleMouse(const COORD position,
 
                 if (success)
                 {
-                    _SendInputSequence(sequence);
-                    success = true;
+                    if (isHover)
+                    {
+                        _SendMouseMotion(sequence, now);
+                    }
+                    else
+                    {
+                        _SendMouseButton(sequence);
+                    }
                 }
                 if (_mouseInputState.trackingMode == TrackingMode::ButtonEvent || _mouseInputState.trackingMode == TrackingMode::AnyEvent)
                 {
@@ -393,13 +426,15 @@ bool TerminalInput::HandleMouse(const COORD position,
 // - isHover - true if the sequence is generated in response to a mouse hover
 // - modifierKeyState - the modifier keys pressed with this button
 // - delta - the amount that the scroll wheel changed (should be 0 unless button is a WM_MOUSE*WHEEL)
+// - buffer - where to put the sequence together
 // Return value:
-// - The generated sequence. Will be empty if we couldn't generate.
-std::wstring TerminalInput::_GenerateDefaultSequence(const COORD position,
-                                                     const unsigned int button,
-                                                     const bool isHover,
-                                                     const short modifierKeyState,
-                                                     const short delta)
+// - The generated sequence, in buffer. Will be empty if we couldn't generate.
+std::wstring_view TerminalInput::_GenerateDefaultSequence(const COORD position,
+                                                          const unsigned int button,
+                                                          const bool isHover,
+                                                          const short modifierKeyState,
+                                                          const short delta,
+                                                          SequenceBuffer& buffer) noexcept
 {
     // In the default, non-extended encoding scheme, coordinates above 94 shouldn't be supported,
     //   because (95+32+1)=128, which is not an ASCII character.
@@ -411,11 +446,11 @@ std::wstring TerminalInput::_GenerateDefaultSequence(const COORD position,
         const short encodedX = _encodeDefaultCoordinate(vtCoords.X);
         const short encodedY = _encodeDefaultCoordinate(vtCoords.Y);
 
-        std::wstring format{ L"\x1b[Mbxy" };
-        format.at(3) = ' ' + gsl::narrow_cast<short>(_windowsButtonToXEncoding(button, isHover, modifierKeyState, delta));
-        format.at(4) = encodedX;
-        format.at(5) = encodedY;
-        return format;
+        buffer = { L'\x1b', L'[', L'M' };
+        til::at(buffer, 3) = ' ' + gsl::narrow_cast<short>(_windowsButtonToXEncoding(button, isHover, modifierKeyState, delta));
+        til::at(buffer, 4) = encodedX;
+        til::at(buffer, 5) = encodedY;
+        return { buffer.data(), 6 };
     }
 
     return {};
@@ -430,13 +465,15 @@ std::wstring TerminalInput::_GenerateDefaultSequence(const COORD position,
 // - isHover - true if the sequence is generated in response to a mouse hover
 // - modifierKeyState - the modifier keys pressed with this button
 // - delta - the amount that the scroll wheel changed (should be 0 unless button is a WM_MOUSE*WHEEL)
+// - buffer - where to put the sequence together
 // Return value:
-// - The generated sequence. Will be empty if we couldn't generate.
-std::wstring TerminalInput::_GenerateUtf8Sequence(const COORD position,
-                                                  const unsigned int button,
-                                                  const bool isHover,
-                                                  const short modifierKeyState,
-                                                  const short delta)
+// - The generated sequence, in buffer. Will be empty if we couldn't generate.
+std::wstring_view TerminalInput::_GenerateUtf8Sequence(const COORD position,
+                                                       const unsigned int button,
+                                                       const bool isHover,
+                                                       const short modifierKeyState,
+                                                       const short delta,
+                                                       SequenceBuffer& buffer) noexcept
 {
     // So we have some complications here.
     // The windows input stream is typically encoded as UTF16.
@@ -457,12 +494,12 @@ std::wstring TerminalInput::_GenerateUtf8Sequence(const COORD position,
         const COORD vtCoords = _winToVTCoord(position);
         const short encodedX = _encodeDefaultCoordinate(vtCoords.X);
         const short encodedY = _encodeDefaultCoordinate(vtCoords.Y);
-        std::wstring format{ L"\x1b[Mbxy" };
+        buffer = { L'\x1b', L'[', L'M' };
         // The short cast is safe because we know s_WindowsButtonToXEncoding  never returns more than xff
-        format.at(3) = ' ' + gsl::narrow_cast<short>(_windowsButtonToXEncoding(button, isHover, modifierKeyState, delta));
-        format.at(4) = encodedX;
-        format.at(5) = encodedY;
-        return format;
+        til::at(buffer, 3) = ' ' + gsl::narrow_cast<short>(_windowsButtonToXEncoding(button, isHover, modifierKeyState, delta));
+        til::at(buffer, 4) = encodedX;
+        til::at(buffer, 5) = encodedY;
+        return { buffer.data(), 6 };
     }
 
     return {};
@@ -478,25 +515,24 @@ std::wstring TerminalInput::_GenerateUtf8Sequence(const COORD position,
 // - isHover - true if the sequence is generated in response to a mouse hover
 // - modifierKeyState - the modifier keys pressed with this button
 // - delta - the amount that the scroll wheel changed (should be 0 unless button is a WM_MOUSE*WHEEL)
-// - ppwchSequence - On success, where to put the pointer to the generated sequence
-// - pcchLength - On success, where to put the length of the generated sequence
+// - buffer - where to put the sequence together
 // Return value:
-// - true if we were able to successfully generate a sequence.
-// On success, caller is responsible for delete[]ing *ppwchSequence.
-std::wstring TerminalInput::_GenerateSGRSequence(const COORD position,
-                                                 const unsigned int button,
-                                                 const bool isDown,
-                                                 const bool isHover,
-                                                 const short modifierKeyState,
-                                                 const short delta)
+// - The generated sequence, in buffer. Will be empty if we couldn't generate.
+std::wstring_view TerminalInput::_GenerateSGRSequence(const COORD position,
+                                                      const unsigned int button,
+                                                      const bool isDown,
+                                                      const bool isHover,
+                                                      const short modifierKeyState,
+                                                      const short delta,
+                                                      SequenceBuffer& buffer) noexcept
 {
     // Format for SGR events is:
     // "\x1b[<%d;%d;%d;%c", xButton, x+1, y+1, fButtonDown? 'M' : 'm'
     const int xbutton = _windowsButtonToSGREncoding(button, isHover, modifierKeyState, delta);
 
-    auto format = wil::str_printf<std::wstring>(L"\x1b[<%d;%d;%d%c", xbutton, position.X + 1, position.Y + 1, isDown ? L'M' : L'm');
+    const auto length = _snwprintf_s(buffer.data(), buffer.size(), _TRUNCATE, L"\x1b[<%d;%d;%d%c", xbutton, position.X + 1, position.Y + 1, isDown ? L'M' : L'm');
 
-    return format;
+    return length > 0 ? std::wstring_view{ buffer.data(), gsl::narrow_cast<size_t>(length) } : std::wstring_view{};
 }
 
 // Routine Description:
@@ -533,3 +569,126 @@ bool TerminalInput::_SendAlternateScroll(const short delta) const noexcept
     }
     return true;
 }
+
+// Routine Description:
+// - Sends a motion report, unless the last one was sent less than the motion
+//      interval ago. Then it's held back instead. A report that's held back
+//      replaces the one that was held back before: the app only cares where
+//      the pointer is now, not how it got there.
+// Parameters:
+// - sequence: The encoded report.
+// - now: The time of the event.
+// Return value:
+// <none>
+void TerminalInput::_SendMouseMotion(const std::wstring_view sequence, const clock::time_point now) noexcept
+{
+    auto& state = _mouseInputState;
+    state.motionCounters.generated++;
+    _DiscardMouseMotion();
+
+    if (state.lastMotionSent.has_value() && now - state.lastMotionSent.value() < state.motionInterval)
+    {
+        // The sequence was put together in a SequenceBuffer, so it fits.
+        std::copy(sequence.cbegin(), sequence.cend(), state.pendingMotion.begin());
+        state.pendingMotionLength = sequence.size();
+        return;
+    }
+
+    state.lastMotionSent = now;
+    state.motionCounters.sent++;
+    _SendInputSequence(sequence);
+}
+
+// Routine Description:
+// - Sends a button report. A motion report that was held back goes first, in
+//      the same write, so that the app knows where the pointer was when the
+//      button changed.
+// Parameters:
+// - sequence: The encoded report.
+// Return value:
+// <none>
+void TerminalInput::_SendMouseButton(const std::wstring_view sequence) noexcept
+{
+    auto& state = _mouseInputState;
+    if (state.pendingMotionLength == 0)
+    {
+        _SendInputSequence(sequence);
+        return;
+    }
+
+    std::array<wchar_t, 2 * std::tuple_size_v<SequenceBuffer>> combined;
+    const auto motionEnd = std::copy_n(state.pendingMotion.cbegin(), state.pendingMotionLength, combined.begin());
+    const auto end = std::copy(sequence.cbegin(), sequence.cend(), motionEnd);
+
+    state.pendingMotionLength = 0;
+    state.motionCounters.sent++;
+    _SendInputSequence({ combined.data(), gsl::narrow_cast<size_t>(end - combined.begin()) });
+}
+
+// Routine Description:
+// - Forgets the motion report that was held back, if any.
+// Parameters:
+// <none>
+// Return value:
+// <none>
+void TerminalInput::_DiscardMouseMotion() noexcept
+{
+    if (_mouseInputState.pendingMotionLength != 0)
+    {
+        _mouseInputState.pendingMotionLength = 0;
+        _mouseInputState.motionCounters.dropped++;
+    }
+}
+
+// Routine Description:
+// - Changes how often motion reports are sent at most.
+// Parameters:
+// - interval: The least amount of time between two motion reports. Zero sends
+//      every report right away.
+// Return value:
+// <none>
+void TerminalInput::SetMouseMotionInterval(const clock::duration interval) noexcept
+{
+    _mouseInputState.motionInterval = interval;
+}
+
+// Routine Description:
+// - Sends the motion report that was held back, if it's due.
+// Parameters:
+// - now: The current time.
+// Return value:
+// - The time at which the report that's still held back becomes due, or
+//      nullopt if nothing is held back anymore.
+std::optional<TerminalInput::clock::time_point> TerminalInput::FlushMouseMotion(const clock::time_point now) noexcept
+{
+    auto& state = _mouseInputState;
+    if (state.pendingMotionLength == 0)
+    {
+        return std::nullopt;
+    }
+
+    // A report is only ever held back after another one was sent.
+    const auto due = state.lastMotionSent.value_or(now) + state.motionInterval;
+    if (now < due)
+    {
+        return due;
+    }
+
+    const std::wstring_view sequence{ state.pendingMotion.data(), state.pendingMotionLength };
+    state.pendingMotionLength = 0;
+    state.lastMotionSent = now;
+    state.motionCounters.sent++;
+    _SendInputSequence(sequence);
+    return std::nullopt;
+}
+
+// Routine Description:
+// - Gets how many motion reports were generated, and what happened to them.
+// Parameters:
+// <none>
+// Return value:
+// - The counters.
+TerminalInput::MouseMotionCounters TerminalInput::GetMouseMotionCounters() const noexcept
+{
+    return _mouseInputState.motionCounters;
+}
@@ -18,6 +18,7 @@ using namespace Microsoft::Console::VirtualTerminal;
 // <none>
 void TerminalInput::SetUtf8ExtendedMode(const bool enable) noexcept
 {
+    _DiscardMouseMotion();
     _mouseInputState.extendedMode = enable ? ExtendedMode::Utf8 : ExtendedMode::None;
 }
 
@@ -32,6 +33,7 @@ void TerminalInput::SetUtf8ExtendedMode(const bool enable) noexcept
 // <none>
 void TerminalInput::SetSGRExtendedMode(const bool enable) noexcept
 {
+    _DiscardMouseMotion();
     _mouseInputState.extendedMode = enable ? ExtendedMode::Sgr : ExtendedMode::None;
 }
 
@@ -44,6 +46,7 @@ void TerminalInput::SetSGRExtendedMode(const bool enable) noexcept
 // <none>
 void TerminalInput::EnableDefaultTracking(const bool enable) noexcept
 {
+    _DiscardMouseMotion();
     _mouseInputState.trackingMode = enable ? TrackingMode::Default : TrackingMode::None;
     _mouseInputState.lastPos = { -1, -1 }; // Clear out the last saved mouse position & button.
     _mouseInputState.lastButton = 0;
@@ -60,6 +63,7 @@ void TerminalInput::EnableDefaultTracking(const bool enable) noexcept
 // <none>
 void TerminalInput::EnableButtonEventTracking(const bool enable) noexcept
 {
+    _DiscardMouseMotion();
     _mouseInputState.trackingMode = enable ? TrackingMode::ButtonEvent : TrackingMode::None;
     _mouseInputState.lastPos = { -1, -1 }; // Clear out the last saved mouse position & button.
     _mouseInputState.lastButton = 0;
@@ -76,6 +80,7 @@ void TerminalInput::EnableButtonEventTracking(const bool enable) noexcept
 // <none>
 void TerminalInput::EnableAnyEventTracking(const bool enable) noexcept
 {
+    _DiscardMouseMotion();
     _mouseInputState.trackingMode = enable ? TrackingMode::AnyEvent : TrackingMode::None;
     _mouseInputState.lastPos = { -1, -1 }; // Clear out the last saved mouse position & button.
     _mouseInputState.lastButton = 0;
@@ -21,12 +21,18 @@ using namespace Microsoft::Console::VirtualTerminal;
 
 DWORD const dwAltGrFlags = LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED;
 
-TerminalInput::TerminalInput(_In_ std::function<void(std::deque<std::unique_ptr<IInputEvent>>&)> pfn) :
+TerminalInput::TerminalInput(_In_ WriteInputEvents pfn) :
     _leadingSurrogate{}
 {
     _pfnWriteEvents = pfn;
 }
 
+TerminalInput::TerminalInput(_In_ WriteInputText pfn) :
+    _leadingSurrogate{}
+{
+    _pfnWriteText = pfn;
+}
+
 struct TermKeyMap
 {
     const WORD vkey;
@@ -318,14 +324,15 @@ static bool _searchWithModifier(const KeyEvent& keyEvent, InputSender sender)
     if (match)
     {
         const auto v = match.value();
-        if (!v.sequence.empty())
+        std::array<wchar_t, 16> modified; // Make a copy on the stack so we can modify it.
+        if (!v.sequence.empty() && v.sequence.size() <= modified.size())
         {
-            std::wstring modified{ v.sequence }; // Make a copy so we can modify it.
+            const auto length = v.sequence.copy(modified.data(), modified.size());
             const bool shift = keyEvent.IsShiftPressed();
             const bool alt = keyEvent.IsAltPressed();
             const bool ctrl = keyEvent.IsCtrlPressed();
-            modified.at(modified.size() - 2) = L'1' + (shift ? 1 : 0) + (alt ? 2 : 0) + (ctrl ? 4 : 0);
-            sender(modified);
+            modified.at(length - 2) = L'1' + (shift ? 1 : 0) + (alt ? 2 : 0) + (ctrl ? 4 : 0);
+            sender({ modified.data(), length });
             success = true;
         }
     }
@@ -589,8 +596,8 @@ void TerminalInput::_SendChar(const wchar_t ch)
         {
             // we already were storing a leading surrogate but we got another one. Go ahead and send the
             // saved surrogate piece and save the new one
-            const auto formatted = wil::str_printf<std::wstring>(L"%I32u", _leadingSurrogate.value());
-            _SendInputSequence(formatted);
+            const auto stray = _leadingSurrogate.value();
+            _SendInputSequence({ &stray, 1 });
         }
         // save the leading portion of a surrogate pair so that they can be sent at the same time
         _leadingSurrogate.emplace(ch);
@@ -616,23 +623,21 @@ void TerminalInput::_SendChar(const wchar_t ch)
 // - None
 void TerminalInput::_SendEscapedInputSequence(const wchar_t wch) const
 {
-    try
-    {
-        std::deque<std::unique_ptr<IInputEvent>> inputEvents;
-        inputEvents.push_back(std::make_unique<KeyEvent>(true, 1ui16, 0ui16, 0ui16, L'\x1b', 0));
-        inputEvents.push_back(std::make_unique<KeyEvent>(true, 1ui16, 0ui16, 0ui16, wch, 0));
-        _pfnWriteEvents(inputEvents);
-    }
-    catch (...)
-    {
-        LOG_HR(wil::ResultFromCaughtException());
-    }
+    const std::array<wchar_t, 2> sequence{ L'\x1b', wch };
+    _SendInputSequence({ sequence.data(), sequence.size() });
 }
 
 void TerminalInput::_SendNullInputSequence(const DWORD controlKeyState) const
 {
     try
     {
+        // As text, there's nothing to say which key it was.
+        if (_pfnWriteText)
+        {
+            _pfnWriteText({ L"\0", 1 });
+            return;
+        }
+
         std::deque<std::unique_ptr<IInputEvent>> inputEvents;
         inputEvents.push_back(std::make_unique<KeyEvent>(true,
                                                          1ui16,
@@ -654,6 +659,12 @@ void TerminalInput::_SendInputSequence(const std::wstring_view sequence) const n
     {
         try
         {
+            if (_pfnWriteText)
+            {
+                _pfnWriteText(sequence);
+                return;
+            }
+
             std::deque<std::unique_ptr<IInputEvent>> inputEvents;
             for (const auto& wch : sequence)
             {
@@ -13,6 +13,7 @@ Author(s):
 - Michael Niksa (MiNiksa) 30-Oct-2015
 --*/
 
+#include <chrono>
 #include <functional>
 #include "../../types/inc/IInputEvent.hpp"
 #pragma once
@@ -22,7 +23,14 @@ namespace Microsoft::Console::VirtualTerminal
     class TerminalInput final
     {
     public:
-        TerminalInput(_In_ std::function<void(std::deque<std::unique_ptr<IInputEvent>>&)> pfn);
+        // Receives the input as key events, one for each character.
+        using WriteInputEvents = std::function<void(std::deque<std::unique_ptr<IInputEvent>>&)>;
+        // Receives the input as text. Every HandleKey and HandleMouse call writes it
+        // at most once, and nothing is allocated on the way.
+        using WriteInputText = std::function<void(const std::wstring_view)>;
+
+        TerminalInput(_In_ WriteInputEvents pfn);
+        TerminalInput(_In_ WriteInputText pfn);
 
         TerminalInput() = delete;
         TerminalInput(const TerminalInput& old) = default;
@@ -39,12 +47,34 @@ namespace Microsoft::Console::VirtualTerminal
 
 #pragma region MouseInput
         // These methods are defined in mouseInput.cpp
+        using clock = std::chrono::steady_clock;
+
+        // Every motion report ends up either sent or dropped, or is still
+        // pending: generated == sent + dropped + pending.
+        struct MouseMotionCounters
+        {
+            size_t generated{ 0 };
+            size_t sent{ 0 };
+            size_t dropped{ 0 };
+        };
+
+        static constexpr std::chrono::milliseconds DefaultMouseMotionInterval{ 8 };
+
         bool HandleMouse(const COORD position,
                          const unsigned int button,
                          const short modifierKeyState,
                          const short delta);
+        bool HandleMouse(const COORD position,
+                         const unsigned int button,
+                         const short modifierKeyState,
+                         const short delta,
+                         const clock::time_point now);
 
         bool IsTrackingMouseInput() const noexcept;
+
+        void SetMouseMotionInterval(const clock::duration interval) noexcept;
+        std::optional<clock::time_point> FlushMouseMotion(const clock::time_point now) noexcept;
+        MouseMotionCounters GetMouseMotionCounters() const noexcept;
 #pragma endregion
 
 #pragma region MouseInputState Management
@@ -62,7 +92,13 @@ namespace Microsoft::Console::VirtualTerminal
 #pragma endregion
 
     private:
-        std::function<void(std::deque<std::unique_ptr<IInputEvent>>&)> _pfnWriteEvents;
+        // Where mouse reports are put together. That's enough for the longest
+        // of them, an SGR report with 5 digit coordinates.
+        using SequenceBuffer = std::array<wchar_t, 32>;
+
+        // Exactly one of these is set.
+        WriteInputEvents _pfnWriteEvents;
+        WriteInputText _pfnWriteText;
 
         // storage location for the leading surrogate of a utf-16 surrogate pair
         std::optional<wchar_t> _leadingSurrogate;
@@ -101,32 +137,46 @@ namespace Microsoft::Console::VirtualTerminal
             bool inAlternateBuffer{ false };
             COORD lastPos{ -1, -1 };
             unsigned int lastButton{ 0 };
+
+            // The latest motion report that was held back, if pendingMotionLength isn't 0.
+            SequenceBuffer pendingMotion{};
+            size_t pendingMotionLength{ 0 };
+            std::optional<clock::time_point> lastMotionSent;
+            clock::duration motionInterval{ DefaultMouseMotionInterval };
+            MouseMotionCounters motionCounters;
         };
 
         MouseInputState _mouseInputState;
 #pragma endregion
 
 #pragma region MouseInput
-        static std::wstring _GenerateDefaultSequence(const COORD position,
-                                                     const unsigned int button,
-                                                     const bool isHover,
-                                                     const short modifierKeyState,
-                                                     const short delta);
-        static std::wstring _GenerateUtf8Sequence(const COORD position,
-                                                  const unsigned int button,
-                                                  const bool isHover,
-                                                  const short modifierKeyState,
-                                                  const short delta);
-        static std::wstring _GenerateSGRSequence(const COORD position,
-                                                 const unsigned int button,
-                                                 const bool isDown,
-                                                 const bool isHover,
-                                                 const short modifierKeyState,
-                                                 const short delta);
+        static std::wstring_view _GenerateDefaultSequence(const COORD position,
+                                                          const unsigned int button,
+                                                          const bool isHover,
+                                                          const short modifierKeyState,
+                                                          const short delta,
+                                                          SequenceBuffer& buffer) noexcept;
+        static std::wstring_view _GenerateUtf8Sequence(const COORD position,
+                                                       const unsigned int button,
+                                                       const bool isHover,
+                                                       const short modifierKeyState,
+                                                       const short delta,
+                                                       SequenceBuffer& buffer) noexcept;
+        static std::wstring_view _GenerateSGRSequence(const COORD position,
+                                                      const unsigned int button,
+                                                      const bool isDown,
+                                                      const bool isHover,
+                                                      const short modifierKeyState,
+                                                      const short delta,
+                                                      SequenceBuffer& buffer) noexcept;
 
         bool _ShouldSendAlternateScroll(const unsigned int button, const short delta) const noexcept;
         bool _SendAlternateScroll(const short delta) const noexcept;
 
+        void _SendMouseMotion(const std::wstring_view sequence, const clock::time_point now) noexcept;
+        void _SendMouseButton(const std::wstring_view sequence) noexcept;
+        void _DiscardMouseMotion() noexcept;
+
         static unsigned int s_GetPressedButton() noexcept;
 #pragma endregion
     };
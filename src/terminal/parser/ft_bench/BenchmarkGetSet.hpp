@@ -0,0 +1,340 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- BenchmarkGetSet.hpp
+
+Abstract:
+- An in-memory ConGetSet and AdaptDefaults for driving a real AdaptDispatch
+    from the parser benchmark without a console host behind it.
+- Only the state that AdaptDispatch reads back is kept (the cursor, the
+    attributes and the scroll margins), so the numbers we measure are the
+    parser and the dispatcher, not a text buffer.
+--*/
+
+#pragma once
+
+#include "../../adapter/conGetSet.hpp"
+#include "../../adapter/adaptDefaults.hpp"
+
+namespace Microsoft::Console::VirtualTerminal::Benchmark
+{
+    class BenchmarkGetSet final : public ConGetSet
+    {
+    public:
+        static constexpr COORD ScreenSize{ 120, 30 };
+
+        bool GetConsoleCursorInfo(CONSOLE_CURSOR_INFO& cursorInfo) const override
+        {
+            cursorInfo.dwSize = 25;
+            cursorInfo.bVisible = _cursorVisible;
+            return true;
+        }
+
+        bool GetConsoleScreenBufferInfoEx(CONSOLE_SCREEN_BUFFER_INFOEX& screenBufferInfo) const override
+        {
+            screenBufferInfo.dwSize = ScreenSize;
+            screenBufferInfo.srWindow = { 0, 0, ScreenSize.X - 1, ScreenSize.Y - 1 };
+            screenBufferInfo.dwCursorPosition = _cursor;
+            screenBufferInfo.wAttributes = _attributes.GetLegacyAttributes();
+            screenBufferInfo.dwMaximumWindowSize = ScreenSize;
+            return true;
+        }
+
+        bool SetConsoleScreenBufferInfoEx(const CONSOLE_SCREEN_BUFFER_INFOEX& screenBufferInfo) override
+        {
+            return SetConsoleCursorPosition(screenBufferInfo.dwCursorPosition);
+        }
+
+        bool SetConsoleCursorInfo(const CONSOLE_CURSOR_INFO& cursorInfo) override
+        {
+            _cursorVisible = !!cursorInfo.bVisible;
+            return true;
+        }
+
+        bool SetConsoleCursorPosition(const COORD position) override
+        {
+            _cursor.X = std::clamp<SHORT>(position.X, 0, ScreenSize.X - 1);
+            _cursor.Y = std::clamp<SHORT>(position.Y, 0, ScreenSize.Y - 1);
+            return true;
+        }
+
+        bool SetConsoleTextAttribute(const WORD attr) override
+        {
+            _attributes.SetFromLegacy(attr);
+            return true;
+        }
+
+        bool PrivateIsVtInputEnabled() const override { return false; }
+
+        bool PrivateSetLegacyAttributes(const WORD attr,
+                                        const bool foreground,
+                                        const bool background,
+                                        const bool meta) override
+        {
+            _attributes.SetLegacyAttributes(attr, foreground, background, meta);
+            return true;
+        }
+
+        bool PrivateSetDefaultAttributes(const bool foreground, const bool background) override
+        {
+            if (foreground)
+            {
+                _attributes.SetDefaultForeground();
+            }
+            if (background)
+            {
+                _attributes.SetDefaultBackground();
+            }
+            return true;
+        }
+
+        bool SetConsoleXtermTextAttribute(const int xtermTableEntry, const bool isForeground) override
+        {
+            const auto index = std::make_optional(gsl::narrow_cast<BYTE>(xtermTableEntry));
+            _attributes.SetIndexedAttributes(isForeground ? index : std::nullopt,
+                                             isForeground ? std::nullopt : index);
+            return true;
+        }
+
+        bool SetConsoleRGBTextAttribute(const COLORREF rgbColor, const bool isForeground) override
+        {
+            _attributes.SetColor(rgbColor, isForeground);
+            return true;
+        }
+
+        bool PrivateBoldText(const bool bolded) override
+        {
+            bolded ? _attributes.Embolden() : _attributes.Debolden();
+            return true;
+        }
+
+        bool PrivateGetExtendedTextAttributes(ExtendedAttributes& attrs) override
+        {
+            attrs = _attributes.GetExtendedAttributes();
+            return true;
+        }
+
+        bool PrivateSetExtendedTextAttributes(const ExtendedAttributes attrs) override
+        {
+            _attributes.SetExtendedAttributes(attrs);
+            return true;
+        }
+
+        bool PrivateGetTextAttributes(TextAttribute& attrs) const override
+        {
+            attrs = _attributes;
+            return true;
+        }
+
+        bool PrivateSetTextAttributes(const TextAttribute& attrs) override
+        {
+            _attributes = attrs;
+            return true;
+        }
+
+        bool PrivateWriteConsoleInputW(std::deque<std::unique_ptr<IInputEvent>>& events,
+                                       size_t& eventsWritten) override
+        {
+            // Responses (DSR, DA) have nowhere to go. Drop them.
+            eventsWritten = events.size();
+            events.clear();
+            return true;
+        }
+
+        bool SetConsoleWindowInfo(const bool /*absolute*/, const SMALL_RECT& /*window*/) override { return true; }
+        bool PrivateSetCursorKeysMode(const bool /*applicationMode*/) override { return true; }
+        bool PrivateSetKeypadMode(const bool /*applicationMode*/) override { return true; }
+        bool PrivateSetScreenMode(const bool /*reverseMode*/) override { return true; }
+        bool PrivateSetAutoWrapMode(const bool /*wrapAtEOL*/) override { return true; }
+
+        bool PrivateShowCursor(const bool show) override
+        {
+            _cursorVisible = show;
+            return true;
+        }
+
+        bool PrivateAllowCursorBlinking(const bool /*enable*/) override { return true; }
+
+        bool PrivateSetScrollingRegion(const SMALL_RECT& scrollMargins) override
+        {
+            _scrollMargins = scrollMargins;
+            return true;
+        }
+
+        bool PrivateWarningBell() override { return true; }
+        bool PrivateGetLineFeedMode() const override { return false; }
+
+        bool PrivateLineFeed(const bool withReturn) override
+        {
+            if (withReturn)
+            {
+                _cursor.X = 0;
+            }
+            _cursor.Y = std::min(gsl::narrow_cast<SHORT>(_cursor.Y + 1), _GetBottomMargin());
+            return true;
+        }
+
+        bool PrivateReverseLineFeed() override
+        {
+            _cursor.Y = std::max(gsl::narrow_cast<SHORT>(_cursor.Y - 1), _GetTopMargin());
+            return true;
+        }
+
+        bool SetConsoleTitleW(const std::wstring_view title) override
+        {
+            _title = title;
+            return true;
+        }
+
+        bool PrivateUseAlternateScreenBuffer() override { return true; }
+        bool PrivateUseMainScreenBuffer() override { return true; }
+
+        bool PrivateEnableVT200MouseMode(const bool /*enabled*/) override { return true; }
+        bool PrivateEnableUTF8ExtendedMouseMode(const bool /*enabled*/) override { return true; }
+        bool PrivateEnableSGRExtendedMouseMode(const bool /*enabled*/) override { return true; }
+        bool PrivateEnableButtonEventMouseMode(const bool /*enabled*/) override { return true; }
+        bool PrivateEnableAnyEventMouseMode(const bool /*enabled*/) override { return true; }
+        bool PrivateEnableAlternateScroll(const bool /*enabled*/) override { return true; }
+
+        bool PrivateEraseAll() override
+        {
+            _cursor = { 0, 0 };
+            return true;
+        }
+
+        bool SetCursorStyle(const CursorType /*style*/) override { return true; }
+        bool SetCursorColor(const COLORREF /*color*/) override { return true; }
+
+        bool PrivateGetConsoleScreenBufferAttributes(WORD& attributes) override
+        {
+            attributes = _attributes.GetLegacyAttributes();
+            return true;
+        }
+
+        bool PrivatePrependConsoleInput(std::deque<std::unique_ptr<IInputEvent>>& events,
+                                        size_t& eventsWritten) override
+        {
+            return PrivateWriteConsoleInputW(events, eventsWritten);
+        }
+
+        bool PrivateWriteConsoleControlInput(const KeyEvent /*key*/) override { return true; }
+        bool PrivateRefreshWindow() override { return true; }
+
+        bool GetConsoleOutputCP(unsigned int& codepage) override
+        {
+            codepage = CP_UTF8;
+            return true;
+        }
+
+        bool PrivateSuppressResizeRepaint() override { return true; }
+        bool IsConsolePty() const override { return false; }
+
+        bool DeleteLines(const size_t /*count*/) override { return true; }
+        bool InsertLines(const size_t /*count*/) override { return true; }
+
+        bool MoveToBottom() const override { return true; }
+
+        bool PrivateSetColorTableEntry(const short /*index*/, const COLORREF /*value*/) const override { return true; }
+        bool PrivateSetDefaultForeground(const COLORREF /*value*/) const override { return true; }
+        bool PrivateSetDefaultBackground(const COLORREF /*value*/) const override { return true; }
+
+        bool PrivateFillRegion(const COORD /*startPosition*/,
+                               const size_t /*fillLength*/,
+                               const wchar_t /*fillChar*/,
+                               const bool /*standardFillAttrs*/) override
+        {
+            return true;
+        }
+
+        bool PrivateScrollRegion(const SMALL_RECT /*scrollRect*/,
+                                 const std::optional<SMALL_RECT> /*clipRect*/,
+                                 const COORD /*destinationOrigin*/,
+                                 const bool /*standardFillAttrs*/) override
+        {
+            return true;
+        }
+
+        // Advances the cursor over printed text, wrapping at the right edge
+        // the way the console would.
+        void AdvanceCursor(const size_t cells) noexcept
+        {
+            auto column = static_cast<size_t>(_cursor.X) + cells;
+            while (column >= static_cast<size_t>(ScreenSize.X))
+            {
+                column -= ScreenSize.X;
+                _cursor.Y = std::min(gsl::narrow_cast<SHORT>(_cursor.Y + 1), _GetBottomMargin());
+            }
+            _cursor.X = gsl::narrow_cast<SHORT>(column);
+        }
+
+        void CarriageReturn() noexcept
+        {
+            _cursor.X = 0;
+        }
+
+        void Backspace() noexcept
+        {
+            _cursor.X = std::max<SHORT>(gsl::narrow_cast<SHORT>(_cursor.X - 1), 0);
+        }
+
+    private:
+        COORD _cursor{ 0, 0 };
+        bool _cursorVisible{ true };
+        TextAttribute _attributes;
+        SMALL_RECT _scrollMargins{ 0, 0, 0, 0 };
+        std::wstring _title;
+
+        SHORT _GetTopMargin() const noexcept
+        {
+            return _scrollMargins.Top < _scrollMargins.Bottom ? _scrollMargins.Top : 0;
+        }
+
+        SHORT _GetBottomMargin() const noexcept
+        {
+            return _scrollMargins.Top < _scrollMargins.Bottom ? _scrollMargins.Bottom : ScreenSize.Y - 1;
+        }
+    };
+
+    class BenchmarkDefaults final : public AdaptDefaults
+    {
+    public:
+        // The get/set is owned by the AdaptDispatch that owns us too.
+        BenchmarkDefaults(BenchmarkGetSet& getSet) noexcept :
+            _getSet{ getSet }
+        {
+        }
+
+        void Print(const wchar_t /*wch*/) override
+        {
+            _getSet.AdvanceCursor(1);
+        }
+
+        void PrintString(const std::wstring_view string) override
+        {
+            _getSet.AdvanceCursor(string.size());
+        }
+
+        void Execute(const wchar_t wch) override
+        {
+            switch (wch)
+            {
+            case L'\r':
+                _getSet.CarriageReturn();
+                break;
+            case L'\n':
+                _getSet.PrivateLineFeed(false);
+                break;
+            case L'\b':
+                _getSet.Backspace();
+                break;
+            default:
+                break;
+            }
+        }
+
+    private:
+        BenchmarkGetSet& _getSet;
+    };
+}
@@ -0,0 +1,266 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "Corpora.hpp"
+
+using namespace Microsoft::Console::VirtualTerminal::Benchmark;
+
+// Every generator gets its own engine with the same seed, so adding a corpus
+// doesn't change the contents of the others.
+static constexpr std::mt19937::result_type Seed = 0x5eed;
+
+static constexpr std::wstring_view Words[] = {
+    L"the", L"console", L"buffer", L"parser", L"warning", L"0x7ffe", L"build",
+    L"succeeded", L"render", L"cursor", L"line", L"error", L"src/host/output.cpp",
+    L"Microsoft::Console", L"12345", L"function", L"[INFO]", L"->", L"{", L"}"
+};
+
+// Routine Description:
+// - Fills in the UTF-8 form of a generated corpus.
+// Arguments:
+// - name: The name to report the corpus under.
+// - text: The generated text.
+// Return Value:
+// - The complete corpus.
+static Corpus _MakeCorpus(std::wstring name, std::wstring text)
+{
+    Corpus corpus;
+    corpus.name = std::move(name);
+    THROW_IF_FAILED(til::u16u8(std::wstring_view{ text }, corpus.utf8));
+    corpus.text = std::move(text);
+    return corpus;
+}
+
+// Routine Description:
+// - Appends a random run of words from the word list.
+// Arguments:
+// - text: The string to append to.
+// - engine: The random engine to draw from.
+// - count: The number of words to append.
+// Return Value:
+// - <none>
+static void _AppendWords(std::wstring& text, std::mt19937& engine, const size_t count)
+{
+    std::uniform_int_distribution<size_t> pick{ 0, std::size(Words) - 1 };
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i)
+        {
+            text.push_back(L' ');
+        }
+        text.append(Words[pick(engine)]);
+    }
+}
+
+// Routine Description:
+// - Generates every built-in corpus.
+// Arguments:
+// - targetBytes: The approximate UTF-8 size of each corpus.
+// Return Value:
+// - The corpora, in the order they're reported.
+std::vector<Corpus> Corpora::GenerateAll(const size_t targetBytes)
+{
+    std::vector<Corpus> corpora;
+    corpora.emplace_back(GeneratePlainAscii(targetBytes));
+    corpora.emplace_back(GenerateCjk(targetBytes));
+    corpora.emplace_back(GenerateSgrDense(targetBytes));
+    corpora.emplace_back(GenerateCursorHeavy(targetBytes));
+    corpora.emplace_back(GenerateOscTitles(targetBytes));
+    return corpora;
+}
+
+// Routine Description:
+// - Generates plain ASCII lines, like a build log or `type` of a source file.
+// Arguments:
+// - targetBytes: The approximate UTF-8 size of the corpus.
+// Return Value:
+// - The corpus.
+Corpus Corpora::GeneratePlainAscii(const size_t targetBytes)
+{
+    std::mt19937 engine{ Seed };
+    std::uniform_int_distribution<size_t> wordCount{ 1, 16 };
+
+    std::wstring text;
+    text.reserve(targetBytes);
+    while (text.size() < targetBytes)
+    {
+        _AppendWords(text, engine, wordCount(engine));
+        text.append(L"\r\n");
+    }
+    return _MakeCorpus(L"ascii", std::move(text));
+}
+
+// Routine Description:
+// - Generates lines that are mostly CJK ideographs with a little ASCII mixed
+//      in. Every ideograph is 3 bytes of UTF-8, but 1 wchar_t.
+// Arguments:
+// - targetBytes: The approximate UTF-8 size of the corpus.
+// Return Value:
+// - The corpus.
+Corpus Corpora::GenerateCjk(const size_t targetBytes)
+{
+    std::mt19937 engine{ Seed };
+    std::uniform_int_distribution<unsigned int> ideograph{ 0x4E00, 0x9FFF };
+    std::uniform_int_distribution<size_t> runLength{ 4, 40 };
+
+    std::wstring text;
+    size_t bytes = 0;
+    while (bytes < targetBytes)
+    {
+        const auto count = runLength(engine);
+        for (size_t i = 0; i < count; i++)
+        {
+            text.push_back(gsl::narrow_cast<wchar_t>(ideograph(engine)));
+        }
+        bytes += count * 3;
+
+        const auto before = text.size();
+        text.push_back(L' ');
+        _AppendWords(text, engine, 1);
+        text.append(L"\r\n");
+        bytes += text.size() - before;
+    }
+    return _MakeCorpus(L"cjk", std::move(text));
+}
+
+// Routine Description:
+// - Generates compiler-style diagnostics, where almost every few words come
+//      with a color change. Covers the 16-color, 256-color and RGB forms.
+// Arguments:
+// - targetBytes: The approximate UTF-8 size of the corpus.
+// Return Value:
+// - The corpus.
+Corpus Corpora::GenerateSgrDense(const size_t targetBytes)
+{
+    std::mt19937 engine{ Seed };
+    std::uniform_int_distribution<unsigned int> color16{ 0, 7 };
+    std::uniform_int_distribution<unsigned int> color256{ 0, 255 };
+    std::uniform_int_distribution<unsigned int> channel{ 0, 255 };
+    std::uniform_int_distribution<unsigned int> line{ 1, 9999 };
+    std::uniform_int_distribution<size_t> wordCount{ 2, 10 };
+    std::uniform_int_distribution<int> kind{ 0, 3 };
+
+    std::wstring text;
+    text.reserve(targetBytes);
+    while (text.size() < targetBytes)
+    {
+        text.append(L"\x1b[1m");
+        _AppendWords(text, engine, 1);
+        text.append(L":" + std::to_wstring(line(engine)) + L":" + std::to_wstring(line(engine) % 120) + L": \x1b[0m");
+
+        switch (kind(engine))
+        {
+        case 0:
+            text.append(L"\x1b[1;31merror: \x1b[0m");
+            break;
+        case 1:
+            text.append(L"\x1b[1;35mwarning: \x1b[0m");
+            break;
+        case 2:
+            text.append(L"\x1b[38;5;" + std::to_wstring(color256(engine)) + L"mnote: \x1b[39m");
+            break;
+        default:
+            text.append(L"\x1b[38;2;" + std::to_wstring(channel(engine)) + L";" +
+                        std::to_wstring(channel(engine)) + L";" +
+                        std::to_wstring(channel(engine)) + L"mremark: \x1b[m");
+            break;
+        }
+
+        _AppendWords(text, engine, wordCount(engine));
+        text.append(L" \x1b[3" + std::to_wstring(color16(engine)) + L";4" + std::to_wstring(color16(engine)) + L"m");
+        _AppendWords(text, engine, 1);
+        text.append(L"\x1b[0m\r\n");
+    }
+    return _MakeCorpus(L"sgr", std::move(text));
+}
+
+// Routine Description:
+// - Generates full-screen TUI redraws: the cursor jumps around a 120x30 screen
+//      to repaint small cells of box-drawn content, with erases, background
+//      color changes and the cursor hidden during each frame.
+// Arguments:
+// - targetBytes: The approximate UTF-8 size of the corpus.
+// Return Value:
+// - The corpus.
+Corpus Corpora::GenerateCursorHeavy(const size_t targetBytes)
+{
+    std::mt19937 engine{ Seed };
+    std::uniform_int_distribution<unsigned int> row{ 1, 30 };
+    std::uniform_int_distribution<unsigned int> column{ 1, 120 };
+    std::uniform_int_distribution<unsigned int> color{ 40, 47 };
+    std::uniform_int_distribution<size_t> cellsPerFrame{ 20, 80 };
+    std::uniform_int_distribution<size_t> cellWidth{ 1, 12 };
+
+    std::wstring text;
+    size_t bytes = 0;
+    while (bytes < targetBytes)
+    {
+        const auto before = text.size();
+        text.append(L"\x1b[?25l\x1b[1;30r\x1b[H");
+
+        const auto cells = cellsPerFrame(engine);
+        for (size_t i = 0; i < cells; i++)
+        {
+            text.append(L"\x1b[" + std::to_wstring(row(engine)) + L";" + std::to_wstring(column(engine)) + L"H");
+            text.append(L"\x1b[" + std::to_wstring(color(engine)) + L"m\x2502");
+            text.append(cellWidth(engine), L'\x2500');
+            text.append(L"\x2502\x1b[K");
+        }
+
+        text.append(L"\x1b[0m\x1b[30;1H\x1b[2K\x1b[7m status \x1b[27m\x1b[?25h");
+
+        // The box drawing characters are 3 bytes of UTF-8 each, but that's
+        // close enough for deciding when to stop.
+        bytes += (text.size() - before) * 3 / 2;
+    }
+    return _MakeCorpus(L"tui", std::move(text));
+}
+
+// Routine Description:
+// - Generates a shell prompt that retitles the window every line, with a mix
+//      of BEL- and ST-terminated OSC sequences.
+// Arguments:
+// - targetBytes: The approximate UTF-8 size of the corpus.
+// Return Value:
+// - The corpus.
+Corpus Corpora::GenerateOscTitles(const size_t targetBytes)
+{
+    std::mt19937 engine{ Seed };
+    std::uniform_int_distribution<size_t> wordCount{ 1, 6 };
+    std::bernoulli_distribution useBel{ 0.5 };
+
+    std::wstring text;
+    text.reserve(targetBytes);
+    for (size_t i = 0; text.size() < targetBytes; i++)
+    {
+        text.append(L"\x1b]0;");
+        _AppendWords(text, engine, wordCount(engine));
+        text.append(L" - " + std::to_wstring(i));
+        text.append(useBel(engine) ? L"\x07" : L"\x1b\\");
+
+        text.append(L"C:\\> ");
+        _AppendWords(text, engine, wordCount(engine));
+        text.append(L"\r\n");
+    }
+    return _MakeCorpus(L"osc", std::move(text));
+}
+
+// Routine Description:
+// - Loads a recording from disk. The file is expected to hold exactly what
+//      the client wrote, as UTF-8.
+// Arguments:
+// - path: The file to load.
+// Return Value:
+// - The corpus, named after the file.
+Corpus Corpora::Load(const std::wstring& path)
+{
+    std::ifstream file{ path, std::ios::binary };
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND), !file);
+
+    Corpus corpus;
+    corpus.name = path;
+    corpus.utf8.assign(std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{});
+    THROW_IF_FAILED(til::u8u16(std::string_view{ corpus.utf8 }, corpus.text));
+    return corpus;
+}
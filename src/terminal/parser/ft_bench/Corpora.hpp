@@ -0,0 +1,43 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- Corpora.hpp
+
+Abstract:
+- The inputs that the parser benchmark replays.
+- The built-in corpora are generated from a fixed seed, so every run (and every
+    machine) parses exactly the same text. Each one mimics a kind of output
+    that we see a lot of in the wild.
+- Recordings of real sessions (the raw UTF-8 that a client wrote, e.g. captured
+    with vtpipeterm or `script`) can be loaded from disk as well.
+--*/
+
+#pragma once
+
+namespace Microsoft::Console::VirtualTerminal::Benchmark
+{
+    struct Corpus
+    {
+        std::wstring name;
+        // The text as the client wrote it. The throughput numbers are relative
+        // to this, since that's what comes over the pipe.
+        std::string utf8;
+        // The text as the state machine sees it.
+        std::wstring text;
+    };
+
+    namespace Corpora
+    {
+        std::vector<Corpus> GenerateAll(const size_t targetBytes);
+
+        Corpus GeneratePlainAscii(const size_t targetBytes);
+        Corpus GenerateCjk(const size_t targetBytes);
+        Corpus GenerateSgrDense(const size_t targetBytes);
+        Corpus GenerateCursorHeavy(const size_t targetBytes);
+        Corpus GenerateOscTitles(const size_t targetBytes);
+
+        Corpus Load(const std::wstring& path);
+    }
+}
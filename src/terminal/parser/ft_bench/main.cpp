@@ -0,0 +1,241 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// Parser throughput benchmark.
+// Replays each corpus through a StateMachine with an OutputStateMachineEngine,
+// once against a dispatch that does nothing (the cost of parsing alone) and
+// once against a real AdaptDispatch (parsing plus dispatching), and reports
+// MB/s, ns/byte and heap allocations for each.
+//
+// Usage: ParserBenchmark.exe [-i iterations] [-s corpusKB] [-c chunkChars] [recording...]
+
+#include "precomp.h"
+
+#include "Corpora.hpp"
+#include "BenchmarkGetSet.hpp"
+
+#include "../stateMachine.hpp"
+#include "../OutputStateMachineEngine.hpp"
+#include "../../adapter/adaptDispatch.hpp"
+#include "../../adapter/termDispatch.hpp"
+
+using namespace Microsoft::Console::VirtualTerminal;
+using namespace Microsoft::Console::VirtualTerminal::Benchmark;
+
+// Every heap allocation in the process goes through here, so we can report how
+// many of them the parser makes per byte of input.
+static std::atomic<size_t> g_allocations{ 0 };
+static std::atomic<size_t> g_allocatedBytes{ 0 };
+
+void* __cdecl operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (auto p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void __cdecl operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+// A dispatch that accepts everything and does nothing with it.
+class NullDispatch final : public TermDispatch
+{
+public:
+    void Execute(const wchar_t /*wchControl*/) override {}
+    void Print(const wchar_t /*wchPrintable*/) override {}
+    void PrintString(const std::wstring_view /*string*/) override {}
+};
+
+struct Options
+{
+    unsigned int iterations{ 10 };
+    size_t corpusBytes{ 4 * 1024 * 1024 };
+    // Matches the size of the reads conhost makes from the client's pipe.
+    size_t chunkChars{ 4096 };
+    std::vector<std::wstring> recordings;
+};
+
+struct Result
+{
+    double bestSeconds{ 0 };
+    size_t allocations{ 0 };
+    size_t allocatedBytes{ 0 };
+};
+
+// Routine Description:
+// - Creates a state machine for the given kind of dispatch.
+// Arguments:
+// - adapt: true for a full AdaptDispatch, false for a NullDispatch.
+// Return Value:
+// - The state machine.
+static std::unique_ptr<StateMachine> _CreateStateMachine(const bool adapt)
+{
+    std::unique_ptr<ITermDispatch> dispatch;
+    if (adapt)
+    {
+        auto getSet = std::make_unique<BenchmarkGetSet>();
+        auto defaults = std::make_unique<BenchmarkDefaults>(*getSet);
+        dispatch = std::make_unique<AdaptDispatch>(std::move(getSet), std::move(defaults));
+    }
+    else
+    {
+        dispatch = std::make_unique<NullDispatch>();
+    }
+
+    auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+    return std::make_unique<StateMachine>(std::move(engine));
+}
+
+// Routine Description:
+// - Feeds a whole corpus through the state machine, one chunk at a time the
+//      way that it would arrive from a client.
+// Arguments:
+// - stateMachine: The state machine to drive.
+// - text: The corpus text.
+// - chunkChars: The number of characters to hand over at once.
+// Return Value:
+// - <none>
+static void _Replay(StateMachine& stateMachine, const std::wstring_view text, const size_t chunkChars)
+{
+    for (size_t offset = 0; offset < text.size(); offset += chunkChars)
+    {
+        stateMachine.ProcessString(text.substr(offset, chunkChars));
+    }
+}
+
+// Routine Description:
+// - Runs one corpus against one kind of dispatch. There's one untimed pass
+//      first, so that one-time setup (and any buffers that the parser grows
+//      and keeps) doesn't count against the steady state.
+// Arguments:
+// - corpus: The corpus to replay.
+// - adapt: true for a full AdaptDispatch, false for a NullDispatch.
+// - options: The benchmark options.
+// Return Value:
+// - The fastest pass, and the allocations made by an average pass.
+static Result _Run(const Corpus& corpus, const bool adapt, const Options& options)
+{
+    auto stateMachine = _CreateStateMachine(adapt);
+    _Replay(*stateMachine, corpus.text, options.chunkChars);
+
+    Result result;
+    result.bestSeconds = std::numeric_limits<double>::max();
+
+    const auto allocationsBefore = g_allocations.load();
+    const auto allocatedBytesBefore = g_allocatedBytes.load();
+
+    for (unsigned int i = 0; i < options.iterations; i++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        _Replay(*stateMachine, corpus.text, options.chunkChars);
+        const auto end = std::chrono::steady_clock::now();
+
+        result.bestSeconds = std::min(result.bestSeconds, std::chrono::duration<double>(end - start).count());
+    }
+
+    result.allocations = (g_allocations.load() - allocationsBefore) / options.iterations;
+    result.allocatedBytes = (g_allocatedBytes.load() - allocatedBytesBefore) / options.iterations;
+    return result;
+}
+
+// Routine Description:
+// - Prints one line of the results table.
+// Arguments:
+// - corpus: The corpus that was replayed.
+// - dispatchName: The kind of dispatch it was replayed against.
+// - result: The measurements.
+// Return Value:
+// - <none>
+static void _Report(const Corpus& corpus, const std::wstring_view dispatchName, const Result& result)
+{
+    const auto bytes = static_cast<double>(corpus.utf8.size());
+    const auto megabytes = bytes / (1024 * 1024);
+
+    wprintf(L"%-12s %-6.*s %10.1f %10.2f %12.1f %14.1f\n",
+            corpus.name.c_str(),
+            gsl::narrow_cast<int>(dispatchName.size()),
+            dispatchName.data(),
+            megabytes / result.bestSeconds,
+            result.bestSeconds * 1e9 / bytes,
+            result.allocations / megabytes,
+            result.allocatedBytes / megabytes / 1024);
+}
+
+// Routine Description:
+// - Reads the command line.
+// Arguments:
+// - argc, argv: The command line.
+// - options: Receives the options.
+// Return Value:
+// - true if the command line was valid.
+static bool _ParseArgs(const int argc, const wchar_t* const argv[], Options& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const std::wstring_view arg{ argv[i] };
+        const bool hasValue = i + 1 < argc;
+        if (arg == L"-i" && hasValue)
+        {
+            options.iterations = std::max(1ul, wcstoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == L"-s" && hasValue)
+        {
+            options.corpusBytes = std::max<size_t>(1, wcstoul(argv[++i], nullptr, 10)) * 1024;
+        }
+        else if (arg == L"-c" && hasValue)
+        {
+            options.chunkChars = std::max<size_t>(1, wcstoul(argv[++i], nullptr, 10));
+        }
+        else if (!arg.empty() && arg.front() == L'-')
+        {
+            return false;
+        }
+        else
+        {
+            options.recordings.emplace_back(arg);
+        }
+    }
+    return true;
+}
+
+int __cdecl wmain(int argc, wchar_t* argv[])
+{
+    Options options;
+    if (!_ParseArgs(argc, argv, options))
+    {
+        fwprintf(stderr, L"Usage: %s [-i iterations] [-s corpusKB] [-c chunkChars] [recording...]\n", argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        auto corpora = Corpora::GenerateAll(options.corpusBytes);
+        for (const auto& path : options.recordings)
+        {
+            corpora.emplace_back(Corpora::Load(path));
+        }
+
+        wprintf(L"%u iterations, %zu character chunks\n\n", options.iterations, options.chunkChars);
+        wprintf(L"%-12s %-6s %10s %10s %12s %14s\n", L"corpus", L"disp", L"MB/s", L"ns/byte", L"allocs/MB", L"alloc KB/MB");
+
+        for (const auto& corpus : corpora)
+        {
+            _Report(corpus, L"null", _Run(corpus, false, options));
+            _Report(corpus, L"adapt", _Run(corpus, true, options));
+        }
+    }
+    catch (...)
+    {
+        const auto hr = wil::ResultFromCaughtException();
+        fwprintf(stderr, L"Benchmark failed: 0x%08x\n", static_cast<unsigned int>(hr));
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,27 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+/*
+Module Name:
+- precomp.h
+
+Abstract:
+- Contains external headers to include in the precompile phase of the parser benchmark.
+*/
+
+#pragma once
+
+// This includes support libraries from the CRT, STL, WIL, and GSL
+#include "LibraryIncludes.h"
+
+#include <windows.h>
+
+#include <sal.h>
+
+#include <cstdio>
+#include <chrono>
+#include <fstream>
+#include <random>
+
+#define ENABLE_INTSAFE_SIGNED_FUNCTIONS
+#include <intsafe.h>
@@ -0,0 +1,2 @@
+@echo off
+%OPENCON%\bin\%ARCH%\%_LAST_BUILD_CONF%\ParserBenchmark.exe %*
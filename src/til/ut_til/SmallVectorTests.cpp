@@ -0,0 +1,130 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class SmallVectorTests
+{
+    TEST_CLASS(SmallVectorTests);
+
+    TEST_METHOD(Construct)
+    {
+        Log::Comment(L"Default Constructor");
+        til::small_vector<int, 2> s;
+        VERIFY_IS_TRUE(s.empty());
+        VERIFY_IS_TRUE(s.is_inline());
+        VERIFY_ARE_EQUAL(2u, s.capacity());
+
+        Log::Comment(L"Initializer List Constructor that fits inline");
+        til::small_vector<int, 2> t{ 1, 2 };
+        VERIFY_ARE_EQUAL(2u, t.size());
+        VERIFY_IS_TRUE(t.is_inline());
+
+        Log::Comment(L"Initializer List Constructor that spills to the heap");
+        til::small_vector<int, 2> u{ 1, 2, 3 };
+        VERIFY_ARE_EQUAL(3u, u.size());
+        VERIFY_IS_FALSE(u.is_inline());
+        VERIFY_ARE_EQUAL(3, u[2]);
+    }
+
+    TEST_METHOD(PushBackStaysInlineUntilFull)
+    {
+        til::small_vector<int, 4> s;
+        for (auto i = 0; i < 4; ++i)
+        {
+            s.push_back(i);
+            VERIFY_IS_TRUE(s.is_inline());
+        }
+
+        Log::Comment(L"The fifth element has to go to the heap.");
+        s.push_back(s.front());
+        VERIFY_IS_FALSE(s.is_inline());
+        VERIFY_ARE_EQUAL(5u, s.size());
+
+        const std::vector<int> expected{ 0, 1, 2, 3, 0 };
+        VERIFY_IS_TRUE(std::equal(s.begin(), s.end(), expected.begin(), expected.end()));
+    }
+
+    TEST_METHOD(InsertAndErase)
+    {
+        til::small_vector<int, 4> s{ 0, 1, 2 };
+
+        s.insert(s.begin() + 1, 10);
+        VERIFY_IS_TRUE(s.is_inline());
+
+        const std::vector<int> range{ 20, 21 };
+        s.insert(s.end(), range.begin(), range.end());
+        VERIFY_IS_FALSE(s.is_inline());
+
+        std::vector<int> expected{ 0, 10, 1, 2, 20, 21 };
+        VERIFY_IS_TRUE(std::equal(s.begin(), s.end(), expected.begin(), expected.end()));
+
+        s.erase(s.begin() + 1, s.begin() + 4);
+        expected = { 0, 20, 21 };
+        VERIFY_IS_TRUE(std::equal(s.begin(), s.end(), expected.begin(), expected.end()));
+
+        Log::Comment(L"Shrinking moves us back into the inline buffer.");
+        s.shrink_to_fit();
+        VERIFY_IS_TRUE(s.is_inline());
+        VERIFY_IS_TRUE(std::equal(s.begin(), s.end(), expected.begin(), expected.end()));
+    }
+
+    TEST_METHOD(CopyAndMove)
+    {
+        til::small_vector<int, 2> inlined{ 1, 2 };
+        til::small_vector<int, 2> spilled{ 1, 2, 3 };
+
+        auto inlinedCopy = inlined;
+        auto spilledCopy = spilled;
+        VERIFY_IS_TRUE(inlined == inlinedCopy);
+        VERIFY_IS_TRUE(spilled == spilledCopy);
+        VERIFY_ARE_NOT_EQUAL(spilled.data(), spilledCopy.data());
+
+        const auto spilledData = spilled.data();
+        auto spilledMoved = std::move(spilled);
+        VERIFY_ARE_EQUAL(spilledData, spilledMoved.data(), L"Moving heap storage shouldn't copy it.");
+        VERIFY_IS_TRUE(spilled.empty());
+        VERIFY_IS_TRUE(spilled.is_inline());
+
+        auto inlinedMoved = std::move(inlined);
+        VERIFY_IS_TRUE(inlinedMoved == inlinedCopy);
+        VERIFY_IS_TRUE(inlinedMoved.is_inline());
+    }
+
+    TEST_METHOD(Swap)
+    {
+        til::small_vector<int, 2> a{ 1 };
+        til::small_vector<int, 2> b{ 2, 3, 4 };
+        const til::small_vector<int, 2> aCopy = a;
+        const til::small_vector<int, 2> bCopy = b;
+
+        a.swap(b);
+        VERIFY_IS_TRUE(a == bCopy);
+        VERIFY_IS_TRUE(b == aCopy);
+    }
+
+    TEST_METHOD(Resize)
+    {
+        til::small_vector<int, 2> s{ 1 };
+        s.resize(3);
+        VERIFY_ARE_EQUAL(3u, s.size());
+        VERIFY_ARE_EQUAL(0, s[2]);
+
+        s.resize(1);
+        VERIFY_ARE_EQUAL(1u, s.size());
+        VERIFY_ARE_EQUAL(1, s.back());
+    }
+
+    TEST_METHOD(OutOfRange)
+    {
+        til::small_vector<int, 2> s{ 1 };
+        VERIFY_THROWS(s.at(1), std::out_of_range);
+
+        s.pop_back();
+        VERIFY_THROWS(s.pop_back(), std::out_of_range);
+    }
+};
@@ -0,0 +1,252 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "UiaEventCoalescer.hpp"
+
+using namespace Microsoft::Console::Types;
+
+// Routine Description:
+// - Creates a coalescer that forwards events to the given dispatcher.
+// Arguments:
+// - dispatcher: The dispatcher that actually raises the events.
+// - minInterval: The least amount of time between two events of the same kind.
+//      Zero raises every event as soon as it's flushed.
+// - quietPeriod: How long no new signal has to arrive before a held back
+//      event is raised, once its minimum interval has passed.
+UiaEventCoalescer::UiaEventCoalescer(IUiaEventDispatcher* const dispatcher,
+                                     const clock::duration minInterval,
+                                     const clock::duration quietPeriod) :
+    _dispatcher{ THROW_HR_IF_NULL(E_INVALIDARG, dispatcher) },
+    _minInterval{ minInterval },
+    _quietPeriod{ quietPeriod },
+    _events{}
+{
+}
+
+// Routine Description:
+// - Changes the least amount of time between two events of the same kind.
+// Arguments:
+// - minInterval: The new minimum interval.
+// Return Value:
+// - <none>
+void UiaEventCoalescer::SetMinInterval(const clock::duration minInterval) noexcept
+{
+    _minInterval = minInterval;
+}
+
+// Routine Description:
+// - Changes how long the signals have to stop before held back events are
+//      raised early.
+// Arguments:
+// - quietPeriod: The new quiet period.
+// Return Value:
+// - <none>
+void UiaEventCoalescer::SetQuietPeriod(const clock::duration quietPeriod) noexcept
+{
+    _quietPeriod = quietPeriod;
+}
+
+// Routine Description:
+// - Records that an event happened. Nothing is raised until the next Flush.
+//      If the same kind of event is already waiting to be raised, the two are
+//      merged and this one counts as suppressed.
+// Arguments:
+// - event: The kind of event.
+// - now: The current time.
+// Return Value:
+// - <none>
+void UiaEventCoalescer::Signal(const Event event, const clock::time_point now) noexcept
+{
+    auto& state = til::at(_events, static_cast<size_t>(event));
+    state.counters.signaled++;
+    if (state.pending)
+    {
+        state.counters.suppressed++;
+    }
+    else
+    {
+        state.firstSignaled = now;
+    }
+    state.pending = true;
+    state.lastSignaled = now;
+}
+
+// Routine Description:
+// - Raises every pending event that is due. Events are raised in a fixed
+//      order: selection, then text, then cursor.
+// Arguments:
+// - now: The current time.
+// Return Value:
+// - The time at which the next event that is still pending becomes due, or
+//      nullopt if nothing is pending anymore.
+std::optional<UiaEventCoalescer::clock::time_point> UiaEventCoalescer::Flush(const clock::time_point now) noexcept
+{
+    DueEvents due;
+    const auto nextDue = Collect(now, due);
+    Raise(due);
+    return nextDue;
+}
+
+// Routine Description:
+// - Takes every pending event that is due and counts it as raised, but leaves
+//      the actual raising to Raise.
+// Arguments:
+// - now: The current time.
+// - due: Receives the kinds of event that are due.
+// Return Value:
+// - The time at which the next event that is still pending becomes due, or
+//      nullopt if nothing is pending anymore.
+std::optional<UiaEventCoalescer::clock::time_point> UiaEventCoalescer::Collect(const clock::time_point now, DueEvents& due) noexcept
+{
+    due.reset();
+
+    std::optional<clock::time_point> nextDue;
+    for (size_t i = 0; i < EventCount; i++)
+    {
+        auto& state = til::at(_events, i);
+        if (!state.pending)
+        {
+            continue;
+        }
+
+        const auto dueTime = _DueTime(state);
+        if (dueTime <= now)
+        {
+            state.pending = false;
+            state.lastRaised = now;
+            state.counters.raised++;
+            due.set(i);
+        }
+        else if (!nextDue || dueTime < *nextDue)
+        {
+            nextDue = dueTime;
+        }
+    }
+    return nextDue;
+}
+
+// Routine Description:
+// - Hands the events that Collect found to be due to the dispatcher, in a fixed
+//      order: selection, then text, then cursor. This doesn't touch the state of
+//      the coalescer, so it doesn't need whatever lock guards Collect.
+// Arguments:
+// - due: The kinds of event to raise.
+// Return Value:
+// - <none>
+void UiaEventCoalescer::Raise(const DueEvents& due) const noexcept
+{
+    for (size_t i = 0; i < EventCount; i++)
+    {
+        if (due.test(i))
+        {
+            _Raise(static_cast<Event>(i));
+        }
+    }
+}
+
+// Routine Description:
+// - Drops every pending event without raising it, e.g. because nobody is
+//      listening anymore. They count as suppressed.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void UiaEventCoalescer::DiscardPending() noexcept
+{
+    for (auto& state : _events)
+    {
+        if (state.pending)
+        {
+            state.pending = false;
+            state.counters.suppressed++;
+        }
+    }
+}
+
+// Routine Description:
+// - Checks whether any event is waiting to be raised.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if a later Flush has something to raise.
+bool UiaEventCoalescer::HasPendingEvents() const noexcept
+{
+    return std::any_of(_events.begin(), _events.end(), [](const auto& state) { return state.pending; });
+}
+
+// Routine Description:
+// - Gets the counters for one kind of event.
+// Arguments:
+// - event: The kind of event.
+// Return Value:
+// - How often it was signaled, raised and suppressed.
+UiaEventCoalescer::Counters UiaEventCoalescer::GetCounters(const Event event) const noexcept
+{
+    return til::at(_events, static_cast<size_t>(event)).counters;
+}
+
+// Routine Description:
+// - Gets the counters summed up over every kind of event.
+// Arguments:
+// - <none>
+// Return Value:
+// - How often any event was signaled, raised and suppressed.
+UiaEventCoalescer::Counters UiaEventCoalescer::GetTotalCounters() const noexcept
+{
+    Counters total;
+    for (const auto& state : _events)
+    {
+        total.signaled += state.counters.signaled;
+        total.raised += state.counters.raised;
+        total.suppressed += state.counters.suppressed;
+    }
+    return total;
+}
+
+// Routine Description:
+// - Determines when a pending event may be raised. It's never sooner than the
+//      minimum interval since it was last raised. After that, it's once no new
+//      signal has arrived for the quiet period, or once it has been waiting for
+//      a whole minimum interval, whichever comes first. An event that was never
+//      raised is due right away.
+// Arguments:
+// - state: The state of a pending event.
+// Return Value:
+// - The time at which the event is due.
+UiaEventCoalescer::clock::time_point UiaEventCoalescer::_DueTime(const EventState& state) const noexcept
+{
+    if (!state.lastRaised)
+    {
+        return state.lastSignaled;
+    }
+    const auto quietDeadline = state.lastSignaled + _quietPeriod;
+    const auto latencyDeadline = state.firstSignaled + _minInterval;
+    return std::max(*state.lastRaised + _minInterval, std::min(quietDeadline, latencyDeadline));
+}
+
+// Routine Description:
+// - Hands an event to the dispatcher.
+// Arguments:
+// - event: The kind of event.
+// Return Value:
+// - <none>
+void UiaEventCoalescer::_Raise(const Event event) const noexcept
+{
+    try
+    {
+        switch (event)
+        {
+        case Event::SelectionChanged:
+            _dispatcher->SignalSelectionChanged();
+            break;
+        case Event::TextChanged:
+            _dispatcher->SignalTextChanged();
+            break;
+        case Event::CursorChanged:
+            _dispatcher->SignalCursorChanged();
+            break;
+        }
+    }
+    CATCH_LOG();
+}
@@ -0,0 +1,100 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- UiaEventCoalescer.hpp
+
+Abstract:
+- Sits between a renderer and an IUiaEventDispatcher and limits how often each
+    kind of accessibility event is raised.
+- Raising a UIA event is a cross-process call into every listening client.
+    Under heavy output, the renderer would otherwise raise a text changed event
+    on every single frame. Instead, an event that was already raised within the
+    last minimum interval is held back, and any further signals of the same
+    kind are merged into it.
+- The minimum interval is a floor: a held back event is never raised sooner.
+    Past that, it's raised as soon as nothing new has been signaled for the
+    quiet period, but no later than one minimum interval after it was first
+    signaled. This keeps the latency low for a lone keystroke that follows a
+    burst of output, without flooding the client while the output continues.
+- The coalescer doesn't keep time on its own. The caller provides the current
+    time and is told when the next pending event becomes due.
+- The coalescer isn't thread safe. A caller that guards it with a lock should
+    Collect the due events under the lock and Raise them after releasing it,
+    since raising an event calls out into the automation clients.
+--*/
+
+#pragma once
+
+#include "IUiaEventDispatcher.h"
+
+#include <bitset>
+
+namespace Microsoft::Console::Types
+{
+    class UiaEventCoalescer final
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        enum class Event : size_t
+        {
+            SelectionChanged,
+            TextChanged,
+            CursorChanged
+        };
+
+        // Every signal ends up either raised or suppressed, or is still
+        // pending: signaled == raised + suppressed + pending.
+        struct Counters
+        {
+            size_t signaled{ 0 };
+            size_t raised{ 0 };
+            size_t suppressed{ 0 };
+        };
+
+        static constexpr size_t EventCount = 3;
+
+        // The kinds of event that Collect found to be due, indexed by Event.
+        using DueEvents = std::bitset<EventCount>;
+
+        static constexpr std::chrono::milliseconds DefaultMinInterval{ 100 };
+        static constexpr std::chrono::milliseconds DefaultQuietPeriod{ 20 };
+
+        UiaEventCoalescer(IUiaEventDispatcher* const dispatcher,
+                          const clock::duration minInterval = DefaultMinInterval,
+                          const clock::duration quietPeriod = DefaultQuietPeriod);
+
+        void SetMinInterval(const clock::duration minInterval) noexcept;
+        void SetQuietPeriod(const clock::duration quietPeriod) noexcept;
+
+        void Signal(const Event event, const clock::time_point now) noexcept;
+        std::optional<clock::time_point> Flush(const clock::time_point now) noexcept;
+        std::optional<clock::time_point> Collect(const clock::time_point now, DueEvents& due) noexcept;
+        void Raise(const DueEvents& due) const noexcept;
+        void DiscardPending() noexcept;
+
+        bool HasPendingEvents() const noexcept;
+        Counters GetCounters(const Event event) const noexcept;
+        Counters GetTotalCounters() const noexcept;
+
+    private:
+        struct EventState
+        {
+            bool pending{ false };
+            std::optional<clock::time_point> lastRaised;
+            clock::time_point firstSignaled{};
+            clock::time_point lastSignaled{};
+            Counters counters;
+        };
+
+        IUiaEventDispatcher* _dispatcher;
+        clock::duration _minInterval;
+        clock::duration _quietPeriod;
+        std::array<EventState, EventCount> _events;
+
+        clock::time_point _DueTime(const EventState& state) const noexcept;
+        void _Raise(const Event event) const noexcept;
+    };
+}
@@ -517,16 +517,15 @@ try
         bufferSize.DecrementInBounds(inclusiveEnd, true);
 
         const auto textRects = buffer.GetTextRects(_start, inclusiveEnd, _blockRange);
-        const auto bufferData = buffer.GetText(true,
-                                               false,
-                                               textRects);
 
-        const size_t textDataSize = base::ClampMul(bufferData.text.size(), bufferSize.Width());
-        textData.reserve(textDataSize);
-        for (const auto& text : bufferData.text)
-        {
-            textData += text;
-        }
+        // Stream straight into the result. If we were given a maximum, we
+        // stop reading the buffer as soon as we have that much.
+        PlainTextSink sink{ maxLength };
+        buffer.VisitText(true,
+                         false,
+                         textRects,
+                         sink);
+        textData = std::move(sink.GetText());
     }
 
     if (maxLength.has_value())
@@ -0,0 +1,301 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "..\..\inc\consoletaeftemplates.hpp"
+
+#include "..\UiaEventCoalescer.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace Microsoft::Console::Types;
+using namespace std::chrono_literals;
+
+using Event = UiaEventCoalescer::Event;
+
+// Records every event that the coalescer raises, in order.
+class MockUiaEventDispatcher final : public IUiaEventDispatcher
+{
+public:
+    void SignalSelectionChanged() override
+    {
+        events.push_back(Event::SelectionChanged);
+    }
+
+    void SignalTextChanged() override
+    {
+        events.push_back(Event::TextChanged);
+    }
+
+    void SignalCursorChanged() override
+    {
+        events.push_back(Event::CursorChanged);
+    }
+
+    size_t Count(const Event event) const
+    {
+        return gsl::narrow_cast<size_t>(std::count(events.begin(), events.end(), event));
+    }
+
+    std::vector<Event> events;
+};
+
+class UiaEventCoalescerTests
+{
+    TEST_CLASS(UiaEventCoalescerTests);
+
+    TEST_METHOD(FirstEventIsRaisedRightAway);
+    TEST_METHOD(RepeatedEventsAreMerged);
+    TEST_METHOD(MinIntervalLimitsContinuousEvents);
+    TEST_METHOD(QuietPeriodFlushesEarly);
+    TEST_METHOD(QuietPeriodNeverBeatsMinInterval);
+    TEST_METHOD(EventKindsAreLimitedIndependently);
+    TEST_METHOD(ZeroIntervalRaisesEveryFlush);
+    TEST_METHOD(DiscardPendingCountsAsSuppressed);
+    TEST_METHOD(CollectLeavesRaisingToTheCaller);
+
+    // An arbitrary point in time for the tests to count from.
+    static constexpr UiaEventCoalescer::clock::time_point _start{ 1h };
+};
+
+void UiaEventCoalescerTests::FirstEventIsRaisedRightAway()
+{
+    MockUiaEventDispatcher dispatcher;
+    UiaEventCoalescer coalescer{ &dispatcher, 100ms, 20ms };
+
+    coalescer.Signal(Event::TextChanged, _start);
+    coalescer.Signal(Event::SelectionChanged, _start);
+    VERIFY_IS_TRUE(dispatcher.events.empty(), L"Nothing is raised before the flush.");
+
+    const auto nextDue = coalescer.Flush(_start);
+    VERIFY_IS_FALSE(nextDue.has_value());
+    VERIFY_IS_FALSE(coalescer.HasPendingEvents());
+
+    // Selection always goes first, the same order as the renderer used to raise them in.
+    const std::vector<Event> expected{ Event::SelectionChanged, Event::TextChanged };
+    VERIFY_ARE_EQUAL(expected.size(), dispatcher.events.size());
+    VERIFY_IS_TRUE(expected == dispatcher.events);
+}
+
+void UiaEventCoalescerTests::RepeatedEventsAreMerged()
+{
+    MockUiaEventDispatcher dispatcher;
+    UiaEventCoalescer coalescer{ &dispatcher, 100ms, 20ms };
+
+    for (auto i = 0; i < 5; i++)
+    {
+        coalescer.Signal(Event::TextChanged, _start);
+    }
+    coalescer.Flush(_start);
+
+    VERIFY_ARE_EQUAL(1u, dispatcher.Count(Event::TextChanged));
+
+    const auto counters = coalescer.GetCounters(Event::TextChanged);
+    VERIFY_ARE_EQUAL(5u, counters.signaled);
+    VERIFY_ARE_EQUAL(1u, counters.raised);
+    VERIFY_ARE_EQUAL(4u, counters.suppressed);
+}
+
+void UiaEventCoalescerTests::MinIntervalLimitsContinuousEvents()
+{
+    MockUiaEventDispatcher dispatcher;
+    UiaEventCoalescer coalescer{ &dispatcher, 100ms, 20ms };
+
+    // One frame every 10ms for a whole second, each with new text. The output
+    // never stops for the quiet period, so only the minimum interval applies.
+    auto now = _start;
+    for (auto frame = 0; frame < 100; frame++)
+    {
+        coalescer.Signal(Event::TextChanged, now);
+        const auto nextDue = coalescer.Flush(now);
+        if (nextDue)
+        {
+            VERIFY_IS_TRUE(*nextDue > now);
+            VERIFY_IS_TRUE(coalescer.HasPendingEvents());
+        }
+        now += 10ms;
+    }
+
+    // A held back event goes out one minimum interval after it was first
+    // signaled, which is the frame after the last one was raised:
+    // raised at 0ms, 110ms, 220ms, ... 990ms.
+    VERIFY_ARE_EQUAL(10u, dispatcher.Count(Event::TextChanged));
+
+    // The last frame happened to be raised too, so nothing is left waiting.
+    VERIFY_IS_FALSE(coalescer.HasPendingEvents());
+
+    const auto counters = coalescer.GetCounters(Event::TextChanged);
+    VERIFY_ARE_EQUAL(100u, counters.signaled);
+    VERIFY_ARE_EQUAL(10u, counters.raised);
+    VERIFY_ARE_EQUAL(90u, counters.suppressed);
+}
+
+void UiaEventCoalescerTests::QuietPeriodFlushesEarly()
+{
+    MockUiaEventDispatcher dispatcher;
+    UiaEventCoalescer coalescer{ &dispatcher, 100ms, 20ms };
+
+    coalescer.Signal(Event::CursorChanged, _start);
+    coalescer.Flush(_start);
+    VERIFY_ARE_EQUAL(1u, dispatcher.Count(Event::CursorChanged));
+
+    // A keystroke 90ms later is held back by the minimum interval...
+    const auto keystroke = _start + 90ms;
+    coalescer.Signal(Event::CursorChanged, keystroke);
+    const auto nextDue = coalescer.Flush(keystroke);
+    VERIFY_ARE_EQUAL(1u, dispatcher.Count(Event::CursorChanged));
+
+    // ...and then only until nothing else has happened for the quiet period,
+    // which is sooner than waiting for a whole minimum interval again.
+    VERIFY_IS_TRUE(nextDue.has_value());
+    VERIFY_IS_TRUE(*nextDue == keystroke + 20ms);
+
+    VERIFY_IS_TRUE(coalescer.Flush(keystroke + 19ms).has_value());
+    VERIFY_ARE_EQUAL(1u, dispatcher.Count(Event::CursorChanged));
+
+    VERIFY_IS_FALSE(coalescer.Flush(keystroke + 20ms).has_value());
+    VERIFY_ARE_EQUAL(2u, dispatcher.Count(Event::CursorChanged));
+}
+
+void UiaEventCoalescerTests::QuietPeriodNeverBeatsMinInterval()
+{
+    MockUiaEventDispatcher dispatcher;
+    UiaEventCoalescer coalescer{ &dispatcher, 100ms, 20ms };
+
+    // One signal every 50ms: closer together than the minimum interval,
+    // but far enough apart that the quiet period passes between each of them.
+    // Whenever the coalescer asks for it, the timer fires before the next signal.
+    std::vector<UiaEventCoalescer::clock::time_point> raisedAt;
+    const auto flush = [&](const UiaEventCoalescer::clock::time_point now) {
+        const auto before = dispatcher.Count(Event::TextChanged);
+        const auto nextDue = coalescer.Flush(now);
+        if (dispatcher.Count(Event::TextChanged) != before)
+        {
+            raisedAt.push_back(now);
+        }
+        return nextDue;
+    };
+
+    auto now = _start;
+    for (auto signal = 0; signal < 20; signal++)
+    {
+        coalescer.Signal(Event::TextChanged, now);
+        const auto nextDue = flush(now);
+        if (nextDue && *nextDue < now + 50ms)
+        {
+            flush(*nextDue);
+        }
+
+        now += 50ms;
+    }
+
+    // The first one goes out right away. The second is raised once the minimum
+    // interval has passed and the signals went quiet again, at 120ms. From
+    // then on, the signals are merged in pairs: 220ms, 320ms, ... 920ms.
+    VERIFY_ARE_EQUAL(10u, raisedAt.size());
+    VERIFY_IS_TRUE(raisedAt.at(1) == _start + 120ms);
+    for (size_t i = 1; i < raisedAt.size(); i++)
+    {
+        VERIFY_IS_TRUE(raisedAt.at(i) - raisedAt.at(i - 1) >= 100ms, L"The quiet period never beats the minimum interval.");
+    }
+
+    // The last signal at 950ms waits for the minimum interval too.
+    VERIFY_IS_TRUE(coalescer.HasPendingEvents());
+    VERIFY_IS_TRUE(coalescer.Flush(now).has_value());
+    VERIFY_IS_FALSE(coalescer.Flush(_start + 1020ms).has_value());
+    VERIFY_ARE_EQUAL(11u, dispatcher.Count(Event::TextChanged));
+
+    const auto counters = coalescer.GetCounters(Event::TextChanged);
+    VERIFY_ARE_EQUAL(20u, counters.signaled);
+    VERIFY_ARE_EQUAL(11u, counters.raised);
+    VERIFY_ARE_EQUAL(9u, counters.suppressed);
+}
+
+void UiaEventCoalescerTests::EventKindsAreLimitedIndependently()
+{
+    MockUiaEventDispatcher dispatcher;
+    UiaEventCoalescer coalescer{ &dispatcher, 100ms, 50ms };
+
+    coalescer.Signal(Event::TextChanged, _start);
+    coalescer.Flush(_start);
+
+    // Text was just raised, but the selection never was.
+    const auto later = _start + 10ms;
+    coalescer.Signal(Event::TextChanged, later);
+    coalescer.Signal(Event::SelectionChanged, later);
+    const auto nextDue = coalescer.Flush(later);
+
+    VERIFY_ARE_EQUAL(1u, dispatcher.Count(Event::TextChanged));
+    VERIFY_ARE_EQUAL(1u, dispatcher.Count(Event::SelectionChanged));
+    VERIFY_IS_TRUE(nextDue.has_value());
+    VERIFY_IS_TRUE(*nextDue == _start + 100ms);
+
+    const auto total = coalescer.GetTotalCounters();
+    VERIFY_ARE_EQUAL(3u, total.signaled);
+    VERIFY_ARE_EQUAL(2u, total.raised);
+    VERIFY_ARE_EQUAL(0u, total.suppressed);
+}
+
+void UiaEventCoalescerTests::ZeroIntervalRaisesEveryFlush()
+{
+    MockUiaEventDispatcher dispatcher;
+    UiaEventCoalescer coalescer{ &dispatcher, 0ms, 0ms };
+
+    auto now = _start;
+    for (auto frame = 0; frame < 10; frame++)
+    {
+        coalescer.Signal(Event::TextChanged, now);
+        VERIFY_IS_FALSE(coalescer.Flush(now).has_value());
+        now += 1ms;
+    }
+
+    VERIFY_ARE_EQUAL(10u, dispatcher.Count(Event::TextChanged));
+    VERIFY_ARE_EQUAL(0u, coalescer.GetCounters(Event::TextChanged).suppressed);
+}
+
+void UiaEventCoalescerTests::DiscardPendingCountsAsSuppressed()
+{
+    MockUiaEventDispatcher dispatcher;
+    UiaEventCoalescer coalescer{ &dispatcher, 100ms, 20ms };
+
+    coalescer.Signal(Event::TextChanged, _start);
+    coalescer.Flush(_start);
+
+    coalescer.Signal(Event::TextChanged, _start + 1ms);
+    coalescer.Signal(Event::CursorChanged, _start + 1ms);
+    coalescer.Flush(_start + 1ms);
+    VERIFY_IS_TRUE(coalescer.HasPendingEvents());
+
+    coalescer.DiscardPending();
+    VERIFY_IS_FALSE(coalescer.HasPendingEvents());
+    VERIFY_IS_FALSE(coalescer.Flush(_start + 1s).has_value());
+
+    const auto total = coalescer.GetTotalCounters();
+    VERIFY_ARE_EQUAL(3u, total.signaled);
+    VERIFY_ARE_EQUAL(2u, total.raised);
+    VERIFY_ARE_EQUAL(1u, total.suppressed);
+    VERIFY_ARE_EQUAL(total.signaled, total.raised + total.suppressed);
+}
+
+void UiaEventCoalescerTests::CollectLeavesRaisingToTheCaller()
+{
+    MockUiaEventDispatcher dispatcher;
+    UiaEventCoalescer coalescer{ &dispatcher, 100ms, 20ms };
+
+    coalescer.Signal(Event::CursorChanged, _start);
+    coalescer.Signal(Event::SelectionChanged, _start);
+
+    UiaEventCoalescer::DueEvents due;
+    VERIFY_IS_FALSE(coalescer.Collect(_start, due).has_value());
+    VERIFY_IS_TRUE(dispatcher.events.empty(), L"Collect doesn't raise anything.");
+    VERIFY_IS_FALSE(coalescer.HasPendingEvents());
+    VERIFY_ARE_EQUAL(2u, coalescer.GetTotalCounters().raised);
+
+    coalescer.Raise(due);
+    const std::vector<Event> expected{ Event::SelectionChanged, Event::CursorChanged };
+    VERIFY_ARE_EQUAL(expected.size(), dispatcher.events.size());
+    VERIFY_IS_TRUE(expected == dispatcher.events);
+}